@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @file    boot_time.h
+ * @brief   Boot-time budget of the Boot: records of the last boots in backup
+ *          SRAM, completed with the time of the jump and printed at start-up
+ ******************************************************************************
+ */
+
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#include "main.h"
+#include "boot_time_record.h"
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Read the cycle counter left running by the Boot: end of the jump
+ * @note   Call it first in main, before anything takes time
+ */
+void Boot_Time_AppliStart(void);
+
+/**
+ * @brief  Copy the record
+ * @retval 1 if the record is valid, 0 otherwise
+ */
+int Boot_Time_Load(Boot_Time_Record_t *record);
+
+/**
+ * @brief  Add the time of the jump to the entry of this boot and print the
+ *         entries, oldest first
+ * @note   The backup SRAM must be enabled (XIP_Profile_Init)
+ */
+void Boot_Time_Report(void);
+
+/**
+ * @brief  Sum of the phases of an entry, in us
+ */
+uint32_t Boot_Time_Total(const Boot_Time_Entry_t *entry);
+
+#endif /* BOOT_TIME_H */
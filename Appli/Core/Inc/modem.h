@@ -7,7 +7,26 @@
 #include <stdio.h>
 #include "usbh_def.h"
 #include "usbh_cdc.h"
+#include "psram.h"
+#include "fw_store.h"
+
+/* 1: stream the chunks into the eMMC firmware store (fw_store.c) instead of
+ *    Slot B: the Boot installs the image and keeps the one it replaces for a
+ *    rollback. Needs OTA_DIRECT_FLASH */
+#ifndef OTA_EMMC_STORE
+#define OTA_EMMC_STORE      FW_STORE_ENABLE
+#endif
 
+/* 1: stream every chunk straight into Slot B (ota_flash.c), size limited by
+ *    the slot only. 0: keep the whole file in a buffer (mailbox flow), in
+ *    the PSRAM when the board carries it, then the Boot programs Slot B */
+#ifndef OTA_DIRECT_FLASH
+#if (PSRAM_ENABLE == 1) && !OTA_EMMC_STORE
+#define OTA_DIRECT_FLASH    0
+#else
+#define OTA_DIRECT_FLASH    1
+#endif
+#endif
 
 typedef enum {
     MODEM_OK = 0,
@@ -58,11 +77,14 @@ OTA_Status_t OTA_DownloadFirmware_v2(const char *url, uint32_t *downloadedSize);
 
 
 Modem_Status_t OTA_VerifyFirmwareCRC(void);
+Modem_Status_t OTA_RequestBoot(void);
 
 
 
 void Modem_TestHTTPS_OTA(void);
+#if !OTA_DIRECT_FLASH
 uint8_t* OTA_GetFirmwareBuffer(void);
+#endif
 uint32_t OTA_GetFirmwareSize(void);
 void OTA_TestChunkSizes(void);
 
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ * @file    ota_flash.h
+ * @brief   Direct-to-flash OTA staging into Slot B while executing from Slot A
+ ******************************************************************************
+ */
+
+#ifndef OTA_FLASH_H
+#define OTA_FLASH_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                    SHARED DEFINITIONS (Must match Boot!)                   */
+/*============================================================================*/
+
+#define OTA_MAGIC               0x4F544131  /* "OTA1" */
+#define OTA_HEADER_SIZE         16
+
+/* Boot flags in RTC backup register */
+#define BOOT_FLAG_NORMAL        0x00000000
+#define BOOT_FLAG_UPDATE        0x55AA55AA  /* Image waiting in the SRAM or PSRAM mailbox */
+#define BOOT_FLAG_STAGED        0x5AA55AA5  /* Image already written to Slot B */
+#define BOOT_FLAG_STORE_INSTALL 0x5A5AA5A5  /* Candidate of the eMMC store to install in Slot B */
+#define BOOT_FLAG_STORE_ROLLBACK 0xA5A55A5A /* Previous image of the eMMC store to install again */
+
+/* Application slots */
+#define SLOT_A_FLASH_ADDR       0x00000000  /* Flash internal address */
+#define SLOT_B_FLASH_ADDR       0x01000000  /* 16MB offset */
+#define SLOT_A_CPU_ADDR         0x70000000  /* Memory-mapped address */
+#define SLOT_B_CPU_ADDR         0x71000000
+#define SLOT_SIZE               0x01000000
+
+/* Staged image header (same 16 bytes as the OTA file header) lives in the
+ * last 4KB sector of Slot B, so the image itself starts at the slot base */
+#define SLOT_B_HEADER_ADDR      (SLOT_B_FLASH_ADDR + SLOT_SIZE - 0x1000)
+#define OTA_SLOT_MAX_FW_SIZE    (SLOT_SIZE - 0x10000)
+
+/*============================================================================*/
+/*                          STATUS CODES                                      */
+/*============================================================================*/
+
+typedef enum {
+    OTA_FLASH_OK = 0,
+    OTA_FLASH_ERROR,
+    OTA_FLASH_NOT_READY,
+    OTA_FLASH_INVALID_FW,
+    OTA_FLASH_ERASE_ERROR,
+    OTA_FLASH_WRITE_ERROR,
+    OTA_FLASH_VERIFY_ERROR
+} OTA_Flash_Status_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Relocate the vector table to RAM and attach the ExtMem manager to
+ *         the XSPI2 link the bootloader left in memory-mapped mode
+ * @note   Call once after HAL_Init(), before any other OTA_Flash_* call
+ */
+OTA_Flash_Status_t OTA_Flash_Init(void);
+
+/**
+ * @brief  Start a new staging session for an OTA file of fileSize bytes
+ *         (16-byte header included)
+ */
+OTA_Flash_Status_t OTA_Flash_Begin(uint32_t fileSize);
+
+/**
+ * @brief  Stage a chunk of the OTA file at the given file offset
+ * @note   Chunks are gathered in a page cache and programmed one full
+ *         cache at a time, blocks are erased on their first program.
+ *         OTA_Flash_Finish() programs what is left in the cache.
+ */
+OTA_Flash_Status_t OTA_Flash_Write(uint32_t fileOffset, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief  Check the staged image CRC (read through XIP) and store the header
+ *         in SLOT_B_HEADER_ADDR
+ */
+OTA_Flash_Status_t OTA_Flash_Finish(void);
+
+/**
+ * @brief  Ask the bootloader to validate and boot Slot B on next reset
+ */
+void OTA_Flash_RequestBoot(void);
+
+/**
+ * @brief  Ask the bootloader to program the image left in the mailbox
+ *         (PSRAM_MAILBOX_ADDR) on next reset
+ * @note   The D-cache lines of the mailbox must be cleaned first
+ */
+void OTA_Flash_RequestMailbox(void);
+
+/**
+ * @brief  Ask the bootloader to install the candidate of the eMMC store
+ *         (fw_store.h) into Slot B on next reset
+ */
+void OTA_Flash_RequestInstall(void);
+
+/**
+ * @brief  Ask the bootloader to install the previous image of the eMMC store
+ *         into Slot B again on next reset
+ */
+void OTA_Flash_RequestRollback(void);
+
+#endif /* OTA_FLASH_H */
@@ -33,7 +33,7 @@
 */
 
 #define EXTMEM_DRIVER_NOR_SFDP   1
-#define EXTMEM_DRIVER_PSRAM      0
+#define EXTMEM_DRIVER_PSRAM      1
 #define EXTMEM_DRIVER_SDCARD     0
 #define EXTMEM_DRIVER_USER       0
 
@@ -55,6 +55,8 @@
 extern XSPI_HandleTypeDef hxspi2;
 
 /* USER CODE BEGIN PV */
+/* XSPI1 of the PSRAM (EXTMEMORY_2), set up by PSRAM_Init() in psram.c */
+extern XSPI_HandleTypeDef hxspi1;
 
 /* USER CODE END PV */
 
@@ -63,11 +65,30 @@ extern XSPI_HandleTypeDef hxspi2;
   * @{
   */
 enum {
-  EXTMEMORY_1  = 0 /*!< ID=0 for the first memory  */
+  EXTMEMORY_1  = 0, /*!< ID=0 for the first memory  */
+  EXTMEMORY_2  = 1  /*!< ID=1 for the second memory  */
 };
 
 /* USER CODE BEGIN EC */
+/*
+  @brief static SFDP profile generated by tools/sfdp_profile: 0 runs the SFDP discovery at EXTMEM_Init
+         (set to 1 with EXTMEM_DRIVER_NOR_SFDP_PROFILE_FILE to skip it, see tools/sfdp_profile/README.md)
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE 0
 
+/*
+  @brief the 8 lines link must come up in octal DTR (8D8D8D with DQS), EXTMEM_Init fails otherwise
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_OCTAL_DTR      1
+
+/*
+  @brief read timing calibrated by the Boot, applied again when OTA_Flash_Init runs EXTMEM_Init
+         (same record as the Boot: backup SRAM after its 1KB SFDP cache, the BKPSRAM clock is
+         enabled by XIP_Profile_Init)
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE          1
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_ADDRESS  (BKPSRAM_BASE + 1024u)
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_SIZE     64u
 /* USER CODE END EC */
 
 /* Exported configuration --------------------------------------------------------*/
@@ -75,9 +96,9 @@ enum {
   * @{
   */
 
-extern EXTMEM_DefinitionTypeDef extmem_list_config[1];
+extern EXTMEM_DefinitionTypeDef extmem_list_config[2];
 #if defined(EXTMEM_C)
-EXTMEM_DefinitionTypeDef extmem_list_config[1];
+EXTMEM_DefinitionTypeDef extmem_list_config[2];
 #endif /* EXTMEM_C */
 
 /**
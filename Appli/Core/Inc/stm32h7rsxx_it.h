@@ -59,6 +59,7 @@ void UART4_IRQHandler(void);
 void OTG_HS_IRQHandler(void);
 void SDMMC1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void GPDMA1_Channel0_IRQHandler(void);
 
 /* USER CODE END EFP */
 
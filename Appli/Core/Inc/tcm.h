@@ -0,0 +1,57 @@
+/**
+ ******************************************************************************
+ * @file    tcm.h
+ * @brief   Tightly coupled memories: hot code paths executed from ITCM and
+ *          the vector table in DTCM
+ ******************************************************************************
+ */
+
+#ifndef TCM_H
+#define TCM_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 0 to leave the functions marked ITCM_FUNC in flash (XIP) */
+#ifndef APPLI_ITCM_FUNC
+#define APPLI_ITCM_FUNC         1
+#endif
+
+/* 16 system exceptions + 156 IRQ lines (g_pfnVectors in the startup file) */
+#define TCM_VECTOR_COUNT        172U
+
+/*============================================================================*/
+/*                          ATTRIBUTES                                        */
+/*============================================================================*/
+
+#if APPLI_ITCM_FUNC == 1
+/* Linked into .itcm_text and copied from flash by the startup. Not inlined,
+ * so that the code does not come back to flash inside a caller. */
+#define ITCM_FUNC               __attribute__((section(".itcm_text"), noinline))
+#else
+#define ITCM_FUNC
+#endif
+
+/* Zero wait state data, not initialized by the startup (NOLOAD) */
+#define DTCM_BSS                __attribute__((section(".dtcm_bss")))
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/* Vector table of the image, in flash */
+extern const uint32_t g_pfnVectors[];
+
+/**
+ * @brief  Copy the vector table of the image to DTCM and point VTOR on it.
+ *         The exception entries no longer fetch from XIP, and the table
+ *         stays readable while XSPI2 leaves memory-mapped mode.
+ * @note   Does nothing once the table is relocated
+ */
+void TCM_RelocateVectors(void);
+
+#endif /* TCM_H */
@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ * @file    xip_bench.h
+ * @brief   XIP benchmark: CoreMark-style kernels and image reads executed
+ *          from the slot, for each XSPI profile and MPU preset, and the
+ *          kernels executed from ITCM
+ ******************************************************************************
+ */
+
+#ifndef XIP_BENCH_H
+#define XIP_BENCH_H
+
+#include "xip_profile.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 1 to sweep the profiles at start-up (one reset per XSPI profile) */
+#ifndef APPLI_XIP_BENCH
+#define APPLI_XIP_BENCH         0
+#endif
+
+#define XIP_BENCH_CORE_RUNS     8U              /* kernel runs, each from a cold I-cache */
+#define XIP_BENCH_SEQ_SIZE      0x00010000U     /* image bytes read in sequence (64KB) */
+#define XIP_BENCH_RAND_SPAN     0x00040000U     /* window of the random line reads (256KB) */
+#define XIP_BENCH_RAND_COUNT    2048U           /* random line reads */
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef struct {
+    uint32_t coreCycles;        /* CoreMark-style kernels: list, matrix, state machine */
+    uint32_t itcmCycles;        /* the same kernels executed from ITCM */
+    uint32_t seqCycles;         /* checksum of the start of the image, as the OTA checks do */
+    uint32_t randCycles;        /* one word per line at random offsets: wrapped line fills */
+    uint16_t crc;               /* result of the kernels, the same for every profile */
+    uint16_t itcmCrc;           /* result of the ITCM kernels, the same as crc */
+} XIP_Bench_Result_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Measure the running profile, the caches are dropped before each part
+ */
+void XIP_Bench_Measure(XIP_Bench_Result_t *result);
+
+/**
+ * @brief  One step of the profile sweep: measure the XSPI profile set by the
+ *         Boot with every MPU preset, then reset for the next profile. Once
+ *         every profile is measured, the fastest pair is stored in the record
+ *         (the Boot and XIP_Profile_Init apply it) and the table is printed.
+ * @note   A completed sweep is only reported; clear the record to run a new one
+ * @retval 0 once the sweep is complete, does not return otherwise
+ */
+int XIP_Bench_Run(void);
+
+#endif /* XIP_BENCH_H */
@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * @file    xip_profile.h
+ * @brief   XIP profile of the Appli: MPU cache policy of the memory-mapped
+ *          NOR and record shared with the Boot, which sets the XSPI side
+ ******************************************************************************
+ */
+
+#ifndef XIP_PROFILE_H
+#define XIP_PROFILE_H
+
+#include "main.h"
+#include "xip_record.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* MPU preset while no valid record selects one: the policy of MPU_Config */
+#ifndef APPLI_XIP_MPU_DEFAULT
+#define APPLI_XIP_MPU_DEFAULT       XIP_MPU_WRITE_BACK
+#endif
+
+/* Region of MPU_Config covering both slots */
+#define XIP_MPU_REGION              MPU_REGION_NUMBER1
+#define XIP_MPU_BASE                0x70000000U
+#define XIP_MPU_SIZE                MPU_REGION_SIZE_32MB
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Enable the backup SRAM and apply the MPU preset of the record
+ * @note   Call it once the caches are enabled, MPU_Config has set the region
+ */
+void XIP_Profile_Init(void);
+
+/**
+ * @brief  Set the cache policy of the slots, then drop the cached lines so
+ *         that the next fetches use it
+ */
+void XIP_Profile_SetMpu(XIP_Mpu_t preset);
+
+/**
+ * @brief  Copy the record
+ * @retval 1 if the record is valid, 0 otherwise
+ */
+int XIP_Profile_Load(XIP_Profile_Record_t *record);
+
+/**
+ * @brief  Write the record, the check word is computed here
+ */
+void XIP_Profile_Save(XIP_Profile_Record_t *record);
+
+const char *XIP_Profile_MpuName(XIP_Mpu_t preset);
+
+#endif /* XIP_PROFILE_H */
@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * @file    boot_time.c
+ * @brief   Boot-time budget report - STM32H7S3
+ *
+ * The Boot times its phases and writes them before the jump. The cycle
+ * counter keeps running across the jump (neither image clears it after the
+ * Boot main has started), so the time from the save of the Boot to the
+ * first line of this main is the difference of two readings, at the clock
+ * the Boot left.
+ ******************************************************************************
+ */
+
+#include "boot_time.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+/* Indexed by Boot_Phase_t */
+static const char *const phaseNames[BOOT_PHASE_COUNT] = {
+    "hal", "clock", "periph", "emmc", "xspi", "update", "extmem", "xip", "jump", "handover"
+};
+
+static uint32_t appliStartCycles;
+static uint8_t appliStartValid;
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+void Boot_Time_AppliStart(void)
+{
+    appliStartCycles = DWT->CYCCNT;
+    appliStartValid = ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U);
+}
+
+int Boot_Time_Load(Boot_Time_Record_t *record)
+{
+    memcpy(record, BOOT_TIME_RECORD, sizeof(*record));
+    return (record->magic == BOOT_TIME_MAGIC) && (record->check == Boot_Time_Check(record))
+           && (record->next < BOOT_TIME_HISTORY);
+}
+
+uint32_t Boot_Time_Total(const Boot_Time_Entry_t *entry)
+{
+    uint32_t total = 0;
+
+    for (uint32_t phase = 0; phase < BOOT_PHASE_COUNT; phase++)
+    {
+        total += entry->phaseUs[phase];
+    }
+    return total;
+}
+
+void Boot_Time_Report(void)
+{
+    Boot_Time_Record_t record;
+    Boot_Time_Entry_t *last;
+
+    if (Boot_Time_Load(&record) == 0)
+    {
+        LOG_INF("[BOOT TIME] No record\r\n");
+        return;
+    }
+
+    /* Entry of this boot: the jump is only added once, a reset of the Appli alone keeps it */
+    last = &record.entries[(record.next + BOOT_TIME_HISTORY - 1U) % BOOT_TIME_HISTORY];
+    if ((last->phaseUs[BOOT_PHASE_HANDOVER] == 0U) && (appliStartValid != 0U) && (record.coreClock >= 1000000U))
+    {
+        last->phaseUs[BOOT_PHASE_HANDOVER] = (appliStartCycles - last->jumpCycles) / (record.coreClock / 1000000U);
+        record.check = Boot_Time_Check(&record);
+        memcpy(BOOT_TIME_RECORD, &record, sizeof(record));
+    }
+
+    for (uint32_t i = 0; i < BOOT_TIME_HISTORY; i++)
+    {
+        const Boot_Time_Entry_t *entry = &record.entries[(record.next + i) % BOOT_TIME_HISTORY];
+
+        if (Boot_Time_Total(entry) == 0U)
+        {
+            continue;       /* not written yet */
+        }
+
+        LOG_INF("[BOOT TIME] #%lu%s%s slot %c: %lu us =",
+                (unsigned long)entry->sequence,
+                ((entry->flags & BOOT_TIME_FLAG_UPDATE) != 0U) ? " update" : "",
+                ((entry->flags & BOOT_TIME_FLAG_FAST) != 0U) ? " fast" : "",
+                ((entry->flags & BOOT_TIME_FLAG_SLOT_B) != 0U) ? 'B' : 'A',
+                (unsigned long)Boot_Time_Total(entry));
+        for (uint32_t phase = 0; phase < BOOT_PHASE_COUNT; phase++)
+        {
+            if (entry->phaseUs[phase] != 0U)
+            {
+                LOG_INF(" %s %lu", phaseNames[phase], (unsigned long)entry->phaseUs[phase]);
+            }
+        }
+        LOG_INF("\r\n");
+    }
+}
@@ -24,6 +24,15 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "modem.h"
+#include "ota_flash.h"
+#include "xip_profile.h"
+#include "xip_bench.h"
+#include "boot_time.h"
+#include "tcm.h"
+#include "psram.h"
+#include "fw_store.h"
+#include "trace.h"
+#include "log.h"
 #include <stdio.h>
 #include <string.h>
 /* USER CODE END Includes */
@@ -73,11 +82,11 @@ void MX_USB_HOST_Process(void);
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
-/* Retarget printf to UART4 */
+/* Retarget printf to UART4, through the DMA log ring */
 #ifdef __GNUC__
 int _write(int file, char *ptr, int len)
 {
-    HAL_UART_Transmit(&huart4, (uint8_t*)ptr, len, HAL_MAX_DELAY);
+    (void)Log_Write(ptr, (uint32_t)len);
     return len;
 }
 #endif
@@ -90,7 +99,7 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
         /* Check what character was received */
         if(uart4_rx_byte == 'o' || uart4_rx_byte == 'O')
         {
-        	printf("[MODEM] Turning off modem\r\n");
+        	LOG_INF("[MODEM] Turning off modem\r\n");
         	HAL_GPIO_WritePin(MODEM_PWR_OFF_GPIO_Port, MODEM_PWR_OFF_Pin, 0);
         }
         HAL_UART_Receive_IT(&huart4, &uart4_rx_byte, 1);
@@ -109,6 +118,9 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
+	  /* End of the jump from the Boot, for the boot-time budget */
+	  Boot_Time_AppliStart();
+
 	  SCB_InvalidateDCache();
 	  SCB_InvalidateICache();
 
@@ -134,7 +146,11 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  /* Exception entries fetch their vector from DTCM instead of XIP */
+  TCM_RelocateVectors();
+  /* Cache policy of the slots: MPU preset stored by the XIP benchmark */
+  XIP_Profile_Init();
+  Trace_Init(TRACE_IMAGE_APPLI);
   /* USER CODE END Init */
 
   /* USER CODE BEGIN SysInit */
@@ -149,25 +165,78 @@ int main(void)
   MX_SDMMC1_MMC_Init();
 //  MX_EXTMEM_MANAGER_Init();
   /* USER CODE BEGIN 2 */
+  Log_Init(&huart4);
   HAL_UART_Receive_IT(&huart4, &uart4_rx_byte, 1);
-  printf("MAIN APPLICATION STARTED\r\n");
+  LOG_INF("MAIN APPLICATION STARTED\r\n");
+
+  /* Phases of the last boots, measured by the Boot */
+  Boot_Time_Report();
+
+#if APPLI_XIP_BENCH == 1
+  /* Development builds: one reset per XSPI profile until the sweep is complete */
+  (void)XIP_Bench_Run();
+#endif
+
+#if PSRAM_ENABLE == 1
+  /* OTA mailbox and heap of the large buffers */
+  if (PSRAM_Init() != 0)
+  {
+	  LOG_WRN("[PSRAM] Not available, OTA mailbox disabled\r\n");
+  }
+#if PSRAM_BENCH == 1
+  else
+  {
+	  PSRAM_Bench_Result_t psramBench;
+
+	  if (PSRAM_Bench_Run(&psramBench) != 0)
+	  {
+		  LOG_ERR("[PSRAM] Bench: %lu words read back wrong\r\n", psramBench.errors);
+	  }
+	  LOG_INF("[PSRAM] write %lu KB/s, read %lu KB/s, copy to SRAM %lu KB/s\r\n",
+	          psramBench.writeKBps, psramBench.readKBps, psramBench.copyKBps);
+  }
+#endif
+#endif
+
+  if (OTA_Flash_Init() != OTA_FLASH_OK)
+  {
+	  LOG_WRN("[OTA] Direct Slot B staging unavailable\r\n");
+  }
 
   HAL_MMC_CardInfoTypeDef cardInfo;
   	if (HAL_MMC_GetCardInfo(&hmmc1, &cardInfo) == HAL_OK) {
-  		char msg[128];
   		uint64_t totalSize = (uint64_t) cardInfo.LogBlockNbr
   				* cardInfo.LogBlockSize;
 
-  		sprintf(msg, "eMMC size: %lu blocks of %lu bytes = %.2f MB\r\n",
+  		LOG_INF("eMMC size: %lu blocks of %lu bytes = %.2f MB\r\n",
   				cardInfo.LogBlockNbr, cardInfo.LogBlockSize,
   				(float) totalSize / (1024 * 1024));
-
-  		HAL_UART_Transmit(&huart4, (uint8_t*) msg, strlen(msg), HAL_MAX_DELAY);
   	} else {
-  		char *err = "Error getting eMMC card info\r\n";
-  		HAL_UART_Transmit(&huart4, (uint8_t*) err, strlen(err), HAL_MAX_DELAY);
+  		LOG_ERR("Error getting eMMC card info\r\n");
   	}
 
+#if FW_STORE_ENABLE == 1
+  /* Firmware store: candidate downloaded here, installed by the Boot */
+  if (FW_Store_Init(&hmmc1) != FW_STORE_OK)
+  {
+	  LOG_WRN("[STORE] eMMC firmware store unavailable\r\n");
+  }
+  else
+  {
+	  static const char *const roleName[FW_STORE_ROLE_COUNT] = { "current", "previous", "candidate" };
+
+	  for (uint32_t role = 0; role < FW_STORE_ROLE_COUNT; role++)
+	  {
+		  const FW_Store_Image_t *image = FW_Store_GetImage((FW_Store_Role_t)role);
+
+		  if (image != NULL)
+		  {
+			  LOG_INF("[STORE] %s: version 0x%08lX, %lu bytes\r\n", roleName[role], image->version, image->fwSize);
+		  }
+	  }
+  }
+#endif
+
   HAL_PWREx_EnableUSBHSregulator();
   HAL_Delay(100);
 
@@ -191,10 +260,13 @@ int main(void)
 
   if(MODEM_OK != Modem_Init())
   {
-	  printf("[MODEM] FAILED to Initialize the Modem\r\n");
+	  LOG_ERR("[MODEM] FAILED to Initialize the Modem\r\n");
 	  while(1);
   }
 
+  /* Spans of the start (USB enumeration, AT commands), for tools/trace_decode */
+  Trace_Dump(&huart4);
+
 
 
 
@@ -204,21 +276,31 @@ int main(void)
 
   if (OTA_TestDownload() == MODEM_OK)
   {
-      printf("Firmware downloaded successfully!\r\n");
-
-      /* Access the firmware data */
-      uint8_t *fw = OTA_GetFirmwareBuffer();
+      LOG_INF("Firmware downloaded successfully!\r\n");
 
       uint32_t size = OTA_GetFirmwareSize();
-      printf("Size : %ld\n", size);
+      LOG_INF("Size : %ld\n", size);
       /* Now you can flash it or verify CRC */
       if(OTA_VerifyFirmwareCRC() == MODEM_OK)
       {
-
+          (void)OTA_RequestBoot();
       }
 
   }
 
+  /* Spans of the first download */
+  Trace_Dump(&huart4);
+
+  {
+    Log_Stats_t logStats;
+
+    Log_GetStats(&logStats);
+    LOG_INF("[LOG] %lu bytes, %lu dropped (%lu full, %lu from interrupts), ring peak %lu\r\n",
+            (unsigned long)logStats.written, (unsigned long)logStats.dropped,
+            (unsigned long)logStats.overruns, (unsigned long)logStats.collisions,
+            (unsigned long)logStats.highWater);
+  }
+
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -228,13 +310,10 @@ int main(void)
 	  HAL_Delay(50000);
 	  if (OTA_TestDownload() == MODEM_OK)
 	  {
-	      printf("Firmware downloaded successfully!\r\n");
+	      LOG_INF("Firmware downloaded successfully!\r\n");
 
-	      /* Access the firmware data */
-	      uint8_t *fw = OTA_GetFirmwareBuffer();
-	      (void)fw;
 	      uint32_t size = OTA_GetFirmwareSize();
-	      printf("Size : %ld\n", size);
+	      LOG_INF("Size : %ld\n", size);
 	      /* Now you can flash it or verify CRC */
 	       OTA_VerifyFirmwareCRC();
 	  }
@@ -549,6 +628,7 @@ void Error_Handler(void)
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
   __disable_irq();
+  Log_FaultFlush();
   while (1)
   {
   }
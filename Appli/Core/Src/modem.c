@@ -6,6 +6,12 @@
  */
 
 #include "modem.h"
+#include "ota_flash.h"
+#include "psram.h"
+#include "fw_store.h"
+#include "tcm.h"
+#include "trace.h"
+#include "log.h"
 
 
 /* External declarations */
@@ -102,9 +108,27 @@ uint8_t Modem_IsReady(void)
 /*                          AT COMMAND FUNCTIONS                              */
 /*============================================================================*/
 
-Modem_Status_t Modem_SendCommandWaitURC(const char *cmd, const char *expectedURC,
-                                         char *response, uint32_t maxLen,
-                                         uint32_t timeout)
+#if TRACE_ENABLE == 1
+/**
+ * @brief  Tag of the trace span of a command: last 4 characters of its name
+ *         ("AT+HTTPREAD=0,512\r\n" gives "READ")
+ */
+static uint32_t Modem_TraceTag(const char *cmd)
+{
+    uint32_t len = strcspn(cmd, "=?\r\n");
+    uint32_t tag = 0;
+
+    for (uint32_t i = (len > 4U) ? (len - 4U) : 0U; i < len; i++)
+    {
+        tag = (tag >> 8) | ((uint32_t)(uint8_t)cmd[i] << 24);
+    }
+    return tag >> (8U * (4U - ((len > 4U) ? 4U : len)));
+}
+#endif
+
+static Modem_Status_t Modem_ExchangeWaitURC(const char *cmd, const char *expectedURC,
+                                            char *response, uint32_t maxLen,
+                                            uint32_t timeout)
 {
     uint32_t start = HAL_GetTick();
     uint32_t idx = 0;
@@ -116,7 +140,7 @@ Modem_Status_t Modem_SendCommandWaitURC(const char *cmd, const char *expectedURC
 
     USB_CDC_FlushRx();
     memset(response, 0, maxLen);
-    printf("[TX] %s", cmd);
+    LOG_DBG("[TX] %s", cmd);
     if (USB_CDC_Transmit((uint8_t*)cmd, strlen(cmd), 1000) != HAL_OK)
         return MODEM_ERROR;
 
@@ -155,21 +179,21 @@ Modem_Status_t Modem_SendCommandWaitURC(const char *cmd, const char *expectedURC
             /* Check for expected URC */
             if (strstr(response, expectedURC) != NULL)
             {
-                printf("[RX] %s\r\n", response);
+                LOG_DBG("[RX] %s\r\n", response);
                 return MODEM_OK;
             }
 
             /* Check for ERROR */
             if (strstr(response, "ERROR") != NULL)
             {
-                printf("[RX ERROR] %s\r\n", response);
+                LOG_WRN("[RX ERROR] %s\r\n", response);
                 return MODEM_ERROR;
             }
 
             /* Check for connection closed */
             if (strstr(response, "+CCHCLOSE:") != NULL && strstr(response, expectedURC) == NULL)
             {
-                printf("[RX CLOSED] %s\r\n", response);
+                LOG_WRN("[RX CLOSED] %s\r\n", response);
                 return MODEM_ERROR;
             }
         }
@@ -178,27 +202,40 @@ Modem_Status_t Modem_SendCommandWaitURC(const char *cmd, const char *expectedURC
         static uint32_t lastProgress = 0;
         if ((HAL_GetTick() - lastProgress) >= 10000)
         {
-            printf("    Still waiting... (%lu sec) gotOK=%d\r\n",
-                   (HAL_GetTick() - start) / 1000, gotOK);
+            LOG_DBG("    Still waiting... (%lu sec) gotOK=%d\r\n",
+                    (HAL_GetTick() - start) / 1000, gotOK);
             lastProgress = HAL_GetTick();
         }
 
         HAL_Delay(10);
     }
 
-    printf("[RX TIMEOUT] Response length: %lu bytes\r\n", idx);
+    LOG_WRN("[RX TIMEOUT] Response length: %lu bytes\r\n", idx);
     return MODEM_TIMEOUT;
 }
 
+Modem_Status_t Modem_SendCommandWaitURC(const char *cmd, const char *expectedURC,
+                                         char *response, uint32_t maxLen,
+                                         uint32_t timeout)
+{
+    Modem_Status_t status;
 
-Modem_Status_t Modem_SendCommand(const char *cmd, char *response, uint32_t maxLen, uint32_t timeout)
+    TRACE_BEGIN(TRACE_ID_AT_COMMAND, Modem_TraceTag(cmd));
+    status = Modem_ExchangeWaitURC(cmd, expectedURC, response, maxLen, timeout);
+    TRACE_END(TRACE_ID_AT_COMMAND, status);
+
+    return status;
+}
+
+
+static Modem_Status_t Modem_Exchange(const char *cmd, char *response, uint32_t maxLen, uint32_t timeout)
 {
     if (!USB_CDC_IsReady())
         return MODEM_NOT_READY;
 
     USB_CDC_FlushRx();
 
-    printf("[TX] %s", cmd);
+    LOG_DBG("[TX] %s", cmd);
     if (USB_CDC_Transmit((uint8_t*)cmd, strlen(cmd), 1000) != HAL_OK)
         return MODEM_ERROR;
 
@@ -233,14 +270,14 @@ Modem_Status_t Modem_SendCommand(const char *cmd, char *response, uint32_t maxLe
 
             if (strstr(response, "OK\r\n") != NULL)
             {
-            	printf("[RAW] %s", response);
-                printf("[RES] OK\r\n");
+            	LOG_DBG("[RAW] %s", response);
+                LOG_DBG("[RES] OK\r\n");
                 return MODEM_OK;
             }
             if (strstr(response, "ERROR") != NULL)
             {
-            	printf("[RAW] %s", response);
-                printf("[RX] ERROR\r\n");
+            	LOG_DBG("[RAW] %s", response);
+                LOG_DBG("[RX] ERROR\r\n");
                 return MODEM_ERROR;
             }
         }
@@ -248,16 +285,27 @@ Modem_Status_t Modem_SendCommand(const char *cmd, char *response, uint32_t maxLe
         HAL_Delay(5);
     }
 
-    printf("[RX] TIMEOUT\r\n");
+    LOG_DBG("[RX] TIMEOUT\r\n");
     return MODEM_TIMEOUT;
 }
 
+Modem_Status_t Modem_SendCommand(const char *cmd, char *response, uint32_t maxLen, uint32_t timeout)
+{
+    Modem_Status_t status;
+
+    TRACE_BEGIN(TRACE_ID_AT_COMMAND, Modem_TraceTag(cmd));
+    status = Modem_Exchange(cmd, response, maxLen, timeout);
+    TRACE_END(TRACE_ID_AT_COMMAND, status);
+
+    return status;
+}
+
 void Modem_SendRaw(const char *cmd)
 {
     if (!USB_CDC_IsReady())
         return;
 
-    printf("[TX] %s", cmd);
+    LOG_DBG("[TX] %s", cmd);
     USB_CDC_Transmit((uint8_t*)cmd, strlen(cmd), 1000);
 }
 
@@ -269,7 +317,7 @@ Modem_Status_t Modem_CheckNetwork(void)
 {
     char response[256];
 
-    printf("\r\n=== NETWORK STATUS ===\r\n");
+    LOG_INF("\r\n=== NETWORK STATUS ===\r\n");
 
     Modem_SendCommand("AT+CPIN?\r\n", response, sizeof(response), 2000);
     Modem_SendCommand("AT+CSQ\r\n", response, sizeof(response), 2000);
@@ -281,7 +329,7 @@ Modem_Status_t Modem_CheckNetwork(void)
     HAL_Delay(2000);
     Modem_SendCommand("AT+CGACT?\r\n", response, sizeof(response), 2000);
 
-    printf("======================\r\n\r\n");
+    LOG_INF("======================\r\n\r\n");
 
     return MODEM_OK;
 }
@@ -291,35 +339,35 @@ Modem_Status_t Modem_SetupDataConnection(const char *apn)
     char response[256];
     char cmd[128];
 
-    printf("\r\n=== SETUP DATA CONNECTION ===\r\n");
+    LOG_INF("\r\n=== SETUP DATA CONNECTION ===\r\n");
 
     /* Deactivate existing PDP */
-    printf("[1] Deactivating existing PDP...\r\n");
+    LOG_INF("[1] Deactivating existing PDP...\r\n");
     Modem_SendCommand("AT+CGACT=0,1\r\n", response, sizeof(response), 5000);
     Modem_PollUSB(1000);
 
     /* Set APN */
-    printf("[2] Setting APN: %s\r\n", apn);
+    LOG_INF("[2] Setting APN: %s\r\n", apn);
     snprintf(cmd, sizeof(cmd), "AT+CGDCONT=1,\"IP\",\"%s\"\r\n", apn);
     if (Modem_SendCommand(cmd, response, sizeof(response), 2000) != MODEM_OK)
     {
-        printf("[ERROR] Failed to set APN!\r\n");
+        LOG_ERR("[ERROR] Failed to set APN!\r\n");
         return MODEM_ERROR;
     }
 
     /* Activate PDP */
-    printf("[3] Activating PDP...\r\n");
+    LOG_INF("[3] Activating PDP...\r\n");
     if (Modem_SendCommand("AT+CGACT=1,1\r\n", response, sizeof(response), 30000) != MODEM_OK)
     {
-        printf("[ERROR] Failed to activate PDP!\r\n");
+        LOG_ERR("[ERROR] Failed to activate PDP!\r\n");
         return MODEM_ERROR;
     }
 
     /* Get IP address */
-    printf("[4] Getting IP address...\r\n");
+    LOG_INF("[4] Getting IP address...\r\n");
     Modem_SendCommand("AT+CGPADDR=1\r\n", response, sizeof(response), 2000);
 
-    printf("=============================\r\n\r\n");
+    LOG_INF("=============================\r\n\r\n");
 
     return MODEM_OK;
 }
@@ -332,11 +380,11 @@ Modem_Status_t Modem_HTTP_GET(const char *url, char *response, uint32_t maxLen)
 {
 //    char cmd[256];
 
-    printf("\r\n=== HTTP GET ===\r\n");
-    printf("URL: %s\r\n", url);
+    LOG_INF("\r\n=== HTTP GET ===\r\n");
+    LOG_INF("URL: %s\r\n", url);
 
     /* Initialize HTTP */
-    printf("[1] Init HTTP...\r\n");
+    LOG_INF("[1] Init HTTP...\r\n");
     Modem_SendCommand("AT+HTTPINIT\r\n", response, maxLen, 2000);
 
     Modem_SendCommand("AT+HTTPPARA=\"URL\",\"https://temp.staticsave.com/695294fc3309c.css", response, maxLen, 2000);
@@ -363,20 +411,20 @@ static void Modem_PrintRxBuffer(void)
 
         buf[len] = '\0';
 
-        printf("[RX]: ");
+        LOG_DBG("[RX]: ");
         for (uint32_t i = 0; i < len; i++)
         {
             char c = buf[i];
             if (c >= 32 && c <= 126)
-                printf("%c", c);
+                LOG_DBG("%c", c);
             else if (c == '\r')
-                printf("<CR>");
+                LOG_DBG("<CR>");
             else if (c == '\n')
-                printf("<LF>\r\n");
+                LOG_DBG("<LF>\r\n");
             else
-                printf("[%02X]", c);
+                LOG_DBG("[%02X]", c);
         }
-        printf("\r\n");
+        LOG_DBG("\r\n");
 
         available = USB_CDC_GetRxAvailable();
     }
@@ -396,12 +444,12 @@ Modem_Status_t Modem_WaitForATReady(uint32_t timeout)
     uint32_t start = HAL_GetTick();
     int attempts = 0;
 
-    printf("[STEP 5] Waiting for modem AT response...\r\n");
+    LOG_INF("[STEP 5] Waiting for modem AT response...\r\n");
 
     while ((HAL_GetTick() - start) < timeout)
     {
         attempts++;
-        printf("  Attempt %d (%lu ms)...\r\n", attempts, HAL_GetTick() - start);
+        LOG_DBG("  Attempt %d (%lu ms)...\r\n", attempts, HAL_GetTick() - start);
 
         /* Flush any pending data */
         USB_CDC_FlushRx();
@@ -439,9 +487,9 @@ Modem_Status_t Modem_WaitForATReady(uint32_t timeout)
                     /* Check for OK */
                     if (strstr(response, "OK") != NULL)
                     {
-                        printf("  Modem ready! (attempt %d, %lu ms)\r\n",
-                               attempts, HAL_GetTick() - start);
-                        printf("[STEP 5] Done\r\n\r\n");
+                        LOG_INF("  Modem ready! (attempt %d, %lu ms)\r\n",
+                                attempts, HAL_GetTick() - start);
+                        LOG_INF("[STEP 5] Done\r\n\r\n");
                         return MODEM_OK;
                     }
                 }
@@ -457,8 +505,8 @@ Modem_Status_t Modem_WaitForATReady(uint32_t timeout)
         }
     }
 
-    printf("  Timeout - no response after %d attempts!\r\n", attempts);
-    printf("[STEP 5] FAILED\r\n\r\n");
+    LOG_ERR("  Timeout - no response after %d attempts!\r\n", attempts);
+    LOG_ERR("[STEP 5] FAILED\r\n\r\n");
     return MODEM_TIMEOUT;
 }
 
@@ -466,29 +514,29 @@ Modem_Status_t Modem_Init(void)
 {
     char response[256];
 
-    printf("\r\n");
-    printf("##################################################\r\n");
-    printf("#            MODEM INIT START                    #\r\n");
-    printf("##################################################\r\n\r\n");
+    LOG_INF("\r\n");
+    LOG_INF("##################################################\r\n");
+    LOG_INF("#            MODEM INIT START                    #\r\n");
+    LOG_INF("##################################################\r\n\r\n");
 
     /*--- Step 1: Power On ---*/
-    printf("[STEP 1] Powering on modem...\r\n");
+    LOG_INF("[STEP 1] Powering on modem...\r\n");
     Modem_PowerOn();
-    printf("[STEP 1] Done\r\n\r\n");
+    LOG_INF("[STEP 1] Done\r\n\r\n");
 
     /*--- Step 2: Reset ---*/
-    printf("[STEP 2] Resetting modem...\r\n");
+    LOG_INF("[STEP 2] Resetting modem...\r\n");
     Modem_Reset();
-    printf("[STEP 2] Done\r\n\r\n");
+    LOG_INF("[STEP 2] Done\r\n\r\n");
 
     /*--- Step 3: Disable Airplane Mode ---*/
-    printf("[STEP 3] Disabling airplane mode...\r\n");
+    LOG_INF("[STEP 3] Disabling airplane mode...\r\n");
     HAL_GPIO_WritePin(MODEM_W_DIS1_GPIO_Port, MODEM_W_DIS1_Pin, GPIO_PIN_SET);
     HAL_Delay(500);
-    printf("[STEP 3] Done\r\n\r\n");
+    LOG_INF("[STEP 3] Done\r\n\r\n");
 
     /*--- Step 4: Wait for USB CDC ---*/
-    printf("[STEP 4] Waiting for USB CDC...\r\n");
+    LOG_INF("[STEP 4] Waiting for USB CDC...\r\n");
     uint32_t startTick = HAL_GetTick();
 
     while (!USB_CDC_IsReady())
@@ -497,78 +545,78 @@ Modem_Status_t Modem_Init(void)
 
         if ((HAL_GetTick() - startTick) > 30000)
         {
-            printf("[ERROR] USB CDC timeout!\r\n");
-            printf("##################################################\r\n");
-            printf("#            MODEM INIT FAILED                   #\r\n");
-            printf("##################################################\r\n\r\n");
+            LOG_ERR("[ERROR] USB CDC timeout!\r\n");
+            LOG_ERR("##################################################\r\n");
+            LOG_ERR("#            MODEM INIT FAILED                   #\r\n");
+            LOG_ERR("##################################################\r\n\r\n");
             return MODEM_TIMEOUT;
         }
 
         if ((HAL_GetTick() - startTick) % 5000 < 10)
         {
-            printf("  Waiting... (%lu ms) State: %s\r\n",
-                   HAL_GetTick() - startTick,
-                   USBH_GetStateString(&hUsbHostHS));
+            LOG_DBG("  Waiting... (%lu ms) State: %s\r\n",
+                    HAL_GetTick() - startTick,
+                    USBH_GetStateString(&hUsbHostHS));
         }
 
         HAL_Delay(10);
     }
-    printf("[STEP 4] USB CDC ready! (%lu ms)\r\n\r\n", HAL_GetTick() - startTick);
+    LOG_INF("[STEP 4] USB CDC ready! (%lu ms)\r\n\r\n", HAL_GetTick() - startTick);
 
     /*--- Step 5: Wait for Modem AT Ready ---*/
     if (Modem_WaitForATReady(60000) != MODEM_OK)  /* 60 second timeout */
     {
-        printf("[ERROR] Modem not responding to AT commands!\r\n");
-        printf("##################################################\r\n");
-        printf("#            MODEM INIT FAILED                   #\r\n");
-        printf("##################################################\r\n\r\n");
+        LOG_ERR("[ERROR] Modem not responding to AT commands!\r\n");
+        LOG_ERR("##################################################\r\n");
+        LOG_ERR("#            MODEM INIT FAILED                   #\r\n");
+        LOG_ERR("##################################################\r\n\r\n");
         return MODEM_TIMEOUT;
     }
 
     /*--- Step 6: Configure and Test ---*/
-    printf("##################################################\r\n");
-    printf("#              AT COMMAND TESTS                  #\r\n");
-    printf("##################################################\r\n\r\n");
+    LOG_INF("##################################################\r\n");
+    LOG_INF("#              AT COMMAND TESTS                  #\r\n");
+    LOG_INF("##################################################\r\n\r\n");
 
     /* Disable echo */
-    printf("--- Test 1: ATE0 (Disable Echo) ---\r\n");
+    LOG_INF("--- Test 1: ATE0 (Disable Echo) ---\r\n");
     Modem_SendCommand("ATE0\r\n", response, sizeof(response), 2000);
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* Basic AT */
-    printf("--- Test 2: AT ---\r\n");
+    LOG_INF("--- Test 2: AT ---\r\n");
     Modem_SendCommand("AT\r\n", response, sizeof(response), 1000);
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* Module Info */
-    printf("--- Test 3: ATI (Module Info) ---\r\n");
+    LOG_INF("--- Test 3: ATI (Module Info) ---\r\n");
     if (Modem_SendCommand("ATI\r\n", response, sizeof(response), 2000) == MODEM_OK)
     {
-        printf("  Info: %s\r\n", response);
+        LOG_INF("  Info: %s\r\n", response);
     }
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* IMEI */
-    printf("--- Test 4: AT+CGSN (IMEI) ---\r\n");
+    LOG_INF("--- Test 4: AT+CGSN (IMEI) ---\r\n");
     if (Modem_SendCommand("AT+CGSN\r\n", response, sizeof(response), 1000) == MODEM_OK)
     {
-        printf("  IMEI: %s\r\n", response);
+        LOG_INF("  IMEI: %s\r\n", response);
     }
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* SIM Status */
-    printf("--- Test 5: AT+CPIN? (SIM Status) ---\r\n");
+    LOG_INF("--- Test 5: AT+CPIN? (SIM Status) ---\r\n");
     if (Modem_SendCommand("AT+CPIN?\r\n", response, sizeof(response), 1000) == MODEM_OK)
     {
         if (strstr(response, "READY"))
-            printf("  SIM: READY\r\n");
+            LOG_INF("  SIM: READY\r\n");
         else
-            printf("  SIM: %s\r\n", response);
+            LOG_INF("  SIM: %s\r\n", response);
     }
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* Signal Strength */
-    printf("--- Test 6: AT+CSQ (Signal) ---\r\n");
+    LOG_INF("--- Test 6: AT+CSQ (Signal) ---\r\n");
     if (Modem_SendCommand("AT+CSQ\r\n", response, sizeof(response), 1000) == MODEM_OK)
     {
         int rssi = 0, ber = 0;
@@ -576,18 +624,18 @@ Modem_Status_t Modem_Init(void)
         if (p && sscanf(p, "+CSQ: %d,%d", &rssi, &ber) == 2)
         {
             int dbm = (rssi == 99) ? -999 : (-113 + rssi * 2);
-            printf("  Signal: %d dBm (rssi=%d)\r\n", dbm, rssi);
+            LOG_INF("  Signal: %d dBm (rssi=%d)\r\n", dbm, rssi);
         }
     }
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* Network Registration */
-    printf("--- Test 7: AT+CREG? (Network) ---\r\n");
+    LOG_INF("--- Test 7: AT+CREG? (Network) ---\r\n");
     Modem_SendCommand("AT+CREG?\r\n", response, sizeof(response), 1000);
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /* Operator */
-    printf("--- Test 8: AT+COPS? (Operator) ---\r\n");
+    LOG_INF("--- Test 8: AT+COPS? (Operator) ---\r\n");
     if (Modem_SendCommand("AT+COPS?\r\n", response, sizeof(response), 2000) == MODEM_OK)
     {
         char *start = strstr(response, "\"");
@@ -598,18 +646,18 @@ Modem_Status_t Modem_Init(void)
             if (end)
             {
                 *end = '\0';
-                printf("  Operator: %s\r\n", start);
+                LOG_INF("  Operator: %s\r\n", start);
             }
         }
     }
-    printf("\r\n");
+    LOG_INF("\r\n");
 
     /*--- Complete ---*/
     modemInitialized = 1;
 
-    printf("##################################################\r\n");
-    printf("#            MODEM INIT COMPLETE                 #\r\n");
-    printf("##################################################\r\n\r\n");
+    LOG_INF("##################################################\r\n");
+    LOG_INF("#            MODEM INIT COMPLETE                 #\r\n");
+    LOG_INF("##################################################\r\n\r\n");
 
     return MODEM_OK;
 }
@@ -625,7 +673,7 @@ Modem_Status_t Modem_HTTP_ReadData(uint32_t offset, uint32_t length, char *data,
     uint32_t idx = 0;
 
     snprintf(cmd, sizeof(cmd), "AT+HTTPREAD=%lu,%lu\r\n", offset, length);
-    printf("[TX] %s", cmd);
+    LOG_DBG("[TX] %s", cmd);
 
     USB_CDC_FlushRx();
 
@@ -673,7 +721,7 @@ Modem_Status_t Modem_HTTP_ReadData(uint32_t offset, uint32_t length, char *data,
         }
     }
 
-    printf("[RAW Response] %s\r\n", response);
+    LOG_DBG("[RAW Response] %s\r\n", response);
 
     /* Parse the data - find +HTTPREAD: DATA,<len> then extract data */
     char *dataStart = strstr(response, "+HTTPREAD: DATA,");
@@ -723,7 +771,7 @@ Modem_Status_t Modem_WaitForHTTPAction(int method, uint32_t timeout, int *httpSt
 
     char cmd[32];
     snprintf(cmd, sizeof(cmd), "AT+HTTPACTION=%d\r\n", method);
-    printf("[TX] %s", cmd);
+    LOG_DBG("[TX] %s", cmd);
 
     if (USB_CDC_Transmit((uint8_t*)cmd, strlen(cmd), 1000) != HAL_OK)
     {
@@ -755,7 +803,7 @@ Modem_Status_t Modem_WaitForHTTPAction(int method, uint32_t timeout, int *httpSt
                 response[idx] = '\0';
             }
 
-            printf("[RX] %s\r\n", buf);
+            LOG_DBG("[RX] %s\r\n", buf);
 
             /* Parse +HTTPACTION URC */
             char *p = strstr(response, "+HTTPACTION:");
@@ -764,7 +812,7 @@ Modem_Status_t Modem_WaitForHTTPAction(int method, uint32_t timeout, int *httpSt
                 int m;
                 if (sscanf(p, "+HTTPACTION: %d,%d,%lu", &m, httpStatus, dataLen) >= 2)
                 {
-                    printf("    Status: %d, Length: %lu\r\n", *httpStatus, *dataLen);
+                    LOG_INF("    Status: %d, Length: %lu\r\n", *httpStatus, *dataLen);
                     return MODEM_OK;  /* Return OK even if HTTP status != 200 */
                 }
             }
@@ -774,7 +822,7 @@ Modem_Status_t Modem_WaitForHTTPAction(int method, uint32_t timeout, int *httpSt
         static uint32_t lastPrint = 0;
         if ((HAL_GetTick() - lastPrint) > 5000)
         {
-            printf("    Waiting... (%lu sec)\r\n", (HAL_GetTick() - start) / 1000);
+            LOG_DBG("    Waiting... (%lu sec)\r\n", (HAL_GetTick() - start) / 1000);
             lastPrint = HAL_GetTick();
         }
     }
@@ -789,68 +837,68 @@ Modem_Status_t Modem_HTTP_SimpleTest(void)
     int httpStatus = 0;
     uint32_t dataLen = 0;
 
-    printf("\r\n========== HTTP GET TEST ==========\r\n");
+    LOG_INF("\r\n========== HTTP GET TEST ==========\r\n");
 
     /* Cleanup */
-    printf("[0] Cleanup...\r\n");
+    LOG_INF("[0] Cleanup...\r\n");
     Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 2000);
     HAL_Delay(500);
 
     /* HTTPINIT */
-    printf("[1] AT+HTTPINIT\r\n");
+    LOG_INF("[1] AT+HTTPINIT\r\n");
     if (Modem_SendCommand("AT+HTTPINIT\r\n", response, sizeof(response), 2000) != MODEM_OK)
     {
-        printf("    FAILED!\r\n");
+        LOG_ERR("    FAILED!\r\n");
         return MODEM_ERROR;
     }
     HAL_Delay(300);
 
     /* Set URL */
-    printf("[2] AT+HTTPPARA URL\r\n");
+    LOG_INF("[2] AT+HTTPPARA URL\r\n");
     if (Modem_SendCommand("AT+HTTPPARA=\"URL\",\"https://raw.githubusercontent.com/khuram11/ota_test/main/fw_with_crc.bin\"\r\n",
                           response, sizeof(response), 2000) != MODEM_OK)
     {
-        printf("    FAILED!\r\n");
+        LOG_ERR("    FAILED!\r\n");
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_ERROR;
     }
     HAL_Delay(300);
 
     /* HTTP GET */
-    printf("[3] AT+HTTPACTION=0\r\n");
+    LOG_INF("[3] AT+HTTPACTION=0\r\n");
     if (Modem_WaitForHTTPAction(0, 60000, &httpStatus, &dataLen) != MODEM_OK)
     {
-        printf("    TIMEOUT!\r\n");
+        LOG_ERR("    TIMEOUT!\r\n");
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_TIMEOUT;
     }
 
-    printf("    HTTP Status: %d\r\n", httpStatus);
-    printf("    Data Length: %lu bytes\r\n", dataLen);
+    LOG_INF("    HTTP Status: %d\r\n", httpStatus);
+    LOG_INF("    Data Length: %lu bytes\r\n", dataLen);
 
     if (httpStatus != 200)
     {
-        printf("    HTTP Error!\r\n");
+        LOG_ERR("    HTTP Error!\r\n");
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_ERROR;
     }
     HAL_Delay(2000);
 
     /* Read headers */
-    printf("\n\n\n[4] AT+HTTPHEAD\r\n");
+    LOG_INF("\n\n\n[4] AT+HTTPHEAD\r\n");
     Modem_SendCommand("AT+HTTPHEAD\r\n", response, sizeof(response), 5000);
-    printf("--- HEADERS ---\r\n%s\r\n---------------\r\n", response);
+    LOG_INF("--- HEADERS ---\r\n%s\r\n---------------\r\n", response);
     HAL_Delay(5000);
 
-    printf("---------- Checking buffer len --------------");
+    LOG_INF("---------- Checking buffer len --------------");
 
     Modem_SendCommandWaitURC("AT+HTTPREAD?\r\n", "+HTTPREAD",  response, sizeof(response), 5000);
     HAL_Delay(5000);
-    printf("----------[4] Reading the buffer --------------\n");
+    LOG_INF("----------[4] Reading the buffer --------------\n");
 
     // Manual test - don't use Modem_SendCommandWaitURC for binary data
     USB_CDC_FlushRx();
-    printf("[TX] AT+HTTPREAD=0,64\r\n");  // Try smaller chunk first
+    LOG_DBG("[TX] AT+HTTPREAD=0,64\r\n");  // Try smaller chunk first
     USB_CDC_Transmit((uint8_t*)"AT+HTTPREAD=0,64\r\n", sizeof "AT+HTTPREAD=0,64\r\n", 1000);
 
     // Wait and collect raw bytes
@@ -878,14 +926,14 @@ Modem_Status_t Modem_HTTP_SimpleTest(void)
                 rawIdx += len;
             }
 
-            printf("[GOT %lu bytes, total %lu]\r\n", len, rawIdx);
+            LOG_DBG("[GOT %lu bytes, total %lu]\r\n", len, rawIdx);
 
             // Print what we got as hex
             for (uint32_t i = 0; i < len && i < 32; i++)
             {
-                printf("%02X ", buf[i]);
+                LOG_DBG("%02X ", buf[i]);
             }
-            printf("\r\n");
+            LOG_DBG("\r\n");
 
             // Check if we have enough (should be ~100+ bytes for 64 byte read)
             if (rawIdx > 100)
@@ -895,14 +943,14 @@ Modem_Status_t Modem_HTTP_SimpleTest(void)
         }
     }
 
-    printf("\r\n[FINAL] Total received: %lu bytes\r\n", rawIdx);
-    printf("[FINAL HEX DUMP]:\r\n");
+    LOG_INF("\r\n[FINAL] Total received: %lu bytes\r\n", rawIdx);
+    LOG_DBG("[FINAL HEX DUMP]:\r\n");
     for (uint32_t i = 0; i < rawIdx && i < 150; i++)
     {
-        if (i % 16 == 0) printf("\r\n%04lX: ", i);
-        printf("%02X ", rawBuf[i]);
+        if (i % 16 == 0) LOG_DBG("\r\n%04lX: ", i);
+        LOG_DBG("%02X ", rawBuf[i]);
     }
-    printf("\r\n");
+    LOG_DBG("\r\n");
 
 //    /* Read data with proper parsing */
 //    printf("\n\n\n[5] AT+HTTPREAD\r\n");
@@ -917,10 +965,10 @@ Modem_Status_t Modem_HTTP_SimpleTest(void)
 //    HAL_Delay(300);
 
     /* Terminate */
-    printf("[6] AT+HTTPTERM\r\n");
+    LOG_INF("[6] AT+HTTPTERM\r\n");
     Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 2000);
 
-    printf("========== TEST COMPLETE ==========\r\n\r\n");
+    LOG_INF("========== TEST COMPLETE ==========\r\n\r\n");
 
     return MODEM_OK;
 }
@@ -930,35 +978,35 @@ Modem_Status_t Modem_HTTP_SimpleTest(void)
 Modem_Status_t Modem_TestHTTP(void)
 {
 
-    printf("\r\n##################################################\r\n");
-    printf("#              HTTP TEST START                   #\r\n");
-    printf("##################################################\r\n\r\n");
+    LOG_INF("\r\n##################################################\r\n");
+    LOG_INF("#              HTTP TEST START                   #\r\n");
+    LOG_INF("##################################################\r\n\r\n");
 
     /* Step 1: Check network */
-    printf("=== Step 1: Check Network ===\r\n");
+    LOG_INF("=== Step 1: Check Network ===\r\n");
     Modem_CheckNetwork();
 
 
-    printf("Test 1\r\n");
+    LOG_INF("Test 1\r\n");
     HAL_Delay(100);
-    printf("Test 2\r\n");
+    LOG_INF("Test 2\r\n");
     HAL_Delay(100);
-    printf("Test 3\r\n");
+    LOG_INF("Test 3\r\n");
     char response[512];
 
     Modem_SendCommand("AT+GARBAGE\r\n", response, sizeof(response), 3000);
 
-    printf("Test 4\r\n");
+    LOG_INF("Test 4\r\n");
     HAL_Delay(100);
-    printf("Test 5\r\n");
+    LOG_INF("Test 5\r\n");
 
     /* Step 2: Simple HTTP test */
-    printf("=== Step 2: Simple HTTP Test ===\r\n");
+    LOG_INF("=== Step 2: Simple HTTP Test ===\r\n");
     Modem_HTTP_SimpleTest();
 
-    printf("\r\n##################################################\r\n");
-    printf("#              HTTP TEST COMPLETE                #\r\n");
-    printf("##################################################\r\n\r\n");
+    LOG_INF("\r\n##################################################\r\n");
+    LOG_INF("#              HTTP TEST COMPLETE                #\r\n");
+    LOG_INF("##################################################\r\n\r\n");
 
     return MODEM_OK;
 }
@@ -968,15 +1016,68 @@ Modem_Status_t Modem_TestHTTP(void)
 /*                          OTA FIRMWARE DOWNLOAD                             */
 /*============================================================================*/
 
-#define OTA_CHUNK_SIZE      330
+#ifndef OTA_CHUNK_SIZE
+#define OTA_CHUNK_SIZE      330     /* bytes per AT+HTTPREAD, overridable for benchmarks */
+#endif
 #define OTA_MAX_FW_SIZE     (50 * 1024)  /* 400KB max firmware */
 #define OTA_READ_TIMEOUT    10000
 
+#if OTA_DIRECT_FLASH || (PSRAM_ENABLE == 1)
+#define OTA_MAX_FILE_SIZE   (OTA_SLOT_MAX_FW_SIZE + OTA_HEADER_SIZE)
+#else
+#define OTA_MAX_FILE_SIZE   OTA_MAX_FW_SIZE
+#endif
+
+#if OTA_DIRECT_FLASH
+static uint8_t g_chunkBuffer[OTA_CHUNK_SIZE];
+#elif PSRAM_ENABLE == 1
+/* Mailbox read by the Boot: header, then the image */
+static uint8_t *const g_fwBuffer = (uint8_t *)PSRAM_MAILBOX_ADDR;
+#else
 /* Global firmware buffer - allocate in RAM */
 static uint8_t g_fwBuffer[OTA_MAX_FW_SIZE];
+#endif
 static uint32_t g_fwSize = 0;
 static uint32_t g_fwDownloaded = 0;
 
+#if OTA_DIRECT_FLASH
+#if OTA_EMMC_STORE
+#define OTA_STAGE_NAME      "eMMC store"
+#else
+#define OTA_STAGE_NAME      "Slot B"
+#endif
+
+/**
+ * @brief  Destination of the streamed chunks: Slot B, or the eMMC store
+ */
+static Modem_Status_t OTA_StageBegin(uint32_t fileSize)
+{
+#if OTA_EMMC_STORE
+    return (FW_Store_Begin(fileSize) == FW_STORE_OK) ? MODEM_OK : MODEM_ERROR;
+#else
+    return (OTA_Flash_Begin(fileSize) == OTA_FLASH_OK) ? MODEM_OK : MODEM_ERROR;
+#endif
+}
+
+static Modem_Status_t OTA_StageWrite(uint32_t fileOffset, const uint8_t *data, uint32_t len)
+{
+#if OTA_EMMC_STORE
+    return (FW_Store_Write(fileOffset, data, len) == FW_STORE_OK) ? MODEM_OK : MODEM_ERROR;
+#else
+    return (OTA_Flash_Write(fileOffset, data, len) == OTA_FLASH_OK) ? MODEM_OK : MODEM_ERROR;
+#endif
+}
+
+static Modem_Status_t OTA_StageFinish(void)
+{
+#if OTA_EMMC_STORE
+    return (FW_Store_Finish() == FW_STORE_OK) ? MODEM_OK : MODEM_ERROR;
+#else
+    return (OTA_Flash_Finish() == OTA_FLASH_OK) ? MODEM_OK : MODEM_ERROR;
+#endif
+}
+#else
+
 /**
  * @brief  Get pointer to firmware buffer
  */
@@ -984,6 +1085,7 @@ uint8_t* OTA_GetFirmwareBuffer(void)
 {
     return g_fwBuffer;
 }
+#endif /* OTA_DIRECT_FLASH */
 
 /**
  * @brief  Get downloaded firmware size
@@ -1001,8 +1103,8 @@ uint32_t OTA_GetFirmwareSize(void)
  * @param  needleLen: Length of pattern
  * @retval Pointer to found pattern, or NULL if not found
  */
-static uint8_t* OTA_FindPattern(uint8_t *haystack, uint32_t haystackLen,
-                                 const char *needle, uint32_t needleLen)
+static ITCM_FUNC uint8_t* OTA_FindPattern(uint8_t *haystack, uint32_t haystackLen,
+                                           const char *needle, uint32_t needleLen)
 {
     if (haystackLen < needleLen)
     {
@@ -1028,7 +1130,7 @@ static uint8_t* OTA_FindPattern(uint8_t *haystack, uint32_t haystackLen,
  * @param  maxLen: Maximum search length
  * @retval Pointer to \r\n, or NULL if not found
  */
-static uint8_t* OTA_FindLineEnd(uint8_t *buffer, uint32_t maxLen)
+static ITCM_FUNC uint8_t* OTA_FindLineEnd(uint8_t *buffer, uint32_t maxLen)
 {
     for (uint32_t i = 0; i < maxLen - 1; i++)
     {
@@ -1077,7 +1179,7 @@ static uint32_t OTA_ParseChunkLength(uint8_t *dataMarker)
     return chunkLen;
 }
 
-Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *buffer, uint32_t *bytesRead)
+static Modem_Status_t OTA_HTTPReadChunk(uint32_t offset, uint32_t length, uint8_t *buffer, uint32_t *bytesRead)
 {
     char cmd[64];
     uint8_t rxBuffer[2048];
@@ -1136,14 +1238,14 @@ Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *bu
 
     if (!endMarkerFound)
     {
-        printf("[OTA] Timeout - no end marker. Received %lu bytes\r\n", rxIdx);
+        LOG_ERR("[OTA] Timeout - no end marker. Received %lu bytes\r\n", rxIdx);
         /* Debug: print what we got */
-        printf("[OTA] First 64 bytes: ");
+        LOG_DBG("[OTA] First 64 bytes: ");
         for (uint32_t i = 0; i < 64 && i < rxIdx; i++)
         {
-            printf("%02X ", rxBuffer[i]);
+            LOG_DBG("%02X ", rxBuffer[i]);
         }
-        printf("\r\n");
+        LOG_DBG("\r\n");
         return MODEM_TIMEOUT;
     }
 
@@ -1185,13 +1287,13 @@ Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *bu
 
     if (dataMarker == NULL)
     {
-        printf("[OTA] Could not find data marker in %lu bytes\r\n", rxIdx);
-        printf("[OTA] Buffer dump: ");
+        LOG_ERR("[OTA] Could not find data marker in %lu bytes\r\n", rxIdx);
+        LOG_DBG("[OTA] Buffer dump: ");
         for (uint32_t i = 0; i < 100 && i < rxIdx; i++)
         {
-            printf("%02X ", rxBuffer[i]);
+            LOG_DBG("%02X ", rxBuffer[i]);
         }
-        printf("\r\n");
+        LOG_DBG("\r\n");
         return MODEM_ERROR;
     }
 
@@ -1218,7 +1320,7 @@ Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *bu
 
     if (chunkLen == 0 || chunkLen > length)
     {
-        printf("[OTA] Invalid chunk length: %lu (expected max %lu)\r\n", chunkLen, length);
+        LOG_ERR("[OTA] Invalid chunk length: %lu (expected max %lu)\r\n", chunkLen, length);
         return MODEM_ERROR;
     }
 
@@ -1226,7 +1328,7 @@ Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *bu
     uint8_t *lineEnd = OTA_FindLineEnd(dataMarker, rxIdx - (dataMarker - rxBuffer));
     if (lineEnd == NULL)
     {
-        printf("[OTA] Could not find header line end\r\n");
+        LOG_ERR("[OTA] Could not find header line end\r\n");
         return MODEM_ERROR;
     }
 
@@ -1248,7 +1350,7 @@ Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *bu
 
     if (availableData < chunkLen)
     {
-        printf("[OTA] Not enough data: have %lu, need %lu\r\n", availableData, chunkLen);
+        LOG_ERR("[OTA] Not enough data: have %lu, need %lu\r\n", availableData, chunkLen);
         return MODEM_ERROR;
     }
 
@@ -1258,6 +1360,17 @@ Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *bu
 
     return MODEM_OK;
 }
+
+Modem_Status_t OTA_ReadBinaryChunk(uint32_t offset, uint32_t length, uint8_t *buffer, uint32_t *bytesRead)
+{
+    Modem_Status_t status;
+
+    TRACE_BEGIN(TRACE_ID_OTA_CHUNK, offset);
+    status = OTA_HTTPReadChunk(offset, length, buffer, bytesRead);
+    TRACE_END(TRACE_ID_OTA_CHUNK, *bytesRead);
+
+    return status;
+}
 /**
  * @brief  Download complete firmware file via HTTP
  * @param  url: URL to firmware binary
@@ -1273,65 +1386,81 @@ Modem_Status_t OTA_DownloadFirmware(const char *url)
     uint32_t bytesRead = 0;
     Modem_Status_t result = MODEM_ERROR;
 
-    printf("\r\n##################################################\r\n");
-    printf("#              OTA FIRMWARE DOWNLOAD             #\r\n");
-    printf("##################################################\r\n\r\n");
+    LOG_INF("\r\n##################################################\r\n");
+    LOG_INF("#              OTA FIRMWARE DOWNLOAD             #\r\n");
+    LOG_INF("##################################################\r\n\r\n");
 
     g_fwDownloaded = 0;
     g_fwSize = 0;
 
     /* Step 1: Initialize HTTP */
-    printf("[OTA] Step 1: Initialize HTTP\r\n");
+    LOG_INF("[OTA] Step 1: Initialize HTTP\r\n");
     Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 2000);
     HAL_Delay(500);
 
     if (Modem_SendCommand("AT+HTTPINIT\r\n", response, sizeof(response), 2000) != MODEM_OK)
     {
-        printf("[OTA] HTTPINIT failed!\r\n");
+        LOG_ERR("[OTA] HTTPINIT failed!\r\n");
         return MODEM_ERROR;
     }
     HAL_Delay(300);
 
     /* Step 2: Set URL */
-    printf("[OTA] Step 2: Set URL\r\n");
-    printf("       %s\r\n", url);
+    LOG_INF("[OTA] Step 2: Set URL\r\n");
+    LOG_INF("       %s\r\n", url);
 
     snprintf(cmd, sizeof(cmd), "AT+HTTPPARA=\"URL\",\"%s\"\r\n", url);
 
     if (Modem_SendCommand(cmd, response, sizeof(response), 2000) != MODEM_OK)
     {
-        printf("[OTA] Set URL failed!\r\n");
+        LOG_ERR("[OTA] Set URL failed!\r\n");
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_ERROR;
     }
     HAL_Delay(300);
 
     /* Step 3: Execute GET request */
-    printf("[OTA] Step 3: HTTP GET request\r\n");
+    LOG_INF("[OTA] Step 3: HTTP GET request\r\n");
 
     if (Modem_WaitForHTTPAction(0, 60000, &httpStatus, &totalSize) != MODEM_OK)
     {
-        printf("[OTA] HTTP request timeout!\r\n");
+        LOG_ERR("[OTA] HTTP request timeout!\r\n");
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_TIMEOUT;
     }
 
-    printf("[OTA] HTTP Status: %d\r\n", httpStatus);
-    printf("[OTA] File Size: %lu bytes\r\n", totalSize);
+    LOG_INF("[OTA] HTTP Status: %d\r\n", httpStatus);
+    LOG_INF("[OTA] File Size: %lu bytes\r\n", totalSize);
 
     if (httpStatus != 200)
     {
-        printf("[OTA] HTTP Error: %d\r\n", httpStatus);
+        LOG_ERR("[OTA] HTTP Error: %d\r\n", httpStatus);
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_ERROR;
     }
 
-    if (totalSize > OTA_MAX_FW_SIZE)
+    if (totalSize > OTA_MAX_FILE_SIZE)
     {
-        printf("[OTA] File too large! Max: %d bytes\r\n", OTA_MAX_FW_SIZE);
+        LOG_ERR("[OTA] File too large! Max: %lu bytes\r\n", (uint32_t)OTA_MAX_FILE_SIZE);
         Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
         return MODEM_ERROR;
     }
+
+#if OTA_DIRECT_FLASH
+    if (OTA_StageBegin(totalSize) != MODEM_OK)
+    {
+        LOG_ERR("[OTA] " OTA_STAGE_NAME " staging not available!\r\n");
+        Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
+        return MODEM_ERROR;
+    }
+#elif PSRAM_ENABLE == 1
+    if (PSRAM_IsReady() == 0U)
+    {
+        LOG_ERR("[OTA] PSRAM mailbox not available!\r\n");
+        Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 1000);
+        return MODEM_ERROR;
+    }
+#endif
     g_fwSize = totalSize;
     HAL_Delay(5000);
 
@@ -1349,8 +1478,8 @@ Modem_Status_t OTA_DownloadFirmware(const char *url)
 //    HAL_Delay(5000);
 
     /* Step 5: Download in chunks */
-    printf("[OTA] Step 5: Downloading %lu bytes in %lu chunks\r\n",
-           totalSize, (totalSize + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE);
+    LOG_INF("[OTA] Step 5: Downloading %lu bytes in %lu chunks\r\n",
+            totalSize, (totalSize + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE);
 
     result = MODEM_OK;
 
@@ -1360,15 +1489,27 @@ Modem_Status_t OTA_DownloadFirmware(const char *url)
         uint32_t chunkSize = (remaining > OTA_CHUNK_SIZE) ? OTA_CHUNK_SIZE : remaining;
 
         /* Read chunk */
+#if OTA_DIRECT_FLASH
+        result = OTA_ReadBinaryChunk(downloaded, chunkSize, g_chunkBuffer, &bytesRead);
+
+        if ((result == MODEM_OK) && (bytesRead > 0) &&
+            (OTA_StageWrite(downloaded, g_chunkBuffer, bytesRead) != MODEM_OK))
+        {
+            LOG_ERR("[OTA] " OTA_STAGE_NAME " write failed at offset %lu\r\n", downloaded);
+            result = MODEM_ERROR;
+            break;
+        }
+#else
         result = OTA_ReadBinaryChunk(downloaded, chunkSize, &g_fwBuffer[downloaded], &bytesRead);
+#endif
 
         if (result != MODEM_OK)
         {
-            printf("[OTA] Failed to read chunk at offset--------------------------------------------------------------------------------------------  %lu\r\n", downloaded);
+            LOG_ERR("[OTA] Failed to read chunk at offset--------------------------------------------------------------------------------------------  %lu\r\n", downloaded);
         }
         else if (bytesRead == 0)
         {
-            printf("[OTA] Zero bytes read at offset-------------------------------------------------------------------------------------------- %lu\r\n", downloaded);
+            LOG_ERR("[OTA] Zero bytes read at offset-------------------------------------------------------------------------------------------- %lu\r\n", downloaded);
             result = MODEM_ERROR;
         }
         else
@@ -1378,7 +1519,7 @@ Modem_Status_t OTA_DownloadFirmware(const char *url)
 
             /* Progress */
             uint32_t percent = (downloaded * 100) / totalSize;
-            printf("[OTA] Progress: %lu / %lu bytes (%lu%%)\r\n", downloaded, totalSize, percent);
+            LOG_INF("[OTA] Progress: %lu / %lu bytes (%lu%%)\r\n", downloaded, totalSize, percent);
 
             HAL_Delay(1);
         }
@@ -1386,101 +1527,182 @@ Modem_Status_t OTA_DownloadFirmware(const char *url)
     ota_started = 0;
 
     /* Cleanup */
-    printf("[OTA] Step 6: Cleanup\r\n");
+    LOG_INF("[OTA] Step 6: Cleanup\r\n");
     Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 2000);
 
+#if OTA_DIRECT_FLASH
+    if ((result == MODEM_OK) && (OTA_StageFinish() != MODEM_OK))
+    {
+        LOG_ERR("[OTA] " OTA_STAGE_NAME " staging failed!\r\n");
+        result = MODEM_ERROR;
+    }
+#endif
+
     if (result == MODEM_OK)
     {
-        printf("\r\n[OTA] Download complete!\r\n");
-        printf("[OTA] Total bytes: %lu\r\n", g_fwDownloaded);
+        LOG_INF("\r\n[OTA] Download complete!\r\n");
+        LOG_INF("[OTA] Total bytes: %lu\r\n", g_fwDownloaded);
 
+#if !OTA_DIRECT_FLASH
         /* Print first 32 bytes as hex for verification */
-        printf("[OTA] First 32 bytes: ");
+        LOG_DBG("[OTA] First 32 bytes: ");
         for (uint32_t i = 0; i < 32 && i < g_fwDownloaded; i++)
         {
-            printf("%02X ", g_fwBuffer[i]);
+            LOG_DBG("%02X ", g_fwBuffer[i]);
         }
-        printf("\r\n");
+        LOG_DBG("\r\n");
+#endif
 
-        printf("\r\n##################################################\r\n");
-        printf("#           OTA DOWNLOAD COMPLETE                #\r\n");
-        printf("##################################################\r\n\r\n");
+        LOG_INF("\r\n##################################################\r\n");
+        LOG_INF("#           OTA DOWNLOAD COMPLETE                #\r\n");
+        LOG_INF("##################################################\r\n\r\n");
     }
 
     return result;
 }
 
+#if !OTA_DIRECT_FLASH
+/**
+ * @brief  CRC32 (IEEE 802.3, reflected) of a buffer
+ * @param  data: Buffer
+ * @param  len: Length of buffer
+ * @retval CRC32 value
+ */
+static ITCM_FUNC uint32_t OTA_CalculateCRC32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            if (crc & 1)
+                crc = (crc >> 1) ^ 0xEDB88320;
+            else
+                crc >>= 1;
+        }
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+#endif
+
 /**
  * @brief  Verify downloaded firmware CRC
  * @param  expectedCRC: Expected CRC32 value
  * @retval MODEM_OK if CRC matches
  */
-#define OTA_HEADER_SIZE   16
-#define OTA_MAGIC         0x4F544131  /* "OTA1" */
 Modem_Status_t OTA_VerifyFirmwareCRC(void)
 {
     uint32_t magic;
     uint32_t fwSize;
     uint32_t expectedCRC;
     uint32_t version;
-    uint32_t crc = 0xFFFFFFFF;
+#if OTA_EMMC_STORE
+    /* Image was streamed into the eMMC store: header from its directory */
+    const FW_Store_Image_t *image = FW_Store_GetImage(FW_STORE_CANDIDATE);
+#elif OTA_DIRECT_FLASH
+    /* Image was streamed into Slot B: header through XIP */
+    const uint8_t *header = (const uint8_t *)(SLOT_A_CPU_ADDR + SLOT_B_HEADER_ADDR);
+#else
+    const uint8_t *header = g_fwBuffer;
+    const uint8_t *fw = &g_fwBuffer[OTA_HEADER_SIZE];
+    uint32_t crc;
+#endif
 
     /* Sanity check */
     if (g_fwDownloaded < OTA_HEADER_SIZE)
     {
-        printf("[OTA] Image too small\r\n");
+        LOG_ERR("[OTA] Image too small\r\n");
         return MODEM_ERROR;
     }
 
+#if OTA_EMMC_STORE
+    if (image == NULL)
+    {
+        LOG_ERR("[OTA] No candidate in the eMMC store\r\n");
+        return MODEM_ERROR;
+    }
+    magic = image->magic;
+    fwSize = image->fwSize;
+    expectedCRC = image->crc;
+    version = image->version;
+#else
     /* Extract header (little endian) */
-    memcpy(&magic,       &g_fwBuffer[0],  4);
-    memcpy(&fwSize,      &g_fwBuffer[4],  4);
-    memcpy(&expectedCRC, &g_fwBuffer[8],  4);
-    memcpy(&version,     &g_fwBuffer[12], 4);
+    memcpy(&magic,       &header[0],  4);
+    memcpy(&fwSize,      &header[4],  4);
+    memcpy(&expectedCRC, &header[8],  4);
+    memcpy(&version,     &header[12], 4);
+#endif
 
     /* Validate magic */
     if (magic != OTA_MAGIC)
     {
-        printf("[OTA] Invalid magic: 0x%08lX\r\n", magic);
+        LOG_ERR("[OTA] Invalid magic: 0x%08lX\r\n", magic);
         return MODEM_ERROR;
     }
 
     /* Validate size */
     if ((fwSize + OTA_HEADER_SIZE) != g_fwDownloaded)
     {
-        printf("[OTA] Size mismatch. Header: %lu, Received: %lu\r\n",
-               fwSize, g_fwDownloaded - OTA_HEADER_SIZE);
+        LOG_ERR("[OTA] Size mismatch. Header: %lu, Received: %lu\r\n",
+                fwSize, g_fwDownloaded - OTA_HEADER_SIZE);
         return MODEM_ERROR;
     }
 
-    /* CRC32 over firmware only (skip header) */
-    for (uint32_t i = OTA_HEADER_SIZE; i < g_fwDownloaded; i++)
-    {
-        crc ^= g_fwBuffer[i];
-        for (uint32_t j = 0; j < 8; j++)
-        {
-            if (crc & 1)
-                crc = (crc >> 1) ^ 0xEDB88320;
-            else
-                crc >>= 1;
-        }
-    }
+    LOG_INF("[OTA] Version		:	0x%08lX\r\n", version);
+    LOG_INF("[OTA] Firmware size	:	%lu bytes\r\n", fwSize);
 
-    crc ^= 0xFFFFFFFF;
+#if OTA_DIRECT_FLASH
+    /* OTA_StageFinish() read the staged image back and matched this CRC,
+     * the header is only recorded once it did */
+    LOG_INF("[OTA] Expected CRC	:   0x%08lX\r\n", expectedCRC);
+    LOG_INF("[OTA] CRC VALID (checked by the " OTA_STAGE_NAME " staging)\r\n");
+    return MODEM_OK;
+#else
+    /* CRC32 over firmware only (skip header) */
+    crc = OTA_CalculateCRC32(fw, fwSize);
 
-    printf("[OTA] Version		:	0x%08lX\r\n", version);
-    printf("[OTA] Firmware size	:	%lu bytes\r\n", fwSize);
-    printf("[OTA] Calculated CRC:	0x%08lX\r\n", crc);
-    printf("[OTA] Expected CRC	:   0x%08lX\r\n", expectedCRC);
+    LOG_INF("[OTA] Calculated CRC:	0x%08lX\r\n", crc);
+    LOG_INF("[OTA] Expected CRC	:   0x%08lX\r\n", expectedCRC);
 
     if (crc == expectedCRC)
     {
-        printf("[OTA] CRC VALID\r\n");
+        LOG_INF("[OTA] CRC VALID\r\n");
         return MODEM_OK;
     }
 
-    printf("[OTA] CRC MISMATCH\r\n");
+    LOG_ERR("[OTA] CRC MISMATCH\r\n");
     return MODEM_ERROR;
+#endif
+}
+
+/**
+ * @brief  Hand the verified image to the Boot for the next reset
+ * @retval MODEM_ERROR if this build keeps the file in an SRAM buffer the
+ *         Boot does not read
+ */
+Modem_Status_t OTA_RequestBoot(void)
+{
+#if OTA_EMMC_STORE
+    OTA_Flash_RequestInstall();
+    LOG_INF("[OTA] Candidate stored in the eMMC, reset to install it\r\n");
+    return MODEM_OK;
+#elif OTA_DIRECT_FLASH
+    OTA_Flash_RequestBoot();
+    LOG_INF("[OTA] Slot B armed, reset to boot it\r\n");
+    return MODEM_OK;
+#elif PSRAM_ENABLE == 1
+    /* The Boot reads the mailbox from the PSRAM, not from this D-cache */
+    SCB_CleanDCache_by_Addr((void *)g_fwBuffer, (int32_t)g_fwDownloaded);
+    OTA_Flash_RequestMailbox();
+    LOG_INF("[OTA] Image left in the PSRAM mailbox, reset to program Slot B\r\n");
+    return MODEM_OK;
+#else
+    LOG_WRN("[OTA] Image kept in SRAM only, not armed\r\n");
+    return MODEM_ERROR;
+#endif
 }
 
 /**
@@ -1488,7 +1710,13 @@ Modem_Status_t OTA_VerifyFirmwareCRC(void)
  */
 Modem_Status_t OTA_TestDownload(void)
 {
-    return OTA_DownloadFirmware("https://raw.githubusercontent.com/khuram11/ota_test/main/fw_with_crc.bin");
+    Modem_Status_t status;
+
+    TRACE_BEGIN(TRACE_ID_OTA_DOWNLOAD, 0);
+    status = OTA_DownloadFirmware("https://raw.githubusercontent.com/khuram11/ota_test/main/fw_with_crc.bin");
+    TRACE_END(TRACE_ID_OTA_DOWNLOAD, status);
+
+    return status;
 }
 
 
@@ -1499,7 +1727,7 @@ void OTA_TestChunkSizes(void)
     uint8_t testBuf[2048];
     uint32_t bytesRead;
 
-    printf("\r\n=== CHUNK SIZE TEST ===\r\n");
+    LOG_INF("\r\n=== CHUNK SIZE TEST ===\r\n");
 
     /* Setup HTTP */
     Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 2000);
@@ -1514,7 +1742,7 @@ void OTA_TestChunkSizes(void)
 
     if (httpStatus != 200)
     {
-        printf("HTTP failed!\r\n");
+        LOG_ERR("HTTP failed!\r\n");
         return;
     }
 
@@ -1532,23 +1760,23 @@ void OTA_TestChunkSizes(void)
 
         uint32_t elapsed = HAL_GetTick() - start;
 
-        printf("Chunk %lu: %s, got %lu bytes in %lu ms\r\n",
-               chunkSize,
-               (result == MODEM_OK) ? "OK" : "FAIL",
-               bytesRead,
-               elapsed);
+        LOG_INF("Chunk %lu: %s, got %lu bytes in %lu ms\r\n",
+                chunkSize,
+                (result == MODEM_OK) ? "OK" : "FAIL",
+                bytesRead,
+                elapsed);
 
         if (result == MODEM_OK && bytesRead > 0)
         {
             /* Verify first bytes are correct (magic number) */
             if (testBuf[0] == 0x31 && testBuf[1] == 0x41)
             {
-                printf("  Data valid (magic OK)\r\n");
+                LOG_INF("  Data valid (magic OK)\r\n");
             }
             else
             {
-                printf("  Data INVALID! First 4: %02X %02X %02X %02X\r\n",
-                       testBuf[0], testBuf[1], testBuf[2], testBuf[3]);
+                LOG_ERR("  Data INVALID! First 4: %02X %02X %02X %02X\r\n",
+                        testBuf[0], testBuf[1], testBuf[2], testBuf[3]);
             }
         }
 
@@ -1556,7 +1784,7 @@ void OTA_TestChunkSizes(void)
     }
 
     Modem_SendCommand("AT+HTTPTERM\r\n", response, sizeof(response), 2000);
-    printf("=== TEST COMPLETE ===\r\n");
+    LOG_INF("=== TEST COMPLETE ===\r\n");
 }
 
 
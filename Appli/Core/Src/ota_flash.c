@@ -0,0 +1,627 @@
+/**
+ ******************************************************************************
+ * @file    ota_flash.c
+ * @brief   Direct-to-flash OTA staging - STM32H7S3 + MX25UW25645G
+ *
+ *          The application executes in place from Slot A on XSPI2 and the
+ *          same device holds Slot B. Every erase/program therefore runs in
+ *          a short "flash window" where XSPI2 leaves memory-mapped mode:
+ *           - this file, the ExtMem middleware, the XSPI HAL, the HAL tick
+ *             and the exception handlers are linked into ITCM (.itcm_text,
+ *             see STM32H7S3L8HX_ROMxspi1_app.ld) and copied by the startup
+ *           - the vector table is in DTCM (TCM_RelocateVectors) so SysTick
+ *             keeps running
+ *           - all NVIC lines are masked for the duration of the window, so
+ *             handlers still located in flash cannot be entered
+ *          Nothing executed between OTA_Flash_EnterWindow() and
+ *          OTA_Flash_LeaveWindow() may live in flash (no printf there).
+ *          64KB block erases are suspended every few ms and the window is
+ *          left while the erase is on hold, so a block erase no longer
+ *          stalls interrupts and XIP for its full duration.
+ *          Downloaded chunks are gathered in a write cache (ExtMem
+ *          EXTMEM_WCACHE) so that each page of Slot B is programmed once,
+ *          in one window, whatever the chunk size.
+ *          EXTMEM_Init resets the memory and XSPI2 to linear bursts: the
+ *          XIP profile the Boot set (xip_record.h) is set again after it.
+ ******************************************************************************
+ */
+
+#include "ota_flash.h"
+#include "tcm.h"
+#include "extmem_manager.h"
+#include "stm32_sfdp_driver_api.h"
+#include "stm32_extmem_wcache.h"
+#include "xip_profile.h"
+#include "trace.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================*/
+/*                          EXTERNAL REFERENCES                               */
+/*============================================================================*/
+
+extern XSPI_HandleTypeDef hxspi2;
+
+/*============================================================================*/
+/*                          PRIVATE DEFINITIONS                               */
+/*============================================================================*/
+
+/* Flash geometry */
+#define FLASH_BLOCK_SIZE_64K    0x10000
+#define FLASH_SECTOR_SIZE_4K    0x1000
+#define FLASH_PAGE_SIZE         256U
+
+/* Write cache: pages gathered before a program window */
+#define OTA_CACHE_PAGES         4U
+
+/* Mapped mode must come back, otherwise the next flash fetch faults */
+#define OTA_REMAP_RETRIES       3U
+
+/* Block erases are sliced with erase suspend/resume so that interrupts and
+ * XIP are only held off for one slice instead of the whole block erase */
+#define OTA_ERASE_SLICE_MS      2U
+#define OTA_ERASE_TIMEOUT_MS    3000U
+
+#define OTA_NVIC_REG_COUNT      (sizeof(NVIC->ISER) / sizeof(NVIC->ISER[0]))
+
+/* Staging session */
+typedef struct {
+    uint8_t  ready;                         /* ExtMem attached */
+    uint8_t  active;                        /* Begin() done, Finish() pending */
+    uint32_t fileSize;                      /* Header + image */
+    uint8_t  header[OTA_HEADER_SIZE];
+    uint32_t headerBytes;
+} OTA_Flash_Session_t;
+
+static uint32_t savedIser[OTA_NVIC_REG_COUNT];
+static OTA_Flash_Session_t session;
+
+/* Slot B image area is erased block by block on the first program */
+static uint8_t cacheBuffer[OTA_CACHE_PAGES * FLASH_PAGE_SIZE];
+static uint32_t cacheEraseMap[EXTMEM_WCACHE_MAP_WORDS(OTA_SLOT_MAX_FW_SIZE, FLASH_BLOCK_SIZE_64K)];
+static EXTMEM_WCACHE_HandleTypeDef cache;
+
+/*============================================================================*/
+/*                          FLASH WINDOW                                      */
+/*============================================================================*/
+
+static void OTA_Flash_EnterWindow(void)
+{
+    for (uint32_t i = 0; i < OTA_NVIC_REG_COUNT; i++)
+    {
+        savedIser[i] = NVIC->ISER[i];
+        NVIC->ICER[i] = savedIser[i];
+    }
+    __DSB();
+    __ISB();
+}
+
+static void OTA_Flash_LeaveWindow(void)
+{
+    EXTMEM_StatusTypeDef status = EXTMEM_ERROR_DRIVER;
+
+    for (uint32_t retry = 0; (retry < OTA_REMAP_RETRIES) && (status != EXTMEM_OK); retry++)
+    {
+        status = EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_ENABLE);
+    }
+
+    if (status != EXTMEM_OK)
+    {
+        /* Code in Slot A is unreachable, the bootloader will recover */
+        NVIC_SystemReset();
+    }
+
+    __DSB();
+    __ISB();
+
+    for (uint32_t i = 0; i < OTA_NVIC_REG_COUNT; i++)
+    {
+        NVIC->ISER[i] = savedIser[i];
+    }
+}
+
+static OTA_Flash_Status_t OTA_Flash_Erase(uint32_t flashAddr, uint32_t size)
+{
+    EXTMEM_StatusTypeDef status;
+
+    TRACE_BEGIN(TRACE_ID_FLASH_ERASE, flashAddr);
+    OTA_Flash_EnterWindow();
+    status = EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    if (status == EXTMEM_OK)
+    {
+        status = EXTMEM_EraseSector(EXTMEMORY_1, flashAddr, size);
+    }
+    OTA_Flash_LeaveWindow();
+    TRACE_END(TRACE_ID_FLASH_ERASE, size);
+
+    /* Drop stale cache lines of the erased range */
+    SCB_InvalidateDCache_by_Addr((void *)(SLOT_A_CPU_ADDR + flashAddr), (int32_t)size);
+
+    return (status == EXTMEM_OK) ? OTA_FLASH_OK : OTA_FLASH_ERASE_ERROR;
+}
+
+/**
+ * @brief  Erase one 64KB block, suspending the erase every OTA_ERASE_SLICE_MS
+ *         to leave the window (pending IRQs run, Slot A is mapped again)
+ * @note   Falls back to a blocking erase when SFDP reports no suspend support
+ */
+static OTA_Flash_Status_t OTA_Flash_EraseBlock(uint32_t flashAddr)
+{
+    EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *nor = &extmem_list_config[EXTMEMORY_1].NorSfdpObject;
+    EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef type;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status = EXTMEM_DRIVER_NOR_SFDP_ERROR;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef busy;
+    uint32_t start;
+    uint32_t slices = 0;
+
+    /* Sector type whose size is 64KB (sizes are stored as powers of two) */
+    if (nor->sfpd_private.DriverInfo.EraseType4Size == 16U)
+        type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE4;
+    else if (nor->sfpd_private.DriverInfo.EraseType3Size == 16U)
+        type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE3;
+    else if (nor->sfpd_private.DriverInfo.EraseType2Size == 16U)
+        type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE2;
+    else
+        return OTA_Flash_Erase(flashAddr, FLASH_BLOCK_SIZE_64K);
+
+    TRACE_BEGIN(TRACE_ID_FLASH_ERASE, flashAddr);
+    start = HAL_GetTick();
+
+    OTA_Flash_EnterWindow();
+    if (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE) == EXTMEM_OK)
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_SectorEraseStart(nor, flashAddr, type);
+    }
+
+    while (status == EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        busy = EXTMEM_DRIVER_NOR_SFDP_CheckBusy(nor, OTA_ERASE_SLICE_MS);
+        if (busy == EXTMEM_DRIVER_NOR_SFDP_OK)
+        {
+            break;
+        }
+        if (busy != EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY)
+        {
+            /* Status not readable: suspending an erase of unknown state is not safe */
+            status = busy;
+            break;
+        }
+
+        if ((HAL_GetTick() - start) > OTA_ERASE_TIMEOUT_MS)
+        {
+            status = EXTMEM_DRIVER_NOR_SFDP_ERROR_ERASE_TIMEOUT;
+            break;
+        }
+
+        status = EXTMEM_DRIVER_NOR_SFDP_Suspend(nor);
+        if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+        {
+            break;
+        }
+
+        /* Erase suspended: the array is readable, let Slot A and the IRQs run */
+        OTA_Flash_LeaveWindow();
+        slices++;
+        OTA_Flash_EnterWindow();
+
+        status = (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE) == EXTMEM_OK)
+                 ? EXTMEM_DRIVER_NOR_SFDP_Resume(nor) : EXTMEM_DRIVER_NOR_SFDP_ERROR_MAP_ENABLE;
+    }
+
+    if (status == EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND_UNSUPPORTED)
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_CheckBusy(nor, OTA_ERASE_TIMEOUT_MS);
+    }
+    OTA_Flash_LeaveWindow();
+    TRACE_END(TRACE_ID_FLASH_ERASE, FLASH_BLOCK_SIZE_64K);
+
+    SCB_InvalidateDCache_by_Addr((void *)(SLOT_A_CPU_ADDR + flashAddr), (int32_t)FLASH_BLOCK_SIZE_64K);
+
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        LOG_ERR("[OTA] Block erase error %d after %lu slices\r\n", status, slices);
+        return OTA_FLASH_ERASE_ERROR;
+    }
+
+    return OTA_FLASH_OK;
+}
+
+static OTA_Flash_Status_t OTA_Flash_Program(uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    EXTMEM_StatusTypeDef status;
+
+    TRACE_BEGIN(TRACE_ID_FLASH_PROGRAM, flashAddr);
+    OTA_Flash_EnterWindow();
+    status = EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    if (status == EXTMEM_OK)
+    {
+        status = EXTMEM_Write(EXTMEMORY_1, flashAddr, data, size);
+    }
+    OTA_Flash_LeaveWindow();
+    TRACE_END(TRACE_ID_FLASH_PROGRAM, size);
+
+    SCB_InvalidateDCache_by_Addr((void *)(SLOT_A_CPU_ADDR + flashAddr), (int32_t)size);
+
+    return (status == EXTMEM_OK) ? OTA_FLASH_OK : OTA_FLASH_WRITE_ERROR;
+}
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+/**
+ * @brief  Init fields of hxspi2 read back from the XSPI2 registers
+ * @note   The inverse of the register writes of HAL_XSPI_Init(): the
+ *         prescaler and sample shift are those of the timing the Boot
+ *         calibrated, the wrap size that of the XIP profile it set.
+ */
+static void OTA_Flash_ReadXSPIInit(void)
+{
+    hxspi2.Init.FifoThresholdByte = (READ_BIT(XSPI2->CR, XSPI_CR_FTHRES) >> XSPI_CR_FTHRES_Pos) + 1U;
+    hxspi2.Init.MemoryMode = READ_BIT(XSPI2->CR, XSPI_CR_DMM);
+    hxspi2.Init.MemorySelect = READ_BIT(XSPI2->CR, XSPI_CR_CSSEL);
+    hxspi2.Init.MemoryType = READ_BIT(XSPI2->DCR1, XSPI_DCR1_MTYP);
+    hxspi2.Init.MemorySize = READ_BIT(XSPI2->DCR1, XSPI_DCR1_DEVSIZE) >> XSPI_DCR1_DEVSIZE_Pos;
+    hxspi2.Init.ChipSelectHighTimeCycle = (READ_BIT(XSPI2->DCR1, XSPI_DCR1_CSHT) >> XSPI_DCR1_CSHT_Pos) + 1U;
+    hxspi2.Init.FreeRunningClock = READ_BIT(XSPI2->DCR1, XSPI_DCR1_FRCK);
+    hxspi2.Init.ClockMode = READ_BIT(XSPI2->DCR1, XSPI_DCR1_CKMODE);
+    hxspi2.Init.WrapSize = READ_BIT(XSPI2->DCR2, XSPI_DCR2_WRAPSIZE);
+    hxspi2.Init.ClockPrescaler = READ_BIT(XSPI2->DCR2, XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos;
+    hxspi2.Init.ChipSelectBoundary = READ_BIT(XSPI2->DCR3, XSPI_DCR3_CSBOUND) >> XSPI_DCR3_CSBOUND_Pos;
+    hxspi2.Init.MaxTran = READ_BIT(XSPI2->DCR3, XSPI_DCR3_MAXTRAN) >> XSPI_DCR3_MAXTRAN_Pos;
+    hxspi2.Init.Refresh = READ_BIT(XSPI2->DCR4, XSPI_DCR4_REFRESH);
+    hxspi2.Init.SampleShifting = READ_BIT(XSPI2->TCR, XSPI_TCR_SSHIFT);
+    hxspi2.Init.DelayHoldQuarterCycle = READ_BIT(XSPI2->TCR, XSPI_TCR_DHQC);
+}
+
+/**
+ * @brief  Adopt the XSPI2 configuration left by the bootloader
+ * @note   HAL_XSPI_Init() cannot be used: it would reconfigure the
+ *         peripheral we are executing from. The Init fields are taken
+ *         from the registers, so a change of the Boot's MX_XSPI2_Init(),
+ *         calibrated timing or XIP profile is followed here.
+ */
+static void OTA_Flash_AttachXSPI(void)
+{
+    hxspi2.Instance = XSPI2;
+    OTA_Flash_ReadXSPIInit();
+    hxspi2.Timeout = HAL_XSPI_TIMEOUT_DEFAULT_VALUE;
+    hxspi2.ErrorCode = HAL_XSPI_ERROR_NONE;
+    hxspi2.State = HAL_XSPI_STATE_BUSY_MEM_MAPPED;
+
+    /* The NOR entry only: the PSRAM one (EXTMEMORY_2) is already set up */
+    memset(&extmem_list_config[EXTMEMORY_1], 0x0, sizeof(extmem_list_config[EXTMEMORY_1]));
+    extmem_list_config[EXTMEMORY_1].MemType = EXTMEM_NOR_SFDP;
+    extmem_list_config[EXTMEMORY_1].Handle = (void *)&hxspi2;
+    extmem_list_config[EXTMEMORY_1].ConfigType = EXTMEM_LINK_CONFIG_8LINES;
+}
+
+/**
+ * @brief  Check the live map configuration of XSPI2 against a profile
+ * @note   The timeout counter is only set by the memory-mapped mode
+ */
+static int OTA_Flash_MapMatches(const EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef *profile)
+{
+    uint32_t timeout = ((XSPI2->CR & XSPI_CR_TCEN) != 0U) ? (XSPI2->LPTR & XSPI_LPTR_TIMEOUT) : 0U;
+
+    return ((XSPI2->DCR2 & XSPI_DCR2_WRAPSIZE) == profile->Map.WrapSize) && (timeout == profile->Map.Timeout);
+}
+
+/**
+ * @brief  XIP profile the Boot left on XSPI2, read before EXTMEM_Init
+ *         drops it: the one the record says the Boot applied, if the live
+ *         DCR2.WRAPSIZE and timeout agree, else the one they match
+ */
+static XIP_Profile_t OTA_Flash_BootProfile(void)
+{
+    XIP_Profile_Record_t record;
+
+    if ((XIP_Profile_Load(&record) != 0) && (record.applied < (uint8_t)XIP_PROFILE_COUNT))
+    {
+        if (OTA_Flash_MapMatches(XIP_Profile_Get((XIP_Profile_t)record.applied)))
+        {
+            return (XIP_Profile_t)record.applied;
+        }
+        LOG_WRN("[OTA] XSPI2 does not run the %s profile of the record\r\n",
+                XIP_Profile_Name((XIP_Profile_t)record.applied));
+    }
+
+    for (uint32_t profile = 0; profile < (uint32_t)XIP_PROFILE_COUNT; profile++)
+    {
+        if (OTA_Flash_MapMatches(XIP_Profile_Get((XIP_Profile_t)profile)))
+        {
+            return (XIP_Profile_t)profile;
+        }
+    }
+
+    return XIP_PROFILE_LINEAR;
+}
+
+/* Write cache back-end: every program and erase gets its own window */
+static EXTMEM_StatusTypeDef OTA_Flash_CacheProgram(void *context, uint32_t flashAddr,
+                                                   const uint8_t *data, uint32_t size)
+{
+    (void)context;
+    return (OTA_Flash_Program(flashAddr, data, size) == OTA_FLASH_OK) ? EXTMEM_OK : EXTMEM_ERROR_DRIVER;
+}
+
+static EXTMEM_StatusTypeDef OTA_Flash_CacheErase(void *context, uint32_t flashAddr, uint32_t size)
+{
+    (void)context;
+    (void)size;
+
+    if (OTA_Flash_EraseBlock(flashAddr) != OTA_FLASH_OK)
+    {
+        LOG_ERR("[OTA] Erase failed at 0x%08lX\r\n", flashAddr);
+        return EXTMEM_ERROR_DRIVER;
+    }
+    return EXTMEM_OK;
+}
+
+static OTA_Flash_Status_t OTA_Flash_InitCache(void)
+{
+    EXTMEM_WCACHE_InitTypeDef init = {
+        .MemId         = EXTMEMORY_1,
+        .RegionAddress = SLOT_B_FLASH_ADDR,
+        .RegionSize    = OTA_SLOT_MAX_FW_SIZE,
+        .PageSize      = FLASH_PAGE_SIZE,
+        .EraseSize     = FLASH_BLOCK_SIZE_64K,
+        .Buffer        = cacheBuffer,
+        .BufferSize    = sizeof(cacheBuffer),
+        .EraseMap      = cacheEraseMap,
+        .Program       = OTA_Flash_CacheProgram,
+        .Erase         = OTA_Flash_CacheErase,
+        .Context       = NULL
+    };
+
+    return (EXTMEM_WCACHE_Init(&cache, &init) == EXTMEM_OK) ? OTA_FLASH_OK : OTA_FLASH_ERROR;
+}
+
+static uint32_t OTA_Flash_CalculateCRC32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t j = 0; j < 8; j++)
+        {
+            if (crc & 1)
+                crc = (crc >> 1) ^ 0xEDB88320;
+            else
+                crc >>= 1;
+        }
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+OTA_Flash_Status_t OTA_Flash_Init(void)
+{
+    EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *nor = &extmem_list_config[EXTMEMORY_1].NorSfdpObject;
+    EXTMEM_StatusTypeDef status;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef xipStatus = EXTMEM_DRIVER_NOR_SFDP_OK;
+    XIP_Profile_t profile;
+    uint32_t clockIn;
+
+    memset(&session, 0, sizeof(session));
+
+    profile = OTA_Flash_BootProfile();
+
+    TCM_RelocateVectors();
+    OTA_Flash_AttachXSPI();
+
+    HAL_RCCEx_EnableClockProtection(RCC_CLOCKPROTECT_XSPI);
+    clockIn = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_XSPI2);
+
+    TRACE_BEGIN(TRACE_ID_EXTMEM_INIT, 0);
+    OTA_Flash_EnterWindow();
+    status = (HAL_XSPI_Abort(&hxspi2) == HAL_OK) ? EXTMEM_OK : EXTMEM_ERROR_DRIVER;
+    if (status == EXTMEM_OK)
+    {
+        status = EXTMEM_Init(EXTMEMORY_1, clockIn);
+    }
+    if (status == EXTMEM_OK)
+    {
+        xipStatus = EXTMEM_DRIVER_NOR_SFDP_SetXipProfile(nor, XIP_Profile_Get(profile));
+        if ((xipStatus != EXTMEM_DRIVER_NOR_SFDP_OK) && (profile != XIP_PROFILE_LINEAR))
+        {
+            /* the memory may have taken the burst length: set it back with the profile */
+            (void)EXTMEM_DRIVER_NOR_SFDP_SetXipProfile(nor, XIP_Profile_Get(XIP_PROFILE_LINEAR));
+        }
+    }
+    OTA_Flash_LeaveWindow();
+    TRACE_END(TRACE_ID_EXTMEM_INIT, status);
+
+    /* EXTMEM_Init changes the prescaler in DCR2 only (SAL_XSPI_SetClock) */
+    OTA_Flash_ReadXSPIInit();
+
+    if (status != EXTMEM_OK)
+    {
+        LOG_ERR("[OTA] ExtMem init failed: %d\r\n", status);
+        return OTA_FLASH_ERROR;
+    }
+
+    /* A rejected record leaves Slot A on the default timing of the SFDP clock */
+    LOG_INF("[OTA] XSPI2 read timing: %s\r\n",
+            (nor->sfpd_private.TimingStored == 1U) ? "calibrated by the Boot" : "default");
+
+    if (xipStatus != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        LOG_ERR("[OTA] XIP profile %s rejected (%d), linear kept\r\n", XIP_Profile_Name(profile), xipStatus);
+        profile = XIP_PROFILE_LINEAR;
+    }
+    if (!OTA_Flash_MapMatches(XIP_Profile_Get(profile)))
+    {
+        LOG_ERR("[OTA] XSPI2 map config differs from the %s profile\r\n", XIP_Profile_Name(profile));
+    }
+    else
+    {
+        LOG_INF("[OTA] XIP profile: %s\r\n", XIP_Profile_Name(profile));
+    }
+
+    if (OTA_Flash_InitCache() != OTA_FLASH_OK)
+    {
+        return OTA_FLASH_ERROR;
+    }
+
+    session.ready = 1;
+    LOG_INF("[OTA] Flash staging ready (vectors @ 0x%08lX)\r\n", SCB->VTOR);
+    return OTA_FLASH_OK;
+}
+
+OTA_Flash_Status_t OTA_Flash_Begin(uint32_t fileSize)
+{
+    if (!session.ready)
+    {
+        return OTA_FLASH_NOT_READY;
+    }
+
+    if ((fileSize <= OTA_HEADER_SIZE) || ((fileSize - OTA_HEADER_SIZE) > OTA_SLOT_MAX_FW_SIZE))
+    {
+        LOG_ERR("[OTA] Invalid file size for Slot B: %lu\r\n", fileSize);
+        return OTA_FLASH_INVALID_FW;
+    }
+
+    session.active = 1;
+    session.fileSize = fileSize;
+    session.headerBytes = 0;
+    memset(session.header, 0, sizeof(session.header));
+    (void)EXTMEM_WCACHE_Reset(&cache);
+
+    return OTA_FLASH_OK;
+}
+
+OTA_Flash_Status_t OTA_Flash_Write(uint32_t fileOffset, const uint8_t *data, uint32_t len)
+{
+    uint32_t slotOffset;
+
+    if (!session.active)
+    {
+        return OTA_FLASH_NOT_READY;
+    }
+
+    if ((fileOffset + len) > session.fileSize)
+    {
+        return OTA_FLASH_INVALID_FW;
+    }
+
+    /* Header bytes are kept in RAM and written last by OTA_Flash_Finish() */
+    while ((len > 0) && (fileOffset < OTA_HEADER_SIZE))
+    {
+        session.header[fileOffset++] = *data++;
+        session.headerBytes++;
+        len--;
+    }
+
+    if (len == 0)
+    {
+        return OTA_FLASH_OK;
+    }
+
+    slotOffset = fileOffset - OTA_HEADER_SIZE;
+
+    if (EXTMEM_WCACHE_Write(&cache, SLOT_B_FLASH_ADDR + slotOffset, data, len) != EXTMEM_OK)
+    {
+        return OTA_FLASH_WRITE_ERROR;
+    }
+
+    return OTA_FLASH_OK;
+}
+
+OTA_Flash_Status_t OTA_Flash_Finish(void)
+{
+    OTA_Flash_Status_t status;
+    uint32_t magic, fwSize, expectedCRC, version;
+    uint32_t crc;
+
+    if (!session.active)
+    {
+        return OTA_FLASH_NOT_READY;
+    }
+    session.active = 0;
+
+    if (session.headerBytes != OTA_HEADER_SIZE)
+    {
+        LOG_ERR("[OTA] Header incomplete\r\n");
+        return OTA_FLASH_INVALID_FW;
+    }
+
+    memcpy(&magic,       &session.header[0],  4);
+    memcpy(&fwSize,      &session.header[4],  4);
+    memcpy(&expectedCRC, &session.header[8],  4);
+    memcpy(&version,     &session.header[12], 4);
+
+    /* Program the tail of the image still held in the cache */
+    if (EXTMEM_WCACHE_Sync(&cache) != EXTMEM_OK)
+    {
+        return OTA_FLASH_WRITE_ERROR;
+    }
+    LOG_INF("[OTA] %lu page programs, %lu block erases\r\n", cache.PageProgramCount, cache.EraseCount);
+
+    if ((magic != OTA_MAGIC) || ((fwSize + OTA_HEADER_SIZE) != session.fileSize))
+    {
+        LOG_ERR("[OTA] Invalid header (magic 0x%08lX, size %lu)\r\n", magic, fwSize);
+        return OTA_FLASH_INVALID_FW;
+    }
+
+    /* Slot B is readable through XIP: verify what actually landed in flash */
+    TRACE_BEGIN(TRACE_ID_CRC, fwSize);
+    crc = OTA_Flash_CalculateCRC32((const uint8_t *)SLOT_B_CPU_ADDR, fwSize);
+    TRACE_END(TRACE_ID_CRC, crc);
+    LOG_INF("[OTA] Slot B CRC: 0x%08lX (expected 0x%08lX)\r\n", crc, expectedCRC);
+
+    if (crc != expectedCRC)
+    {
+        return OTA_FLASH_VERIFY_ERROR;
+    }
+
+    status = OTA_Flash_Erase(SLOT_B_HEADER_ADDR, FLASH_SECTOR_SIZE_4K);
+    if (status == OTA_FLASH_OK)
+    {
+        status = OTA_Flash_Program(SLOT_B_HEADER_ADDR, session.header, OTA_HEADER_SIZE);
+    }
+
+    if (status == OTA_FLASH_OK)
+    {
+        LOG_INF("[OTA] Version 0x%08lX staged in Slot B\r\n", version);
+    }
+
+    return status;
+}
+
+static void OTA_Flash_SetBootFlag(uint32_t flag)
+{
+    RCC->APB4ENR |= RCC_APB4ENR_SBSEN | RCC_APB4ENR_RTCAPBEN;
+    __DSB();
+
+    PWR->CR1 |= PWR_CR1_DBP;
+    while ((PWR->CR1 & PWR_CR1_DBP) == 0);
+
+    TAMP->BKP0R = flag;
+}
+
+void OTA_Flash_RequestBoot(void)
+{
+    OTA_Flash_SetBootFlag(BOOT_FLAG_STAGED);
+}
+
+void OTA_Flash_RequestMailbox(void)
+{
+    OTA_Flash_SetBootFlag(BOOT_FLAG_UPDATE);
+}
+
+void OTA_Flash_RequestInstall(void)
+{
+    OTA_Flash_SetBootFlag(BOOT_FLAG_STORE_INSTALL);
+}
+
+void OTA_Flash_RequestRollback(void)
+{
+    OTA_Flash_SetBootFlag(BOOT_FLAG_STORE_ROLLBACK);
+}
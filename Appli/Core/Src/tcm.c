@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @file    tcm.c
+ * @brief   Vector table in DTCM - STM32H7S3, Appli in Slot A or B
+ *
+ * The functions marked ITCM_FUNC (tcm.h) and the objects listed in the
+ * .itcm_text section of the linker script are copied to ITCM by the startup
+ * code; nothing is left to do for them at run time. The vector table is
+ * copied here, once HAL_Init has set up the table in flash.
+ ******************************************************************************
+ */
+
+#include "tcm.h"
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+/* VTOR requires alignment on the table size rounded up to a power of two */
+static uint32_t tcmVectors[TCM_VECTOR_COUNT] DTCM_BSS __attribute__((aligned(1024)));
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+void TCM_RelocateVectors(void)
+{
+    uint32_t primask_bit = __get_PRIMASK();
+
+    if (SCB->VTOR == (uint32_t)tcmVectors)
+    {
+        return;
+    }
+
+    memcpy(tcmVectors, g_pfnVectors, sizeof(tcmVectors));
+
+    __disable_irq();
+    SCB->VTOR = (uint32_t)tcmVectors;
+    __DSB();
+    __ISB();
+    __set_PRIMASK(primask_bit);
+}
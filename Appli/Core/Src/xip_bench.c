@@ -0,0 +1,398 @@
+/**
+ ******************************************************************************
+ * @file    xip_bench.c
+ * @brief   XIP benchmark - STM32H7S3 + MX25UW25645G, Appli in Slot A or B
+ *
+ * The kernels follow CoreMark: linked list search and sort, small matrix
+ * product, number parsing state machine, with a CRC16 of their results.
+ * They fit in the I-cache, so each run starts from a cold I-cache: this is
+ * the cost of the code paths of the Appli (USB, modem, OTA) that do not
+ * stay cached. Two data parts complete it: a checksum over the start of
+ * the running image, as the OTA checks read a slot, and one word per 32-byte
+ * line at random offsets, where the wrapped fills return the word first.
+ * The same kernels are also compiled into ITCM (ITCM_FUNC): the difference
+ * is what the code placed in ITCM saves over XIP with cache misses.
+ * The XSPI profile can only change across a reset (the code executes from
+ * it), so the sweep measures one profile per boot and keeps its state in
+ * the backup SRAM record that the Boot reads.
+ ******************************************************************************
+ */
+
+#include "xip_bench.h"
+#include "ota_flash.h"
+#include "tcm.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DEFINITIONS                               */
+/*============================================================================*/
+
+#define BENCH_LIST_SIZE     32U
+#define BENCH_MATRIX_SIZE   10U
+
+/* The kernels are inlined in both runs (XIP and ITCM): only the place their
+ * code is fetched from differs */
+#define BENCH_INLINE        static inline __attribute__((always_inline))
+
+typedef struct BenchNode {
+    struct BenchNode *next;
+    int16_t  value;
+    uint16_t index;
+} BenchNode_t;
+
+static BenchNode_t benchNodes[BENCH_LIST_SIZE];
+static int16_t benchMatA[BENCH_MATRIX_SIZE][BENCH_MATRIX_SIZE];
+static int16_t benchMatB[BENCH_MATRIX_SIZE][BENCH_MATRIX_SIZE];
+static int32_t benchMatC[BENCH_MATRIX_SIZE][BENCH_MATRIX_SIZE];
+
+static const char *const benchInputs[] = {
+    "5012", "-0x1F", "3.1415", "+2.5e-3", "12a", "0", "-.5", "7e", "0x7fff", "-118.0e+2"
+};
+
+typedef enum {
+    STATE_START, STATE_SIGN, STATE_INT, STATE_HEX, STATE_FLOAT,
+    STATE_EXP, STATE_SCI, STATE_INVALID, STATE_COUNT
+} BenchState_t;
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+BENCH_INLINE uint16_t Bench_Crc16(uint32_t value, uint16_t crc)
+{
+    for (uint32_t bit = 0; bit < 32U; bit++)
+    {
+        uint16_t mix = (uint16_t)((crc ^ (value >> bit)) & 1U);
+        crc >>= 1;
+        if (mix != 0U)
+        {
+            crc ^= 0xA001U;
+        }
+    }
+    return crc;
+}
+
+BENCH_INLINE uint32_t Bench_Random(uint32_t *seed)
+{
+    *seed = (*seed * 1103515245U) + 12345U;
+    return *seed >> 8;
+}
+
+/**
+ * @brief  Build the list, count the nodes over a threshold, sort it by value
+ */
+BENCH_INLINE uint32_t Bench_List(uint32_t seed)
+{
+    BenchNode_t *head = NULL;
+    BenchNode_t *sorted = NULL;
+    uint32_t found = 0;
+
+    for (uint32_t i = 0; i < BENCH_LIST_SIZE; i++)
+    {
+        benchNodes[i].value = (int16_t)Bench_Random(&seed);
+        benchNodes[i].index = (uint16_t)i;
+        benchNodes[i].next = head;
+        head = &benchNodes[i];
+    }
+
+    for (BenchNode_t *node = head; node != NULL; node = node->next)
+    {
+        found += (node->value > 0) ? 1U : 0U;
+    }
+
+    /* insertion sort */
+    while (head != NULL)
+    {
+        BenchNode_t *node = head;
+        BenchNode_t **pos = &sorted;
+
+        head = head->next;
+        while ((*pos != NULL) && ((*pos)->value < node->value))
+        {
+            pos = &(*pos)->next;
+        }
+        node->next = *pos;
+        *pos = node;
+    }
+
+    return (found << 16) ^ sorted->index ^ ((uint32_t)(uint16_t)sorted->value << 5);
+}
+
+/**
+ * @brief  Matrix product, then a bit field sum of the result
+ */
+BENCH_INLINE uint32_t Bench_Matrix(uint32_t seed)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < BENCH_MATRIX_SIZE; i++)
+    {
+        for (uint32_t j = 0; j < BENCH_MATRIX_SIZE; j++)
+        {
+            benchMatA[i][j] = (int16_t)(Bench_Random(&seed) & 0xFFU);
+            benchMatB[i][j] = (int16_t)((int32_t)(Bench_Random(&seed) & 0xFFU) - 128);
+        }
+    }
+
+    for (uint32_t i = 0; i < BENCH_MATRIX_SIZE; i++)
+    {
+        for (uint32_t j = 0; j < BENCH_MATRIX_SIZE; j++)
+        {
+            int32_t acc = 0;
+            for (uint32_t k = 0; k < BENCH_MATRIX_SIZE; k++)
+            {
+                acc += (int32_t)benchMatA[i][k] * benchMatB[k][j];
+            }
+            benchMatC[i][j] = acc;
+            sum += ((uint32_t)acc >> 2) & 0x0FU;
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief  Classify the inputs with a number parsing state machine
+ */
+BENCH_INLINE uint32_t Bench_State(void)
+{
+    uint32_t finals[STATE_COUNT] = {0};
+    uint32_t result = 0;
+
+    for (uint32_t n = 0; n < (sizeof(benchInputs) / sizeof(benchInputs[0])); n++)
+    {
+        BenchState_t state = STATE_START;
+
+        for (const char *c = benchInputs[n]; (*c != '\0') && (state != STATE_INVALID); c++)
+        {
+            switch (state)
+            {
+            case STATE_START:
+                state = ((*c == '+') || (*c == '-')) ? STATE_SIGN :
+                        ((*c >= '0') && (*c <= '9')) ? STATE_INT :
+                        (*c == '.') ? STATE_FLOAT : STATE_INVALID;
+                break;
+            case STATE_SIGN:
+                state = ((*c >= '0') && (*c <= '9')) ? STATE_INT : (*c == '.') ? STATE_FLOAT : STATE_INVALID;
+                break;
+            case STATE_INT:
+                state = ((*c >= '0') && (*c <= '9')) ? STATE_INT : (*c == '.') ? STATE_FLOAT :
+                        ((*c == 'x') || (*c == 'X')) ? STATE_HEX : ((*c == 'e') || (*c == 'E')) ? STATE_EXP : STATE_INVALID;
+                break;
+            case STATE_HEX:
+                state = (((*c >= '0') && (*c <= '9')) || ((*c | 0x20) >= 'a' && (*c | 0x20) <= 'f')) ? STATE_HEX : STATE_INVALID;
+                break;
+            case STATE_FLOAT:
+                state = ((*c >= '0') && (*c <= '9')) ? STATE_FLOAT : ((*c == 'e') || (*c == 'E')) ? STATE_EXP : STATE_INVALID;
+                break;
+            case STATE_EXP:
+                state = (((*c >= '0') && (*c <= '9')) || (*c == '+') || (*c == '-')) ? STATE_SCI : STATE_INVALID;
+                break;
+            case STATE_SCI:
+                state = ((*c >= '0') && (*c <= '9')) ? STATE_SCI : STATE_INVALID;
+                break;
+            default:
+                state = STATE_INVALID;
+                break;
+            }
+        }
+        finals[(state == STATE_EXP) ? STATE_INVALID : state]++;
+    }
+
+    for (uint32_t i = 0; i < STATE_COUNT; i++)
+    {
+        result = (result << 3) ^ finals[i];
+    }
+    return result;
+}
+
+/**
+ * @brief  One run of the kernels, executed from the slot (XIP)
+ */
+static __attribute__((noinline)) uint16_t Bench_KernelsXip(uint32_t seed, uint16_t crc)
+{
+    crc = Bench_Crc16(Bench_List(seed), crc);
+    crc = Bench_Crc16(Bench_Matrix(seed), crc);
+    return Bench_Crc16(Bench_State(), crc);
+}
+
+/**
+ * @brief  One run of the kernels, executed from ITCM
+ */
+static ITCM_FUNC uint16_t Bench_KernelsItcm(uint32_t seed, uint16_t crc)
+{
+    crc = Bench_Crc16(Bench_List(seed), crc);
+    crc = Bench_Crc16(Bench_Matrix(seed), crc);
+    return Bench_Crc16(Bench_State(), crc);
+}
+
+static uint32_t Bench_Cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+void XIP_Bench_Measure(XIP_Bench_Result_t *result)
+{
+    /* Start of the running image: its vector table, VTOR points on DTCM */
+    const volatile uint32_t *image = (const volatile uint32_t *)((uint32_t)g_pfnVectors & ~0xFFFFU);
+    uint32_t seed = 0x3415U;
+    uint32_t start;
+    uint32_t sum = 0;
+    uint16_t crc = 0;
+    uint16_t itcmCrc = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    result->coreCycles = 0;
+    for (uint32_t run = 0; run < XIP_BENCH_CORE_RUNS; run++)
+    {
+        SCB_InvalidateICache();
+        start = Bench_Cycles();
+        crc = Bench_KernelsXip(seed, crc);
+        result->coreCycles += Bench_Cycles() - start;
+    }
+    result->crc = crc;
+
+    /* Same runs from ITCM; the I-cache is dropped as well, for the data */
+    result->itcmCycles = 0;
+    for (uint32_t run = 0; run < XIP_BENCH_CORE_RUNS; run++)
+    {
+        SCB_InvalidateICache();
+        start = Bench_Cycles();
+        itcmCrc = Bench_KernelsItcm(seed, itcmCrc);
+        result->itcmCycles += Bench_Cycles() - start;
+    }
+    result->itcmCrc = itcmCrc;
+
+    SCB_CleanInvalidateDCache();
+    start = Bench_Cycles();
+    for (uint32_t i = 0; i < (XIP_BENCH_SEQ_SIZE / sizeof(uint32_t)); i++)
+    {
+        sum = (sum << 1) ^ (sum >> 31) ^ image[i];
+    }
+    result->seqCycles = Bench_Cycles() - start;
+
+    SCB_CleanInvalidateDCache();
+    start = Bench_Cycles();
+    for (uint32_t i = 0; i < XIP_BENCH_RAND_COUNT; i++)
+    {
+        /* last word of a random line: the worst case for linear fills */
+        uint32_t line = Bench_Random(&seed) % (XIP_BENCH_RAND_SPAN / 32U);
+        sum += image[(line * 8U) + 7U];
+    }
+    result->randCycles = Bench_Cycles() - start;
+
+    /* the reads are volatile, the sum is not needed */
+    (void)sum;
+}
+
+int XIP_Bench_Run(void)
+{
+    XIP_Profile_Record_t record;
+    XIP_Bench_Result_t result;
+    uint32_t best = UINT32_MAX;
+    uint32_t bestProfile = 0;
+    uint32_t bestMpu = APPLI_XIP_MPU_DEFAULT;
+
+    if ((XIP_Profile_Load(&record) == 0) || (record.sweep == XIP_SWEEP_NONE))
+    {
+        memset(&record, 0, sizeof(record));
+        record.profile = XIP_PROFILE_LINEAR;
+        record.mpu = APPLI_XIP_MPU_DEFAULT;
+        record.sweep = XIP_SWEEP_RUNNING;
+        record.applied = 0xFFU;
+        XIP_Profile_Save(&record);
+        LOG_INF("[XIP] profile sweep: reset for %s\r\n", XIP_Profile_Name(XIP_PROFILE_LINEAR));
+        Log_Flush(LOG_BLOCKING_TIMEOUT);
+        NVIC_SystemReset();
+    }
+
+    if (record.sweep == XIP_SWEEP_RUNNING)
+    {
+        LOG_INF("[XIP] slot %s, XSPI profile %s\r\n",
+                ((uint32_t)g_pfnVectors >= SLOT_B_CPU_ADDR) ? "B" : "A", XIP_Profile_Name((XIP_Profile_t)record.profile));
+        LOG_INF("[XIP] mpu     |  core cyc  itcm cyc saved %% |   seq cyc  rand cyc | crc\r\n");
+
+        for (uint32_t mpu = 0; mpu < XIP_MPU_COUNT; mpu++)
+        {
+            if (record.applied != record.profile)
+            {
+                /* the Boot rejected the profile: never select it */
+                record.cycles[record.profile][mpu] = UINT32_MAX;
+                continue;
+            }
+            XIP_Profile_SetMpu((XIP_Mpu_t)mpu);
+            XIP_Bench_Measure(&result);
+            record.cycles[record.profile][mpu] = result.coreCycles + result.seqCycles + result.randCycles;
+            LOG_INF("[XIP] %-7s | %9lu %9lu %7ld | %9lu %9lu | %04X\r\n", XIP_Profile_MpuName((XIP_Mpu_t)mpu),
+                    (unsigned long)result.coreCycles, (unsigned long)result.itcmCycles,
+                    (long)((((int64_t)result.coreCycles - (int64_t)result.itcmCycles) * 100) /
+                           (int64_t)((result.coreCycles != 0U) ? result.coreCycles : 1U)),
+                    (unsigned long)result.seqCycles, (unsigned long)result.randCycles, result.crc);
+            if (result.itcmCrc != result.crc)
+            {
+                LOG_ERR("[XIP] ITCM kernels: crc %04X instead of %04X\r\n", result.itcmCrc, result.crc);
+            }
+        }
+        XIP_Profile_SetMpu((XIP_Mpu_t)record.mpu);
+
+        if ((record.profile + 1U) < (uint32_t)XIP_PROFILE_COUNT)
+        {
+            record.profile++;
+            XIP_Profile_Save(&record);
+            LOG_INF("[XIP] profile sweep: reset for %s\r\n", XIP_Profile_Name((XIP_Profile_t)record.profile));
+            Log_Flush(LOG_BLOCKING_TIMEOUT);
+            NVIC_SystemReset();
+        }
+
+        for (uint32_t profile = 0; profile < XIP_PROFILE_COUNT; profile++)
+        {
+            for (uint32_t mpu = 0; mpu < XIP_MPU_COUNT; mpu++)
+            {
+                if ((record.cycles[profile][mpu] != 0U) && (record.cycles[profile][mpu] < best))
+                {
+                    best = record.cycles[profile][mpu];
+                    bestProfile = profile;
+                    bestMpu = mpu;
+                }
+            }
+        }
+        record.profile = (uint8_t)bestProfile;
+        record.mpu = (uint8_t)bestMpu;
+        record.sweep = XIP_SWEEP_DONE;
+        XIP_Profile_Save(&record);
+        XIP_Profile_SetMpu((XIP_Mpu_t)bestMpu);
+    }
+
+    LOG_INF("[XIP] total cycles  |");
+    for (uint32_t mpu = 0; mpu < XIP_MPU_COUNT; mpu++)
+    {
+        LOG_INF(" %9s", XIP_Profile_MpuName((XIP_Mpu_t)mpu));
+    }
+    LOG_INF("\r\n");
+    for (uint32_t profile = 0; profile < XIP_PROFILE_COUNT; profile++)
+    {
+        LOG_INF("[XIP] %-14s|", XIP_Profile_Name((XIP_Profile_t)profile));
+        for (uint32_t mpu = 0; mpu < XIP_MPU_COUNT; mpu++)
+        {
+            if (record.cycles[profile][mpu] == UINT32_MAX)
+            {
+                LOG_INF(" %9s", "rejected");
+            }
+            else
+            {
+                LOG_INF(" %9lu", (unsigned long)record.cycles[profile][mpu]);
+            }
+        }
+        LOG_INF("\r\n");
+    }
+    LOG_INF("[XIP] selected: %s, %s (the XSPI profile is set by the Boot at the next reset)\r\n",
+            XIP_Profile_Name((XIP_Profile_t)record.profile), XIP_Profile_MpuName((XIP_Mpu_t)record.mpu));
+    return 0;
+}
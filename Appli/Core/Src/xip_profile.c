@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ * @file    xip_profile.c
+ * @brief   MPU cache policy of the memory-mapped NOR - STM32H7S3
+ *
+ * The Appli executes from Slot A or B through the XSPI2 memory-mapped
+ * window, covered by one MPU region. The presets only change the TEX, C and
+ * B attributes of that region. The region is never shareable: the Cortex-M7
+ * does not cache shareable normal memory in its D-cache, the constants read
+ * in place would then always miss.
+ ******************************************************************************
+ */
+
+#include "xip_profile.h"
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+typedef struct {
+    uint8_t tex;
+    uint8_t cacheable;
+    uint8_t bufferable;
+} XIP_MpuAttr_t;
+
+/* Indexed by XIP_Mpu_t */
+static const XIP_MpuAttr_t mpuPresets[XIP_MPU_COUNT] = {
+    { MPU_TEX_LEVEL1, MPU_ACCESS_NOT_CACHEABLE, MPU_ACCESS_NOT_BUFFERABLE },
+    { MPU_TEX_LEVEL0, MPU_ACCESS_CACHEABLE,     MPU_ACCESS_NOT_BUFFERABLE },
+    { MPU_TEX_LEVEL0, MPU_ACCESS_CACHEABLE,     MPU_ACCESS_BUFFERABLE },
+    { MPU_TEX_LEVEL1, MPU_ACCESS_CACHEABLE,     MPU_ACCESS_BUFFERABLE },
+};
+
+static const char *const mpuNames[XIP_MPU_COUNT] = {
+    "nocache", "WT", "WB", "WBWA"
+};
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+void XIP_Profile_Init(void)
+{
+    XIP_Profile_Record_t record;
+
+    __HAL_RCC_BKPRAM_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+
+    if ((XIP_Profile_Load(&record) != 0) && (record.mpu < (uint8_t)XIP_MPU_COUNT))
+    {
+        XIP_Profile_SetMpu((XIP_Mpu_t)record.mpu);
+    }
+    else
+    {
+        XIP_Profile_SetMpu(APPLI_XIP_MPU_DEFAULT);
+    }
+}
+
+void XIP_Profile_SetMpu(XIP_Mpu_t preset)
+{
+    MPU_Region_InitTypeDef region = {0};
+
+    region.Enable           = MPU_REGION_ENABLE;
+    region.Number           = XIP_MPU_REGION;
+    region.BaseAddress      = XIP_MPU_BASE;
+    region.Size             = XIP_MPU_SIZE;
+    region.SubRegionDisable = 0x0;
+    region.TypeExtField     = mpuPresets[preset].tex;
+    region.AccessPermission = MPU_REGION_FULL_ACCESS;
+    region.DisableExec      = MPU_INSTRUCTION_ACCESS_ENABLE;
+    region.IsShareable      = MPU_ACCESS_NOT_SHAREABLE;
+    region.IsCacheable      = mpuPresets[preset].cacheable;
+    region.IsBufferable     = mpuPresets[preset].bufferable;
+
+    /* While the MPU is off this code keeps executing through the default map */
+    HAL_MPU_Disable();
+    HAL_MPU_ConfigRegion(&region);
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+
+    /* Nothing is written in the slots: the RAM lines are cleaned, the others dropped */
+    SCB_CleanInvalidateDCache();
+    SCB_InvalidateICache();
+}
+
+int XIP_Profile_Load(XIP_Profile_Record_t *record)
+{
+    memcpy(record, XIP_RECORD, sizeof(*record));
+    return (record->magic == XIP_PROFILE_MAGIC) && (record->check == XIP_Record_Check(record));
+}
+
+void XIP_Profile_Save(XIP_Profile_Record_t *record)
+{
+    record->magic = XIP_PROFILE_MAGIC;
+    record->check = XIP_Record_Check(record);
+    memcpy(XIP_RECORD, record, sizeof(*record));
+}
+
+const char *XIP_Profile_MpuName(XIP_Mpu_t preset)
+{
+    return (preset < XIP_MPU_COUNT) ? mpuNames[preset] : "?";
+}
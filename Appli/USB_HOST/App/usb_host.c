@@ -16,6 +16,9 @@
 /* USER CODE BEGIN Includes */
 #include <string.h>
 #include <stdio.h>
+#include "tcm.h"
+#include "trace.h"
+#include "log.h"
 /* USER CODE END Includes */
 
 /* Private variables ---------------------------------------------------------*/
@@ -78,7 +81,7 @@ static void USBH_UserProcess(USBH_HandleTypeDef *phost, uint8_t id);
 /*                          RING BUFFER FUNCTIONS                             */
 /*============================================================================*/
 
-static uint32_t RingBuffer_Write(uint8_t *data, uint32_t len)
+static ITCM_FUNC uint32_t RingBuffer_Write(uint8_t *data, uint32_t len)
 {
     uint32_t written = 0;
 
@@ -101,7 +104,7 @@ static uint32_t RingBuffer_Write(uint8_t *data, uint32_t len)
     return written;
 }
 
-uint32_t RingBuffer_Read(uint8_t *data, uint32_t maxLen)
+ITCM_FUNC uint32_t RingBuffer_Read(uint8_t *data, uint32_t maxLen)
 {
     uint32_t readCount = 0;
 
@@ -114,7 +117,7 @@ uint32_t RingBuffer_Read(uint8_t *data, uint32_t maxLen)
     return readCount;
 }
 
-static uint32_t RingBuffer_Available(void)
+static ITCM_FUNC uint32_t RingBuffer_Available(void)
 {
     if (rxRingBuffer.head >= rxRingBuffer.tail)
     {
@@ -304,7 +307,8 @@ static void USBH_UserProcess  (USBH_HandleTypeDef *phost, uint8_t id)
             CDC_TxComplete = 1;
             CDC_RxComplete = 0;
             CDC_RxLength = 0;
-            printf("[USB] Disconnected\r\n");
+            LOG_INF("[USB] Disconnected\r\n");
+            USBH_MEM_Report();
             break;
 
         case HOST_USER_CLASS_ACTIVE:
@@ -313,13 +317,15 @@ static void USBH_UserProcess  (USBH_HandleTypeDef *phost, uint8_t id)
             CDC_RxComplete = 0;
             CDC_RxLength = 0;
             RingBuffer_Flush();
-            printf("[USB] CDC Ready!\r\n");
+            TRACE_END(TRACE_ID_USB_ENUM, 0);
+            LOG_INF("[USB] CDC Ready!\r\n");
             /* NOTE: Do NOT start receive here - causes interrupt flooding! */
             break;
 
         case HOST_USER_CONNECTION:
             Appli_state = APPLICATION_START;
-            printf("[USB] Connected\r\n");
+            TRACE_BEGIN(TRACE_ID_USB_ENUM, 0);
+            LOG_INF("[USB] Connected\r\n");
             break;
 
         case HOST_USER_CLASS_SELECTED:
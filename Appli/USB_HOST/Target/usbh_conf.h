@@ -36,7 +36,7 @@
 #include "stm32h7rsxx_hal.h"
 
 /* USER CODE BEGIN INCLUDE */
-
+#include "usbh_mem.h"
 /* USER CODE END INCLUDE */
 
 /** @addtogroup STM32_USB_HOST_LIBRARY
@@ -111,11 +111,11 @@
 
 /* Memory management macros */
 
-/** Alias for memory allocation. */
-#define USBH_malloc         malloc
+/** Alias for memory allocation (fixed-block pools, see usbh_mem.h). */
+#define USBH_malloc         USBH_MEM_Alloc
 
 /** Alias for memory release. */
-#define USBH_free           free
+#define USBH_free           USBH_MEM_Free
 
 /** Alias for memory set. */
 #define USBH_memset         memset
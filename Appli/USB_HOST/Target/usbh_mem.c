@@ -0,0 +1,168 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : usbh_mem.c
+  * @brief          : Deterministic fixed-block pool allocator for the USB
+  *                   host library. Replaces newlib malloc/free so repeated
+  *                   modem re-enumerations cannot fragment the heap.
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbh_mem.h"
+#include "usbh_conf.h"
+#include "usbh_cdc.h"
+
+/* Compile-time sanity checks on the pool geometry */
+_Static_assert((USBH_MEM_PIPE_BLOCK_SIZE % 4U) == 0U, "pipe block size must be word aligned");
+_Static_assert((USBH_MEM_CLASS_BLOCK_SIZE % 4U) == 0U, "class block size must be word aligned");
+_Static_assert((USBH_MEM_DESC_BLOCK_SIZE % 4U) == 0U, "descriptor block size must be word aligned");
+_Static_assert(USBH_MEM_PIPE_BLOCK_SIZE < USBH_MEM_CLASS_BLOCK_SIZE, "pools must be sorted by block size");
+_Static_assert(USBH_MEM_CLASS_BLOCK_SIZE < USBH_MEM_DESC_BLOCK_SIZE, "pools must be sorted by block size");
+_Static_assert(USBH_MEM_PIPE_BLOCK_COUNT <= 32U, "pool bitmap is 32 bits wide");
+_Static_assert(USBH_MEM_CLASS_BLOCK_COUNT <= 32U, "pool bitmap is 32 bits wide");
+_Static_assert(USBH_MEM_DESC_BLOCK_COUNT <= 32U, "pool bitmap is 32 bits wide");
+_Static_assert(USBH_MEM_CLASS_BLOCK_COUNT >= USBH_MAX_NUM_SUPPORTED_CLASS, "one class block per supported class");
+_Static_assert(sizeof(CDC_HandleTypeDef) <= USBH_MEM_CLASS_BLOCK_SIZE, "CDC handle does not fit in a class block");
+_Static_assert(USBH_MAX_SIZE_CONFIGURATION <= USBH_MEM_DESC_BLOCK_SIZE, "descriptor block smaller than configuration");
+
+/*============================================================================*/
+/*                          POOL STORAGE                                      */
+/*============================================================================*/
+
+static uint32_t pipePool[USBH_MEM_PIPE_BLOCK_COUNT][USBH_MEM_PIPE_BLOCK_SIZE / 4U];
+static uint32_t classPool[USBH_MEM_CLASS_BLOCK_COUNT][USBH_MEM_CLASS_BLOCK_SIZE / 4U];
+static uint32_t descPool[USBH_MEM_DESC_BLOCK_COUNT][USBH_MEM_DESC_BLOCK_SIZE / 4U];
+
+typedef struct {
+    uint8_t *base;
+    uint32_t blockSize;
+    uint32_t blockCount;
+    uint32_t usedMask;      /* Bit n set = block n allocated */
+    uint32_t inUse;
+    uint32_t highWater;
+    uint32_t failures;
+} USBH_MEM_PoolCtrl_t;
+
+static USBH_MEM_PoolCtrl_t pools[USBH_MEM_POOL_COUNT] = {
+    [USBH_MEM_POOL_PIPE]  = { (uint8_t *)pipePool,  USBH_MEM_PIPE_BLOCK_SIZE,  USBH_MEM_PIPE_BLOCK_COUNT,  0, 0, 0, 0 },
+    [USBH_MEM_POOL_CLASS] = { (uint8_t *)classPool, USBH_MEM_CLASS_BLOCK_SIZE, USBH_MEM_CLASS_BLOCK_COUNT, 0, 0, 0, 0 },
+    [USBH_MEM_POOL_DESC]  = { (uint8_t *)descPool,  USBH_MEM_DESC_BLOCK_SIZE,  USBH_MEM_DESC_BLOCK_COUNT,  0, 0, 0, 0 },
+};
+
+static const char *const poolNames[USBH_MEM_POOL_COUNT] = { "pipe", "class", "desc" };
+
+/*============================================================================*/
+/*                          ALLOCATOR                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Allocate one block from the smallest pool that fits
+ * @param  size: Requested size in bytes
+ * @retval Block pointer, or NULL if too large or the pool is exhausted
+ * @note   Called from USBH_Process context only (never from the HCD IRQ)
+ */
+void *USBH_MEM_Alloc(size_t size)
+{
+    for (uint32_t p = 0; p < USBH_MEM_POOL_COUNT; p++)
+    {
+        USBH_MEM_PoolCtrl_t *pool = &pools[p];
+
+        if (size > pool->blockSize)
+        {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < pool->blockCount; i++)
+        {
+            if ((pool->usedMask & (1UL << i)) == 0U)
+            {
+                pool->usedMask |= (1UL << i);
+                pool->inUse++;
+                if (pool->inUse > pool->highWater)
+                {
+                    pool->highWater = pool->inUse;
+                }
+                return pool->base + (i * pool->blockSize);
+            }
+        }
+
+        /* Fail fast: the right-sized pool is full, do not spill into a larger one */
+        pool->failures++;
+        USBH_ErrLog("USBH_MEM: %s pool exhausted (%lu blocks)", poolNames[p], pool->blockCount);
+        return NULL;
+    }
+
+    USBH_ErrLog("USBH_MEM: no pool for %lu bytes", (uint32_t)size);
+    return NULL;
+}
+
+/**
+ * @brief  Return a block to its pool
+ * @param  ptr: Pointer previously returned by USBH_MEM_Alloc (NULL ignored)
+ */
+void USBH_MEM_Free(void *ptr)
+{
+    uint8_t *p8 = (uint8_t *)ptr;
+
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t p = 0; p < USBH_MEM_POOL_COUNT; p++)
+    {
+        USBH_MEM_PoolCtrl_t *pool = &pools[p];
+        uint8_t *end = pool->base + (pool->blockCount * pool->blockSize);
+
+        if ((p8 >= pool->base) && (p8 < end))
+        {
+            uint32_t offset = (uint32_t)(p8 - pool->base);
+            uint32_t i = offset / pool->blockSize;
+
+            if (((offset % pool->blockSize) != 0U) || ((pool->usedMask & (1UL << i)) == 0U))
+            {
+                USBH_ErrLog("USBH_MEM: bad free %p", ptr);
+                return;
+            }
+
+            pool->usedMask &= ~(1UL << i);
+            pool->inUse--;
+            return;
+        }
+    }
+
+    USBH_ErrLog("USBH_MEM: free of foreign pointer %p", ptr);
+}
+
+/*============================================================================*/
+/*                          STATISTICS                                        */
+/*============================================================================*/
+
+void USBH_MEM_GetStats(USBH_MEM_Pool_t pool, USBH_MEM_Stats_t *stats)
+{
+    if ((pool >= USBH_MEM_POOL_COUNT) || (stats == NULL))
+    {
+        return;
+    }
+
+    stats->blockSize  = pools[pool].blockSize;
+    stats->blockCount = pools[pool].blockCount;
+    stats->inUse      = pools[pool].inUse;
+    stats->highWater  = pools[pool].highWater;
+    stats->failures   = pools[pool].failures;
+}
+
+/**
+ * @brief  Print usage and high-water mark of every pool
+ */
+void USBH_MEM_Report(void)
+{
+    for (uint32_t p = 0; p < USBH_MEM_POOL_COUNT; p++)
+    {
+        printf("[USBH_MEM] %-5s %3lu B x %2lu: used %lu, peak %lu, fail %lu\r\n",
+               poolNames[p], pools[p].blockSize, pools[p].blockCount,
+               pools[p].inUse, pools[p].highWater, pools[p].failures);
+    }
+}
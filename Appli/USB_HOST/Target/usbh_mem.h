@@ -0,0 +1,77 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file           : usbh_mem.h
+  * @brief          : Header for usbh_mem.c file.
+  *                   Fixed-block pool allocator behind USBH_malloc/USBH_free
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBH_MEM_H__
+#define __USBH_MEM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*============================================================================*/
+/*                          POOL CONFIGURATION                                */
+/*============================================================================*/
+
+/*
+ * Block sizes must be multiples of 4 and listed from smallest to largest:
+ * a request is served from the smallest pool whose block fits, and fails
+ * (returns NULL) when that pool is exhausted. There is no heap fallback.
+ */
+
+/* Pipe / endpoint contexts */
+#define USBH_MEM_PIPE_BLOCK_SIZE        32U
+#define USBH_MEM_PIPE_BLOCK_COUNT       16U
+
+/* Class handles (CDC_HandleTypeDef, one per supported class) */
+#define USBH_MEM_CLASS_BLOCK_SIZE       256U
+#define USBH_MEM_CLASS_BLOCK_COUNT      2U
+
+/* Descriptor buffers (sized for USBH_MAX_SIZE_CONFIGURATION) */
+#define USBH_MEM_DESC_BLOCK_SIZE        512U
+#define USBH_MEM_DESC_BLOCK_COUNT       2U
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef enum {
+    USBH_MEM_POOL_PIPE = 0,
+    USBH_MEM_POOL_CLASS,
+    USBH_MEM_POOL_DESC,
+    USBH_MEM_POOL_COUNT
+} USBH_MEM_Pool_t;
+
+typedef struct {
+    uint32_t blockSize;
+    uint32_t blockCount;
+    uint32_t inUse;
+    uint32_t highWater;     /* Max blocks in use since boot */
+    uint32_t failures;      /* Allocations refused because pool was full */
+} USBH_MEM_Stats_t;
+
+/*============================================================================*/
+/*                          API                                               */
+/*============================================================================*/
+
+void *USBH_MEM_Alloc(size_t size);
+void  USBH_MEM_Free(void *ptr);
+void  USBH_MEM_GetStats(USBH_MEM_Pool_t pool, USBH_MEM_Stats_t *stats);
+void  USBH_MEM_Report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBH_MEM_H__ */
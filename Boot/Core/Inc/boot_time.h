@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ * @file    boot_time.h
+ * @brief   Boot-time budget: time of each phase from main to the jump, kept
+ *          for the last boots in backup SRAM and reported by the Appli
+ ******************************************************************************
+ */
+
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#include "boot_time_record.h"
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Clear the cycle counter and start the first phase
+ * @note   Call it first in main: the time of the startup code before main
+ *         is not measured
+ */
+void Boot_Time_Start(void);
+
+/**
+ * @brief  End a phase and start the next one
+ * @note   Cycles are converted at the core clock of the start of the phase;
+ *         phases over one second, which the 32-bit counter may wrap, are
+ *         taken from the HAL tick
+ */
+void Boot_Time_Mark(Boot_Phase_t phase);
+
+/**
+ * @brief  Write this boot in the record, just before the jump
+ * @param  flags: BOOT_TIME_FLAG_*
+ * @note   The backup SRAM must be enabled (SysInit of main)
+ */
+void Boot_Time_Save(uint32_t flags);
+
+#endif /* BOOT_TIME_H */
@@ -20,18 +20,36 @@
 
 /* Boot flags in RTC backup register */
 #define BOOT_FLAG_NORMAL        0x00000000
-#define BOOT_FLAG_UPDATE        0x55AA55AA
+#define BOOT_FLAG_UPDATE        0x55AA55AA  /* Image waiting in the SRAM or PSRAM mailbox */
+#define BOOT_FLAG_STAGED        0x5AA55AA5  /* Image already written to Slot B */
+#define BOOT_FLAG_STORE_INSTALL 0x5A5AA5A5  /* Candidate of the eMMC store to install in Slot B */
+#define BOOT_FLAG_STORE_ROLLBACK 0xA5A55A5A /* Previous image of the eMMC store to install again */
 
 /* Application slots */
 #define SLOT_A_FLASH_ADDR       0x00000000  /* Flash internal address */
 #define SLOT_B_FLASH_ADDR       0x01000000  /* 16MB offset */
 #define SLOT_A_CPU_ADDR         0x70000000  /* Memory-mapped address */
 #define SLOT_B_CPU_ADDR         0x71000000
+#define SLOT_SIZE               0x01000000
+
+/* Header of an image staged by the Appli (last 4KB sector of Slot B) */
+#define SLOT_B_HEADER_ADDR      (SLOT_B_FLASH_ADDR + SLOT_SIZE - 0x1000)
+#define OTA_SLOT_MAX_FW_SIZE    (SLOT_SIZE - 0x10000)
 
 /* OTA mailbox in AXI SRAM (must match Appli!) */
 #define OTA_SRAM_BASE           0x2406C000
 #define OTA_SRAM_SIZE           0x00020000  /* 128KB */
 
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 1 to skip, when no update is pending, what the jump to Slot A does
+ * not need: the eMMC probe, the second XSPI2 init and the fixed delays */
+#ifndef BOOT_FAST_BOOT
+#define BOOT_FAST_BOOT          0
+#endif
+
 /*============================================================================*/
 /*                          STATUS CODES                                      */
 /*============================================================================*/
@@ -56,6 +74,13 @@ typedef enum {
  */
 uint32_t OTA_Bootloader_Process(void);
 
+/**
+ * @brief  Check the boot flag for an update or a staged Slot B
+ * @note   Still 1 after OTA_Bootloader_Process has cleared the flag
+ * @retval 1 if the boot installs or validates an image, 0 otherwise
+ */
+uint8_t OTA_Bootloader_UpdatePending(void);
+
 /**
  * @brief  Jump to application
  * @param  appAddr: 0x70000000 (Slot A) or 0x71000000 (Slot B)
@@ -33,7 +33,7 @@
 */
 
 #define EXTMEM_DRIVER_NOR_SFDP   1
-#define EXTMEM_DRIVER_PSRAM      0
+#define EXTMEM_DRIVER_PSRAM      1
 #define EXTMEM_DRIVER_SDCARD     0
 #define EXTMEM_DRIVER_USER       0
 
@@ -43,6 +43,17 @@
 #define EXTMEM_SAL_XSPI   1
 #define EXTMEM_SAL_SD     0
 
+/*
+  @brief asynchronous read/write/erase, completed under the XSPI2 interrupt
+*/
+#define EXTMEM_ASYNC      1
+
+/*
+  @brief read, program, erase and status commands built once at init and written directly to the XSPI
+         registers (set before the includes: the driver object depends on it)
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS  1
+
 /* Includes ------------------------------------------------------------------*/
 #include "stm32h7rsxx_hal.h"
 #include "stm32_extmem.h"
@@ -56,6 +67,8 @@
 extern XSPI_HandleTypeDef hxspi2;
 
 /* USER CODE BEGIN PV */
+/* XSPI1 of the PSRAM (EXTMEMORY_2), set up by PSRAM_Init() in psram.c */
+extern XSPI_HandleTypeDef hxspi1;
 
 /* USER CODE END PV */
 
@@ -64,7 +77,8 @@ extern XSPI_HandleTypeDef hxspi2;
   * @{
   */
 enum {
-  EXTMEMORY_1  = 0 /*!< ID=0 for the first memory  */
+  EXTMEMORY_1  = 0, /*!< ID=0 for the first memory  */
+  EXTMEMORY_2  = 1  /*!< ID=1 for the second memory  */
 };
 
 /*
@@ -73,7 +87,31 @@ enum {
 #define EXTMEM_MEMORY_BOOTXIP  EXTMEMORY_1
 
 /* USER CODE BEGIN EC */
+/*
+  @brief static SFDP profile generated by tools/sfdp_profile: 0 runs the SFDP discovery at EXTMEM_Init
+         (set to 1 with EXTMEM_DRIVER_NOR_SFDP_PROFILE_FILE to skip it, see tools/sfdp_profile/README.md)
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE 0
 
+/*
+  @brief SFDP discovery cache, kept in backup SRAM so that it survives resets
+         (BKPSRAM clock and backup domain access are enabled in main.c)
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_CACHE          1
+#define EXTMEM_DRIVER_NOR_SFDP_CACHE_ADDRESS  BKPSRAM_BASE
+#define EXTMEM_DRIVER_NOR_SFDP_CACHE_SIZE     1024u
+
+/*
+  @brief the 8 lines link must come up in octal DTR (8D8D8D with DQS), EXTMEM_Init fails otherwise
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_OCTAL_DTR      1
+
+/*
+  @brief calibrated read timing, stored in backup SRAM after the SFDP cache and applied by EXTMEM_Init
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE          1
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_ADDRESS  (BKPSRAM_BASE + EXTMEM_DRIVER_NOR_SFDP_CACHE_SIZE)
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_SIZE     64u
 /* USER CODE END EC */
 
 /* Exported configuration --------------------------------------------------------*/
@@ -81,9 +119,9 @@ enum {
   * @{
   */
 
-extern EXTMEM_DefinitionTypeDef extmem_list_config[1];
+extern EXTMEM_DefinitionTypeDef extmem_list_config[2];
 #if defined(EXTMEM_C)
-EXTMEM_DefinitionTypeDef extmem_list_config[1];
+EXTMEM_DefinitionTypeDef extmem_list_config[2];
 #endif /* EXTMEM_C */
 
 /**
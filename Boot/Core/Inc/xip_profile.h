@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ * @file    xip_profile.h
+ * @brief   XIP profiles of XSPI2: wrapped bursts for the cache line fills and
+ *          timeout of the memory-mapped prefetch, selected before the jump
+ ******************************************************************************
+ */
+
+#ifndef XIP_PROFILE_H
+#define XIP_PROFILE_H
+
+#include "xip_record.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Profile applied while no valid record selects one */
+#ifndef BOOT_XIP_PROFILE_DEFAULT
+#define BOOT_XIP_PROFILE_DEFAULT    XIP_PROFILE_LINEAR
+#endif
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Set the XIP profile of the record (or the default one) on XSPI2
+ * @note   Call it after MX_EXTMEM_MANAGER_Init, before the memory-mapped
+ *         mode. The profile is checked by comparing mapped reads (through
+ *         the D-cache, so as line fills) with indirect reads; if the driver
+ *         or the check fails, linear bursts are set instead. The profile
+ *         set is written back in the record for the Appli.
+ * @param  applied: profile set on XSPI2
+ * @retval EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ */
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef XIP_Profile_Apply(XIP_Profile_t *applied);
+
+#endif /* XIP_PROFILE_H */
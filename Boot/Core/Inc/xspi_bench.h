@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file    xspi_bench.h
+ * @brief   XSPI2 NOR throughput benchmark: read, page program and erase for
+ *          each PHY link and clock, on the board or on the host simulator
+ ******************************************************************************
+ */
+
+#ifndef XSPI_BENCH_H
+#define XSPI_BENCH_H
+
+#include "stm32_extmem_conf.h"
+#include "stm32_sfdp_driver_api.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 1 to run the benchmark at boot (development builds: the bench area is erased) */
+#ifndef BOOT_XSPI_BENCH
+#define BOOT_XSPI_BENCH         0
+#endif
+
+/* Bench area: start of the reserved end of Slot B, the staged header (last 4KB) is not touched */
+#define XSPI_BENCH_ADDR         0x01FF0000U
+#define XSPI_BENCH_SIZE         0x00008000U     /* 32KB */
+#define XSPI_BENCH_CHUNK        0x00001000U     /* RAM buffer, one transfer */
+#define XSPI_BENCH_SMALL        16U             /* size of the small reads */
+#define XSPI_BENCH_REPEAT       32U             /* small operations averaged */
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+/* One measurement point: the link requested from the driver and a clock limit */
+typedef struct {
+    EXTMEM_LinkConfig_TypeDef config;
+    uint32_t maxFreq;                   /* Hz, 0 = fastest allowed by the memory */
+} XSPI_Bench_Point_t;
+
+typedef struct {
+    EXTMEM_DRIVER_NOR_SFDP_LinkInfoTypeDef link;    /* Link actually configured */
+    uint32_t readKBps;
+    uint32_t programKBps;
+    uint32_t eraseKBps;
+    uint32_t pollNs;                    /* status polling of an idle memory */
+    uint32_t smallReadNs;               /* read of XSPI_BENCH_SMALL bytes */
+    int32_t  status;                    /* EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef, -1 on data mismatch */
+} XSPI_Bench_Result_t;
+
+/*============================================================================*/
+/*                          PLATFORM HOOKS                                    */
+/*============================================================================*/
+
+/* Implemented in xspi_bench.c for the board, in tools/xspi_bench for the host */
+
+/**
+ * @brief  Initialize the driver object for a measurement point
+ */
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef XSPI_Bench_Setup(const XSPI_Bench_Point_t *point,
+                                                      EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object);
+
+/**
+ * @brief  Monotonic time in ns (DWT cycles on the board, bus cycles on the host)
+ */
+uint64_t XSPI_Bench_TimeNs(void);
+
+/**
+ * @brief  Output one line of the report
+ */
+void XSPI_Bench_Print(const char *str);
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Erase, program then read back the bench area at one point
+ * @retval 0 on success, -1 on error (result->status tells which)
+ */
+int XSPI_Bench_Measure(const XSPI_Bench_Point_t *point, XSPI_Bench_Result_t *result);
+
+/**
+ * @brief  Measure every point of the default table and print the report
+ * @note   The memory is left in the last configuration: re-initialize the
+ *         ExtMem Manager afterwards
+ * @retval Number of points that failed
+ */
+int XSPI_Bench_Run(void);
+
+#endif /* XSPI_BENCH_H */
@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * @file    xspi_calib.h
+ * @brief   XSPI2 read timing calibration at boot: clock prescaler, sample
+ *          shifting and read sampling delay tuned on a pattern in the NOR
+ ******************************************************************************
+ */
+
+#ifndef XSPI_CALIB_H
+#define XSPI_CALIB_H
+
+#include "stm32_extmem_conf.h"
+#include "stm32_sfdp_driver_api.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Pattern sector: reserved end of Slot B, below the staged header (last 4KB) */
+#define XSPI_CALIB_ADDR         0x01FFE000U
+#define XSPI_CALIB_SIZE         256U        /* One page, read back at each setting */
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Calibrate the read timing of XSPI2 unless EXTMEM_Init applied a
+ *         stored one. The pattern is programmed first if the sector does not
+ *         hold it. The result is stored and applied by the next EXTMEM_Init.
+ * @note   Call it after MX_EXTMEM_MANAGER_Init, before the memory-mapped mode
+ * @param  result: calibration result, valid when 0 is returned
+ * @retval 1 stored timing in use, 0 calibrated, negative
+ *         EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef on error
+ */
+int XSPI_Calib_Run(EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef *result);
+
+#endif /* XSPI_CALIB_H */
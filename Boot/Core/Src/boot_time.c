@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ * @file    boot_time.c
+ * @brief   Boot-time budget - STM32H7S3
+ *
+ * Each phase of main is timed with the DWT cycle counter, cleared at the
+ * start of main. The core runs on the 64 MHz HSI until SystemClock_Config
+ * switches it to the PLL, so each phase is converted at the clock it started
+ * with. The entry of this boot is written before the jump into a ring of
+ * BOOT_TIME_HISTORY entries in backup SRAM; the Appli adds the time of the
+ * jump and prints them.
+ ******************************************************************************
+ */
+
+#include "boot_time.h"
+#include "main.h"
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+/* Over this, the phase is taken from the HAL tick: the counter wraps
+ * after 7 s at 600 MHz */
+#define BOOT_TIME_TICK_MS   1000U
+
+static Boot_Time_Entry_t bootEntry;
+static uint32_t phaseCycles;
+static uint32_t phaseTick;
+static uint32_t phaseClock;
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+void Boot_Time_Start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(&bootEntry, 0, sizeof(bootEntry));
+    phaseCycles = 0;
+    phaseTick = HAL_GetTick();
+    phaseClock = SystemCoreClock;
+}
+
+void Boot_Time_Mark(Boot_Phase_t phase)
+{
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t tick = HAL_GetTick();
+
+    if ((tick - phaseTick) >= BOOT_TIME_TICK_MS)
+    {
+        bootEntry.phaseUs[phase] = (tick - phaseTick) * 1000U;
+    }
+    else
+    {
+        bootEntry.phaseUs[phase] = (cycles - phaseCycles) / (phaseClock / 1000000U);
+    }
+
+    /* Restart from the counter, not from a new read: the marks cost no time */
+    phaseCycles = cycles;
+    phaseTick = tick;
+    phaseClock = SystemCoreClock;
+}
+
+void Boot_Time_Save(uint32_t flags)
+{
+    Boot_Time_Record_t *record = BOOT_TIME_RECORD;
+
+    if ((record->magic != BOOT_TIME_MAGIC) || (record->check != Boot_Time_Check(record)) ||
+        (record->next >= BOOT_TIME_HISTORY))
+    {
+        /* First boot or lost backup domain: start a new history */
+        memset(record, 0, sizeof(*record));
+        record->magic = BOOT_TIME_MAGIC;
+        bootEntry.sequence = 0;
+    }
+    else
+    {
+        bootEntry.sequence = record->entries[(record->next + BOOT_TIME_HISTORY - 1U) % BOOT_TIME_HISTORY].sequence + 1U;
+    }
+
+    bootEntry.flags = flags;
+    bootEntry.phaseUs[BOOT_PHASE_HANDOVER] = 0;
+    bootEntry.jumpCycles = DWT->CYCCNT;
+
+    record->entries[record->next] = bootEntry;
+    record->next = (record->next + 1U) % BOOT_TIME_HISTORY;
+    record->coreClock = SystemCoreClock;
+    record->check = Boot_Time_Check(record);
+}
@@ -23,7 +23,7 @@
 #include <string.h>
 
 /* USER CODE BEGIN Includes */
-
+#include "trace.h"
 /* USER CODE END Includes */
 
 /* USER CODE BEGIN PV */
@@ -58,7 +58,7 @@ void MX_EXTMEM_MANAGER_Init(void)
 {
 
   /* USER CODE BEGIN MX_EXTMEM_Init_PreTreatment */
-
+  TRACE_BEGIN(TRACE_ID_EXTMEM_INIT, 0);
   /* USER CODE END MX_EXTMEM_Init_PreTreatment */
   HAL_RCCEx_EnableClockProtection(RCC_CLOCKPROTECT_XSPI);
 
@@ -73,6 +73,6 @@ void MX_EXTMEM_MANAGER_Init(void)
   EXTMEM_Init(EXTMEMORY_1, HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_XSPI2));
 
   /* USER CODE BEGIN MX_EXTMEM_Init_PostTreatment */
-
+  TRACE_END(TRACE_ID_EXTMEM_INIT, 0);
   /* USER CODE END MX_EXTMEM_Init_PostTreatment */
 }
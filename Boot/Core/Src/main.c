@@ -23,6 +23,12 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "ota_bootloader.h"
+#include "xspi_bench.h"
+#include "xspi_calib.h"
+#include "xip_profile.h"
+#include "boot_time.h"
+#include "trace.h"
+#include "log.h"
 #include <string.h>
 #include <stdio.h>
 /* USER CODE END Includes */
@@ -70,7 +76,7 @@ static void Boot_PrintString(const char *str);
 /* USER CODE BEGIN 0 */
 static void Boot_PrintString(const char *str)
 {
-    HAL_UART_Transmit(&huart4, (uint8_t *)str, strlen(str), 1000);
+    (void)Log_Write(str, strlen(str));
 }
 
 static void Boot_PrintHex(uint32_t val)
@@ -92,7 +98,7 @@ static void Boot_PrintHex(uint32_t val)
     p--;
     *p = '0';
 
-    HAL_UART_Transmit(&huart4, (uint8_t *)p, 12, 1000);
+    (void)Log_Write(p, 12);
 }
 /* USER CODE END 0 */
 
@@ -104,6 +110,8 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
+  /* Cycle counter of the boot-time budget, also used by the ExtMem start-up time and the trace */
+  Boot_Time_Start();
 
   SCB_InvalidateDCache();
   SCB_InvalidateICache();
@@ -118,13 +126,19 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
+  Boot_Time_Mark(BOOT_PHASE_HAL_INIT);
   /* USER CODE END Init */
 
   /* Configure the system clock */
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  Boot_Time_Mark(BOOT_PHASE_CLOCK);
 
+  /* Backup SRAM holds the SFDP discovery cache used by EXTMEM_Init */
+  __HAL_RCC_BKPRAM_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+  Trace_Init(TRACE_IMAGE_BOOT);
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -135,43 +149,127 @@ int main(void)
   MX_SDMMC1_MMC_Init();
   MX_EXTMEM_MANAGER_Init();
   /* USER CODE BEGIN 2 */
+  /* Every line below goes through the DMA log ring */
+  Log_Init(&huart4);
+  Boot_Time_Mark(BOOT_PHASE_PERIPHERALS);
 
-  HAL_MMC_CardInfoTypeDef cardInfo;
-  	if (HAL_MMC_GetCardInfo(&hmmc1, &cardInfo) == HAL_OK) {
-  		char msg[128];
-  		uint64_t totalSize = (uint64_t) cardInfo.LogBlockNbr
-  				* cardInfo.LogBlockSize;
+  uint32_t initCycles;
+  uint32_t bootFlags = (OTA_Bootloader_UpdatePending() != 0U) ? BOOT_TIME_FLAG_UPDATE : 0U;
 
-  		sprintf(msg, "eMMC size: %lu blocks of %lu bytes = %.2f MB\r\n",
-  				cardInfo.LogBlockNbr, cardInfo.LogBlockSize,
-  				(float) totalSize / (1024 * 1024));
+  /* Fast boot: nothing to install, only what the jump to Slot A needs */
+  if ((BOOT_FAST_BOOT == 1) && ((bootFlags & BOOT_TIME_FLAG_UPDATE) == 0U))
+  {
+    bootFlags |= BOOT_TIME_FLAG_FAST;
+  }
 
-  		HAL_UART_Transmit(&huart4, (uint8_t*) msg, strlen(msg), HAL_MAX_DELAY);
-  	} else {
-  		char *err = "Error getting eMMC card info\r\n";
-  		HAL_UART_Transmit(&huart4, (uint8_t*) err, strlen(err), HAL_MAX_DELAY);
-  	}
+  /* eMMC card information (OTA_Bootloader_Process opens the image store) */
+  if ((bootFlags & BOOT_TIME_FLAG_FAST) == 0U)
+  {
+    HAL_MMC_CardInfoTypeDef cardInfo;
+    if (HAL_MMC_GetCardInfo(&hmmc1, &cardInfo) == HAL_OK) {
+      char msg[128];
+      uint64_t totalSize = (uint64_t) cardInfo.LogBlockNbr
+          * cardInfo.LogBlockSize;
+
+      sprintf(msg, "eMMC size: %lu blocks of %lu bytes = %.2f MB\r\n",
+          cardInfo.LogBlockNbr, cardInfo.LogBlockSize,
+          (float) totalSize / (1024 * 1024));
+
+      (void)Log_Write(msg, strlen(msg));
+    } else {
+      char *err = "Error getting eMMC card info\r\n";
+      (void)Log_Write(err, strlen(err));
+    }
+    Boot_Time_Mark(BOOT_PHASE_EMMC_PROBE);
+  }
 
   Boot_PrintString("\r\n========================================\r\n");
   Boot_PrintString("       OTA BOOTLOADER STARTED\r\n");
   Boot_PrintString("========================================\r\n");
 
-  Boot_PrintString("[BOOT] Initializing XSPI2...\r\n");
-  MX_XSPI2_Init();
+  /* XSPI2 is already set by the generated init */
+  if ((bootFlags & BOOT_TIME_FLAG_FAST) == 0U)
+  {
+    Boot_PrintString("[BOOT] Initializing XSPI2...\r\n");
+    MX_XSPI2_Init();
+  }
+
+#if BOOT_XSPI_BENCH == 1
+  /* Development builds: measure every link, then restore the ExtMem Manager configuration */
+  Boot_PrintString("[BOOT] XSPI2 benchmark...\r\n");
+  (void)XSPI_Bench_Run();
+  MX_EXTMEM_MANAGER_Init();
+#endif
+  Boot_Time_Mark(BOOT_PHASE_XSPI_REINIT);
 
   Boot_PrintString("[BOOT] Checking for OTA update...\r\n");
+  TRACE_BEGIN(TRACE_ID_BOOT_UPDATE, 0);
   g_jumpAddress = OTA_Bootloader_Process();
+  TRACE_END(TRACE_ID_BOOT_UPDATE, g_jumpAddress);
+  Boot_Time_Mark(BOOT_PHASE_UPDATE);
 
   Boot_PrintString("[BOOT] Jump address: ");
   Boot_PrintHex(g_jumpAddress);
 
   Boot_PrintString("[BOOT] Initializing ExtMemManager (XIP mode)...\r\n");
+  initCycles = DWT->CYCCNT;
   MX_EXTMEM_MANAGER_Init();
+  initCycles = DWT->CYCCNT - initCycles;
+  Boot_Time_Mark(BOOT_PHASE_EXTMEM_INIT);
+
+  Boot_PrintString(extmem_list_config[EXTMEMORY_1].NorSfdpObject.sfpd_private.ProfileCached
+                   ? "[BOOT] SFDP cache hit, init us: " : "[BOOT] SFDP cache miss, init us: ");
+  Boot_PrintHex(initCycles / (SystemCoreClock / 1000000U));
+
+  /* Read timing: stored record applied by the init, or a new calibration before XIP starts */
+  {
+    EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef calib;
+    char msg[96];
+    int calibStatus = XSPI_Calib_Run(&calib);
+
+    if (calibStatus == 1)
+    {
+      Boot_PrintString("[BOOT] XSPI2 timing: stored calibration\r\n");
+    }
+    else if (calibStatus == 0)
+    {
+      snprintf(msg, sizeof(msg), "[BOOT] XSPI2 timing: %lu MHz, window %u/%u, delay %u:%u, shift %u\r\n",
+               (unsigned long)(calib.Clock / 1000000U), calib.WindowWidth, calib.TapCount,
+               calib.Timing.DelayCoarse, calib.Timing.DelayFine, calib.Timing.SampleShift);
+      Boot_PrintString(msg);
+    }
+    else
+    {
+      Boot_PrintString("[BOOT] XSPI2 timing: calibration failed, default timing kept\r\n");
+    }
+  }
+
+  /* XIP profile selected by the Appli benchmark: wrapped line fills and prefetch timeout */
+  {
+    XIP_Profile_t profile;
+    char msg[96];
+
+    if (XIP_Profile_Apply(&profile) == EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+      snprintf(msg, sizeof(msg), "[BOOT] XIP profile: %s\r\n", XIP_Profile_Name(profile));
+    }
+    else
+    {
+      snprintf(msg, sizeof(msg), "[BOOT] XIP profile rejected, %s kept\r\n", XIP_Profile_Name(profile));
+    }
+    Boot_PrintString(msg);
+  }
+  Boot_Time_Mark(BOOT_PHASE_XIP_SETUP);
+
+  /* Spans of the boot, for tools/trace_decode */
+  Trace_Dump(&huart4);
 
   Boot_PrintString("[BOOT] Jumping to application...\r\n");
   Boot_PrintString("========================================\r\n\r\n");
 
-  HAL_Delay(50);
+  /* Budget of this boot, reported by the Appli */
+  Boot_Time_Mark(BOOT_PHASE_JUMP);
+  Boot_Time_Save(bootFlags | ((g_jumpAddress == SLOT_B_CPU_ADDR) ? BOOT_TIME_FLAG_SLOT_B : 0U));
 
   OTA_Bootloader_JumpToApp(g_jumpAddress);
 
@@ -492,6 +590,7 @@ void Error_Handler(void)
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
   __disable_irq();
+  Log_FaultFlush();
   while (1)
   {
   }
@@ -7,7 +7,13 @@
 
 #include "ota_bootloader.h"
 #include "stm32_extmem.h"
+#include "stm32_extmem_conf.h"  /* For EXTMEM_ASYNC */
 #include "stm32_boot_xip.h"  /* For EXTMEM_XIP_IMAGE_OFFSET, EXTMEM_HEADER_OFFSET */
+#include "stm32_sal_xspi_api.h"  /* For SAL_XSPI_Abort */
+#include "trace.h"
+#include "log.h"
+#include "psram.h"
+#include "fw_store.h"
 #include <string.h>
 
 /*============================================================================*/
@@ -15,21 +21,46 @@
 /*============================================================================*/
 
 extern UART_HandleTypeDef huart4;
+extern MMC_HandleTypeDef hmmc1;
 
 /*============================================================================*/
 /*                          PRIVATE DEFINITIONS                               */
 /*============================================================================*/
 
 /*
- * OTA Mailbox location in AXI SRAM
+ * OTA Mailbox location: the start of the PSRAM when the board carries it
+ * (psram.h), else AXI SRAM
  */
 #define OTA_SRAM_BASE           0x2406C000
 #define OTA_SRAM_SIZE           0x00020000  /* 128KB */
+#if PSRAM_ENABLE == 1
+#define OTA_MAILBOX_BASE        PSRAM_MAILBOX_ADDR
+#define OTA_MAX_FW_SIZE         OTA_SLOT_MAX_FW_SIZE
+#else
+#define OTA_MAILBOX_BASE        OTA_SRAM_BASE
 #define OTA_MAX_FW_SIZE         (OTA_SRAM_SIZE - 32)
+#endif
 
 /* Flash geometry */
 #define FLASH_BLOCK_SIZE_64K    0x10000
 
+/* Granularity of the compare-before-erase pass (one bit per chunk in a block) */
+#define FLASH_COMPARE_CHUNK     0x1000
+#define FLASH_CHUNKS_PER_BLOCK  (FLASH_BLOCK_SIZE_64K / FLASH_COMPARE_CHUNK)
+
+/* Read-back verification */
+#define FLASH_PAGE_SIZE         256
+#define FLASH_SECTOR_SIZE_4K    0x1000
+#define FLASH_VERIFY_BENCH_SIZE 0x4000      /* Sample used to pick the faster read path */
+#define FLASH_VERIFY_RETRIES    2           /* Repair attempts per failing page */
+
+/* Erase planning: a 64KB block planned in 4KB sectors at worst */
+#define FLASH_ERASE_PLAN_STEPS  (FLASH_BLOCK_SIZE_64K / FLASH_SECTOR_SIZE_4K)
+
+/* Deadline of a queued operation on top of its erase time: the WIP timeout
+ * of the blocking driver */
+#define FLASH_WAIT_TIMEOUT_MS   5000
+
 /* Mailbox structure */
 typedef struct {
     uint32_t magic;
@@ -39,7 +70,7 @@ typedef struct {
     uint8_t  fwData[];
 } OTA_Mailbox_t;
 
-#define OTA_MAILBOX             ((OTA_Mailbox_t *)OTA_SRAM_BASE)
+#define OTA_MAILBOX             ((OTA_Mailbox_t *)OTA_MAILBOX_BASE)
 
 /* ExtMemManager memory ID */
 #ifndef EXTMEMORY_1
@@ -49,13 +80,62 @@ typedef struct {
 /* Slot B offset from Slot A (16MB) */
 #define SLOT_B_OFFSET           0x01000000
 
+/* What a block of the new image needs compared to the current flash contents */
+typedef enum {
+    BLOCK_UNCHANGED = 0,    /* Identical: nothing to do */
+    BLOCK_PROGRAM_ONLY,     /* Only 1->0 bit transitions: program, no erase */
+    BLOCK_ERASE             /* At least one 0->1 transition: erase + program */
+} Boot_BlockAction_t;
+
+/* How Slot B is read back for verification */
+typedef enum {
+    VERIFY_PATH_MAPPED = 0,     /* XIP window, word compare, cached */
+    VERIFY_PATH_INDIRECT        /* EXTMEM_Read into flashBuf + memcmp */
+} Boot_VerifyPath_t;
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+/* Scratch buffer for indirect flash reads (compare and CRC passes) */
+static uint8_t flashBuf[FLASH_COMPARE_CHUNK];
+
+#if EXTMEM_ASYNC == 1
+/* Completion of the queued flash operation, written by the XSPI2 interrupt */
+static volatile uint8_t flashBusy;
+static volatile EXTMEM_StatusTypeDef flashStatus;
+
+/* Cycles spent asleep waiting for the flash during the current program pass */
+static uint64_t flashIdleCycles;
+#endif
+
+/* Erase plans of the current program pass */
+static uint32_t eraseTimeMs;        /* Sum of the SFDP erase times of the sectors erased */
+static uint32_t eraseBlankBytes;    /* Bytes found already erased */
+
+/* Blocks of the current program pass, by action */
+static uint32_t blocksSkipped;
+static uint32_t blocksProgramOnly;
+static uint32_t blocksErased;
+#if EXTMEM_ASYNC == 1
+static uint32_t programStartTick;
+#endif
+
+#if FW_STORE_ENABLE == 1
+/* Image blocks read from the eMMC: one is programmed while the IDMA fills the other */
+static uint8_t storeBuf[2][FLASH_BLOCK_SIZE_64K] __attribute__((aligned(32)));
+#endif
+
+/* Boot flag found by OTA_Bootloader_Process asked for an update or a staged slot */
+static uint8_t bootUpdateSeen;
+
 /*============================================================================*/
 /*                          PRIVATE FUNCTIONS                                 */
 /*============================================================================*/
 
 static void Boot_Print(const char *str)
 {
-    HAL_UART_Transmit(&huart4, (uint8_t *)str, strlen(str), 500);
+    (void)Log_Write(str, strlen(str));
 }
 
 static void Boot_PrintHex32(const char *prefix, uint32_t val)
@@ -81,7 +161,37 @@ static void Boot_PrintHex32(const char *prefix, uint32_t val)
     buf[len++] = '\r';
     buf[len++] = '\n';
 
-    HAL_UART_Transmit(&huart4, (uint8_t *)buf, len, 500);
+    (void)Log_Write(buf, len);
+}
+
+static void Boot_PrintDec32(const char *prefix, uint32_t val, const char *suffix)
+{
+    char buf[128];
+    char digits[10];
+    uint32_t n = 0;
+    uint32_t len = strlen(prefix);
+
+    if (len > 100) len = 100;
+
+    memcpy(buf, prefix, len);
+
+    do
+    {
+        digits[n++] = (char)('0' + (val % 10));
+        val /= 10;
+    } while (val != 0);
+
+    while (n > 0)
+    {
+        buf[len++] = digits[--n];
+    }
+
+    for (const char *p = suffix; (*p != '\0') && (len < sizeof(buf)); p++)
+    {
+        buf[len++] = *p;
+    }
+
+    (void)Log_Write(buf, len);
 }
 
 static void Boot_EnableBackupDomain(void)
@@ -101,16 +211,20 @@ static uint32_t Boot_GetBootFlag(void)
     return TAMP->BKP0R;
 }
 
+static uint8_t Boot_FlagPending(uint32_t bootFlag)
+{
+    return (bootFlag == BOOT_FLAG_UPDATE) || (bootFlag == BOOT_FLAG_STAGED) ||
+           (bootFlag == BOOT_FLAG_STORE_INSTALL) || (bootFlag == BOOT_FLAG_STORE_ROLLBACK);
+}
+
 static void Boot_ClearBootFlag(void)
 {
     Boot_EnableBackupDomain();
     TAMP->BKP0R = BOOT_FLAG_NORMAL;
 }
 
-static uint32_t Boot_CalculateCRC32(uint8_t *data, uint32_t len)
+static uint32_t Boot_UpdateCRC32(uint32_t crc, const uint8_t *data, uint32_t len)
 {
-    uint32_t crc = 0xFFFFFFFF;
-
     for (uint32_t i = 0; i < len; i++)
     {
         crc ^= data[i];
@@ -123,69 +237,660 @@ static uint32_t Boot_CalculateCRC32(uint8_t *data, uint32_t len)
         }
     }
 
-    return crc ^ 0xFFFFFFFF;
+    return crc;
+}
+
+static uint32_t Boot_CalculateCRC32(uint8_t *data, uint32_t len)
+{
+    uint32_t crc;
+
+    TRACE_BEGIN(TRACE_ID_CRC, len);
+    crc = Boot_UpdateCRC32(0xFFFFFFFF, data, len) ^ 0xFFFFFFFF;
+    TRACE_END(TRACE_ID_CRC, crc);
+
+    return crc;
 }
 
 /*============================================================================*/
 /*                    FLASH OPERATIONS VIA EXTMEM                             */
 /*============================================================================*/
 
-static OTA_Boot_Status_t Boot_WriteFirmwareToFlash(uint32_t flashAddr,
-                                                    uint8_t *data,
-                                                    uint32_t size)
+/**
+ * @brief  Compare one block of the new image with the current flash contents
+ * @param  flashAddr: Block address in flash
+ * @param  data: New block contents
+ * @param  size: Bytes of the block covered by the image
+ * @param  chunkMask: Set to one bit per FLASH_COMPARE_CHUNK that differs
+ * @retval Action needed to bring the block to the new contents
+ * @note   Mapped mode must be disabled (indirect EXTMEM_Read)
+ */
+static Boot_BlockAction_t Boot_CompareBlock(uint32_t flashAddr,
+                                            const uint8_t *data,
+                                            uint32_t size,
+                                            uint32_t *chunkMask)
+{
+    Boot_BlockAction_t action = BLOCK_UNCHANGED;
+
+    *chunkMask = 0;
+
+    for (uint32_t chunk = 0; (chunk * FLASH_COMPARE_CHUNK) < size; chunk++)
+    {
+        uint32_t offset = chunk * FLASH_COMPARE_CHUNK;
+        uint32_t len = size - offset;
+
+        if (len > FLASH_COMPARE_CHUNK)
+        {
+            len = FLASH_COMPARE_CHUNK;
+        }
+
+        /* Unreadable block: assume it must be rewritten from scratch */
+        if (EXTMEM_Read(EXTMEMORY_1, flashAddr + offset, flashBuf, len) != EXTMEM_OK)
+        {
+            return BLOCK_ERASE;
+        }
+
+        if (memcmp(flashBuf, &data[offset], len) == 0)
+        {
+            continue;
+        }
+
+        *chunkMask |= (1UL << chunk);
+        action = BLOCK_PROGRAM_ONLY;
+
+        for (uint32_t i = 0; i < len; i++)
+        {
+            /* Programming can only clear bits */
+            if ((flashBuf[i] & data[offset + i]) != data[offset + i])
+            {
+                return BLOCK_ERASE;
+            }
+        }
+    }
+
+    return action;
+}
+
+/*============================================================================*/
+/*                          READ-BACK VERIFICATION                            */
+/*============================================================================*/
+
+/* The counter is not cleared: it runs on for the trace, cycles are deltas */
+static void Boot_CycleCounterStart(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static void Boot_PrintThroughput(const char *label, uint32_t bytes, uint32_t cycles)
+{
+    uint64_t kbps = 0;
+
+    if (cycles != 0)
+    {
+        kbps = ((uint64_t)bytes * SystemCoreClock) / ((uint64_t)cycles * 1024U);
+    }
+
+    Boot_PrintDec32(label, (uint32_t)kbps, " KB/s\r\n");
+}
+
+/**
+ * @brief  Compare flash with the source through the memory-mapped window
+ * @retval Offset of the first differing byte, or size if identical
+ * @note   Mapped mode must be enabled
+ */
+static uint32_t Boot_CompareMapped(uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    const uint8_t *flash = (const uint8_t *)(SLOT_A_CPU_ADDR + flashAddr);
+    uint32_t offset = 0;
+
+    /* The erase/program went around the cache: drop any stale line */
+    SCB_InvalidateDCache_by_Addr((void *)flash, (int32_t)size);
+
+    if ((((uint32_t)flash | (uint32_t)data) & 3U) == 0)
+    {
+        const uint32_t *flash32 = (const uint32_t *)flash;
+        const uint32_t *data32 = (const uint32_t *)data;
+
+        while (((offset + 4) <= size) && (flash32[offset / 4] == data32[offset / 4]))
+        {
+            offset += 4;
+        }
+    }
+
+    while ((offset < size) && (flash[offset] == data[offset]))
+    {
+        offset++;
+    }
+
+    return offset;
+}
+
+/**
+ * @brief  Compare flash with the source through indirect EXTMEM_Read
+ * @retval Offset of the first differing (or unreadable) byte, or size if identical
+ * @note   Mapped mode must be disabled
+ */
+static uint32_t Boot_CompareIndirect(uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    uint32_t offset = 0;
+
+    while (offset < size)
+    {
+        uint32_t len = size - offset;
+
+        if (len > sizeof(flashBuf))
+        {
+            len = sizeof(flashBuf);
+        }
+
+        if (EXTMEM_Read(EXTMEMORY_1, flashAddr + offset, flashBuf, len) != EXTMEM_OK)
+        {
+            return offset;
+        }
+
+        if (memcmp(flashBuf, &data[offset], len) != 0)
+        {
+            for (uint32_t i = 0; i < len; i++)
+            {
+                if (flashBuf[i] != data[offset + i])
+                {
+                    return offset + i;
+                }
+            }
+        }
+
+        offset += len;
+    }
+
+    return size;
+}
+
+static uint32_t Boot_Compare(Boot_VerifyPath_t path, uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    if (path == VERIFY_PATH_MAPPED)
+    {
+        return Boot_CompareMapped(flashAddr, data, size);
+    }
+
+    return Boot_CompareIndirect(flashAddr, data, size);
+}
+
+static void Boot_SetMappedMode(Boot_VerifyPath_t path)
+{
+    (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1,
+                                  (path == VERIFY_PATH_MAPPED) ? EXTMEM_ENABLE : EXTMEM_DISABLE);
+}
+
+/**
+ * @brief  Time both read paths on the start of the image and keep the faster
+ * @note   Entered with mapped mode enabled, returns in the mode of the chosen path
+ */
+static Boot_VerifyPath_t Boot_SelectVerifyPath(uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    uint32_t sample = (size < FLASH_VERIFY_BENCH_SIZE) ? size : FLASH_VERIFY_BENCH_SIZE;
+    uint32_t mappedCycles, indirectCycles;
+    uint32_t start;
+
+    Boot_CycleCounterStart();
+
+    start = DWT->CYCCNT;
+    (void)Boot_CompareMapped(flashAddr, data, sample);
+    mappedCycles = DWT->CYCCNT - start;
+
+    Boot_SetMappedMode(VERIFY_PATH_INDIRECT);
+
+    start = DWT->CYCCNT;
+    (void)Boot_CompareIndirect(flashAddr, data, sample);
+    indirectCycles = DWT->CYCCNT - start;
+
+    Boot_PrintThroughput("[BOOT] Verify mapped:   ", sample, mappedCycles);
+    Boot_PrintThroughput("[BOOT] Verify indirect: ", sample, indirectCycles);
+
+    if (mappedCycles <= indirectCycles)
+    {
+        Boot_SetMappedMode(VERIFY_PATH_MAPPED);
+        return VERIFY_PATH_MAPPED;
+    }
+
+    return VERIFY_PATH_INDIRECT;
+}
+
+/**
+ * @brief  Rewrite the page holding a mismatch, erasing its 4KB sector only
+ *         when a bit has to go back from 0 to 1
+ * @note   Mapped mode must be disabled
+ */
+static EXTMEM_StatusTypeDef Boot_RepairPage(uint32_t flashAddr, const uint8_t *data,
+                                            uint32_t size, uint32_t mismatch)
 {
     EXTMEM_StatusTypeDef status;
-    uint32_t blockCount;
-    uint32_t eraseAddr;
+    uint32_t pageOffset = mismatch & ~(FLASH_PAGE_SIZE - 1U);
+    uint32_t sectorOffset = mismatch & ~(FLASH_SECTOR_SIZE_4K - 1U);
+    uint32_t len;
 
-    Boot_Print("[BOOT] Writing firmware to flash\r\n");
-    Boot_PrintHex32("       Flash addr: ", flashAddr);
-    Boot_PrintHex32("       Size: ", size);
+    len = size - pageOffset;
+    if (len > FLASH_PAGE_SIZE)
+    {
+        len = FLASH_PAGE_SIZE;
+    }
 
-    /* Disable memory-mapped mode */
-    Boot_Print("[BOOT] Disabling memory-mapped mode...\r\n");
+    status = EXTMEM_Read(EXTMEMORY_1, flashAddr + pageOffset, flashBuf, len);
+    if (status != EXTMEM_OK)
+    {
+        return status;
+    }
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((flashBuf[i] & data[pageOffset + i]) != data[pageOffset + i])
+        {
+            /* Programming cannot set bits: rebuild the whole sector */
+            status = EXTMEM_EraseSector(EXTMEMORY_1, flashAddr + sectorOffset, FLASH_SECTOR_SIZE_4K);
+            if (status != EXTMEM_OK)
+            {
+                return status;
+            }
+
+            len = size - sectorOffset;
+            if (len > FLASH_SECTOR_SIZE_4K)
+            {
+                len = FLASH_SECTOR_SIZE_4K;
+            }
+
+            return EXTMEM_Write(EXTMEMORY_1, flashAddr + sectorOffset, &data[sectorOffset], len);
+        }
+    }
+
+    return EXTMEM_Write(EXTMEMORY_1, flashAddr + pageOffset, &data[pageOffset], len);
+}
+
+/**
+ * @brief  Read back the programmed range and repair failing pages
+ * @note   Entered and left with mapped mode enabled
+ */
+static OTA_Boot_Status_t Boot_VerifyFlash(uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    Boot_VerifyPath_t path;
+    uint32_t offset = 0;
+    uint32_t mismatch;
+    uint32_t failedPage = 0xFFFFFFFF;
+    uint32_t retries = 0;
+    uint32_t dcacheWasOn = (SCB->CCR & SCB_CCR_DC_Msk);
+    OTA_Boot_Status_t result = OTA_BOOT_OK;
+
+    Boot_Print("[BOOT] Verifying...\r\n");
+    TRACE_BEGIN(TRACE_ID_FLASH_VERIFY, flashAddr);
+
+    /* Let the XIP compare run through the cache and prefetcher */
+    if (!dcacheWasOn)
+    {
+        SCB_EnableDCache();
+    }
+
+    path = Boot_SelectVerifyPath(flashAddr, data, size);
+
+    while (offset < size)
+    {
+        mismatch = offset + Boot_Compare(path, flashAddr + offset, &data[offset], size - offset);
+        if (mismatch >= size)
+        {
+            break;
+        }
+
+        Boot_PrintHex32("[BOOT] VERIFY MISMATCH at ", flashAddr + mismatch);
+
+        /* Each repair fixes one page: count the retries of that page, so a
+         * sector with several bad pages gets them all repaired */
+        if ((mismatch & ~(FLASH_PAGE_SIZE - 1U)) == failedPage)
+        {
+            retries++;
+        }
+        else
+        {
+            failedPage = mismatch & ~(FLASH_PAGE_SIZE - 1U);
+            retries = 1;
+        }
+
+        if (retries > FLASH_VERIFY_RETRIES)
+        {
+            Boot_Print("[BOOT] VERIFY FAILED!\r\n");
+            result = OTA_BOOT_VERIFY_ERROR;
+            break;
+        }
+
+        Boot_SetMappedMode(VERIFY_PATH_INDIRECT);
+        if (Boot_RepairPage(flashAddr, data, size, mismatch) != EXTMEM_OK)
+        {
+            Boot_Print("[BOOT] Page repair failed\r\n");
+        }
+        Boot_SetMappedMode(path);
+
+        /* Re-check from the start of the repaired sector */
+        offset = failedPage & ~(FLASH_SECTOR_SIZE_4K - 1U);
+    }
+
+    if (path != VERIFY_PATH_MAPPED)
+    {
+        Boot_SetMappedMode(VERIFY_PATH_MAPPED);
+    }
+
+    if (!dcacheWasOn)
+    {
+        SCB_DisableDCache();
+    }
+
+    TRACE_END(TRACE_ID_FLASH_VERIFY, result);
+
+    if (result == OTA_BOOT_OK)
+    {
+        Boot_Print("[BOOT] Verify OK\r\n");
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*                          FLASH OPERATIONS                                  */
+/*============================================================================*/
+
+#if EXTMEM_ASYNC == 1
+static void Boot_FlashDone(uint32_t MemId, EXTMEM_StatusTypeDef Status, void *Context)
+{
+    (void)MemId;
+    (void)Context;
+
+    flashStatus = Status;
+    flashBusy = 0;
+}
+
+/**
+ * @brief  Longest time the memory may take to erase a range, from the SFDP
+ *         maximum erase times
+ * @note   Whatever erase types the driver picks, the range costs at most its
+ *         size at the slowest time per byte of the memory
+ */
+static uint32_t Boot_FlashEraseTimeout(uint32_t size)
+{
+    const EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef *info =
+        &extmem_list_config[EXTMEMORY_1].NorSfdpObject.sfpd_private.DriverInfo;
+    const uint8_t sizes[4] = { info->EraseType1Size, info->EraseType2Size,
+                               info->EraseType3Size, info->EraseType4Size };
+    const uint32_t times[4] = { info->EraseType1Timing, info->EraseType2Timing,
+                                info->EraseType3Timing, info->EraseType4Timing };
+    uint64_t timeout = 0;
+    uint64_t typeTimeout;
+
+    for (uint32_t type = 0; type < 4U; type++)
+    {
+        if (sizes[type] == 0U)
+        {
+            continue;
+        }
+
+        /* Whole sectors of this type over the range */
+        typeTimeout = (((uint64_t)size + (1ULL << sizes[type]) - 1U) >> sizes[type]) * times[type];
+        if (typeTimeout > timeout)
+        {
+            timeout = typeTimeout;
+        }
+    }
+
+    return (timeout > 0xFFFFFFFFULL) ? 0xFFFFFFFFU : (uint32_t)timeout;
+}
+
+/**
+ * @brief  Sleep until the queued flash operation completes
+ * @param  status: Return value of the EXTMEM_*Async call
+ * @param  timeoutMs: Time the memory needs at most for the operation
+ * @note   The driver chains WIP polling, write enable and page programs under
+ *         interrupt, so the core only wakes up between two steps. The wait
+ *         gives up FLASH_WAIT_TIMEOUT_MS after timeoutMs: a memory stuck busy
+ *         or a lost XSPI2 completion must not hang the Boot.
+ */
+static EXTMEM_StatusTypeDef Boot_FlashWait(EXTMEM_StatusTypeDef status, uint32_t timeoutMs)
+{
+    uint32_t tickStart = HAL_GetTick();
+    uint32_t deadline = timeoutMs + FLASH_WAIT_TIMEOUT_MS;
+    uint32_t start;
 
-    status = EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
     if (status != EXTMEM_OK)
     {
-        Boot_Print("[BOOT] Note: Mapped mode disable returned ");
-        Boot_PrintHex32("", (uint32_t)status);
+        /* Not queued: no completion will come */
+        flashBusy = 0;
+        return status;
     }
 
-    /* Erase blocks */
-    blockCount = (size + FLASH_BLOCK_SIZE_64K - 1) / FLASH_BLOCK_SIZE_64K;
-    Boot_PrintHex32("[BOOT] Erasing blocks: ", blockCount);
+    if (deadline < timeoutMs)
+    {
+        deadline = 0xFFFFFFFFU;
+    }
 
-    for (uint32_t i = 0; i < blockCount; i++)
+    while (flashBusy)
     {
-        eraseAddr = flashAddr + (i * FLASH_BLOCK_SIZE_64K);
+        if ((HAL_GetTick() - tickStart) > deadline)
+        {
+            /* Stop the XSPI2 transfer or auto-polling in progress */
+            (void)SAL_XSPI_Abort(&extmem_list_config[EXTMEMORY_1].NorSfdpObject.sfpd_private.SALObject);
+            flashBusy = 0;
+            Boot_Print("[BOOT] Flash operation timeout\r\n");
+            return EXTMEM_ERROR_DRIVER;
+        }
 
-        Boot_Print(".");
+        /* Masked check + WFI: a completion between the test and the sleep
+         * still wakes the core, the handler runs once the mask is cleared.
+         * The SysTick wakes the core for the deadline check. */
+        __disable_irq();
+        start = DWT->CYCCNT;
+        if (flashBusy)
+        {
+            __WFI();
+        }
+        flashIdleCycles += DWT->CYCCNT - start;
+        __enable_irq();
+    }
+
+    return flashStatus;
+}
+#endif
+
+static EXTMEM_StatusTypeDef Boot_FlashEraseSector(uint32_t flashAddr, uint32_t size)
+{
+#if EXTMEM_ASYNC == 1
+    flashBusy = 1;
+    return Boot_FlashWait(EXTMEM_EraseAsync(EXTMEMORY_1, flashAddr, size, Boot_FlashDone, NULL),
+                          Boot_FlashEraseTimeout(size));
+#else
+    return EXTMEM_EraseSector(EXTMEMORY_1, flashAddr, size);
+#endif
+}
+
+/**
+ * @brief  Erase a range through an erase plan: sectors already blank are
+ *         skipped and 4KB/32KB/64KB erases are mixed for the shortest time
+ * @note   Mapped mode must be disabled (the blank check reads indirectly)
+ */
+static EXTMEM_StatusTypeDef Boot_FlashErase(uint32_t flashAddr, uint32_t size)
+{
+    EXTMEM_EraseStepTypeDef steps[FLASH_ERASE_PLAN_STEPS];
+    EXTMEM_ErasePlanTypeDef plan = { .Steps = steps, .MaxSteps = FLASH_ERASE_PLAN_STEPS };
+    EXTMEM_StatusTypeDef status;
+
+    TRACE_BEGIN(TRACE_ID_FLASH_ERASE, flashAddr);
 
-        status = EXTMEM_EraseSector(EXTMEMORY_1, eraseAddr, FLASH_BLOCK_SIZE_64K);
+    status = EXTMEM_PlanErase(EXTMEMORY_1, flashAddr, size, &plan);
+    if (status != EXTMEM_OK)
+    {
+        /* No plan (too many steps, no SFDP erase type): erase everything */
+        status = Boot_FlashEraseSector(flashAddr, size);
+    }
+    else
+    {
+        eraseTimeMs += plan.EraseTime;
+        eraseBlankBytes += plan.BlankSize;
+
+        for (uint32_t i = 0; (i < plan.StepCount) && (status == EXTMEM_OK); i++)
+        {
+            status = Boot_FlashEraseSector(steps[i].Address, steps[i].Size);
+        }
+    }
+
+    TRACE_END(TRACE_ID_FLASH_ERASE, size);
+
+    return status;
+}
+
+static EXTMEM_StatusTypeDef Boot_FlashProgram(uint32_t flashAddr, const uint8_t *data, uint32_t size)
+{
+    EXTMEM_StatusTypeDef status;
+
+    TRACE_BEGIN(TRACE_ID_FLASH_PROGRAM, flashAddr);
+#if EXTMEM_ASYNC == 1
+    flashBusy = 1;
+    status = Boot_FlashWait(EXTMEM_WriteAsync(EXTMEMORY_1, flashAddr, data, size, Boot_FlashDone, NULL), 0U);
+#else
+    status = EXTMEM_Write(EXTMEMORY_1, flashAddr, data, size);
+#endif
+    TRACE_END(TRACE_ID_FLASH_PROGRAM, size);
+
+    return status;
+}
 
+/*============================================================================*/
+/*                          IMAGE PROGRAMMING                                 */
+/*============================================================================*/
+
+/**
+ * @brief  Bring one 64KB block of Slot B to the new contents: skipped if
+ *         already equal, programmed without erase if only 1->0 transitions
+ *         are needed, erased and programmed otherwise
+ * @note   Mapped mode must be disabled
+ */
+static OTA_Boot_Status_t Boot_UpdateBlock(uint32_t blockAddr, const uint8_t *blockData, uint32_t blockLen)
+{
+    EXTMEM_StatusTypeDef status = EXTMEM_OK;
+    uint32_t chunkMask;
+
+    switch (Boot_CompareBlock(blockAddr, blockData, blockLen, &chunkMask))
+    {
+    case BLOCK_UNCHANGED:
+        Boot_Print("=");
+        blocksSkipped++;
+        break;
+
+    case BLOCK_PROGRAM_ONLY:
+        Boot_Print("+");
+        blocksProgramOnly++;
+
+        /* Rewrite the differing chunks only: equal bytes program as no-ops */
+        for (uint32_t chunk = 0; chunk < FLASH_CHUNKS_PER_BLOCK; chunk++)
+        {
+            uint32_t offset = chunk * FLASH_COMPARE_CHUNK;
+            uint32_t len;
+
+            if ((chunkMask & (1UL << chunk)) == 0)
+            {
+                continue;
+            }
+
+            len = blockLen - offset;
+            if (len > FLASH_COMPARE_CHUNK)
+            {
+                len = FLASH_COMPARE_CHUNK;
+            }
+
+            status = Boot_FlashProgram(blockAddr + offset, &blockData[offset], len);
+            if (status != EXTMEM_OK)
+            {
+                break;
+            }
+        }
+        break;
+
+    default:
+        Boot_Print(".");
+        blocksErased++;
+
+        status = Boot_FlashErase(blockAddr, FLASH_BLOCK_SIZE_64K);
         if (status != EXTMEM_OK)
         {
             Boot_Print("\r\n[BOOT] ERASE FAILED!\r\n");
-            Boot_PrintHex32("       Address: ", eraseAddr);
+            Boot_PrintHex32("       Address: ", blockAddr);
             Boot_PrintHex32("       Status: ", (uint32_t)status);
             return OTA_BOOT_FLASH_ERROR;
         }
-    }
-    Boot_Print(" Done\r\n");
 
-    /* Program data */
-    Boot_Print("[BOOT] Programming...\r\n");
-
-    status = EXTMEM_Write(EXTMEMORY_1, flashAddr, data, size);
+        status = Boot_FlashProgram(blockAddr, blockData, blockLen);
+        break;
+    }
 
     if (status != EXTMEM_OK)
     {
-        Boot_Print("[BOOT] PROGRAM FAILED!\r\n");
+        Boot_Print("\r\n[BOOT] PROGRAM FAILED!\r\n");
+        Boot_PrintHex32("       Address: ", blockAddr);
         Boot_PrintHex32("       Status: ", (uint32_t)status);
         return OTA_BOOT_FLASH_ERROR;
     }
 
+    return OTA_BOOT_OK;
+}
+
+/**
+ * @brief  Start a program pass: mapped mode off, counters cleared
+ */
+static void Boot_ProgramBegin(void)
+{
+    EXTMEM_StatusTypeDef status;
+
+    /* Disable memory-mapped mode */
+    Boot_Print("[BOOT] Disabling memory-mapped mode...\r\n");
+
+    status = EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    if (status != EXTMEM_OK)
+    {
+        Boot_Print("[BOOT] Note: Mapped mode disable returned ");
+        Boot_PrintHex32("", (uint32_t)status);
+    }
+
+    blocksSkipped = 0;
+    blocksProgramOnly = 0;
+    blocksErased = 0;
+    eraseTimeMs = 0;
+    eraseBlankBytes = 0;
+#if EXTMEM_ASYNC == 1
+    flashIdleCycles = 0;
+    programStartTick = HAL_GetTick();
+#endif
+}
+
+/**
+ * @brief  End a program pass: statistics, mapped mode back on
+ */
+static void Boot_ProgramEnd(uint32_t blockCount)
+{
+    EXTMEM_StatusTypeDef status;
+#if EXTMEM_ASYNC == 1
+    uint32_t elapsedMs;
+    uint32_t idleMs;
+#endif
+
+    Boot_Print(" Done\r\n");
+
+    Boot_PrintDec32("[BOOT] Blocks unchanged: ", blocksSkipped, "");
+    Boot_PrintDec32(", program only: ", blocksProgramOnly, "");
+    Boot_PrintDec32(", erased: ", blocksErased, "");
+    Boot_PrintDec32(" (", (blockCount != 0) ? ((blocksSkipped * 100) / blockCount) : 0, "% skipped)\r\n");
+    Boot_PrintDec32("[BOOT] Erase plan: ", eraseTimeMs, " ms max");
+    Boot_PrintDec32(", already blank: ", eraseBlankBytes / 1024U, " KB\r\n");
+
+#if EXTMEM_ASYNC == 1
+    /* Share of the program pass the core spent asleep in Boot_FlashWait */
+    elapsedMs = HAL_GetTick() - programStartTick;
+    idleMs = (uint32_t)(flashIdleCycles / (SystemCoreClock / 1000U));
+    Boot_PrintDec32("[BOOT] Program time: ", elapsedMs, " ms");
+    Boot_PrintDec32(", CPU idle: ", (elapsedMs != 0) ? ((idleMs * 100) / elapsedMs) : 0, "%\r\n");
+#endif
+
     Boot_Print("[BOOT] Programming complete!\r\n");
 
     /* Re-enable memory-mapped mode */
@@ -197,10 +902,279 @@ static OTA_Boot_Status_t Boot_WriteFirmwareToFlash(uint32_t flashAddr,
         Boot_Print("[BOOT] Note: Re-enable mapped mode returned ");
         Boot_PrintHex32("", (uint32_t)status);
     }
+}
 
-    return OTA_BOOT_OK;
+/**
+ * @brief  Incrementally write an image held in RAM (Boot_UpdateBlock), then
+ *         verify it
+ */
+static OTA_Boot_Status_t Boot_WriteFirmwareToFlash(uint32_t flashAddr,
+                                                    uint8_t *data,
+                                                    uint32_t size)
+{
+    uint32_t blockCount;
+
+    Boot_Print("[BOOT] Writing firmware to flash\r\n");
+    Boot_PrintHex32("       Flash addr: ", flashAddr);
+    Boot_PrintHex32("       Size: ", size);
+
+    Boot_ProgramBegin();
+
+    blockCount = (size + FLASH_BLOCK_SIZE_64K - 1) / FLASH_BLOCK_SIZE_64K;
+    Boot_PrintHex32("[BOOT] Updating blocks: ", blockCount);
+
+    for (uint32_t i = 0; i < blockCount; i++)
+    {
+        uint32_t blockLen = size - (i * FLASH_BLOCK_SIZE_64K);
+
+        if (blockLen > FLASH_BLOCK_SIZE_64K)
+        {
+            blockLen = FLASH_BLOCK_SIZE_64K;
+        }
+
+        if (Boot_UpdateBlock(flashAddr + (i * FLASH_BLOCK_SIZE_64K),
+                             &data[i * FLASH_BLOCK_SIZE_64K], blockLen) != OTA_BOOT_OK)
+        {
+            return OTA_BOOT_FLASH_ERROR;
+        }
+    }
+
+    Boot_ProgramEnd(blockCount);
+
+    return Boot_VerifyFlash(flashAddr, data, size);
 }
 
+/**
+ * @brief  Validate an image the Appli wrote directly into Slot B
+ * @retval SLOT_B_CPU_ADDR if header and CRC match, SLOT_A_CPU_ADDR otherwise
+ */
+static uint32_t Boot_ValidateStagedSlot(void)
+{
+    uint32_t header[OTA_HEADER_SIZE / 4];
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t offset = 0;
+
+    Boot_Print("[BOOT] *** STAGED IMAGE IN SLOT B ***\r\n");
+
+    if (EXTMEM_Read(EXTMEMORY_1, SLOT_B_HEADER_ADDR, (uint8_t *)header, OTA_HEADER_SIZE) != EXTMEM_OK)
+    {
+        Boot_Print("[BOOT] ERROR: Cannot read Slot B header!\r\n");
+        return SLOT_A_CPU_ADDR;
+    }
+
+    Boot_PrintHex32("       Magic: ", header[0]);
+    Boot_PrintHex32("       Size: ", header[1]);
+    Boot_PrintHex32("       Expected CRC: ", header[2]);
+    Boot_PrintHex32("       Version: ", header[3]);
+
+    if ((header[0] != OTA_MAGIC) || (header[1] == 0) || (header[1] > OTA_SLOT_MAX_FW_SIZE))
+    {
+        Boot_Print("[BOOT] ERROR: Invalid Slot B header!\r\n");
+        Boot_Print("[BOOT] Falling back to Slot A\r\n");
+        return SLOT_A_CPU_ADDR;
+    }
+
+    TRACE_BEGIN(TRACE_ID_CRC, header[1]);
+    while (offset < header[1])
+    {
+        uint32_t len = header[1] - offset;
+        if (len > sizeof(flashBuf))
+        {
+            len = sizeof(flashBuf);
+        }
+
+        if (EXTMEM_Read(EXTMEMORY_1, SLOT_B_FLASH_ADDR + offset, flashBuf, len) != EXTMEM_OK)
+        {
+            TRACE_END(TRACE_ID_CRC, 0);
+            Boot_PrintHex32("[BOOT] ERROR: Slot B read failed at ", offset);
+            return SLOT_A_CPU_ADDR;
+        }
+
+        crc = Boot_UpdateCRC32(crc, flashBuf, len);
+        offset += len;
+    }
+    crc ^= 0xFFFFFFFF;
+    TRACE_END(TRACE_ID_CRC, crc);
+
+    Boot_PrintHex32("       Calculated: ", crc);
+
+    if (crc != header[2])
+    {
+        Boot_Print("[BOOT] ERROR: Slot B CRC mismatch!\r\n");
+        Boot_Print("[BOOT] Falling back to Slot A\r\n");
+        return SLOT_A_CPU_ADDR;
+    }
+
+    Boot_Print("[BOOT] Booting Slot B\r\n");
+    Boot_Print("========================================\r\n\r\n");
+
+    return SLOT_B_CPU_ADDR;
+}
+
+#if FW_STORE_ENABLE == 1
+/**
+ * @brief  Copy an image of the eMMC store into Slot B, then validate it
+ * @note   Pipelined: the IDMA reads block i+1 while block i is compared,
+ *         erased and programmed (the XSPI2 completions and the SDMMC1 one
+ *         wake the core in Boot_FlashWait). The Slot B header is erased
+ *         first and programmed last, once the CRC of the data read from the
+ *         eMMC matched.
+ * @retval SLOT_B_CPU_ADDR if the installed image is valid, SLOT_A_CPU_ADDR otherwise
+ */
+static uint32_t Boot_InstallFromStore(FW_Store_Role_t role)
+{
+    const FW_Store_Image_t *image = FW_Store_GetImage(role);
+    uint32_t header[OTA_HEADER_SIZE / 4];
+    uint32_t blockCount;
+    uint32_t jumpAddr;
+    uint32_t crc = 0xFFFFFFFF;
+    FW_Store_Status_t readStatus;
+    OTA_Boot_Status_t status = OTA_BOOT_OK;
+
+    if ((image == NULL) || (image->fwSize == 0) || (image->fwSize > OTA_SLOT_MAX_FW_SIZE))
+    {
+        Boot_Print("[BOOT] ERROR: No valid image in the eMMC store!\r\n");
+        return SLOT_A_CPU_ADDR;
+    }
+
+    header[0] = OTA_MAGIC;
+    header[1] = image->fwSize;
+    header[2] = image->crc;
+    header[3] = image->version;
+
+    Boot_Print("[BOOT] Installing from the eMMC store\r\n");
+    Boot_PrintHex32("       Version: ", header[3]);
+    Boot_PrintHex32("       Size: ", header[1]);
+
+    blockCount = (header[1] + FLASH_BLOCK_SIZE_64K - 1) / FLASH_BLOCK_SIZE_64K;
+
+    Boot_ProgramBegin();
+    Boot_PrintHex32("[BOOT] Updating blocks: ", blockCount);
+
+    /* Slot B stays invalid until the whole image is in */
+    if (Boot_FlashEraseSector(SLOT_B_HEADER_ADDR, FLASH_SECTOR_SIZE_4K) != EXTMEM_OK)
+    {
+        Boot_Print("[BOOT] ERROR: Slot B header erase failed!\r\n");
+        status = OTA_BOOT_FLASH_ERROR;
+    }
+
+    readStatus = FW_Store_ReadStart(role, 0, storeBuf[0], FLASH_BLOCK_SIZE_64K);
+
+    for (uint32_t i = 0; (i < blockCount) && (status == OTA_BOOT_OK); i++)
+    {
+        uint8_t *blockData = storeBuf[i & 1U];
+        uint32_t blockLen = header[1] - (i * FLASH_BLOCK_SIZE_64K);
+
+        if (blockLen > FLASH_BLOCK_SIZE_64K)
+        {
+            blockLen = FLASH_BLOCK_SIZE_64K;
+        }
+
+        if (readStatus == FW_STORE_OK)
+        {
+            readStatus = FW_Store_ReadWait();
+        }
+        if ((readStatus == FW_STORE_OK) && ((i + 1U) < blockCount))
+        {
+            /* The last read may cover blocks past the image: the slot is 16MB */
+            readStatus = FW_Store_ReadStart(role, (i + 1U) * FLASH_BLOCK_SIZE_64K,
+                                            storeBuf[(i + 1U) & 1U], FLASH_BLOCK_SIZE_64K);
+        }
+        if (readStatus != FW_STORE_OK)
+        {
+            Boot_PrintHex32("\r\n[BOOT] ERROR: eMMC read failed at ", i * FLASH_BLOCK_SIZE_64K);
+            status = OTA_BOOT_ERROR;
+            break;
+        }
+
+        crc = Boot_UpdateCRC32(crc, blockData, blockLen);
+        status = Boot_UpdateBlock(SLOT_B_FLASH_ADDR + (i * FLASH_BLOCK_SIZE_64K), blockData, blockLen);
+    }
+
+    /* No IDMA transfer may be left on a buffer */
+    (void)FW_Store_ReadWait();
+
+    if ((status == OTA_BOOT_OK) && ((crc ^ 0xFFFFFFFF) != header[2]))
+    {
+        Boot_Print("\r\n[BOOT] ERROR: eMMC image CRC mismatch!\r\n");
+        status = OTA_BOOT_INVALID_FW;
+    }
+
+    if ((status == OTA_BOOT_OK) &&
+        (Boot_FlashProgram(SLOT_B_HEADER_ADDR, (const uint8_t *)header, OTA_HEADER_SIZE) != EXTMEM_OK))
+    {
+        Boot_Print("\r\n[BOOT] ERROR: Slot B header write failed!\r\n");
+        status = OTA_BOOT_FLASH_ERROR;
+    }
+
+    Boot_ProgramEnd(blockCount);
+
+    if (status != OTA_BOOT_OK)
+    {
+        return SLOT_A_CPU_ADDR;
+    }
+
+    /* EXTMEM_Read is refused while mapped mode is on */
+    Boot_SetMappedMode(VERIFY_PATH_INDIRECT);
+    jumpAddr = Boot_ValidateStagedSlot();
+    Boot_SetMappedMode(VERIFY_PATH_MAPPED);
+
+    return jumpAddr;
+}
+
+/**
+ * @brief  Install the candidate of the eMMC store, or roll back to the
+ *         previous image, and update the roles of the store
+ * @note   A candidate that fails is dropped and the current image is
+ *         installed again: Slot B may hold part of the candidate
+ */
+static uint32_t Boot_ProcessStore(uint32_t bootFlag)
+{
+    uint32_t jumpAddr;
+
+    if (FW_Store_Init(&hmmc1) != FW_STORE_OK)
+    {
+        Boot_Print("[BOOT] ERROR: eMMC store not available!\r\n");
+        Boot_Print("[BOOT] Falling back to Slot A\r\n");
+        return SLOT_A_CPU_ADDR;
+    }
+
+    if (bootFlag == BOOT_FLAG_STORE_ROLLBACK)
+    {
+        Boot_Print("[BOOT] *** ROLLBACK FROM eMMC ***\r\n");
+
+        jumpAddr = Boot_InstallFromStore(FW_STORE_PREVIOUS);
+        if ((jumpAddr == SLOT_B_CPU_ADDR) && (FW_Store_Rollback() != FW_STORE_OK))
+        {
+            Boot_Print("[BOOT] Note: eMMC directory not updated\r\n");
+        }
+        return jumpAddr;
+    }
+
+    Boot_Print("[BOOT] *** INSTALL FROM eMMC ***\r\n");
+
+    jumpAddr = Boot_InstallFromStore(FW_STORE_CANDIDATE);
+    if (jumpAddr == SLOT_B_CPU_ADDR)
+    {
+        if (FW_Store_Commit() != FW_STORE_OK)
+        {
+            Boot_Print("[BOOT] Note: eMMC directory not updated\r\n");
+        }
+        return jumpAddr;
+    }
+
+    (void)FW_Store_Discard();
+
+    if (FW_Store_GetImage(FW_STORE_CURRENT) != NULL)
+    {
+        Boot_Print("[BOOT] Reinstalling the current image\r\n");
+        jumpAddr = Boot_InstallFromStore(FW_STORE_CURRENT);
+    }
+
+    return jumpAddr;
+}
+#endif /* FW_STORE_ENABLE == 1 */
+
 /*============================================================================*/
 /*                          PUBLIC FUNCTIONS                                  */
 /*============================================================================*/
@@ -219,6 +1193,22 @@ uint32_t OTA_Bootloader_Process(void)
 
     bootFlag = Boot_GetBootFlag();
     Boot_PrintHex32("[BOOT] Boot flag: ", bootFlag);
+    bootUpdateSeen = Boot_FlagPending(bootFlag);
+
+    if (bootFlag == BOOT_FLAG_STAGED)
+    {
+        /* Appli already programmed Slot B: validate and select only */
+        Boot_ClearBootFlag();
+        return Boot_ValidateStagedSlot();
+    }
+
+#if FW_STORE_ENABLE == 1
+    if ((bootFlag == BOOT_FLAG_STORE_INSTALL) || (bootFlag == BOOT_FLAG_STORE_ROLLBACK))
+    {
+        Boot_ClearBootFlag();
+        return Boot_ProcessStore(bootFlag);
+    }
+#endif
 
     if (bootFlag != BOOT_FLAG_UPDATE)
     {
@@ -233,6 +1223,15 @@ uint32_t OTA_Bootloader_Process(void)
     Boot_ClearBootFlag();
     Boot_Print("[BOOT] Boot flag cleared\r\n");
 
+#if PSRAM_ENABLE == 1
+    if (PSRAM_Init() != 0)
+    {
+        Boot_Print("[BOOT] ERROR: PSRAM not available!\r\n");
+        Boot_Print("[BOOT] Falling back to Slot A\r\n");
+        return SLOT_A_CPU_ADDR;
+    }
+#endif
+
     Boot_PrintHex32("[BOOT] Mailbox magic: ", OTA_MAILBOX->magic);
 
     if (OTA_MAILBOX->magic != OTA_MAGIC)
@@ -280,6 +1279,9 @@ uint32_t OTA_Bootloader_Process(void)
     }
 
     OTA_MAILBOX->magic = 0;
+#if PSRAM_ENABLE == 1
+    SCB_CleanDCache_by_Addr((void *)OTA_MAILBOX_BASE, 32);
+#endif
 
     Boot_Print("[BOOT] *** UPDATE SUCCESSFUL ***\r\n");
     Boot_Print("[BOOT] Booting Slot B\r\n");
@@ -288,6 +1290,11 @@ uint32_t OTA_Bootloader_Process(void)
     return SLOT_B_CPU_ADDR;
 }
 
+uint8_t OTA_Bootloader_UpdatePending(void)
+{
+    return bootUpdateSeen || Boot_FlagPending(Boot_GetBootFlag());
+}
+
 /**
  * @brief  Jump to application - uses same method as original bootloader
  * @param  appAddr: SLOT_A_CPU_ADDR (0x70000000) or SLOT_B_CPU_ADDR (0x71000000)
@@ -336,7 +1343,16 @@ void OTA_Bootloader_JumpToApp(uint32_t appAddr)
 
     Boot_PrintHex32("[BOOT] Final vector address: ", Application_vector);
 
-    HAL_Delay(50);
+    /* Send the rest of the log and release its DMA channel before the Appli takes over */
+    Log_Stop();
+
+    /* Log_Stop() returns once the last byte has left UART4: the pause only
+     * separates the Boot and Appli output on the terminal, the fast boot
+     * skips it */
+    if ((BOOT_FAST_BOOT != 1) || (OTA_Bootloader_UpdatePending() != 0U))
+    {
+        HAL_Delay(50);
+    }
 
     /* Suspend SysTick */
     HAL_SuspendTick();
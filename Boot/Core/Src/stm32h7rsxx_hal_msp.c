@@ -186,7 +186,9 @@ void HAL_MMC_MspInit(MMC_HandleTypeDef* hmmc)
     HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
     /* USER CODE BEGIN SDMMC1_MspInit 1 */
-
+    /* SDMMC1 interrupt Init: completion of the IDMA transfers */
+    HAL_NVIC_SetPriority(SDMMC1_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(SDMMC1_IRQn);
     /* USER CODE END SDMMC1_MspInit 1 */
 
   }
@@ -229,6 +231,7 @@ void HAL_MMC_MspDeInit(MMC_HandleTypeDef* hmmc)
                           |GPIO_PIN_9|GPIO_PIN_6|GPIO_PIN_7);
 
     /* USER CODE BEGIN SDMMC1_MspDeInit 1 */
+    HAL_NVIC_DisableIRQ(SDMMC1_IRQn);
 
     /* USER CODE END SDMMC1_MspDeInit 1 */
   }
@@ -364,6 +367,9 @@ void HAL_XSPI_MspInit(XSPI_HandleTypeDef* hxspi)
     GPIO_InitStruct.Alternate = GPIO_AF9_XSPIM_P2;
     HAL_GPIO_Init(GPION, &GPIO_InitStruct);
 
+    /* XSPI2 interrupt Init */
+    HAL_NVIC_SetPriority(XSPI2_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(XSPI2_IRQn);
     /* USER CODE BEGIN XSPI2_MspInit 1 */
 
     /* USER CODE END XSPI2_MspInit 1 */
@@ -406,6 +412,8 @@ void HAL_XSPI_MspDeInit(XSPI_HandleTypeDef* hxspi)
                           |GPIO_PIN_10|GPIO_PIN_9|GPIO_PIN_2|GPIO_PIN_6
                           |GPIO_PIN_8|GPIO_PIN_4|GPIO_PIN_5);
 
+    /* XSPI2 interrupt DeInit */
+    HAL_NVIC_DisableIRQ(XSPI2_IRQn);
     /* USER CODE BEGIN XSPI2_MspDeInit 1 */
 
     /* USER CODE END XSPI2_MspDeInit 1 */
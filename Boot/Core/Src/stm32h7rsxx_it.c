@@ -22,6 +22,7 @@
 #include "stm32h7rsxx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -55,8 +56,11 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern XSPI_HandleTypeDef hxspi2;
+extern UART_HandleTypeDef huart4;
 
 /* USER CODE BEGIN EV */
+extern MMC_HandleTypeDef hmmc1;
 
 /* USER CODE END EV */
 
@@ -84,6 +88,7 @@ void NMI_Handler(void)
 void HardFault_Handler(void)
 {
   /* USER CODE BEGIN HardFault_IRQn 0 */
+  Log_FaultFlush();
 
   /* USER CODE END HardFault_IRQn 0 */
   while (1)
@@ -198,6 +203,42 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32h7rsxx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles XSPI2 global interrupt.
+  */
+void XSPI2_IRQHandler(void)
+{
+  /* USER CODE BEGIN XSPI2_IRQn 0 */
+
+  /* USER CODE END XSPI2_IRQn 0 */
+  HAL_XSPI_IRQHandler(&hxspi2);
+  /* USER CODE BEGIN XSPI2_IRQn 1 */
+
+  /* USER CODE END XSPI2_IRQn 1 */
+}
+
+/**
+  * @brief This function handles UART4 global interrupt.
+  */
+void UART4_IRQHandler(void)
+{
+  /* USER CODE BEGIN UART4_IRQn 0 */
+
+  /* USER CODE END UART4_IRQn 0 */
+  HAL_UART_IRQHandler(&huart4);
+  /* USER CODE BEGIN UART4_IRQn 1 */
+
+  /* USER CODE END UART4_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles SDMMC1 global interrupt (IDMA transfers of fw_store.c).
+  */
+void SDMMC1_IRQHandler(void)
+{
+  HAL_MMC_IRQHandler(&hmmc1);
+}
+
 /* USER CODE END 1 */
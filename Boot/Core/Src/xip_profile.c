@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ * @file    xip_profile.c
+ * @brief   XIP profiles of XSPI2 - STM32H7S3 + MX25UW25645G
+ *
+ * The Appli executes from the memory-mapped window. A D-cache or I-cache
+ * miss is a 32-byte line fill, and the XSPI reads ahead after it while nCS
+ * stays low. Two settings change what a miss costs:
+ * - wrapped bursts: the line fill starts at the missed word and wraps inside
+ *   the 32-byte line, so the CPU gets its word first. The memory must be
+ *   set to the same burst length (SBL command of the MX25UW25645G);
+ * - the timeout counter: without it the prefetch runs until the next non
+ *   sequential access, which then waits for the prefetch to stop; with it
+ *   nCS is released after XIP_PROFILE_TIMEOUT idle cycles.
+ * The best profile depends on the code, so it is measured by the Appli
+ * benchmark and kept in a backup SRAM record that the Boot reads here.
+ * Before the jump, the profile is checked on the calibration sector: each
+ * line is first read at an offset inside it, so that the fill wraps. The
+ * profile table and the record are shared with the Appli (xip_record.c).
+ ******************************************************************************
+ */
+
+#include "xip_profile.h"
+#include "xspi_calib.h"
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+/* Check area: the calibration pattern, compared line by line */
+#define XIP_CHECK_ADDR      XSPI_CALIB_ADDR
+#define XIP_CHECK_SIZE      XSPI_CALIB_SIZE
+#define XIP_CHECK_LINE      32U
+#define XIP_CHECK_OFFSET    20U         /* first word read in each line */
+
+static uint8_t checkBuffer[XIP_CHECK_SIZE];
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+static int Record_Valid(const XIP_Profile_Record_t *record)
+{
+    return (record->magic == XIP_PROFILE_MAGIC) && (record->check == XIP_Record_Check(record)) &&
+           (record->profile < (uint8_t)XIP_PROFILE_COUNT);
+}
+
+/**
+ * @brief  Compare mapped line fills with an indirect read of the check area
+ * @retval 0 if the data match
+ */
+static int Profile_Check(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object)
+{
+    uint32_t mapBase;
+    const volatile uint8_t *mapped;
+    int result = 0;
+
+    if ((EXTMEM_DRIVER_NOR_SFDP_Read(object, XIP_CHECK_ADDR, checkBuffer, XIP_CHECK_SIZE) != EXTMEM_DRIVER_NOR_SFDP_OK) ||
+        (EXTMEM_GetMapAddress(EXTMEMORY_1, &mapBase) != EXTMEM_OK) ||
+        (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_ENABLE) != EXTMEM_OK))
+    {
+        return -1;
+    }
+    mapped = (const volatile uint8_t *)(mapBase + XIP_CHECK_ADDR);
+
+    /* The Boot runs without D-cache: enable it so that the reads are line fills */
+    SCB_EnableDCache();
+    for (uint32_t line = 0; (line < XIP_CHECK_SIZE) && (result == 0); line += XIP_CHECK_LINE)
+    {
+        (void)mapped[line + XIP_CHECK_OFFSET];
+        for (uint32_t i = 0; i < XIP_CHECK_LINE; i++)
+        {
+            if (mapped[line + i] != checkBuffer[line + i])
+            {
+                result = -1;
+                break;
+            }
+        }
+    }
+    SCB_DisableDCache();
+
+    (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    return result;
+}
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef XIP_Profile_Apply(XIP_Profile_t *applied)
+{
+    EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object = &extmem_list_config[EXTMEMORY_1].NorSfdpObject;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status;
+    int valid = Record_Valid(XIP_RECORD);
+
+    *applied = valid ? (XIP_Profile_t)XIP_RECORD->profile : BOOT_XIP_PROFILE_DEFAULT;
+
+    status = EXTMEM_DRIVER_NOR_SFDP_SetXipProfile(object, XIP_Profile_Get(*applied));
+    if ((status == EXTMEM_DRIVER_NOR_SFDP_OK) && (Profile_Check(object) != 0))
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE;
+    }
+    if ((status != EXTMEM_DRIVER_NOR_SFDP_OK) && (*applied != XIP_PROFILE_LINEAR))
+    {
+        /* the memory may have taken the burst length: set it back with the profile */
+        *applied = XIP_PROFILE_LINEAR;
+        (void)EXTMEM_DRIVER_NOR_SFDP_SetXipProfile(object, XIP_Profile_Get(XIP_PROFILE_LINEAR));
+    }
+
+    if (valid)
+    {
+        XIP_RECORD->applied = (uint8_t)*applied;
+        XIP_RECORD->check = XIP_Record_Check(XIP_RECORD);
+    }
+    return status;
+}
@@ -0,0 +1,260 @@
+/**
+ ******************************************************************************
+ * @file    xspi_bench.c
+ * @brief   XSPI2 NOR throughput benchmark - STM32H7S3 + MX25UW25645G
+ *
+ * For each point of the table the NOR SFDP driver is initialized with the
+ * requested link and clock limit, then the bench area is erased with the
+ * smallest sector type, programmed and read back in 4KB transfers. The rates
+ * count the driver calls only (polling included), the data check is not
+ * timed. The link actually configured is reported next to the rates: the
+ * driver may select another link than the one requested. The latency of the
+ * small operations (status polling, 16-byte read) is averaged separately:
+ * it is the part the setup of each command dominates.
+ *
+ * The same file is built on the host by tools/xspi_bench with
+ * XSPI_BENCH_HOST defined, against a cycle-modelled XSPI HAL.
+ ******************************************************************************
+ */
+
+#include "xspi_bench.h"
+#ifndef XSPI_BENCH_HOST
+#include "log.h"
+#endif
+#include <stdio.h>
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DEFINITIONS                               */
+/*============================================================================*/
+
+/* Last point uses the ExtMem Manager configuration, so the memory is left as expected */
+static const XSPI_Bench_Point_t benchPoints[] = {
+    { EXTMEM_LINK_CONFIG_1LINE,   50000000U },
+    { EXTMEM_LINK_CONFIG_1LINE,  100000000U },
+    { EXTMEM_LINK_CONFIG_8LINES,  50000000U },
+    { EXTMEM_LINK_CONFIG_8LINES, 100000000U },
+    { EXTMEM_LINK_CONFIG_8LINES,          0U },
+};
+
+static const char *const linkNames[] = {
+    "1S1S1S", "1S1S2S", "1S2S2S", "1S1D1D", "4S4S4S",
+    "4S4D4D", "4D4D4D", "1S8S8S", "8S8D8D", "8D8D8D", "RAM8"
+};
+
+static EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef benchObject;
+static uint8_t benchBuffer[XSPI_BENCH_CHUNK];
+
+/*============================================================================*/
+/*                          PLATFORM HOOKS (BOARD)                            */
+/*============================================================================*/
+
+#ifndef XSPI_BENCH_HOST
+extern UART_HandleTypeDef huart4;
+
+static uint64_t benchTimeNs;
+static uint32_t benchLastCycles;
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef XSPI_Bench_Setup(const XSPI_Bench_Point_t *point,
+                                                      EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object)
+{
+    object->sfdp_public.MaxFreq = point->maxFreq;
+    return EXTMEM_DRIVER_NOR_SFDP_Init(&hxspi2, point->config,
+                                       HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_XSPI2), object);
+}
+
+uint64_t XSPI_Bench_TimeNs(void)
+{
+    /* DWT is enabled in main(); accumulate so that the 32-bit counter may wrap between calls */
+    uint32_t now = DWT->CYCCNT;
+
+    benchTimeNs += ((uint64_t)(now - benchLastCycles) * 1000U) / (SystemCoreClock / 1000000U);
+    benchLastCycles = now;
+    return benchTimeNs;
+}
+
+void XSPI_Bench_Print(const char *str)
+{
+    (void)Log_Write(str, strlen(str));
+}
+#endif /* XSPI_BENCH_HOST */
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+static void Bench_Fill(uint32_t offset)
+{
+    for (uint32_t i = 0; i < XSPI_BENCH_CHUNK; i++)
+    {
+        uint32_t pos = offset + i;
+        benchBuffer[i] = (uint8_t)(pos ^ (pos >> 8) ^ 0x5AU);
+    }
+}
+
+static int Bench_Check(uint32_t offset)
+{
+    for (uint32_t i = 0; i < XSPI_BENCH_CHUNK; i++)
+    {
+        uint32_t pos = offset + i;
+        if (benchBuffer[i] != (uint8_t)(pos ^ (pos >> 8) ^ 0x5AU))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Rate in KB/s of a transfer
+ */
+static uint32_t Bench_Rate(uint32_t bytes, uint64_t ns)
+{
+    if (ns == 0U)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)bytes * 1000000000ULL) / (ns * 1024U));
+}
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+int XSPI_Bench_Measure(const XSPI_Bench_Point_t *point, XSPI_Bench_Result_t *result)
+{
+    EXTMEM_NOR_SFDP_FlashInfoTypeDef info;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status;
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t offset;
+
+    memset(result, 0, sizeof(*result));
+
+    memset(&benchObject, 0, sizeof(benchObject));
+    status = XSPI_Bench_Setup(point, &benchObject);
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        goto error;
+    }
+
+    EXTMEM_DRIVER_NOR_SFDP_GetLinkInfo(&benchObject, &result->link);
+    EXTMEM_DRIVER_NOR_SFDP_GetFlashInfo(&benchObject, &info);
+    if ((info.EraseType1Size == 0U) || ((XSPI_BENCH_SIZE % info.EraseType1Size) != 0U))
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_ERROR_SECTORTYPE_UNAVAILABLE;
+        goto error;
+    }
+
+    /* Erase with the smallest sector: the rate a partial update sees */
+    start = XSPI_Bench_TimeNs();
+    for (offset = 0; (offset < XSPI_BENCH_SIZE) && (status == EXTMEM_DRIVER_NOR_SFDP_OK); offset += info.EraseType1Size)
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_SectorErase(&benchObject, XSPI_BENCH_ADDR + offset,
+                                                    EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1);
+    }
+    elapsed = XSPI_Bench_TimeNs() - start;
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        goto error;
+    }
+    result->eraseKBps = Bench_Rate(XSPI_BENCH_SIZE, elapsed);
+
+    /* Page programs, split on page bounds by the driver */
+    elapsed = 0;
+    for (offset = 0; (offset < XSPI_BENCH_SIZE) && (status == EXTMEM_DRIVER_NOR_SFDP_OK); offset += XSPI_BENCH_CHUNK)
+    {
+        Bench_Fill(offset);
+        start = XSPI_Bench_TimeNs();
+        status = EXTMEM_DRIVER_NOR_SFDP_Write(&benchObject, XSPI_BENCH_ADDR + offset, benchBuffer, XSPI_BENCH_CHUNK);
+        elapsed += XSPI_Bench_TimeNs() - start;
+    }
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        goto error;
+    }
+    result->programKBps = Bench_Rate(XSPI_BENCH_SIZE, elapsed);
+
+    /* Indirect reads, checked against the programmed pattern */
+    elapsed = 0;
+    for (offset = 0; (offset < XSPI_BENCH_SIZE) && (status == EXTMEM_DRIVER_NOR_SFDP_OK); offset += XSPI_BENCH_CHUNK)
+    {
+        memset(benchBuffer, 0, sizeof(benchBuffer));
+        start = XSPI_Bench_TimeNs();
+        status = EXTMEM_DRIVER_NOR_SFDP_Read(&benchObject, XSPI_BENCH_ADDR + offset, benchBuffer, XSPI_BENCH_CHUNK);
+        elapsed += XSPI_Bench_TimeNs() - start;
+
+        if ((status == EXTMEM_DRIVER_NOR_SFDP_OK) && (Bench_Check(offset) != 0))
+        {
+            result->status = -1;
+            return -1;
+        }
+    }
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        goto error;
+    }
+    result->readKBps = Bench_Rate(XSPI_BENCH_SIZE, elapsed);
+
+    /* Small operations, one command each */
+    start = XSPI_Bench_TimeNs();
+    for (uint32_t i = 0; (i < XSPI_BENCH_REPEAT) && (status == EXTMEM_DRIVER_NOR_SFDP_OK); i++)
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_CheckBusy(&benchObject, 100U);
+    }
+    elapsed = XSPI_Bench_TimeNs() - start;
+    result->pollNs = (uint32_t)(elapsed / XSPI_BENCH_REPEAT);
+
+    start = XSPI_Bench_TimeNs();
+    for (uint32_t i = 0; (i < XSPI_BENCH_REPEAT) && (status == EXTMEM_DRIVER_NOR_SFDP_OK); i++)
+    {
+        /* the read checks the busy flag first, as every driver call */
+        status = EXTMEM_DRIVER_NOR_SFDP_Read(&benchObject, XSPI_BENCH_ADDR + (i * XSPI_BENCH_SMALL), benchBuffer, XSPI_BENCH_SMALL);
+    }
+    elapsed = XSPI_Bench_TimeNs() - start;
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        goto error;
+    }
+    result->smallReadNs = (uint32_t)(elapsed / XSPI_BENCH_REPEAT);
+    return 0;
+
+error:
+    result->status = (int32_t)status;
+    return -1;
+}
+
+int XSPI_Bench_Run(void)
+{
+    XSPI_Bench_Result_t result;
+    char line[160];
+    int failures = 0;
+
+    XSPI_Bench_Print("[BENCH] link    clock MHz dummy DQS ext |  read KB/s  prog KB/s erase KB/s | poll ns rd16 ns\r\n");
+
+    for (uint32_t i = 0; i < (sizeof(benchPoints) / sizeof(benchPoints[0])); i++)
+    {
+        const XSPI_Bench_Point_t *point = &benchPoints[i];
+
+        if (XSPI_Bench_Measure(point, &result) != 0)
+        {
+            snprintf(line, sizeof(line), "[BENCH] %u lines, %lu MHz max: error %ld\r\n",
+                     (point->config == EXTMEM_LINK_CONFIG_8LINES) ? 8U : 1U,
+                     (unsigned long)(point->maxFreq / 1000000U), (long)result.status);
+            failures++;
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "[BENCH] %-7s %9lu %5u %3u %3u | %10lu %10lu %10lu | %7lu %7lu\r\n",
+                     (result.link.PhyLink < (sizeof(linkNames) / sizeof(linkNames[0]))) ? linkNames[result.link.PhyLink] : "?",
+                     (unsigned long)(result.link.Clock / 1000000U), result.link.ReadDummyCycles,
+                     result.link.DataStrobe, result.link.CommandExtension,
+                     (unsigned long)result.readKBps, (unsigned long)result.programKBps,
+                     (unsigned long)result.eraseKBps, (unsigned long)result.pollNs,
+                     (unsigned long)result.smallReadNs);
+        }
+        XSPI_Bench_Print(line);
+    }
+
+    return failures;
+}
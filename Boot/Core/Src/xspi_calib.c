@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file    xspi_calib.c
+ * @brief   XSPI2 read timing calibration at boot - STM32H7S3 + MX25UW25645G
+ *
+ * MX_XSPI2_Init starts with a fixed timing and EXTMEM_Init only limits the
+ * clock to the memory maximum. On the first boot (or when the stored record
+ * no longer matches), the driver sweeps the prescaler from that clock down,
+ * and at each clock the read sampling delay, on a known pattern. The fastest
+ * clock with a wide enough passing window is kept, in the middle of the
+ * window. The record in backup SRAM lets the next boots skip the sweep; XIP
+ * then runs with the same timing.
+ ******************************************************************************
+ */
+
+#include "xspi_calib.h"
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+static uint8_t calibPattern[XSPI_CALIB_SIZE];
+static uint8_t calibBuffer[XSPI_CALIB_SIZE];
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+/**
+ * @brief  Fill the pattern: all bits toggling together, alternating bits,
+ *         walking ones and zeros, then an address ramp
+ */
+static void Calib_BuildPattern(void)
+{
+    for (uint32_t i = 0; i < XSPI_CALIB_SIZE; i++)
+    {
+        switch (i / 64U)
+        {
+        case 0:  calibPattern[i] = (i & 1U) ? 0xFFU : 0x00U; break;
+        case 1:  calibPattern[i] = (i & 1U) ? 0xAAU : 0x55U; break;
+        case 2:  calibPattern[i] = (i & 8U) ? (uint8_t)~(1U << (i & 7U)) : (uint8_t)(1U << (i & 7U)); break;
+        default: calibPattern[i] = (uint8_t)i; break;
+        }
+    }
+}
+
+/**
+ * @brief  Program the pattern if the sector does not hold it yet
+ */
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef Calib_PreparePattern(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object)
+{
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status;
+
+    status = EXTMEM_DRIVER_NOR_SFDP_Read(object, XSPI_CALIB_ADDR, calibBuffer, XSPI_CALIB_SIZE);
+    if ((status == EXTMEM_DRIVER_NOR_SFDP_OK) && (memcmp(calibBuffer, calibPattern, XSPI_CALIB_SIZE) == 0))
+    {
+        return EXTMEM_DRIVER_NOR_SFDP_OK;
+    }
+
+    status = EXTMEM_DRIVER_NOR_SFDP_SectorErase(object, XSPI_CALIB_ADDR, EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1);
+    if (status == EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_Write(object, XSPI_CALIB_ADDR, calibPattern, XSPI_CALIB_SIZE);
+    }
+    return status;
+}
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+int XSPI_Calib_Run(EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef *result)
+{
+    EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object = &extmem_list_config[EXTMEMORY_1].NorSfdpObject;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status;
+
+    if (object->sfpd_private.TimingStored == 1U)
+    {
+        return 1;
+    }
+
+    Calib_BuildPattern();
+
+    /* Programmed with the default timing of the initialization */
+    status = Calib_PreparePattern(object);
+    if (status == EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        status = EXTMEM_DRIVER_NOR_SFDP_Calibrate(object, XSPI_CALIB_ADDR, calibPattern, XSPI_CALIB_SIZE, result);
+    }
+    return (int)status;
+}
@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @file    boot_time_record.h
+ * @brief   Boot-time record in backup SRAM: written by the Boot before the
+ *          jump, completed and printed by the Appli (boot_time.h of each image)
+ ******************************************************************************
+ */
+
+#ifndef BOOT_TIME_RECORD_H
+#define BOOT_TIME_RECORD_H
+
+#include "stm32h7rsxx.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Record in backup SRAM, after the XIP profile record (checked in
+ * boot_time_record.c) */
+#define BOOT_TIME_RECORD_ADDR       (BKPSRAM_BASE + 0x0500U)
+#define BOOT_TIME_MAGIC             0x314D5442U     /* "BTM1" */
+
+/* Boots kept in the record, the oldest is overwritten */
+#define BOOT_TIME_HISTORY           8U
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+/* Phases of the Boot main, in order */
+typedef enum {
+    BOOT_PHASE_HAL_INIT = 0,        /* MPU_Config, HAL_Init */
+    BOOT_PHASE_CLOCK,               /* SystemClock_Config: HSE start-up and PLL lock */
+    BOOT_PHASE_PERIPHERALS,         /* backup domain, MX_*_Init of the generated code */
+    BOOT_PHASE_EMMC_PROBE,          /* eMMC card information on the log */
+    BOOT_PHASE_XSPI_REINIT,         /* second MX_XSPI2_Init */
+    BOOT_PHASE_UPDATE,              /* OTA_Bootloader_Process */
+    BOOT_PHASE_EXTMEM_INIT,         /* MX_EXTMEM_MANAGER_Init: SFDP and memory-mapped mode */
+    BOOT_PHASE_XIP_SETUP,           /* XSPI2 timing and XIP profile */
+    BOOT_PHASE_JUMP,                /* trace dump, log and delay before the jump */
+    BOOT_PHASE_HANDOVER,            /* Boot_Time_Save to Boot_Time_AppliStart, measured by the Appli */
+    BOOT_PHASE_COUNT
+} Boot_Phase_t;
+
+/* Flags of a boot */
+#define BOOT_TIME_FLAG_UPDATE       0x01U   /* update or staged slot pending */
+#define BOOT_TIME_FLAG_FAST         0x02U   /* fast boot path taken */
+#define BOOT_TIME_FLAG_SLOT_B       0x04U   /* jump to Slot B */
+
+/* One boot */
+typedef struct {
+    uint32_t sequence;              /* boots recorded before this one */
+    uint32_t flags;                 /* BOOT_TIME_FLAG_* */
+    uint32_t jumpCycles;            /* DWT->CYCCNT when the entry was saved */
+    uint32_t phaseUs[BOOT_PHASE_COUNT];  /* 0 = skipped */
+} Boot_Time_Entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t next;                  /* entry written by the next boot: the oldest */
+    uint32_t coreClock;             /* SystemCoreClock at the jump, in Hz */
+    Boot_Time_Entry_t entries[BOOT_TIME_HISTORY];
+    uint32_t check;                 /* complement of the sum of the previous words */
+} Boot_Time_Record_t;
+
+_Static_assert(sizeof(Boot_Time_Record_t) == (16U + (BOOT_TIME_HISTORY * (12U + (4U * BOOT_PHASE_COUNT)))),
+               "Boot-time record layout changed: a Boot and an Appli of different builds would disagree");
+_Static_assert(offsetof(Boot_Time_Record_t, check) == (sizeof(Boot_Time_Record_t) - sizeof(uint32_t)),
+               "Boot-time record check word must be the last word");
+
+#define BOOT_TIME_RECORD ((Boot_Time_Record_t *)BOOT_TIME_RECORD_ADDR)
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Check word of a record
+ */
+uint32_t Boot_Time_Check(const Boot_Time_Record_t *record);
+
+#endif /* BOOT_TIME_RECORD_H */
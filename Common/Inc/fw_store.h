@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ * @file    fw_store.h
+ * @brief   Firmware image store on the eMMC: current, previous and candidate
+ *          images, IDMA multi-block transfers
+ ******************************************************************************
+ */
+
+#ifndef FW_STORE_H
+#define FW_STORE_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 1 in the preprocessor symbols of both the Boot and the Appli: the
+ * Appli downloads into the store, the Boot installs from it into Slot B */
+#ifndef FW_STORE_ENABLE
+#define FW_STORE_ENABLE         0
+#endif
+
+/* Set to 0 in the Boot, which only reads the images and moves the roles:
+ * FW_Store_Begin, Write, Finish, ImageCrc and their 32KB of buffers are
+ * left out */
+#ifndef FW_STORE_WRITER
+#define FW_STORE_WRITER         1
+#endif
+
+/* Map of the eMMC, in 512-byte blocks */
+#define FW_STORE_BLOCK_SIZE     512U
+#define FW_STORE_DIR_LBA        0U          /* Two copies, LBA 0 and 1: the newest valid one is used */
+#define FW_STORE_AREA_LBA       2048U       /* First image slot, 1MB in */
+#define FW_STORE_SLOT_BLOCKS    32768U      /* 16MB per slot: the image of a NOR slot */
+#define FW_STORE_SLOT_COUNT     3U
+#define FW_STORE_SLOT_LBA(slot) (FW_STORE_AREA_LBA + ((uint32_t)(slot) * FW_STORE_SLOT_BLOCKS))
+
+#define FW_STORE_MAGIC          0x53574D46U /* "FMWS" */
+#define FW_STORE_NONE           0xFFU
+
+/* OTA file: 16-byte header (OTA_MAGIC, size, CRC, version), then the image.
+ * The header goes to the directory, the image to the first block of a slot */
+#define FW_STORE_HEADER_SIZE    16U
+#define FW_STORE_FILE_MAGIC     0x4F544131U /* OTA_MAGIC */
+
+/* One IDMA multi-block write of the download, two buffers in turn */
+#define FW_STORE_WRITE_BLOCKS   32U         /* 16KB */
+#define FW_STORE_TIMEOUT_MS     2000U
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef enum {
+    FW_STORE_OK = 0,
+    FW_STORE_ERROR,             /* eMMC command, IDMA transfer or timeout */
+    FW_STORE_NOT_READY,         /* FW_Store_Init not done, or no write session */
+    FW_STORE_NO_IMAGE,          /* Nothing stored under this role */
+    FW_STORE_INVALID_FW,        /* Bad header or size */
+    FW_STORE_VERIFY_ERROR       /* CRC read back from the eMMC differs */
+} FW_Store_Status_t;
+
+typedef enum {
+    FW_STORE_CURRENT = 0,       /* Installed in Slot B */
+    FW_STORE_PREVIOUS,          /* Installed before it: the rollback image */
+    FW_STORE_CANDIDATE,         /* Downloaded, waiting for the Boot to install it */
+    FW_STORE_ROLE_COUNT
+} FW_Store_Role_t;
+
+/* Image of a slot: the header of its OTA file */
+typedef struct {
+    uint32_t magic;             /* FW_STORE_FILE_MAGIC once written and checked */
+    uint32_t fwSize;            /* Image bytes, header excluded */
+    uint32_t crc;
+    uint32_t version;
+} FW_Store_Image_t;
+
+/* Directory block */
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;          /* Incremented by each write, selects the copy */
+    uint8_t  role[FW_STORE_ROLE_COUNT];     /* Slot of each role, FW_STORE_NONE if empty */
+    uint8_t  reserved;
+    FW_Store_Image_t image[FW_STORE_SLOT_COUNT];
+    uint32_t crc;               /* CRC-32 of the fields above */
+} FW_Store_Dir_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Load the directory from the eMMC, or write an empty one
+ * @note   hmmc must be initialized, with the SDMMC1 interrupt enabled:
+ *         every IDMA transfer completes in HAL_MMC_IRQHandler
+ */
+FW_Store_Status_t FW_Store_Init(MMC_HandleTypeDef *hmmc);
+
+/**
+ * @brief  Image stored under a role
+ * @retval NULL if the role is empty or the store is not initialized
+ */
+const FW_Store_Image_t *FW_Store_GetImage(FW_Store_Role_t role);
+
+#if FW_STORE_WRITER == 1
+/**
+ * @brief  Start a new candidate in the slot used by no role
+ * @note   The candidate in place, if any, is dropped
+ */
+FW_Store_Status_t FW_Store_Begin(uint32_t fileSize);
+
+/**
+ * @brief  Add a chunk of the OTA file, in file order
+ * @note   A full buffer is written by the IDMA while the next one fills
+ */
+FW_Store_Status_t FW_Store_Write(uint32_t fileOffset, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief  Write what is left, read the image back for its CRC and record it
+ *         as the candidate
+ */
+FW_Store_Status_t FW_Store_Finish(void);
+
+/**
+ * @brief  CRC-32 of a stored image, read back with multi-block IDMA reads
+ */
+FW_Store_Status_t FW_Store_ImageCrc(FW_Store_Role_t role, uint32_t *crc);
+#endif /* FW_STORE_WRITER == 1 */
+
+/**
+ * @brief  Start an IDMA read of a stored image
+ * @param  offset: Image offset, multiple of FW_STORE_BLOCK_SIZE
+ * @param  buf: 32-byte aligned, in AXI SRAM (the IDMA does not reach the TCM)
+ * @param  len: Multiple of FW_STORE_BLOCK_SIZE
+ * @note   Returns at once; FW_Store_ReadWait() completes the read
+ */
+FW_Store_Status_t FW_Store_ReadStart(FW_Store_Role_t role, uint32_t offset, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief  Wait for the read of FW_Store_ReadStart() and drop the stale
+ *         D-cache lines of its buffer
+ */
+FW_Store_Status_t FW_Store_ReadWait(void);
+
+/**
+ * @brief  The candidate is installed: it becomes current, current becomes
+ *         previous and the old previous slot is freed
+ */
+FW_Store_Status_t FW_Store_Commit(void);
+
+/**
+ * @brief  The previous image is installed again: it becomes current and the
+ *         image it replaces is dropped
+ */
+FW_Store_Status_t FW_Store_Rollback(void);
+
+/**
+ * @brief  Drop the candidate (it failed to install)
+ */
+FW_Store_Status_t FW_Store_Discard(void);
+
+#endif /* FW_STORE_H */
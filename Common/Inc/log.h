@@ -0,0 +1,232 @@
+/**
+ ******************************************************************************
+ * @file    log.h
+ * @brief   UART4 log: ring buffer sent by DMA, writers never wait for the line
+ *
+ * Log_Write copies the text into a ring and returns; GPDMA1 channel 0 sends
+ * it while the caller goes on. A message that does not fit, or that comes
+ * from an interrupt while another write is copying, is dropped whole and
+ * counted. Built with LOG_ASYNC 0, Log_Write is the blocking transmit of
+ * before. The Boot and the Appli both build this file (Common/).
+ *
+ * LOG_ERR, LOG_WRN, LOG_INF and LOG_DBG take a printf format and its
+ * arguments; the levels above LOG_LEVEL are removed at compile time. Built
+ * with LOG_TOKENIZED 1 they do not format: the format string goes to the
+ * log_fmt section of the ELF, which is not loaded, and the call sends a frame
+ * with its offset in the section and the raw arguments. tools/log_decode
+ * rebuilds the text from the ELF; the lines sent by Log_Write or printf go
+ * through unchanged between the frames.
+ ******************************************************************************
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include "main.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 0 for blocking transmits (no DMA channel, no interrupt) */
+#ifndef LOG_ASYNC
+#define LOG_ASYNC               1
+#endif
+
+/* Ring size in bytes, a power of two: 350 ms of text at 115200 baud */
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE           4096U
+#endif
+
+/* Set to 0 to leave the text in the ring on a fault */
+#ifndef LOG_FLUSH_ON_FAULT
+#define LOG_FLUSH_ON_FAULT      1
+#endif
+
+/* Levels kept: LOG_LEVEL_ERR to LOG_LEVEL_DBG */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL               LOG_LEVEL_DBG
+#endif
+
+/* Set to 1 to send the LOG_xxx calls as frames for tools/log_decode */
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED           0
+#endif
+
+/* Timeout of a blocking transmit (LOG_ASYNC 0 or after Log_Stop) */
+#define LOG_BLOCKING_TIMEOUT    1000U
+
+/* Transmit channel of UART4 and its interrupt (the handler is in log.c) */
+#define LOG_DMA_CHANNEL         GPDMA1_Channel0
+#define LOG_DMA_REQUEST         GPDMA1_REQUEST_UART4_TX
+#define LOG_DMA_IRQn            GPDMA1_Channel0_IRQn
+#define LOG_UART_IRQn           UART4_IRQn
+#define LOG_IRQ_PRIORITY        14U
+
+#define LOG_LEVEL_NONE          0
+#define LOG_LEVEL_ERR           1
+#define LOG_LEVEL_WRN           2
+#define LOG_LEVEL_INF           3
+#define LOG_LEVEL_DBG           4
+
+/* Frame of a LOG_xxx call (LOG_TOKENIZED 1), little endian:
+ *   LOG_FRAME_SYNC, payload length, format offset (16 bits), payload, sum
+ * The sum is the low byte of the sum of the offset and payload bytes. The
+ * payload holds the arguments in order: 4 bytes for the integers, long and
+ * pointers included, 8 for long long and double, and for a string its
+ * length on one byte and its characters, cut to fit the frame. */
+#define LOG_FRAME_SYNC          0x1EU       /* ASCII record separator */
+#define LOG_FRAME_HEADER        4U
+#define LOG_FRAME_PAYLOAD_MAX   255U
+#define LOG_FRAME_MAX_ARGS      8U
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef struct {
+    uint32_t written;           /* bytes queued (LOG_ASYNC) or sent */
+    uint32_t dropped;           /* bytes of the messages dropped */
+    uint32_t overruns;          /* messages dropped: ring full */
+    uint32_t collisions;        /* messages dropped: written from an interrupt during a write */
+    uint32_t highWater;         /* most bytes waiting in the ring */
+} Log_Stats_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Set the UART and its transmit DMA channel
+ * @note   Call it after MX_UART4_Init; the writes before it are dropped
+ */
+void Log_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief  Queue a message, whole or not at all
+ * @note   Callable from interrupts
+ * @retval len if the message is queued (or sent), 0 if it is dropped
+ */
+uint32_t Log_Write(const void *data, uint32_t len);
+
+/**
+ * @brief  Wait until the ring is sent, at most timeoutMs
+ * @note   Before a blocking transmit on the same UART (Trace_Dump) and
+ *         before a reset
+ */
+void Log_Flush(uint32_t timeoutMs);
+
+/**
+ * @brief  Flush, then release the DMA channel and the interrupts: the next
+ *         writes are blocking. Call it before the jump to the Appli.
+ */
+void Log_Stop(void);
+
+void Log_GetStats(Log_Stats_t *stats);
+
+#if (LOG_ASYNC == 1) && (LOG_FLUSH_ON_FAULT == 1)
+/**
+ * @brief  Send what the ring holds by polling the UART, from a fault handler
+ *         or Error_Handler: the DMA is stopped where it is, no HAL call and
+ *         no interrupt is used
+ */
+void Log_FaultFlush(void);
+#else
+#define Log_FaultFlush()        ((void)0)
+#endif
+
+/*============================================================================*/
+/*                          LEVELS AND TOKENS                                 */
+/*============================================================================*/
+
+/* Argument classes of a LOG_xxx call, 3 bits each above the count */
+#define LOG_ARG_INT             0U
+#define LOG_ARG_LONG            1U
+#define LOG_ARG_LLONG           2U
+#define LOG_ARG_DOUBLE          3U
+#define LOG_ARG_STRING          4U
+#define LOG_ARG_POINTER         5U
+
+#define LOG_ARG_CLASS(x) _Generic((x),                                      \
+    _Bool: LOG_ARG_INT, char: LOG_ARG_INT, signed char: LOG_ARG_INT,        \
+    unsigned char: LOG_ARG_INT, short: LOG_ARG_INT,                         \
+    unsigned short: LOG_ARG_INT, int: LOG_ARG_INT, unsigned int: LOG_ARG_INT, \
+    long: LOG_ARG_LONG, unsigned long: LOG_ARG_LONG,                        \
+    long long: LOG_ARG_LLONG, unsigned long long: LOG_ARG_LLONG,            \
+    float: LOG_ARG_DOUBLE, double: LOG_ARG_DOUBLE,                          \
+    char *: LOG_ARG_STRING, const char *: LOG_ARG_STRING,                   \
+    unsigned char *: LOG_ARG_STRING, const unsigned char *: LOG_ARG_STRING, \
+    default: LOG_ARG_POINTER)
+
+#define LOG_NARGS(...)          LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define LOG_CAT(a, b)           LOG_CAT_(a, b)
+#define LOG_CAT_(a, b)          a##b
+
+#define LOG_C(x, i)             (LOG_ARG_CLASS(x) << (4U + (3U * (i))))
+#define LOG_CLASSES_0()         0U
+#define LOG_CLASSES_1(a)        LOG_C(a, 0U)
+#define LOG_CLASSES_2(a, b)     (LOG_CLASSES_1(a) | LOG_C(b, 1U))
+#define LOG_CLASSES_3(a, b, c)  (LOG_CLASSES_2(a, b) | LOG_C(c, 2U))
+#define LOG_CLASSES_4(a, b, c, d) (LOG_CLASSES_3(a, b, c) | LOG_C(d, 3U))
+#define LOG_CLASSES_5(a, b, c, d, e) (LOG_CLASSES_4(a, b, c, d) | LOG_C(e, 4U))
+#define LOG_CLASSES_6(a, b, c, d, e, f) (LOG_CLASSES_5(a, b, c, d, e) | LOG_C(f, 5U))
+#define LOG_CLASSES_7(a, b, c, d, e, f, g) (LOG_CLASSES_6(a, b, c, d, e, f) | LOG_C(g, 6U))
+#define LOG_CLASSES_8(a, b, c, d, e, f, g, h) (LOG_CLASSES_7(a, b, c, d, e, f, g) | LOG_C(h, 7U))
+
+/* Count in bits 0-3, then the class of each argument */
+#define LOG_ARGS_WORD(...)                                                  \
+    ((uint32_t)LOG_NARGS(__VA_ARGS__) | LOG_CAT(LOG_CLASSES_, LOG_NARGS(__VA_ARGS__))(__VA_ARGS__))
+
+/* Checks the format against the arguments, compiles to nothing */
+static inline __attribute__((format(printf, 1, 2))) void Log_CheckFormat(const char *format, ...)
+{
+    (void)format;
+}
+
+#if LOG_TOKENIZED == 1
+/**
+ * @brief  Send the frame of a LOG_xxx call, whole or not at all (Log_Write)
+ * @param  format  string of the log_fmt section
+ * @param  args    LOG_ARGS_WORD of the arguments
+ */
+void Log_Token(const char *format, uint32_t args, ...);
+
+#define LOG_PRINT(format, ...)                                              \
+    do {                                                                    \
+        static const char logFormat[] __attribute__((section("log_fmt"))) = format; \
+        if (0) { Log_CheckFormat(format, ##__VA_ARGS__); }                  \
+        Log_Token(logFormat, LOG_ARGS_WORD(__VA_ARGS__), ##__VA_ARGS__);    \
+    } while (0)
+#else
+#define LOG_PRINT(format, ...)  (void)printf(format, ##__VA_ARGS__)
+#endif
+
+/* A removed level keeps its arguments checked and used, without code */
+#define LOG_SKIP(format, ...)                                               \
+    do { if (0) { Log_CheckFormat(format, ##__VA_ARGS__); } } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERR
+#define LOG_ERR(...)            LOG_PRINT(__VA_ARGS__)
+#else
+#define LOG_ERR(...)            LOG_SKIP(__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WRN
+#define LOG_WRN(...)            LOG_PRINT(__VA_ARGS__)
+#else
+#define LOG_WRN(...)            LOG_SKIP(__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INF
+#define LOG_INF(...)            LOG_PRINT(__VA_ARGS__)
+#else
+#define LOG_INF(...)            LOG_SKIP(__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DBG
+#define LOG_DBG(...)            LOG_PRINT(__VA_ARGS__)
+#else
+#define LOG_DBG(...)            LOG_SKIP(__VA_ARGS__)
+#endif
+
+#endif /* LOG_H */
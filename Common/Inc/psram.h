@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ * @file    psram.h
+ * @brief   External PSRAM on XSPI1 in memory-mapped mode: OTA mailbox of the
+ *          Boot, heap of the large buffers and bandwidth benchmark
+ ******************************************************************************
+ */
+
+#ifndef PSRAM_H
+#define PSRAM_H
+
+#include "main.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 1 in the preprocessor symbols of both the Boot and the Appli when the
+ * board carries the PSRAM: PSRAM_Init() brings up EXTMEMORY_2 (the PSRAM
+ * driver of the .ioc) and the Appli downloads the OTA file into the mailbox */
+#ifndef PSRAM_ENABLE
+#define PSRAM_ENABLE            0
+#endif
+
+/* Set to 1 to measure the PSRAM bandwidth at start-up (Appli) */
+#ifndef PSRAM_BENCH
+#define PSRAM_BENCH             0
+#endif
+
+/* APS256XXN: 256Mbit, 16 lines DTR on XSPIM port 1 */
+#define PSRAM_BASE              0x90000000U     /* XSPI1 memory-mapped window */
+#define PSRAM_SIZE              0x02000000U     /* 32MB */
+#define PSRAM_FREQ_MAX          200000000U
+
+/* Map of the PSRAM, seen the same way by the Boot and the Appli */
+#define PSRAM_MAILBOX_ADDR      PSRAM_BASE      /* OTA file: 16-byte header, then the image */
+#define PSRAM_MAILBOX_SIZE      0x01000000U     /* 16MB: a slot and its header */
+#define PSRAM_HEAP_ADDR         (PSRAM_BASE + PSRAM_MAILBOX_SIZE)
+#define PSRAM_HEAP_SIZE         (PSRAM_SIZE - PSRAM_MAILBOX_SIZE)
+
+/* Region 0 of MPU_Config forbids 0x60000000-0xDFFFFFFF, region 1 is the slot */
+#define PSRAM_MPU_REGION        MPU_REGION_NUMBER2
+
+#define PSRAM_BENCH_SIZE        0x00100000U     /* 1MB, taken from the heap */
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef struct {
+    uint32_t writeKBps;         /* words written, then the D-cache cleaned */
+    uint32_t readKBps;          /* words read from a cold D-cache */
+    uint32_t copyKBps;          /* memcpy from the PSRAM to AXI SRAM, 4KB at a time */
+    uint32_t errors;            /* words read back different from the pattern */
+} PSRAM_Bench_Result_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Bring up XSPI1 and the PSRAM, enable the memory-mapped mode and the
+ *         MPU region, then check a line at the end of the heap
+ * @note   The contents are kept: the mailbox survives the reset to the Boot.
+ *         Call after MX_EXTMEM_MANAGER_Init(), which clears the memory list.
+ * @retval 0 on success, -1 if the PSRAM does not answer
+ */
+int PSRAM_Init(void);
+
+/**
+ * @brief  Check that PSRAM_Init() succeeded
+ */
+uint8_t PSRAM_IsReady(void);
+
+/**
+ * @brief  Allocate a buffer in the PSRAM heap, aligned on a 32-byte D-cache line
+ * @retval NULL if the PSRAM is not ready or no free block is large enough
+ */
+void *PSRAM_Malloc(uint32_t size);
+
+/**
+ * @brief  Release a buffer of PSRAM_Malloc(), NULL is ignored
+ */
+void PSRAM_Free(void *ptr);
+
+/**
+ * @brief  Measure the write, read and copy bandwidth over PSRAM_BENCH_SIZE
+ *         bytes of the heap, the caller prints the result
+ * @retval 0 if the data read back matches, -1 otherwise
+ */
+int PSRAM_Bench_Run(PSRAM_Bench_Result_t *result);
+
+#endif /* PSRAM_H */
@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ * @file    trace.h
+ * @brief   Span tracing on the DWT cycle counter: event ring in DTCM, binary
+ *          dump on UART4, decoded into Chrome trace JSON by tools/trace_decode
+ *
+ * TRACE_BEGIN and TRACE_END record a static span ID, a 32-bit argument, the
+ * cycle counter and the HAL tick. Built with TRACE_ENABLE 0 (the default),
+ * the macros and the ring are removed. The Boot and the Appli both build
+ * this file (Common/): the decoder names the spans from this list.
+ ******************************************************************************
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Set to 1 to record the spans (development builds) */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE            0
+#endif
+
+/* Events kept in the ring, a power of two: the oldest are overwritten.
+ * 2048 (24KB of DTCM) hold a 256KB download in 330-byte chunks. */
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE         2048U
+#endif
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+/* Span IDs: arguments of the begin and of the end event */
+typedef enum {
+    TRACE_ID_NONE = 0,
+    TRACE_ID_BOOT_UPDATE,       /* OTA_Bootloader_Process: -, slot address */
+    TRACE_ID_EXTMEM_INIT,       /* EXTMEM_Init: -, status (0 in the Boot) */
+    TRACE_ID_FLASH_ERASE,       /* erase of a range: flash address, size */
+    TRACE_ID_FLASH_PROGRAM,     /* program of a range: flash address, size */
+    TRACE_ID_FLASH_VERIFY,      /* read-back of an image: flash address, status */
+    TRACE_ID_CRC,               /* CRC-32 of an image: size, CRC */
+    TRACE_ID_USB_ENUM,          /* device connected to CDC class active: -, - */
+    TRACE_ID_AT_COMMAND,        /* AT command: tag (TRACE_TAG), Modem_Status_t */
+    TRACE_ID_OTA_DOWNLOAD,      /* OTA_TestDownload: -, Modem_Status_t */
+    TRACE_ID_OTA_CHUNK,         /* AT+HTTPREAD of one chunk: file offset, bytes read */
+    TRACE_ID_COUNT
+} Trace_Id_t;
+
+/* Image that made the dump */
+#define TRACE_IMAGE_BOOT        1U
+#define TRACE_IMAGE_APPLI       2U
+
+/* Set in the ID of the event that ends a span */
+#define TRACE_END_FLAG          0x8000U
+
+typedef struct {
+    uint32_t cycles;            /* DWT->CYCCNT */
+    uint32_t arg;
+    uint16_t tick;              /* HAL_GetTick, low bits: the decoder unwraps the cycles with it */
+    uint16_t id;                /* Trace_Id_t, TRACE_END_FLAG on the end of a span */
+} Trace_Event_t;
+
+/*
+ * Dump on UART4, little endian, between the text lines of the log:
+ * the header, count events oldest first, then the 32-bit sum of the header
+ * and event words. A dump holds the events recorded since the previous one.
+ * The decoder finds it by its magic.
+ */
+#define TRACE_DUMP_MAGIC        0x31435254U     /* "TRC1" */
+
+typedef struct {
+    uint32_t magic;
+    uint8_t  image;             /* TRACE_IMAGE_* */
+    uint8_t  eventSize;         /* sizeof(Trace_Event_t) */
+    uint16_t count;             /* events that follow */
+    uint32_t coreClock;         /* SystemCoreClock in Hz: cycles to time */
+    uint32_t lost;              /* events overwritten before this dump */
+} Trace_DumpHeader_t;
+
+/* Up to 4 characters packed in an argument, first one in the low byte */
+#define TRACE_TAG(_A_, _B_, _C_, _D_)                                          \
+    ((uint32_t)(uint8_t)(_A_) | ((uint32_t)(uint8_t)(_B_) << 8) |              \
+     ((uint32_t)(uint8_t)(_C_) << 16) | ((uint32_t)(uint8_t)(_D_) << 24))
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+#if TRACE_ENABLE == 1
+
+#include "main.h"
+
+typedef struct {
+    volatile uint32_t head;     /* events recorded since Trace_Init */
+    uint32_t sent;              /* head at the end of the last dump */
+    Trace_Event_t events[TRACE_RING_SIZE];
+} Trace_Ring_t;
+
+extern Trace_Ring_t traceRing;
+
+/**
+ * @brief  Record one event. The slot is taken with LDREX/STREX, so an
+ *         interrupt that records between the slot and the time stamp gets
+ *         the next slot; the decoder puts the events back in time order.
+ */
+static inline void Trace_Record(uint16_t id, uint32_t arg)
+{
+    uint32_t slot = __atomic_fetch_add(&traceRing.head, 1U, __ATOMIC_RELAXED) & (TRACE_RING_SIZE - 1U);
+    Trace_Event_t *event = &traceRing.events[slot];
+
+    event->cycles = DWT->CYCCNT;
+    event->tick = (uint16_t)HAL_GetTick();
+    event->arg = arg;
+    event->id = id;
+}
+
+#define TRACE_BEGIN(_ID_, _ARG_)  Trace_Record((uint16_t)(_ID_), (uint32_t)(_ARG_))
+#define TRACE_END(_ID_, _ARG_)    Trace_Record((uint16_t)((_ID_) | TRACE_END_FLAG), (uint32_t)(_ARG_))
+
+/**
+ * @brief  Start the cycle counter (it is not cleared) and empty the ring
+ * @param  image: TRACE_IMAGE_BOOT or TRACE_IMAGE_APPLI
+ */
+void Trace_Init(uint8_t image);
+
+/**
+ * @brief  Send the events recorded since the last dump on the UART, blocking
+ */
+void Trace_Dump(UART_HandleTypeDef *huart);
+
+#else
+
+#define TRACE_BEGIN(_ID_, _ARG_)  ((void)0)
+#define TRACE_END(_ID_, _ARG_)    ((void)0)
+#define Trace_Init(_IMAGE_)       ((void)0)
+#define Trace_Dump(_HUART_)       ((void)0)
+
+#endif /* TRACE_ENABLE == 1 */
+
+#endif /* TRACE_H */
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    xip_record.h
+ * @brief   XIP profiles of XSPI2 and their backup SRAM record: the Appli
+ *          benchmark requests a profile, the Boot sets it before the jump,
+ *          the Appli OTA staging sets it again after its EXTMEM_Init
+ ******************************************************************************
+ */
+
+#ifndef XIP_RECORD_H
+#define XIP_RECORD_H
+
+#include "stm32_extmem_conf.h"
+#include "stm32_sfdp_driver_api.h"
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          CONFIGURATION                                     */
+/*============================================================================*/
+
+/* Memory clock cycles without access before nCS is released (timeout profiles) */
+#define XIP_PROFILE_TIMEOUT         32U
+
+/* Record in backup SRAM, after the SFDP cache and the timing record of the
+ * ExtMem Manager (checked in xip_record.c) */
+#define XIP_PROFILE_RECORD_ADDR     (BKPSRAM_BASE + 0x0440U)
+#define XIP_PROFILE_MAGIC           0x58495031U     /* "XIP1" */
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+/* XSPI side of the profile */
+typedef enum {
+    XIP_PROFILE_LINEAR = 0,         /* linear bursts, prefetch until the next jump */
+    XIP_PROFILE_LINEAR_TIMEOUT,     /* linear bursts, prefetch stopped after XIP_PROFILE_TIMEOUT */
+    XIP_PROFILE_WRAP32,             /* 32-byte wrapped line fills, prefetch until the next jump */
+    XIP_PROFILE_WRAP32_TIMEOUT,     /* 32-byte wrapped line fills, prefetch stopped after XIP_PROFILE_TIMEOUT */
+    XIP_PROFILE_COUNT
+} XIP_Profile_t;
+
+/* MPU side of the profile: cache policy of the slots, set by the Appli */
+typedef enum {
+    XIP_MPU_NOT_CACHEABLE = 0,      /* reference: every fetch goes to the XSPI */
+    XIP_MPU_WRITE_THROUGH,          /* read allocate, writes go through */
+    XIP_MPU_WRITE_BACK,             /* read allocate, writes kept in the cache */
+    XIP_MPU_WRITE_BACK_WA,          /* read and write allocate */
+    XIP_MPU_COUNT
+} XIP_Mpu_t;
+
+/* Benchmark state of the record */
+typedef enum {
+    XIP_SWEEP_NONE = 0,
+    XIP_SWEEP_RUNNING,              /* one XSPI profile measured per boot */
+    XIP_SWEEP_DONE                  /* best profile stored */
+} XIP_Sweep_t;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t  profile;               /* XIP_Profile_t requested by the Appli */
+    uint8_t  mpu;                   /* XIP_Mpu_t applied at start-up by the Appli */
+    uint8_t  sweep;                 /* XIP_Sweep_t, owned by the Appli */
+    uint8_t  applied;               /* XIP_Profile_t the Boot actually set */
+    uint32_t cycles[XIP_PROFILE_COUNT][XIP_MPU_COUNT];  /* benchmark results, 0 = not measured */
+    uint32_t check;                 /* complement of the sum of the previous words */
+} XIP_Profile_Record_t;
+
+_Static_assert(sizeof(XIP_Profile_Record_t) == (12U + (4U * XIP_PROFILE_COUNT * XIP_MPU_COUNT)),
+               "XIP record layout changed: a Boot and an Appli of different builds would disagree");
+
+#define XIP_RECORD ((XIP_Profile_Record_t *)XIP_PROFILE_RECORD_ADDR)
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Check word of a record
+ */
+uint32_t XIP_Record_Check(const XIP_Profile_Record_t *record);
+
+/**
+ * @brief  Driver profile: map configuration of the XSPI and burst length
+ *         steps of the MX25UW25645G, for the 8 lines link
+ */
+const EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef *XIP_Profile_Get(XIP_Profile_t profile);
+
+/**
+ * @brief  Name of a profile for the logs
+ */
+const char *XIP_Profile_Name(XIP_Profile_t profile);
+
+#endif /* XIP_RECORD_H */
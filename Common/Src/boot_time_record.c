@@ -0,0 +1,34 @@
+/**
+ ******************************************************************************
+ * @file    boot_time_record.c
+ * @brief   Boot-time record in backup SRAM - STM32H7S3
+ ******************************************************************************
+ */
+
+#include "boot_time_record.h"
+#include "xip_record.h"
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+_Static_assert(BOOT_TIME_RECORD_ADDR >= (XIP_PROFILE_RECORD_ADDR + sizeof(XIP_Profile_Record_t)),
+               "Boot-time record overlaps the XIP profile record");
+_Static_assert((BOOT_TIME_RECORD_ADDR + sizeof(Boot_Time_Record_t)) <= (BKPSRAM_BASE + BKPSRAM_SIZE),
+               "Boot-time record does not fit in the backup SRAM");
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+uint32_t Boot_Time_Check(const Boot_Time_Record_t *record)
+{
+    const uint32_t *words = (const uint32_t *)record;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < (offsetof(Boot_Time_Record_t, check) / sizeof(uint32_t)); i++)
+    {
+        sum += words[i];
+    }
+    return ~sum;
+}
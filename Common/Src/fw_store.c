@@ -0,0 +1,631 @@
+/**
+ ******************************************************************************
+ * @file    fw_store.c
+ * @brief   Firmware image store on the eMMC
+ *
+ * Three slots of 16MB hold the current image (installed in Slot B), the
+ * previous one (the rollback image) and a candidate. A directory block
+ * maps the roles to the slots and keeps the header of each image; it is
+ * written to LBA 0 and 1 in turn, so a reset during a write leaves the
+ * other copy. The images are moved with SDMMC1 IDMA multi-block transfers:
+ * the download fills one buffer while the other is written, the readers
+ * queue the next read before using the data of the last one. Nothing is
+ * printed here, the callers report the status. The Boot builds the reader
+ * half only (FW_STORE_WRITER 0): the download and its buffers are the Appli's.
+ *
+ * The ExtMem Manager SDCARD driver is not used: its MMC link has no SAL in
+ * this tree and no write or erase path.
+ ******************************************************************************
+ */
+
+#include "fw_store.h"
+
+#if FW_STORE_ENABLE == 1
+
+#include <stddef.h>
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DEFINITIONS                               */
+/*============================================================================*/
+
+#define FW_STORE_BUFFER_SIZE    (FW_STORE_WRITE_BLOCKS * FW_STORE_BLOCK_SIZE)
+#define FW_STORE_SLOT_BYTES     (FW_STORE_SLOT_BLOCKS * FW_STORE_BLOCK_SIZE)
+
+#if FW_STORE_WRITER == 1
+/* Download in progress */
+typedef struct {
+    uint8_t  active;
+    uint8_t  slot;
+    uint8_t  fill;              /* Buffer being filled, the other may be in flight */
+    uint32_t fileSize;
+    uint32_t received;          /* File bytes received, header included */
+    uint32_t bufLen;            /* Bytes in writeBuf[fill] */
+    uint32_t nextLba;
+    uint8_t  header[FW_STORE_HEADER_SIZE];
+} FW_Store_Session_t;
+#endif /* FW_STORE_WRITER == 1 */
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+static MMC_HandleTypeDef *storeMmc;
+static FW_Store_Dir_t storeDir;
+static uint8_t storeReady = 0;
+
+/* Directory block, read and written by polling */
+static uint32_t dirBlock[FW_STORE_BLOCK_SIZE / 4] __attribute__((aligned(32)));
+
+#if FW_STORE_WRITER == 1
+static FW_Store_Session_t session;
+
+/* Download and read-back buffers, used in turn by the IDMA */
+static uint8_t storeBuf[2][FW_STORE_BUFFER_SIZE] __attribute__((aligned(32)));
+#endif
+
+/* Transfer in flight, completed by the SDMMC1 interrupt */
+static volatile uint8_t xferBusy;
+static volatile uint8_t xferError;
+static uint8_t *readBuf;
+static uint32_t readLen;
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+static uint32_t FW_Store_UpdateCRC32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t j = 0; j < 8; j++)
+        {
+            if (crc & 1)
+                crc = (crc >> 1) ^ 0xEDB88320;
+            else
+                crc >>= 1;
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t FW_Store_DirCrc(const FW_Store_Dir_t *dir)
+{
+    return FW_Store_UpdateCRC32(0xFFFFFFFF, (const uint8_t *)dir, offsetof(FW_Store_Dir_t, crc)) ^ 0xFFFFFFFF;
+}
+
+static uint8_t FW_Store_DirValid(const FW_Store_Dir_t *dir)
+{
+    if ((dir->magic != FW_STORE_MAGIC) || (dir->crc != FW_Store_DirCrc(dir)))
+    {
+        return 0;
+    }
+
+    for (uint32_t role = 0; role < FW_STORE_ROLE_COUNT; role++)
+    {
+        if ((dir->role[role] != FW_STORE_NONE) && (dir->role[role] >= FW_STORE_SLOT_COUNT))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief  Wait for the card to leave the programming state
+ */
+static FW_Store_Status_t FW_Store_WaitCard(void)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (HAL_MMC_GetCardState(storeMmc) != HAL_MMC_CARD_TRANSFER)
+    {
+        if ((HAL_GetTick() - start) > FW_STORE_TIMEOUT_MS)
+        {
+            return FW_STORE_ERROR;
+        }
+    }
+
+    return FW_STORE_OK;
+}
+
+/**
+ * @brief  Wait for the IDMA transfer in flight, if any
+ */
+static FW_Store_Status_t FW_Store_Wait(void)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (xferBusy != 0U)
+    {
+        if ((HAL_GetTick() - start) > FW_STORE_TIMEOUT_MS)
+        {
+            (void)HAL_MMC_Abort(storeMmc);
+            xferError = 1;
+            xferBusy = 0;
+        }
+    }
+
+    if (xferError != 0U)
+    {
+        xferError = 0;
+        return FW_STORE_ERROR;
+    }
+
+    return FW_Store_WaitCard();
+}
+
+static FW_Store_Status_t FW_Store_ReadDir(uint32_t lba, FW_Store_Dir_t *dir)
+{
+    if (HAL_MMC_ReadBlocks(storeMmc, (uint8_t *)dirBlock, lba, 1, FW_STORE_TIMEOUT_MS) != HAL_OK)
+    {
+        return FW_STORE_ERROR;
+    }
+
+    memcpy(dir, dirBlock, sizeof(*dir));
+    return FW_Store_DirValid(dir) ? FW_STORE_OK : FW_STORE_INVALID_FW;
+}
+
+/**
+ * @brief  Write the directory over its older copy
+ */
+static FW_Store_Status_t FW_Store_WriteDir(void)
+{
+    FW_Store_Status_t status = FW_Store_Wait();
+
+    if (status != FW_STORE_OK)
+    {
+        return status;
+    }
+
+    storeDir.sequence++;
+    storeDir.crc = FW_Store_DirCrc(&storeDir);
+
+    memset(dirBlock, 0, sizeof(dirBlock));
+    memcpy(dirBlock, &storeDir, sizeof(storeDir));
+
+    if (HAL_MMC_WriteBlocks(storeMmc, (const uint8_t *)dirBlock, FW_STORE_DIR_LBA + (storeDir.sequence & 1U),
+                            1, FW_STORE_TIMEOUT_MS) != HAL_OK)
+    {
+        return FW_STORE_ERROR;
+    }
+
+    return FW_Store_WaitCard();
+}
+
+static uint8_t FW_Store_RoleSlot(FW_Store_Role_t role)
+{
+    if ((storeReady == 0U) || ((uint32_t)role >= FW_STORE_ROLE_COUNT))
+    {
+        return FW_STORE_NONE;
+    }
+    return storeDir.role[role];
+}
+
+static FW_Store_Status_t FW_Store_ReadSlotStart(uint8_t slot, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    FW_Store_Status_t status;
+
+    if (((offset % FW_STORE_BLOCK_SIZE) != 0U) || ((len % FW_STORE_BLOCK_SIZE) != 0U) ||
+        (len == 0U) || (offset > FW_STORE_SLOT_BYTES) || (len > (FW_STORE_SLOT_BYTES - offset)))
+    {
+        return FW_STORE_INVALID_FW;
+    }
+
+    status = FW_Store_Wait();
+    if (status != FW_STORE_OK)
+    {
+        return status;
+    }
+
+    /* No dirty line of the buffer may be evicted over the IDMA data */
+    SCB_InvalidateDCache_by_Addr(buf, (int32_t)len);
+    readBuf = buf;
+    readLen = len;
+
+    xferBusy = 1;
+    if (HAL_MMC_ReadBlocks_DMA(storeMmc, buf, FW_STORE_SLOT_LBA(slot) + (offset / FW_STORE_BLOCK_SIZE),
+                               len / FW_STORE_BLOCK_SIZE) != HAL_OK)
+    {
+        xferBusy = 0;
+        return FW_STORE_ERROR;
+    }
+
+    return FW_STORE_OK;
+}
+
+#if FW_STORE_WRITER == 1
+/**
+ * @brief  CRC-32 of the first fwSize bytes of a slot: the IDMA reads the
+ *         next buffer while the CPU goes over the last one
+ */
+static FW_Store_Status_t FW_Store_SlotCrc(uint8_t slot, uint32_t fwSize, uint32_t *crc)
+{
+    FW_Store_Status_t status;
+    uint32_t value = 0xFFFFFFFF;
+    uint32_t offset = 0;
+    uint8_t current = 0;
+
+    status = FW_Store_ReadSlotStart(slot, 0, storeBuf[0], FW_STORE_BUFFER_SIZE);
+
+    while ((status == FW_STORE_OK) && (offset < fwSize))
+    {
+        uint32_t len = fwSize - offset;
+
+        if (len > FW_STORE_BUFFER_SIZE)
+        {
+            len = FW_STORE_BUFFER_SIZE;
+        }
+
+        status = FW_Store_ReadWait();
+        if ((status == FW_STORE_OK) && ((offset + len) < fwSize))
+        {
+            status = FW_Store_ReadSlotStart(slot, offset + FW_STORE_BUFFER_SIZE,
+                                            storeBuf[current ^ 1U], FW_STORE_BUFFER_SIZE);
+        }
+        if (status == FW_STORE_OK)
+        {
+            value = FW_Store_UpdateCRC32(value, storeBuf[current], len);
+            offset += len;
+            current ^= 1U;
+        }
+    }
+
+    if (status != FW_STORE_OK)
+    {
+        (void)FW_Store_Wait();
+        return status;
+    }
+
+    *crc = value ^ 0xFFFFFFFF;
+    return FW_STORE_OK;
+}
+
+/**
+ * @brief  Queue the IDMA write of the buffer being filled and switch buffers
+ */
+static FW_Store_Status_t FW_Store_Flush(void)
+{
+    uint8_t *buf = storeBuf[session.fill];
+    uint32_t blocks = (session.bufLen + FW_STORE_BLOCK_SIZE - 1U) / FW_STORE_BLOCK_SIZE;
+    FW_Store_Status_t status;
+
+    if (session.bufLen == 0U)
+    {
+        return FW_STORE_OK;
+    }
+
+    /* The last block of the image is padded */
+    memset(&buf[session.bufLen], 0xFF, (blocks * FW_STORE_BLOCK_SIZE) - session.bufLen);
+
+    status = FW_Store_Wait();
+    if (status != FW_STORE_OK)
+    {
+        return status;
+    }
+
+    SCB_CleanDCache_by_Addr((uint32_t *)buf, (int32_t)(blocks * FW_STORE_BLOCK_SIZE));
+
+    xferBusy = 1;
+    if (HAL_MMC_WriteBlocks_DMA(storeMmc, buf, session.nextLba, blocks) != HAL_OK)
+    {
+        xferBusy = 0;
+        return FW_STORE_ERROR;
+    }
+
+    session.nextLba += blocks;
+    session.fill ^= 1U;
+    session.bufLen = 0;
+
+    return FW_STORE_OK;
+}
+#endif /* FW_STORE_WRITER == 1 */
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+FW_Store_Status_t FW_Store_Init(MMC_HandleTypeDef *hmmc)
+{
+    FW_Store_Dir_t copy;
+    uint8_t found = 0;
+
+    storeMmc = hmmc;
+    storeReady = 0;
+#if FW_STORE_WRITER == 1
+    session.active = 0;
+#endif
+    xferBusy = 0;
+    xferError = 0;
+
+    for (uint32_t i = 0; i < 2U; i++)
+    {
+        if ((FW_Store_ReadDir(FW_STORE_DIR_LBA + i, &copy) == FW_STORE_OK) &&
+            ((found == 0U) || ((int32_t)(copy.sequence - storeDir.sequence) > 0)))
+        {
+            storeDir = copy;
+            found = 1;
+        }
+    }
+
+    if (found == 0U)
+    {
+        /* Blank or foreign card: start with an empty store */
+        memset(&storeDir, 0, sizeof(storeDir));
+        storeDir.magic = FW_STORE_MAGIC;
+        memset(storeDir.role, FW_STORE_NONE, sizeof(storeDir.role));
+
+        if (FW_Store_WriteDir() != FW_STORE_OK)
+        {
+            return FW_STORE_ERROR;
+        }
+    }
+
+    storeReady = 1;
+    return FW_STORE_OK;
+}
+
+const FW_Store_Image_t *FW_Store_GetImage(FW_Store_Role_t role)
+{
+    uint8_t slot = FW_Store_RoleSlot(role);
+
+    return (slot == FW_STORE_NONE) ? NULL : &storeDir.image[slot];
+}
+
+#if FW_STORE_WRITER == 1
+FW_Store_Status_t FW_Store_Begin(uint32_t fileSize)
+{
+    uint8_t slot = 0;
+
+    if (storeReady == 0U)
+    {
+        return FW_STORE_NOT_READY;
+    }
+    if ((fileSize <= FW_STORE_HEADER_SIZE) || ((fileSize - FW_STORE_HEADER_SIZE) > FW_STORE_SLOT_BYTES))
+    {
+        return FW_STORE_INVALID_FW;
+    }
+
+    /* The slot of no current or previous image */
+    while ((slot == storeDir.role[FW_STORE_CURRENT]) || (slot == storeDir.role[FW_STORE_PREVIOUS]))
+    {
+        slot++;
+    }
+
+    /* A reset during the download must not leave a half-written candidate */
+    if (storeDir.role[FW_STORE_CANDIDATE] != FW_STORE_NONE)
+    {
+        FW_Store_Status_t status = FW_Store_Discard();
+
+        if (status != FW_STORE_OK)
+        {
+            return status;
+        }
+    }
+
+    memset(&session, 0, sizeof(session));
+    session.active = 1;
+    session.slot = slot;
+    session.fileSize = fileSize;
+    session.nextLba = FW_STORE_SLOT_LBA(slot);
+
+    return FW_STORE_OK;
+}
+
+FW_Store_Status_t FW_Store_Write(uint32_t fileOffset, const uint8_t *data, uint32_t len)
+{
+    if (session.active == 0U)
+    {
+        return FW_STORE_NOT_READY;
+    }
+    if ((fileOffset != session.received) || (len > (session.fileSize - session.received)))
+    {
+        return FW_STORE_INVALID_FW;
+    }
+
+    while (len > 0U)
+    {
+        uint32_t n;
+
+        if (session.received < FW_STORE_HEADER_SIZE)
+        {
+            n = FW_STORE_HEADER_SIZE - session.received;
+            n = (n < len) ? n : len;
+            memcpy(&session.header[session.received], data, n);
+        }
+        else
+        {
+            n = FW_STORE_BUFFER_SIZE - session.bufLen;
+            n = (n < len) ? n : len;
+            memcpy(&storeBuf[session.fill][session.bufLen], data, n);
+            session.bufLen += n;
+
+            if (session.bufLen == FW_STORE_BUFFER_SIZE)
+            {
+                FW_Store_Status_t status = FW_Store_Flush();
+
+                if (status != FW_STORE_OK)
+                {
+                    session.active = 0;
+                    return status;
+                }
+            }
+        }
+
+        session.received += n;
+        data += n;
+        len -= n;
+    }
+
+    return FW_STORE_OK;
+}
+
+FW_Store_Status_t FW_Store_Finish(void)
+{
+    FW_Store_Image_t image;
+    FW_Store_Status_t status;
+    uint32_t crc;
+
+    if (session.active == 0U)
+    {
+        return FW_STORE_NOT_READY;
+    }
+    session.active = 0;
+
+    if (session.received != session.fileSize)
+    {
+        return FW_STORE_INVALID_FW;
+    }
+
+    status = FW_Store_Flush();
+    if (status == FW_STORE_OK)
+    {
+        status = FW_Store_Wait();
+    }
+    if (status != FW_STORE_OK)
+    {
+        return status;
+    }
+
+    memcpy(&image, session.header, sizeof(image));
+    if ((image.magic != FW_STORE_FILE_MAGIC) || ((image.fwSize + FW_STORE_HEADER_SIZE) != session.fileSize))
+    {
+        return FW_STORE_INVALID_FW;
+    }
+
+    status = FW_Store_SlotCrc(session.slot, image.fwSize, &crc);
+    if (status != FW_STORE_OK)
+    {
+        return status;
+    }
+    if (crc != image.crc)
+    {
+        return FW_STORE_VERIFY_ERROR;
+    }
+
+    storeDir.image[session.slot] = image;
+    storeDir.role[FW_STORE_CANDIDATE] = session.slot;
+
+    return FW_Store_WriteDir();
+}
+
+FW_Store_Status_t FW_Store_ImageCrc(FW_Store_Role_t role, uint32_t *crc)
+{
+    uint8_t slot = FW_Store_RoleSlot(role);
+
+    if (slot == FW_STORE_NONE)
+    {
+        return FW_STORE_NO_IMAGE;
+    }
+
+    return FW_Store_SlotCrc(slot, storeDir.image[slot].fwSize, crc);
+}
+#endif /* FW_STORE_WRITER == 1 */
+
+FW_Store_Status_t FW_Store_ReadStart(FW_Store_Role_t role, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    uint8_t slot = FW_Store_RoleSlot(role);
+
+    if (slot == FW_STORE_NONE)
+    {
+        return FW_STORE_NO_IMAGE;
+    }
+
+    return FW_Store_ReadSlotStart(slot, offset, buf, len);
+}
+
+FW_Store_Status_t FW_Store_ReadWait(void)
+{
+    FW_Store_Status_t status = FW_Store_Wait();
+
+    if ((status == FW_STORE_OK) && (readBuf != NULL))
+    {
+        /* Lines of the buffer the CPU fetched during the transfer */
+        SCB_InvalidateDCache_by_Addr(readBuf, (int32_t)readLen);
+    }
+    readBuf = NULL;
+
+    return status;
+}
+
+FW_Store_Status_t FW_Store_Commit(void)
+{
+    uint8_t previous = FW_Store_RoleSlot(FW_STORE_PREVIOUS);
+
+    if (FW_Store_RoleSlot(FW_STORE_CANDIDATE) == FW_STORE_NONE)
+    {
+        return FW_STORE_NO_IMAGE;
+    }
+
+    if (previous != FW_STORE_NONE)
+    {
+        storeDir.image[previous].magic = 0;
+    }
+    storeDir.role[FW_STORE_PREVIOUS] = storeDir.role[FW_STORE_CURRENT];
+    storeDir.role[FW_STORE_CURRENT] = storeDir.role[FW_STORE_CANDIDATE];
+    storeDir.role[FW_STORE_CANDIDATE] = FW_STORE_NONE;
+
+    return FW_Store_WriteDir();
+}
+
+FW_Store_Status_t FW_Store_Rollback(void)
+{
+    uint8_t current = FW_Store_RoleSlot(FW_STORE_CURRENT);
+
+    if (FW_Store_RoleSlot(FW_STORE_PREVIOUS) == FW_STORE_NONE)
+    {
+        return FW_STORE_NO_IMAGE;
+    }
+
+    if (current != FW_STORE_NONE)
+    {
+        storeDir.image[current].magic = 0;
+    }
+    storeDir.role[FW_STORE_CURRENT] = storeDir.role[FW_STORE_PREVIOUS];
+    storeDir.role[FW_STORE_PREVIOUS] = FW_STORE_NONE;
+
+    return FW_Store_WriteDir();
+}
+
+FW_Store_Status_t FW_Store_Discard(void)
+{
+    uint8_t candidate = FW_Store_RoleSlot(FW_STORE_CANDIDATE);
+
+    if (candidate == FW_STORE_NONE)
+    {
+        return FW_STORE_NO_IMAGE;
+    }
+
+    storeDir.image[candidate].magic = 0;
+    storeDir.role[FW_STORE_CANDIDATE] = FW_STORE_NONE;
+
+    return FW_Store_WriteDir();
+}
+
+/*============================================================================*/
+/*                          HAL CALLBACKS                                     */
+/*============================================================================*/
+
+void HAL_MMC_TxCpltCallback(MMC_HandleTypeDef *hmmc)
+{
+    (void)hmmc;
+    xferBusy = 0;
+}
+
+void HAL_MMC_RxCpltCallback(MMC_HandleTypeDef *hmmc)
+{
+    (void)hmmc;
+    xferBusy = 0;
+}
+
+void HAL_MMC_ErrorCallback(MMC_HandleTypeDef *hmmc)
+{
+    (void)hmmc;
+    xferError = 1;
+    xferBusy = 0;
+}
+
+#endif /* FW_STORE_ENABLE == 1 */
@@ -0,0 +1,420 @@
+/**
+ ******************************************************************************
+ * @file    log.c
+ * @brief   UART4 log: ring buffer sent by DMA
+ *
+ * One writer copies at a time: Log_Write takes the ring with an atomic
+ * exchange, and a write from an interrupt that finds it taken is dropped
+ * instead of waiting. The transfer is started by whoever sees the channel
+ * idle with bytes pending, a writer or the end of the previous transfer;
+ * the writer publishes its bytes before it looks at the channel and the end
+ * of a transfer frees the channel before it looks at the bytes, so no write
+ * is left waiting. The ring is in AXI SRAM, which the GPDMA reads; the lines
+ * of a transfer are cleaned from the D-cache before it starts.
+ *
+ * Log_Token reads the arguments of a LOG_xxx call by their class, given
+ * by the macro, and never looks at the format: the offset of the format in
+ * log_fmt is a link-time constant.
+ ******************************************************************************
+ */
+
+#include "log.h"
+#include <stdarg.h>
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+static UART_HandleTypeDef *logUart;
+static Log_Stats_t logStats;
+
+#if LOG_TOKENIZED == 1
+/* Start of the log_fmt section (linker script, or ld for an orphan section) */
+extern const char __start_log_fmt[];
+#endif
+
+#if LOG_ASYNC == 1
+
+_Static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1U)) == 0U, "LOG_RING_SIZE must be a power of two");
+_Static_assert((LOG_RING_SIZE >= 32U) && (LOG_RING_SIZE <= 32768U), "LOG_RING_SIZE: cache lines, 16-bit DMA length");
+
+#define LOG_CACHE_LINE          32U
+
+/* Bound of the register polling of Log_FaultFlush */
+#define LOG_FAULT_SPIN          100000U
+
+typedef struct {
+    uint8_t data[LOG_RING_SIZE];
+    volatile uint32_t head;     /* bytes written since Log_Init */
+    volatile uint32_t tail;     /* bytes sent */
+} Log_Ring_t;
+
+static Log_Ring_t logRing __attribute__((aligned(LOG_CACHE_LINE)));
+static DMA_HandleTypeDef logDma;
+static volatile uint32_t logWriting;    /* a write is copying into the ring */
+static volatile uint32_t logDmaBusy;    /* a transfer is running */
+static uint32_t logDmaLen;              /* its length */
+static uint8_t logAsync;                /* 0 before Log_Init and after Log_Stop */
+
+#endif /* LOG_ASYNC == 1 */
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+static uint32_t Log_Drop(volatile uint32_t *counter, uint32_t len)
+{
+    (void)__atomic_fetch_add(counter, 1U, __ATOMIC_RELAXED);
+    (void)__atomic_fetch_add(&logStats.dropped, len, __ATOMIC_RELAXED);
+    return 0U;
+}
+
+#if LOG_ASYNC == 1
+
+/**
+ * @brief  Start a transfer of the pending bytes if the channel is idle
+ * @note   One transfer stops at the end of the ring, the next one wraps
+ */
+static void Log_Kick(void)
+{
+    uint32_t idle = 0U;
+    uint32_t tail;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t line;
+
+    if ((logRing.head == logRing.tail) ||
+        !__atomic_compare_exchange_n(&logDmaBusy, &idle, 1U, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    tail = logRing.tail;
+    offset = tail & (LOG_RING_SIZE - 1U);
+    count = logRing.head - tail;
+    if (count > (LOG_RING_SIZE - offset))
+    {
+        count = LOG_RING_SIZE - offset;
+    }
+
+    line = offset & ~(LOG_CACHE_LINE - 1U);
+    SCB_CleanDCache_by_Addr((void *)&logRing.data[line],
+                            (int32_t)(((offset + count + LOG_CACHE_LINE - 1U) & ~(LOG_CACHE_LINE - 1U)) - line));
+
+    logDmaLen = count;
+    if (HAL_UART_Transmit_DMA(logUart, &logRing.data[offset], (uint16_t)count) != HAL_OK)
+    {
+        /* UART taken by a blocking transmit: the next write or flush starts it again */
+        logDmaLen = 0U;
+        __atomic_store_n(&logDmaBusy, 0U, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief  End of a transfer: free its bytes and the channel, start the next one
+ */
+static void Log_TransferDone(void)
+{
+    __atomic_store_n(&logRing.tail, logRing.tail + logDmaLen, __ATOMIC_RELEASE);
+    logDmaLen = 0U;
+    __atomic_store_n(&logDmaBusy, 0U, __ATOMIC_RELEASE);
+    Log_Kick();
+}
+
+#endif /* LOG_ASYNC == 1 */
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+void Log_Init(UART_HandleTypeDef *huart)
+{
+    logUart = huart;
+
+#if LOG_ASYNC == 1
+    __HAL_RCC_GPDMA1_CLK_ENABLE();
+
+    logDma.Instance                   = LOG_DMA_CHANNEL;
+    logDma.Init.Request               = LOG_DMA_REQUEST;
+    logDma.Init.BlkHWRequest          = DMA_BREQ_SINGLE_BURST;
+    logDma.Init.Direction             = DMA_MEMORY_TO_PERIPH;
+    logDma.Init.SrcInc                = DMA_SINC_INCREMENTED;
+    logDma.Init.DestInc               = DMA_DINC_FIXED;
+    logDma.Init.SrcDataWidth          = DMA_SRC_DATAWIDTH_BYTE;
+    logDma.Init.DestDataWidth         = DMA_DEST_DATAWIDTH_BYTE;
+    logDma.Init.Priority              = DMA_LOW_PRIORITY_LOW_WEIGHT;
+    logDma.Init.SrcBurstLength        = 1;
+    logDma.Init.DestBurstLength       = 1;
+    logDma.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
+    logDma.Init.TransferEventMode     = DMA_TCEM_BLOCK_TRANSFER;
+    logDma.Init.Mode                  = DMA_NORMAL;
+    if (HAL_DMA_Init(&logDma) != HAL_OK)
+    {
+        return;     /* blocking transmits */
+    }
+    __HAL_LINKDMA(huart, hdmatx, logDma);
+
+    logRing.head = 0U;
+    logRing.tail = 0U;
+    logDmaBusy = 0U;
+    logAsync = 1U;
+
+    /* The channel hands the last byte to the UART, whose TC interrupt ends the transfer */
+    HAL_NVIC_SetPriority(LOG_DMA_IRQn, LOG_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(LOG_DMA_IRQn);
+    HAL_NVIC_EnableIRQ(LOG_UART_IRQn);
+#endif
+}
+
+uint32_t Log_Write(const void *data, uint32_t len)
+{
+    if ((logUart == NULL) || (len == 0U))
+    {
+        return Log_Drop(&logStats.overruns, len);
+    }
+
+#if LOG_ASYNC == 1
+    if (logAsync != 0U)
+    {
+        uint32_t head;
+        uint32_t used;
+        uint32_t offset;
+        uint32_t first;
+
+        if (__atomic_exchange_n(&logWriting, 1U, __ATOMIC_ACQUIRE) != 0U)
+        {
+            return Log_Drop(&logStats.collisions, len);
+        }
+
+        head = logRing.head;
+        used = head - logRing.tail;
+        if (len > (LOG_RING_SIZE - used))
+        {
+            __atomic_store_n(&logWriting, 0U, __ATOMIC_RELEASE);
+            return Log_Drop(&logStats.overruns, len);
+        }
+
+        offset = head & (LOG_RING_SIZE - 1U);
+        first = ((offset + len) > LOG_RING_SIZE) ? (LOG_RING_SIZE - offset) : len;
+        memcpy(&logRing.data[offset], data, first);
+        memcpy(&logRing.data[0], (const uint8_t *)data + first, len - first);
+        __atomic_store_n(&logRing.head, head + len, __ATOMIC_RELEASE);
+
+        (void)__atomic_fetch_add(&logStats.written, len, __ATOMIC_RELAXED);
+        if ((used + len) > logStats.highWater)
+        {
+            logStats.highWater = used + len;
+        }
+        __atomic_store_n(&logWriting, 0U, __ATOMIC_RELEASE);
+
+        Log_Kick();
+        return len;
+    }
+#endif
+
+    if (HAL_UART_Transmit(logUart, (const uint8_t *)data, (uint16_t)len, LOG_BLOCKING_TIMEOUT) != HAL_OK)
+    {
+        return Log_Drop(&logStats.overruns, len);
+    }
+    logStats.written += len;
+    return len;
+}
+
+void Log_Flush(uint32_t timeoutMs)
+{
+#if LOG_ASYNC == 1
+    uint32_t start = HAL_GetTick();
+
+    while ((logAsync != 0U) && (logRing.head != logRing.tail) && ((HAL_GetTick() - start) < timeoutMs))
+    {
+        /* A transfer refused while the UART was busy is started again */
+        Log_Kick();
+    }
+#else
+    (void)timeoutMs;
+#endif
+}
+
+void Log_Stop(void)
+{
+#if LOG_ASYNC == 1
+    if (logAsync == 0U)
+    {
+        return;
+    }
+
+    Log_Flush(LOG_BLOCKING_TIMEOUT);
+    logAsync = 0U;
+    if (logDmaBusy != 0U)
+    {
+        (void)HAL_UART_AbortTransmit(logUart);
+    }
+    HAL_NVIC_DisableIRQ(LOG_DMA_IRQn);
+    HAL_NVIC_DisableIRQ(LOG_UART_IRQn);
+    (void)HAL_DMA_DeInit(&logDma);
+    logUart->hdmatx = NULL;
+#endif
+}
+
+void Log_GetStats(Log_Stats_t *stats)
+{
+    *stats = logStats;
+}
+
+#if LOG_TOKENIZED == 1
+void Log_Token(const char *format, uint32_t args, ...)
+{
+    uint8_t frame[LOG_FRAME_HEADER + LOG_FRAME_PAYLOAD_MAX + 1U];
+    const uint32_t end = LOG_FRAME_HEADER + LOG_FRAME_PAYLOAD_MAX;
+    uint32_t offset = (uint32_t)(format - __start_log_fmt);
+    uint32_t pos = LOG_FRAME_HEADER;
+    uint32_t count = args & 0xFU;
+    uint8_t sum = 0U;
+    va_list ap;
+
+    /* An argument that does not fit ends the payload, a string is cut to fit */
+    va_start(ap, args);
+    for (uint32_t i = 0; (i < count) && (pos < end); i++)
+    {
+        uint64_t value;
+        uint32_t size = 4U;
+
+        switch ((args >> (4U + (3U * i))) & 0x7U)
+        {
+        case LOG_ARG_STRING:
+        {
+            const char *str = va_arg(ap, const char *);
+            uint32_t len = (str != NULL) ? (uint32_t)strlen(str) : 0U;
+
+            if (len > (end - pos - 1U))
+            {
+                len = end - pos - 1U;
+            }
+            frame[pos++] = (uint8_t)len;
+            memcpy(&frame[pos], str, len);
+            pos += len;
+            continue;
+        }
+        case LOG_ARG_LONG:
+            value = (uint32_t)va_arg(ap, unsigned long);
+            break;
+        case LOG_ARG_LLONG:
+            value = va_arg(ap, unsigned long long);
+            size = 8U;
+            break;
+        case LOG_ARG_DOUBLE:
+        {
+            double d = va_arg(ap, double);
+            memcpy(&value, &d, sizeof(value));
+            size = 8U;
+            break;
+        }
+        case LOG_ARG_POINTER:
+            value = (uint32_t)(uintptr_t)va_arg(ap, void *);
+            break;
+        default:
+            value = va_arg(ap, unsigned int);
+            break;
+        }
+
+        if ((pos + size) > end)
+        {
+            break;
+        }
+        for (uint32_t b = 0; b < size; b++)
+        {
+            frame[pos++] = (uint8_t)(value >> (8U * b));
+        }
+    }
+    va_end(ap);
+
+    frame[0] = LOG_FRAME_SYNC;
+    frame[1] = (uint8_t)(pos - LOG_FRAME_HEADER);
+    frame[2] = (uint8_t)offset;
+    frame[3] = (uint8_t)(offset >> 8);
+    for (uint32_t i = 2U; i < pos; i++)
+    {
+        sum += frame[i];
+    }
+    frame[pos++] = sum;
+
+    (void)Log_Write(frame, pos);
+}
+#endif /* LOG_TOKENIZED == 1 */
+
+#if LOG_ASYNC == 1
+
+/**
+ * @brief  HAL callback: transfer sent, up to the last stop bit
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if ((huart == logUart) && (logDmaBusy != 0U))
+    {
+        Log_TransferDone();
+    }
+}
+
+/**
+ * @brief  HAL callback: a DMA error ends the transfer without TxCplt, its
+ *         bytes are counted as dropped and the ring goes on
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if ((huart == logUart) && (logDmaBusy != 0U) && (huart->gState == HAL_UART_STATE_READY))
+    {
+        (void)Log_Drop(&logStats.overruns, logDmaLen);
+        Log_TransferDone();
+    }
+}
+
+void GPDMA1_Channel0_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&logDma);
+}
+
+#if LOG_FLUSH_ON_FAULT == 1
+void Log_FaultFlush(void)
+{
+    USART_TypeDef *uart;
+    uint32_t tail;
+    uint32_t spin;
+
+    if ((logUart == NULL) || (logAsync == 0U))
+    {
+        return;
+    }
+    uart = logUart->Instance;
+    tail = logRing.tail;
+
+    if (logDmaBusy != 0U)
+    {
+        /* Suspend the channel: the bytes it has not read yet are sent below */
+        LOG_DMA_CHANNEL->CCR |= DMA_CCR_SUSP;
+        for (spin = 0; (spin < LOG_FAULT_SPIN) && ((LOG_DMA_CHANNEL->CSR & DMA_CSR_SUSPF) == 0U); spin++)
+        {
+        }
+        tail += logDmaLen - (LOG_DMA_CHANNEL->CBR1 & DMA_CBR1_BNDT);
+        LOG_DMA_CHANNEL->CCR |= DMA_CCR_RESET;
+        uart->CR3 &= ~USART_CR3_DMAT;
+    }
+
+    for (; tail != logRing.head; tail++)
+    {
+        for (spin = 0; (spin < LOG_FAULT_SPIN) && ((uart->ISR & USART_ISR_TXE_TXFNF) == 0U); spin++)
+        {
+        }
+        uart->TDR = logRing.data[tail & (LOG_RING_SIZE - 1U)];
+    }
+    for (spin = 0; (spin < LOG_FAULT_SPIN) && ((uart->ISR & USART_ISR_TC) == 0U); spin++)
+    {
+    }
+
+    logRing.tail = tail;
+    logDmaBusy = 0U;
+    logAsync = 0U;
+}
+#endif /* LOG_FLUSH_ON_FAULT == 1 */
+
+#endif /* LOG_ASYNC == 1 */
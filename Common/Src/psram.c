@@ -0,0 +1,347 @@
+/**
+ ******************************************************************************
+ * @file    psram.c
+ * @brief   External PSRAM on XSPI1 - STM32H7S3 + APS256XXN
+ *
+ * XSPI1 drives XSPIM port 1 with 16 data lines. The ExtMem Manager PSRAM
+ * driver (EXTMEMORY_2) sets the device up and enables the memory-mapped
+ * mode, then an MPU region opens the window as normal write-back memory.
+ * The XSPI IO manager is not touched: XSPI1 is on port 1 in the reset
+ * configuration, and HAL_XSPIM_Config would disable XSPI2, which the Appli
+ * executes from. Nothing is printed here, the Boot has no printf: the
+ * callers report the status and the benchmark results.
+ *
+ * The heap is a first-fit list of blocks, each with a 32-byte header so
+ * that the buffers start on a D-cache line. Free neighbours are merged
+ * while searching. It is not meant for interrupt handlers.
+ ******************************************************************************
+ */
+
+#include "psram.h"
+
+#if PSRAM_ENABLE == 1
+
+#include "extmem_manager.h"
+#include <string.h>
+
+/*============================================================================*/
+/*                          PRIVATE DEFINITIONS                               */
+/*============================================================================*/
+
+#define PSRAM_LINE              32U
+#define PSRAM_CHECK_ADDR        (PSRAM_BASE + PSRAM_SIZE - PSRAM_LINE)
+#define PSRAM_CHECK_PATTERN     0x5AA5F00FU
+#define PSRAM_BENCH_CHUNK       4096U
+
+/* Header of a heap block, one D-cache line */
+typedef struct {
+    uint32_t size;              /* bytes, header included, multiple of PSRAM_LINE */
+    uint32_t used;
+    uint32_t reserved[6];
+} PSRAM_Block_t;
+
+XSPI_HandleTypeDef hxspi1;
+
+static uint8_t psramReady = 0;
+static uint8_t heapReady = 0;
+
+/*============================================================================*/
+/*                          PRIVATE FUNCTIONS                                 */
+/*============================================================================*/
+
+/**
+ * @brief  Clocks, pins and XSPI1 for the 16-line PSRAM (APS256XXN)
+ */
+static int PSRAM_InitXSPI1(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    /* PLL2S, 200MHz: the driver divides it down to PSRAM_FREQ_MAX */
+    clk.PeriphClockSelection = RCC_PERIPHCLK_XSPI1;
+    clk.Xspi1ClockSelection = RCC_XSPI1CLKSOURCE_PLL2S;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK)
+    {
+        return -1;
+    }
+
+    HAL_PWREx_EnableXSPIM1();
+    __HAL_RCC_XSPIM_CLK_ENABLE();
+    __HAL_RCC_XSPI1_CLK_ENABLE();
+    /* The Boot leaves XSPI1 in memory-mapped mode after reading the mailbox */
+    __HAL_RCC_XSPI1_FORCE_RESET();
+    __HAL_RCC_XSPI1_RELEASE_RESET();
+    __HAL_RCC_GPIOO_CLK_ENABLE();
+    __HAL_RCC_GPIOP_CLK_ENABLE();
+
+    /* PO0 NCS1, PO2 DQS0, PO3 DQS1, PO4 CLK, PP0-PP15 IO0-IO15 */
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio.Alternate = GPIO_AF9_XSPIM_P1;
+    gpio.Pin = GPIO_PIN_0 | GPIO_PIN_2 | GPIO_PIN_3 | GPIO_PIN_4;
+    HAL_GPIO_Init(GPIOO, &gpio);
+    gpio.Pin = GPIO_PIN_ALL;
+    HAL_GPIO_Init(GPIOP, &gpio);
+
+    hxspi1.Instance = XSPI1;
+    hxspi1.Init.FifoThresholdByte = 4;
+    hxspi1.Init.MemoryMode = HAL_XSPI_SINGLE_MEM;
+    hxspi1.Init.MemoryType = HAL_XSPI_MEMTYPE_APMEM_16BITS;
+    hxspi1.Init.MemorySize = HAL_XSPI_SIZE_256MB;
+    hxspi1.Init.ChipSelectHighTimeCycle = 1;
+    hxspi1.Init.FreeRunningClock = HAL_XSPI_FREERUNCLK_DISABLE;
+    hxspi1.Init.ClockMode = HAL_XSPI_CLOCK_MODE_0;
+    hxspi1.Init.WrapSize = HAL_XSPI_WRAP_NOT_SUPPORTED;
+    hxspi1.Init.ClockPrescaler = 0;
+    hxspi1.Init.SampleShifting = HAL_XSPI_SAMPLE_SHIFT_NONE;
+    hxspi1.Init.DelayHoldQuarterCycle = HAL_XSPI_DHQC_ENABLE;
+    /* A burst stops on the 2KB row: chip select low time stays below tCEM */
+    hxspi1.Init.ChipSelectBoundary = HAL_XSPI_BONDARYOF_16KB;
+    hxspi1.Init.MaxTran = 0;
+    hxspi1.Init.Refresh = 0;
+    hxspi1.Init.MemorySelect = HAL_XSPI_CSSEL_NCS1;
+
+    return (HAL_XSPI_Init(&hxspi1) == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief  APS256XXN commands for the ExtMem Manager PSRAM driver
+ */
+static void PSRAM_Configure(EXTMEM_DefinitionTypeDef *mem)
+{
+    memset(mem, 0, sizeof(*mem));
+    mem->MemType = EXTMEM_PSRAM;
+    mem->Handle = (void *)&hxspi1;
+    mem->ConfigType = EXTMEM_LINK_CONFIG_16LINES;
+
+    mem->PsramObject.psram_public.MemorySize = HAL_XSPI_SIZE_256MB;
+    mem->PsramObject.psram_public.FreqMax = PSRAM_FREQ_MAX;
+
+    /* MR8: x16 mode */
+    mem->PsramObject.psram_public.NumberOfConfig = 1;
+    mem->PsramObject.psram_public.config[0].WriteMask = 0x40;
+    mem->PsramObject.psram_public.config[0].WriteValue = 0x40;
+    mem->PsramObject.psram_public.config[0].REGAddress = 0x08;
+
+    mem->PsramObject.psram_public.ReadREG = 0x40;
+    mem->PsramObject.psram_public.WriteREG = 0xC0;
+    mem->PsramObject.psram_public.ReadREGSize = 2;
+    mem->PsramObject.psram_public.REG_DummyCycle = 4;
+    mem->PsramObject.psram_public.Write_command = 0xA0;
+    mem->PsramObject.psram_public.Write_DummyCycle = 4;
+    mem->PsramObject.psram_public.Read_command = 0x20;
+    mem->PsramObject.psram_public.WrapRead_command = 0x00;
+    mem->PsramObject.psram_public.Read_DummyCycle = 4;
+}
+
+/**
+ * @brief  Open the window: normal memory, write-back read/write allocate, no execution
+ */
+static void PSRAM_ConfigMpu(void)
+{
+    MPU_Region_InitTypeDef region = {0};
+
+    region.Enable           = MPU_REGION_ENABLE;
+    region.Number           = PSRAM_MPU_REGION;
+    region.BaseAddress      = PSRAM_BASE;
+    region.Size             = MPU_REGION_SIZE_32MB;
+    region.SubRegionDisable = 0x0;
+    region.TypeExtField     = MPU_TEX_LEVEL1;
+    region.AccessPermission = MPU_REGION_FULL_ACCESS;
+    region.DisableExec      = MPU_INSTRUCTION_ACCESS_DISABLE;
+    region.IsShareable      = MPU_ACCESS_NOT_SHAREABLE;
+    region.IsCacheable      = MPU_ACCESS_CACHEABLE;
+    region.IsBufferable     = MPU_ACCESS_BUFFERABLE;
+
+    HAL_MPU_Disable();
+    HAL_MPU_ConfigRegion(&region);
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+}
+
+/**
+ * @brief  Write and read back the last line of the PSRAM, past the D-cache
+ */
+static int PSRAM_Check(void)
+{
+    volatile uint32_t *line = (volatile uint32_t *)PSRAM_CHECK_ADDR;
+
+    line[0] = PSRAM_CHECK_PATTERN;
+    line[1] = ~PSRAM_CHECK_PATTERN;
+    SCB_CleanInvalidateDCache_by_Addr((void *)PSRAM_CHECK_ADDR, (int32_t)PSRAM_LINE);
+
+    return ((line[0] == PSRAM_CHECK_PATTERN) && (line[1] == ~PSRAM_CHECK_PATTERN)) ? 0 : -1;
+}
+
+static void PSRAM_HeapInit(void)
+{
+    PSRAM_Block_t *first = (PSRAM_Block_t *)PSRAM_HEAP_ADDR;
+
+    first->size = PSRAM_HEAP_SIZE;
+    first->used = 0;
+    heapReady = 1;
+}
+
+/**
+ * @brief  Rate in KB/s of a transfer timed with the cycle counter
+ */
+static uint32_t PSRAM_Rate(uint32_t bytes, uint32_t cycles)
+{
+    if (cycles == 0U)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)bytes * SystemCoreClock) / ((uint64_t)cycles * 1024U));
+}
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+int PSRAM_Init(void)
+{
+    EXTMEM_DefinitionTypeDef *mem = &extmem_list_config[EXTMEMORY_2];
+
+    if (psramReady != 0U)
+    {
+        return 0;
+    }
+
+    if (PSRAM_InitXSPI1() != 0)
+    {
+        return -1;
+    }
+
+    PSRAM_Configure(mem);
+    if ((EXTMEM_Init(EXTMEMORY_2, HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_XSPI1)) != EXTMEM_OK) ||
+        (EXTMEM_MemoryMappedMode(EXTMEMORY_2, EXTMEM_ENABLE) != EXTMEM_OK))
+    {
+        return -1;
+    }
+
+    PSRAM_ConfigMpu();
+    if (PSRAM_Check() != 0)
+    {
+        return -1;
+    }
+
+    psramReady = 1;
+    return 0;
+}
+
+uint8_t PSRAM_IsReady(void)
+{
+    return psramReady;
+}
+
+void *PSRAM_Malloc(uint32_t size)
+{
+    const uint32_t end = PSRAM_HEAP_ADDR + PSRAM_HEAP_SIZE;
+    uint32_t need;
+
+    if ((psramReady == 0U) || (size == 0U) || (size > (PSRAM_HEAP_SIZE - sizeof(PSRAM_Block_t))))
+    {
+        return NULL;
+    }
+    if (heapReady == 0U)
+    {
+        PSRAM_HeapInit();
+    }
+
+    need = (size + sizeof(PSRAM_Block_t) + PSRAM_LINE - 1U) & ~(PSRAM_LINE - 1U);
+
+    for (uint32_t addr = PSRAM_HEAP_ADDR; addr < end; addr += ((PSRAM_Block_t *)addr)->size)
+    {
+        PSRAM_Block_t *block = (PSRAM_Block_t *)addr;
+
+        if (block->used != 0U)
+        {
+            continue;
+        }
+
+        /* merge the free blocks that follow */
+        while ((addr + block->size) < end)
+        {
+            PSRAM_Block_t *next = (PSRAM_Block_t *)(addr + block->size);
+
+            if (next->used != 0U)
+            {
+                break;
+            }
+            block->size += next->size;
+        }
+
+        if (block->size >= need)
+        {
+            if ((block->size - need) >= (2U * PSRAM_LINE))
+            {
+                PSRAM_Block_t *rest = (PSRAM_Block_t *)(addr + need);
+
+                rest->size = block->size - need;
+                rest->used = 0;
+                block->size = need;
+            }
+            block->used = 1;
+            return (void *)(addr + sizeof(PSRAM_Block_t));
+        }
+    }
+
+    return NULL;
+}
+
+void PSRAM_Free(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        ((PSRAM_Block_t *)((uint32_t)ptr - sizeof(PSRAM_Block_t)))->used = 0;
+    }
+}
+
+int PSRAM_Bench_Run(PSRAM_Bench_Result_t *result)
+{
+    static uint8_t sramChunk[PSRAM_BENCH_CHUNK] __attribute__((aligned(32)));
+    uint32_t *words = (uint32_t *)PSRAM_Malloc(PSRAM_BENCH_SIZE);
+    const uint32_t count = PSRAM_BENCH_SIZE / sizeof(uint32_t);
+    uint32_t start;
+
+    memset(result, 0, sizeof(*result));
+    if (words == NULL)
+    {
+        result->errors = count;
+        return -1;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* The write is complete once the dirty lines are back in the PSRAM */
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        words[i] = i * 0x9E3779B1U;
+    }
+    SCB_CleanDCache_by_Addr(words, (int32_t)PSRAM_BENCH_SIZE);
+    result->writeKBps = PSRAM_Rate(PSRAM_BENCH_SIZE, DWT->CYCCNT - start);
+
+    SCB_InvalidateDCache_by_Addr(words, (int32_t)PSRAM_BENCH_SIZE);
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        result->errors += (words[i] != (i * 0x9E3779B1U)) ? 1U : 0U;
+    }
+    result->readKBps = PSRAM_Rate(PSRAM_BENCH_SIZE, DWT->CYCCNT - start);
+
+    /* As the Boot reads the mailbox, or a large buffer is brought back to SRAM */
+    SCB_InvalidateDCache_by_Addr(words, (int32_t)PSRAM_BENCH_SIZE);
+    start = DWT->CYCCNT;
+    for (uint32_t offset = 0; offset < PSRAM_BENCH_SIZE; offset += PSRAM_BENCH_CHUNK)
+    {
+        memcpy(sramChunk, (const uint8_t *)words + offset, PSRAM_BENCH_CHUNK);
+    }
+    result->copyKBps = PSRAM_Rate(PSRAM_BENCH_SIZE, DWT->CYCCNT - start);
+
+    PSRAM_Free(words);
+    return (result->errors == 0U) ? 0 : -1;
+}
+
+#endif /* PSRAM_ENABLE == 1 */
@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ * @file    trace.c
+ * @brief   Span tracing: ring in DTCM and its dump on the UART
+ *
+ * The ring is in DTCM (.dtcm_bss, see the linker script): zero wait state,
+ * outside the D-cache, and left alone by the XSPI2 flash windows. It is not
+ * cleared by the startup, Trace_Init empties it.
+ ******************************************************************************
+ */
+
+#include "trace.h"
+#include "log.h"
+
+#if TRACE_ENABLE == 1
+
+_Static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1U)) == 0U, "TRACE_RING_SIZE must be a power of two");
+_Static_assert(sizeof(Trace_Event_t) == 12U, "Trace_Event_t is the dump format");
+_Static_assert(sizeof(Trace_DumpHeader_t) == 16U, "Trace_DumpHeader_t is the dump format");
+
+Trace_Ring_t traceRing __attribute__((section(".dtcm_bss")));
+
+static uint8_t traceImage;
+
+static uint32_t Trace_Sum(uint32_t sum, const void *data, uint32_t size)
+{
+    const uint32_t *word = (const uint32_t *)data;
+
+    for (uint32_t i = 0; i < (size / 4U); i++)
+    {
+        sum += word[i];
+    }
+    return sum;
+}
+
+void Trace_Init(uint8_t image)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    traceImage = image;
+    traceRing.head = 0U;
+    traceRing.sent = 0U;
+}
+
+void Trace_Dump(UART_HandleTypeDef *huart)
+{
+    Trace_DumpHeader_t header;
+    uint32_t head = traceRing.head;
+    uint32_t pending = head - traceRing.sent;
+    uint32_t count = (pending < TRACE_RING_SIZE) ? pending : TRACE_RING_SIZE;
+    uint32_t first = (head - count) & (TRACE_RING_SIZE - 1U);
+    uint32_t part = ((first + count) > TRACE_RING_SIZE) ? (TRACE_RING_SIZE - first) : count;
+    uint32_t sum;
+
+    header.magic = TRACE_DUMP_MAGIC;
+    header.image = traceImage;
+    header.eventSize = (uint8_t)sizeof(Trace_Event_t);
+    header.count = (uint16_t)count;
+    header.coreClock = SystemCoreClock;
+    header.lost = pending - count;
+
+    /* The text queued before the dump goes out first, and frees the UART */
+    Log_Flush(LOG_BLOCKING_TIMEOUT);
+
+    /* Events recorded during the dump are left out of it */
+    sum = Trace_Sum(0U, &header, sizeof(header));
+    sum = Trace_Sum(sum, &traceRing.events[first], part * sizeof(Trace_Event_t));
+    sum = Trace_Sum(sum, &traceRing.events[0], (count - part) * sizeof(Trace_Event_t));
+
+    (void)HAL_UART_Transmit(huart, (const uint8_t *)&header, sizeof(header), HAL_MAX_DELAY);
+    (void)HAL_UART_Transmit(huart, (const uint8_t *)&traceRing.events[first],
+                            (uint16_t)(part * sizeof(Trace_Event_t)), HAL_MAX_DELAY);
+    if (count > part)
+    {
+        (void)HAL_UART_Transmit(huart, (const uint8_t *)&traceRing.events[0],
+                                (uint16_t)((count - part) * sizeof(Trace_Event_t)), HAL_MAX_DELAY);
+    }
+    (void)HAL_UART_Transmit(huart, (const uint8_t *)&sum, sizeof(sum), HAL_MAX_DELAY);
+
+    traceRing.sent = head;
+}
+
+#endif /* TRACE_ENABLE == 1 */
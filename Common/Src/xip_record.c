@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file    xip_record.c
+ * @brief   XIP profiles of XSPI2 - STM32H7S3 + MX25UW25645G
+ *
+ * A profile is the map configuration of the XSPI (wrap size, timeout) and
+ * the SBL command that sets the same burst length in the memory. The Appli
+ * benchmark requests one in the record, the Boot sets it before the jump and
+ * the Appli sets it again after the EXTMEM_Init of its OTA staging, inside
+ * the flash window (this file is linked into ITCM there).
+ ******************************************************************************
+ */
+
+#include "xip_record.h"
+#include <stddef.h>
+
+/*============================================================================*/
+/*                          PRIVATE DATA                                      */
+/*============================================================================*/
+
+/* Burst length register of the MX25UW25645G: bit 4 set disables the wrap,
+ * bits 1:0 give the length (01 = 32 bytes). DTR: the byte is sent twice */
+static const uint8_t sblLinear[2] = { 0x10U, 0x10U };
+static const uint8_t sblWrap32[2] = { 0x01U, 0x01U };
+
+/* SBL in 8D8D8D: C0h with its inverted extension, 4 address bytes, one data byte */
+#define XIP_SBL_STEP(_DATA_)                                                   \
+    {                                                                          \
+        .Command = {                                                           \
+            .OperationType      = HAL_XSPI_OPTYPE_COMMON_CFG,                  \
+            .IOSelect           = HAL_XSPI_SELECT_IO_7_0,                      \
+            .Instruction        = 0xC03FU,                                     \
+            .InstructionMode    = HAL_XSPI_INSTRUCTION_8_LINES,                \
+            .InstructionWidth   = HAL_XSPI_INSTRUCTION_16_BITS,                \
+            .InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_ENABLE,             \
+            .Address            = 0U,                                          \
+            .AddressMode        = HAL_XSPI_ADDRESS_8_LINES,                    \
+            .AddressWidth       = HAL_XSPI_ADDRESS_32_BITS,                    \
+            .AddressDTRMode     = HAL_XSPI_ADDRESS_DTR_ENABLE,                 \
+            .AlternateBytesMode = HAL_XSPI_ALT_BYTES_NONE,                     \
+            .DataMode           = HAL_XSPI_DATA_8_LINES,                       \
+            .DataLength         = 2U,                                          \
+            .DataDTRMode        = HAL_XSPI_DATA_DTR_ENABLE,                    \
+            .DummyCycles        = 0U,                                          \
+            .DQSMode            = HAL_XSPI_DQS_DISABLE,                        \
+        },                                                                     \
+        .Data = (_DATA_),                                                      \
+    }
+
+static const SAL_XSPI_CommandStepTypeDef stepsLinear[] = { XIP_SBL_STEP(sblLinear) };
+static const SAL_XSPI_CommandStepTypeDef stepsWrap32[] = { XIP_SBL_STEP(sblWrap32) };
+
+/* Indexed by XIP_Profile_t; the steps fit the 8 lines link of the ExtMem Manager */
+static const EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef xipProfiles[XIP_PROFILE_COUNT] = {
+    { { HAL_XSPI_WRAP_NOT_SUPPORTED, 0U },                  PHY_LINK_8D8D8D, stepsLinear, 1U },
+    { { HAL_XSPI_WRAP_NOT_SUPPORTED, XIP_PROFILE_TIMEOUT }, PHY_LINK_8D8D8D, stepsLinear, 1U },
+    { { HAL_XSPI_WRAP_32_BYTES,      0U },                  PHY_LINK_8D8D8D, stepsWrap32, 1U },
+    { { HAL_XSPI_WRAP_32_BYTES,      XIP_PROFILE_TIMEOUT }, PHY_LINK_8D8D8D, stepsWrap32, 1U },
+};
+
+static const char *const xipNames[XIP_PROFILE_COUNT] = {
+    "linear", "linear+timeout", "wrap32", "wrap32+timeout"
+};
+
+_Static_assert(XIP_PROFILE_RECORD_ADDR == (EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_ADDRESS + EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_SIZE),
+               "XIP record overlaps the backup SRAM layout of the ExtMem Manager");
+
+/*============================================================================*/
+/*                          PUBLIC FUNCTIONS                                  */
+/*============================================================================*/
+
+uint32_t XIP_Record_Check(const XIP_Profile_Record_t *record)
+{
+    const uint32_t *words = (const uint32_t *)record;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < (offsetof(XIP_Profile_Record_t, check) / sizeof(uint32_t)); i++)
+    {
+        sum += words[i];
+    }
+    return ~sum;
+}
+
+const EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef *XIP_Profile_Get(XIP_Profile_t profile)
+{
+    return &xipProfiles[(profile < XIP_PROFILE_COUNT) ? profile : XIP_PROFILE_LINEAR];
+}
+
+const char *XIP_Profile_Name(XIP_Profile_t profile)
+{
+    return (profile < XIP_PROFILE_COUNT) ? xipNames[profile] : "?";
+}
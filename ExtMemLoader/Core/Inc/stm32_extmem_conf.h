@@ -33,7 +33,7 @@
 */
 
 #define EXTMEM_DRIVER_NOR_SFDP   1
-#define EXTMEM_DRIVER_PSRAM      0
+#define EXTMEM_DRIVER_PSRAM      1
 #define EXTMEM_DRIVER_SDCARD     0
 #define EXTMEM_DRIVER_USER       0
 
@@ -64,7 +64,8 @@ extern XSPI_HandleTypeDef hxspi2;
   * @{
   */
 enum {
-  EXTMEMORY_1  = 0 /*!< ID=0 for the first memory  */
+  EXTMEMORY_1  = 0, /*!< ID=0 for the first memory  */
+  EXTMEMORY_2  = 1  /*!< ID=1 for the second memory  */
 };
 
 /*
@@ -73,7 +74,11 @@ enum {
 #define EXTMEM_MEMORY_BOOTXIP  EXTMEMORY_1
 
 /* USER CODE BEGIN EC */
-
+/*
+  @brief static SFDP profile generated by tools/sfdp_profile: 0 runs the SFDP discovery at EXTMEM_Init
+         (set to 1 with EXTMEM_DRIVER_NOR_SFDP_PROFILE_FILE to skip it, see tools/sfdp_profile/README.md)
+*/
+#define EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE 0
 /* USER CODE END EC */
 
 /* Exported configuration --------------------------------------------------------*/
@@ -81,9 +86,9 @@ enum {
   * @{
   */
 
-extern EXTMEM_DefinitionTypeDef extmem_list_config[1];
+extern EXTMEM_DefinitionTypeDef extmem_list_config[2];
 #if defined(EXTMEM_C)
-EXTMEM_DefinitionTypeDef extmem_list_config[1];
+EXTMEM_DefinitionTypeDef extmem_list_config[2];
 #endif /* EXTMEM_C */
 
 /**
@@ -26,6 +26,13 @@
 #include <stdio.h>
 #endif /* EXTMEM_DRIVER_NOR_SFDP_DEBUG_LEVEL != 0 && defined(EXTMEM_MACRO_DEBUG) */
 #include <string.h>
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+#include <stddef.h>
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
+
+#if (EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1) && (EXTMEM_DRIVER_NOR_SFDP_CACHE == 1)
+#error "the SFDP discovery cache is not used when a static profile is applied"
+#endif /* (EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1) && (EXTMEM_DRIVER_NOR_SFDP_CACHE == 1) */
 
 /** @defgroup NOR_SFDP_DATA Data module
   * @ingroup NOR_SFDP
@@ -300,7 +307,7 @@ typedef struct {
       uint32_t SuspendInProgress_ProgramMaxLatency:7;
       uint32_t EraseResumeToSuspendInterval:4;
       uint32_t SuspendInProgress_EraseMaxLatency:7;
-      uint32_t :1;
+      uint32_t SuspendResume_NotSupported:1;    /* 31 0b: suspend/resume supported, 1b: not supported */
       } D12;
       struct {
         uint32_t ProgramResume_Intruction:8;
@@ -998,6 +1005,7 @@ typedef union {
 /** @defgroup NOR_SFDP_DATA_Private_Variables Private Variables
   * @{
   */
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0
 /**
  * @brief this variable contains all the table available on a memory
  */
@@ -1028,6 +1036,33 @@ static SFPD_JEDEC_SCCR_Map            JEDEC_SCCR_Map;
  */
 static SFPD_JEDEC_OCTALDDR            JEDEC_OctalDdr;
 
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+/**
+ * @brief discovery cache record, it holds everything SFDP_CollectData reads from the memory
+ */
+typedef struct {
+  uint32_t                       Magic;               /*!< SFDP_CACHE_MAGIC when the record is valid */
+  uint32_t                       Size;                /*!< record size, detects a layout change between builds */
+  uint8_t                        JedecId[4];          /*!< JEDEC ID read in 1S1S1S mode after reset */
+  uint32_t                       Sfdp_table_mask;     /*!< copy of sfpd_private.Sfdp_table_mask */
+  uint32_t                       Reset_info;          /*!< copy of sfpd_private.Reset_info */
+  uint8_t                        Sfdp_param_number;   /*!< copy of sfpd_private.Sfdp_param_number */
+  uint8_t                        Sfdp_AccessProtocol; /*!< copy of sfpd_private.Sfdp_AccessProtocol */
+  SFDP_JEDECBasic_Params         Basic;
+  SFDP_JEDEC4ByteAddress_Params  Address4Bit;
+  SFPD_JEDEC_XSPI10              XSPI10;
+  SFPD_JEDEC_SCCR_Map            SCCR_Map;
+  SFPD_JEDEC_OCTALDDR            OctalDdr;
+  uint32_t                       Crc;                 /*!< CRC32 of all the previous fields */
+} SFDP_CacheRecordTypeDef;
+
+#define SFDP_CACHE_MAGIC   0x53464443u  /* "SFDC" */
+#define SFDP_CACHE         ((SFDP_CacheRecordTypeDef *)EXTMEM_DRIVER_NOR_SFDP_CACHE_ADDRESS)
+
+_Static_assert(sizeof(SFDP_CacheRecordTypeDef) <= EXTMEM_DRIVER_NOR_SFDP_CACHE_SIZE, "SFDP cache record does not fit the storage");
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0 */
+
 
 
 
@@ -1045,6 +1080,10 @@ SFDP_StatusTypeDef sfdp_get_paraminfo(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Obje
 SFDP_StatusTypeDef sfpd_enter_octal_mode(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object);
 uint32_t sfdp_getfrequencevalue(uint32_t BitField);
 SFDP_StatusTypeDef sfpd_set_dummycycle(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, uint32_t Value);
+SFDP_StatusTypeDef sfdp_reset_sequence(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object);
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+static uint32_t sfdp_cache_crc(const uint8_t *Data, uint32_t Size);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
 /**
   * @}
   */
@@ -1118,7 +1157,8 @@ error:
   return retr;
 }
 
-
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0
+/* the SFDP parser below is not linked when the driver uses a static profile */
 SFDP_StatusTypeDef SFDP_GetHeader(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, SFPD_HeaderTypeDef *sfdp_header)
 {
   SFDP_StatusTypeDef retr = EXTMEM_SFDP_ERROR_SIGNATURE;
@@ -1241,7 +1281,6 @@ error:
 
 SFDP_StatusTypeDef SFDP_MemoryReset(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object)
 {
-  RESET_METHOD reset_method;
   SFDP_StatusTypeDef retr = EXTMEM_SFDP_ERROR_NO_PARAMTABLE_BASIC;
   uint32_t sfdp_adress = SFDP_HEADER_SIZE;
   uint8_t find = 0u;
@@ -1288,6 +1327,22 @@ SFDP_StatusTypeDef SFDP_MemoryReset(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object
     goto error;
   }
 
+  retr = sfdp_reset_sequence(Object);
+
+error :
+  return retr;
+}
+
+/**
+ * @brief This function resets the memory with the method given by the JEDEC basic table
+ * @param Object memory Object
+ * @return @ref SFDP_StatusTypeDef
+ */
+SFDP_StatusTypeDef sfdp_reset_sequence(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object)
+{
+  RESET_METHOD reset_method;
+  SFDP_StatusTypeDef retr = EXTMEM_SFDP_OK;
+
   /* determine how to proceed memory reset */
   if( 0x0u == JEDEC_Basic.Params.Param_DWORD.D16.SoftResetRescueSequence_Support)
   {
@@ -1461,6 +1516,28 @@ SFDP_StatusTypeDef SFDP_BuildGenericDriver(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef
 
   Object->sfpd_private.DriverInfo.EraseChipTiming   = JEDEC_Basic.Params.Param_DWORD.D10.MutliplierEraseTime * (JEDEC_Basic.Params.Param_DWORD.D11.ChipErase_TypicalTime_count + 1u)* chip_erase_unit[JEDEC_Basic.Params.Param_DWORD.D11.ChipErase_TypicalTime_units];
 
+  /* ---------------------------------------------------
+   *  Erase suspend/resume management
+   * ---------------------------------------------------
+   */
+  Object->sfpd_private.DriverInfo.SuspendCommand       = 0u;
+  Object->sfpd_private.DriverInfo.ResumeCommand        = 0u;
+  Object->sfpd_private.DriverInfo.SuspendLatency       = 0u;
+  Object->sfpd_private.DriverInfo.ResumeToSuspendDelay = 0u;
+  if ((JEDEC_Basic.size >= 13u) && (0u == JEDEC_Basic.Params.Param_DWORD.D12.SuspendResume_NotSupported))
+  {
+    /* latency units: 00b: 128 ns, 01b: 1 us, 10b: 8 us, 11b: 64 us (bits 6:5), count in bits 4:0 */
+    static const uint32_t suspend_latency_unit_ns[] = { 128u, 1000u, 8000u, 64000u};
+    uint32_t latency = JEDEC_Basic.Params.Param_DWORD.D12.SuspendInProgress_EraseMaxLatency;
+
+    Object->sfpd_private.DriverInfo.SuspendCommand = (uint8_t)JEDEC_Basic.Params.Param_DWORD.D13.Suspend_Intruction;
+    Object->sfpd_private.DriverInfo.ResumeCommand  = (uint8_t)JEDEC_Basic.Params.Param_DWORD.D13.Resume_Intruction;
+    Object->sfpd_private.DriverInfo.SuspendLatency = ((((latency & 0x1Fu) + 1u) * suspend_latency_unit_ns[(latency >> 5u) & 0x3u]) + 999u) / 1000u;
+    /* the interval is expressed in 64 us units */
+    Object->sfpd_private.DriverInfo.ResumeToSuspendDelay = (JEDEC_Basic.Params.Param_DWORD.D12.EraseResumeToSuspendInterval + 1u) * 64u;
+    SFDP_DEBUG_INT("-> erase suspend command:", Object->sfpd_private.DriverInfo.SuspendCommand);
+  }
+
   /* ------------------------------------------------------
    *   WIP/WEL : write in progress/ write enable management
    * ------------------------------------------------------
@@ -1891,6 +1968,12 @@ SFDP_StatusTypeDef SFDP_BuildGenericDriver(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef
       MaxFreqMhz = Object->sfpd_private.DriverInfo.ClockIn;
     }
 
+    /* the frequency limit of the application applies here, the dummy cycles below follow the real clock */
+    if ((Object->sfdp_public.MaxFreq != 0u) && (MaxFreqMhz > Object->sfdp_public.MaxFreq))
+    {
+      MaxFreqMhz = Object->sfdp_public.MaxFreq;
+    }
+
     /* Update the clock to be aligned with selected configuration */
     if(HAL_OK != SAL_XSPI_SetClock(&Object->sfpd_private.SALObject, Object->sfpd_private.DriverInfo.ClockIn, MaxFreqMhz, &ClockOut))
     {
@@ -1899,26 +1982,27 @@ SFDP_StatusTypeDef SFDP_BuildGenericDriver(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef
     }
     *FreqUpdated = 1u; /* Used to indicate that the clock configuration has been updated */
 
-    /* get the dummy cycle value according to the real output clock */
-    if ((ClockOut >= CLOCK_200MHZ) && (JEDEC_XSPI10.Param_DWORD.D4.Operation200Mhz_DummyCycle != 0u))
+    /* get the dummy cycle value according to the real output clock: the smallest operating
+       frequency covering the clock, a clock between two frequencies needs the cycles of the higher one */
+    if ((ClockOut <= CLOCK_100MHZ) && (JEDEC_XSPI10.Param_DWORD.D5.Operation100Mhz_DummyCycle != 0u))
     {
-      dummyCycles = JEDEC_XSPI10.Param_DWORD.D4.Operation200Mhz_DummyCycle;
-      dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D4.Operation200Mhz_ConfigPattern;
-    }
-    else if ((ClockOut >= CLOCK_166MHZ) && (JEDEC_XSPI10.Param_DWORD.D5.Operation166Mhz_DummyCycle != 0u))
-    {
-      dummyCycles = JEDEC_XSPI10.Param_DWORD.D5.Operation166Mhz_DummyCycle;
-      dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D5.Operation166Mhz_ConfigPattern;
+      dummyCycles = JEDEC_XSPI10.Param_DWORD.D5.Operation100Mhz_DummyCycle;
+      dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D5.Operation100Mhz_ConfigPattern;
     }
-    else if ((ClockOut >= CLOCK_133MHZ) && (JEDEC_XSPI10.Param_DWORD.D5.Operation133Mhz_DummyCycle != 0u))
+    else if ((ClockOut <= CLOCK_133MHZ) && (JEDEC_XSPI10.Param_DWORD.D5.Operation133Mhz_DummyCycle != 0u))
     {
       dummyCycles = JEDEC_XSPI10.Param_DWORD.D5.Operation133Mhz_DummyCycle;
       dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D5.Operation133Mhz_ConfigPattern;
     }
-    else /* if (ClockOut =< 100Mhz) */
+    else if ((ClockOut <= CLOCK_166MHZ) && (JEDEC_XSPI10.Param_DWORD.D5.Operation166Mhz_DummyCycle != 0u))
     {
-      dummyCycles = JEDEC_XSPI10.Param_DWORD.D5.Operation100Mhz_DummyCycle;
-      dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D5.Operation100Mhz_ConfigPattern;
+      dummyCycles = JEDEC_XSPI10.Param_DWORD.D5.Operation166Mhz_DummyCycle;
+      dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D5.Operation166Mhz_ConfigPattern;
+    }
+    else /* if (ClockOut <= 200Mhz) */
+    {
+      dummyCycles = JEDEC_XSPI10.Param_DWORD.D4.Operation200Mhz_DummyCycle;
+      dummyCyclesValue = JEDEC_XSPI10.Param_DWORD.D4.Operation200Mhz_ConfigPattern;
     }
 
     /* Write the dummy cycle value in the configuration register using information coming from SCCR Map */
@@ -1944,22 +2028,108 @@ error :
 }
 
 
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+SFDP_StatusTypeDef SFDP_CacheRestore(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object)
+{
+  const SFDP_CacheRecordTypeDef *cache = SFDP_CACHE;
+  SFDP_DEBUG_STR(__func__);
+
+  if ((cache->Magic != SFDP_CACHE_MAGIC) || (cache->Size != sizeof(SFDP_CacheRecordTypeDef))
+      || (cache->Crc != sfdp_cache_crc((const uint8_t *)cache, offsetof(SFDP_CacheRecordTypeDef, Crc))))
+  {
+    return EXTMEM_SFDP_ERROR_CACHEMISS;
+  }
+
+  Object->sfpd_private.Sfdp_table_mask     = cache->Sfdp_table_mask;
+  Object->sfpd_private.Reset_info          = cache->Reset_info;
+  Object->sfpd_private.Sfdp_param_number   = cache->Sfdp_param_number;
+  Object->sfpd_private.Sfdp_AccessProtocol = cache->Sfdp_AccessProtocol;
+  (void)memcpy(&JEDEC_Basic, &cache->Basic, sizeof(JEDEC_Basic));
+  (void)memcpy(&JEDEC_Address4Bit, &cache->Address4Bit, sizeof(JEDEC_Address4Bit));
+  (void)memcpy(&JEDEC_XSPI10, &cache->XSPI10, sizeof(JEDEC_XSPI10));
+  (void)memcpy(&JEDEC_SCCR_Map, &cache->SCCR_Map, sizeof(JEDEC_SCCR_Map));
+  (void)memcpy(&JEDEC_OctalDdr, &cache->OctalDdr, sizeof(JEDEC_OctalDdr));
+
+  /* the memory state is unknown, put it back in 1S1S1S mode */
+  return sfdp_reset_sequence(Object);
+}
+
+SFDP_StatusTypeDef SFDP_CacheCheckId(const uint8_t *JedecId)
+{
+  SFDP_DEBUG_STR(__func__);
+  if (0 != memcmp(SFDP_CACHE->JedecId, JedecId, sizeof(SFDP_CACHE->JedecId)))
+  {
+    /* another memory is fitted, the record is useless */
+    SFDP_CACHE->Magic = 0u;
+    return EXTMEM_SFDP_ERROR_CACHEMISS;
+  }
+  return EXTMEM_SFDP_OK;
+}
+
+void SFDP_CacheSave(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, const uint8_t *JedecId)
+{
+  SFDP_CacheRecordTypeDef *cache = SFDP_CACHE;
+  SFDP_DEBUG_STR(__func__);
+
+  (void)memset(cache, 0x0, sizeof(SFDP_CacheRecordTypeDef));
+  cache->Size                = sizeof(SFDP_CacheRecordTypeDef);
+  (void)memcpy(cache->JedecId, JedecId, sizeof(cache->JedecId));
+  cache->Sfdp_table_mask     = Object->sfpd_private.Sfdp_table_mask;
+  cache->Reset_info          = Object->sfpd_private.Reset_info;
+  cache->Sfdp_param_number   = Object->sfpd_private.Sfdp_param_number;
+  cache->Sfdp_AccessProtocol = Object->sfpd_private.Sfdp_AccessProtocol;
+  (void)memcpy(&cache->Basic, &JEDEC_Basic, sizeof(JEDEC_Basic));
+  (void)memcpy(&cache->Address4Bit, &JEDEC_Address4Bit, sizeof(JEDEC_Address4Bit));
+  (void)memcpy(&cache->XSPI10, &JEDEC_XSPI10, sizeof(JEDEC_XSPI10));
+  (void)memcpy(&cache->SCCR_Map, &JEDEC_SCCR_Map, sizeof(JEDEC_SCCR_Map));
+  (void)memcpy(&cache->OctalDdr, &JEDEC_OctalDdr, sizeof(JEDEC_OctalDdr));
+  cache->Magic               = SFDP_CACHE_MAGIC;
+  cache->Crc                 = sfdp_cache_crc((const uint8_t *)cache, offsetof(SFDP_CacheRecordTypeDef, Crc));
+}
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0 */
+
 EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_check_FlagBUSY(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Timeout)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY;
+  HAL_StatusTypeDef status = HAL_TIMEOUT;
   SFDP_DEBUG_STR((uint8_t *)__func__)
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  if ((1u == SFDPObject->sfpd_private.Commands.Ready) && (0u != SFDPObject->sfpd_private.DriverInfo.ReadWIPCommand))
+  {
+    /* the status polling is the most frequent command, it is sent without the HAL command setup */
+    status = SAL_XSPI_IssuePolling(&SFDPObject->sfpd_private.SALObject,
+                                   &SFDPObject->sfpd_private.Commands.ReadWIP,
+                                   SFDPObject->sfpd_private.DriverInfo.WIPAddress,
+                                   (uint8_t)(SFDPObject->sfpd_private.DriverInfo.WIPBusyPolarity << SFDPObject->sfpd_private.DriverInfo.WIPPosition),
+                                   (uint8_t)(1u << SFDPObject->sfpd_private.DriverInfo.WIPPosition),
+                                   Timeout);
+  }
+  else
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
   if (0u != SFDPObject->sfpd_private.DriverInfo.ReadWIPCommand)
   {
     /* check if the busy flag is enabled */
-    if (HAL_OK == SAL_XSPI_CheckStatusRegister(&SFDPObject->sfpd_private.SALObject,
-                                               SFDPObject->sfpd_private.DriverInfo.ReadWIPCommand,
-                                               SFDPObject->sfpd_private.DriverInfo.WIPAddress,
-                                               SFDPObject->sfpd_private.DriverInfo.WIPBusyPolarity << SFDPObject->sfpd_private.DriverInfo.WIPPosition,
-                                               1u << SFDPObject->sfpd_private.DriverInfo.WIPPosition,
-                                               Timeout))
-    {
-      retr = EXTMEM_DRIVER_NOR_SFDP_OK;
-    }
+    status = SAL_XSPI_CheckStatusRegister(&SFDPObject->sfpd_private.SALObject,
+                                          SFDPObject->sfpd_private.DriverInfo.ReadWIPCommand,
+                                          SFDPObject->sfpd_private.DriverInfo.WIPAddress,
+                                          SFDPObject->sfpd_private.DriverInfo.WIPBusyPolarity << SFDPObject->sfpd_private.DriverInfo.WIPPosition,
+                                          1u << SFDPObject->sfpd_private.DriverInfo.WIPPosition,
+                                          Timeout);
+  }
+
+  if (HAL_OK == status)
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  }
+  else if (HAL_TIMEOUT != status)
+  {
+    /* the polling did not run to its timeout: the busy state is unknown */
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_STATUS_READ;
+  }
+  else
+  {
+    /* still busy at the timeout */
   }
   return retr;
 }
@@ -1972,6 +2142,7 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_check_FlagBUSY(EXTMEM_DRIVER_NOR_SFD
   * @{
   */
 
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0
 /**
  * @brief This function returns the frequency value corresponding to a frequency
  * @param BitField bit field value
@@ -1989,6 +2160,29 @@ uint32_t sfdp_getfrequencevalue(uint32_t BitField)
   return 0; /* the max frequency is unknown */
 }
 
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+/**
+ * @brief This function computes the CRC32 (IEEE 802.3) protecting the discovery cache
+ * @param Data pointer on the data
+ * @param Size data size in bytes
+ * @return CRC value
+ */
+static uint32_t sfdp_cache_crc(const uint8_t *Data, uint32_t Size)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+
+  for (uint32_t index = 0u; index < Size; index++)
+  {
+    crc ^= Data[index];
+    for (uint8_t bit = 0u; bit < 8u; bit++)
+    {
+      crc = ((crc & 1u) != 0u) ? ((crc >> 1u) ^ 0xEDB88320u) : (crc >> 1u);
+    }
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
+
 /**
  * @brief This function reads and checks the SFDP header
  * @param Object memory Object
@@ -2502,6 +2696,8 @@ NOTE If device is in 0-4-4 mode, then this mode must be exited before the 4-4-4
   return retr;
 }
 
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0 */
+
 /**
  * @brief This function check the validity of the memory type
  * @param Object memory Object
@@ -89,7 +89,8 @@ typedef enum {
       EXTMEM_SFDP_ERROR_DRIVER,
       EXTMEM_SFDP_ERROR_SETCLOCK,
       EXTMEM_SFDP_ERROR_CONFIGDUMMY,
-      EXTMEM_SFDP_ERROR_NOTYETHANDLED
+      EXTMEM_SFDP_ERROR_NOTYETHANDLED,
+      EXTMEM_SFDP_ERROR_CACHEMISS                /*!< no valid discovery cache for this memory */
 } SFDP_StatusTypeDef;
 
 /**
@@ -151,6 +152,31 @@ SFDP_StatusTypeDef SFDP_MemoryReset(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object
  */
 SFDP_StatusTypeDef SFDP_BuildGenericDriver(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, uint8_t *FreqUpdated);
 
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+/**
+ * @brief This function restores the SFDP tables from the discovery cache
+ *        and resets the memory with the cached reset method
+ * @param Object memory instance object descriptor
+ * @return EXTMEM_SFDP_ERROR_CACHEMISS if no valid record is stored
+ */
+SFDP_StatusTypeDef SFDP_CacheRestore(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object);
+
+/**
+ * @brief This function checks the memory ID against the cached one,
+ *        the record is invalidated on mismatch
+ * @param JedecId ID read in 1S1S1S mode (4 bytes)
+ * @return @ref SFDP_StatusTypeDef
+ */
+SFDP_StatusTypeDef SFDP_CacheCheckId(const uint8_t *JedecId);
+
+/**
+ * @brief This function stores the collected SFDP tables in the discovery cache
+ * @param Object memory instance object descriptor
+ * @param JedecId ID read in 1S1S1S mode (4 bytes)
+ */
+void SFDP_CacheSave(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, const uint8_t *JedecId);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
+
 /**
  * @brief This function checks the busy flag
  *
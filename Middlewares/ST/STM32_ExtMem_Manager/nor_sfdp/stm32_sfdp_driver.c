@@ -27,6 +27,12 @@
 #include <stdio.h>
 #endif /* EXTMEM_DRIVER_NOR_SFDP_DEBUG_LEVEL != 0 && defined(EXTMEM_MACRO_DEBUG) */
 #include <string.h>
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+#include <stddef.h>
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1
+#include EXTMEM_DRIVER_NOR_SFDP_PROFILE_FILE
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1 */
 
 /** @defgroup NOR_SFDP NOR SFDP driver
   * @ingroup EXTMEM_DRIVER
@@ -59,6 +65,52 @@
  */
 #define DRIVER_SFDP_DEFAULT_CLOCK 50000000u
 
+/**
+ * @brief maximum time in ms to recover from a memory reset (erase in progress included)
+ */
+#define DRIVER_SFDP_RESET_TIMEOUT 20u
+
+/**
+ * @brief read timing calibration: number of clock prescaler values tested, from the fastest allowed
+ */
+#define DRIVER_CALIB_PRESCALER_STEPS 4u
+
+/**
+ * @brief read timing calibration: fine delay step between two tested settings, 32 settings per clock
+ */
+#define DRIVER_CALIB_FINE_STEP 4u
+
+/**
+ * @brief read timing calibration: minimum number of contiguous passing delay settings
+ */
+#define DRIVER_CALIB_MIN_WINDOW 4u
+
+/**
+ * @brief read timing calibration: size of the read back chunk
+ */
+#define DRIVER_CALIB_CHUNK 32u
+
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+/**
+ * @brief largest read sent with the precompiled command, the longer reads keep the SAL transfer (DMA)
+ */
+#define DRIVER_PRECOMPILED_READ_MAX 256u
+
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+/**
+ * @brief magic of a valid read timing record
+ */
+#define DRIVER_TIMING_MAGIC 0x5843414Cu  /* "XCAL" */
+
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+#if EXTMEM_ASYNC == 1
+/**
+ * @brief maximum size of one asynchronous read transfer (DMA block size limit)
+ */
+#define DRIVER_SFDP_ASYNC_READ_CHUNK 0x8000u
+
+#endif /* EXTMEM_ASYNC == 1 */
 /**
  * @brief DEBUG macro
  */
@@ -115,13 +167,62 @@
   */
 
 /* Private typedefs ---------------------------------------------------------*/
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+/**
+ * @brief calibrated read timing record, kept in a storage that survives resets
+ */
+typedef struct {
+  uint32_t               Magic;          /*!< DRIVER_TIMING_MAGIC when the record is valid */
+  uint32_t               ClockIn;        /*!< XSPI kernel clock of the calibration */
+  uint8_t                PhyLink;        /*!< physical link of the calibration */
+  uint8_t                DummyCycles;    /*!< read dummy cycles of the calibration */
+  uint8_t                ManuID;         /*!< manufacturer ID of the memory */
+  uint8_t                Reserved;
+  SAL_XSPI_TimingTypeDef Default;        /*!< timing of the initialization the calibration started from */
+  SAL_XSPI_TimingTypeDef Timing;         /*!< calibrated timing */
+  uint32_t               Check;          /*!< complement of the sum of the previous words */
+} DRIVER_TimingRecordTypeDef;
+
+#define DRIVER_TIMING_RECORD ((DRIVER_TimingRecordTypeDef *)EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_ADDRESS)
+
+_Static_assert(sizeof(DRIVER_TimingRecordTypeDef) <= EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_SIZE, "timing record does not fit the storage");
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+
 /* Private variables ---------------------------------------------------------*/
+/**
+ * @brief memory-mapped mode of the initialization: linear bursts, nCS kept low
+ */
+static const SAL_XSPI_MapConfigTypeDef DriverLinearMap = { HAL_XSPI_WRAP_NOT_SUPPORTED, 0u };
+
 /* Private functions ---------------------------------------------------------*/
 
 /** @defgroup DRIVER_SFDP_Private_Functions DRIVER SFDP Private Functions
   * @{
   */
 static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_set_FlagWEL(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Timeout);
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_apply_profile(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, const EXTMEM_DRIVER_NOR_SFDP_ProfileTypeDef *Profile);
+#else
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_discover(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint8_t *DataID);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1 */
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_get_SectorErase(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType, uint8_t *Command, uint32_t *Timeout);
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_launch_SectorErase(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType, uint32_t *Timeout);
+static uint8_t driver_read_dummy(const SAL_XSPI_ObjectTypeDef *SalXspi);
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_calib_check(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, const uint8_t *Pattern, uint32_t Size);
+static void driver_calib_window(uint32_t PassMap, uint32_t TapCount, uint32_t *Start, uint32_t *Width);
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+static void driver_build_commands(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+static uint32_t driver_timing_check(const DRIVER_TimingRecordTypeDef *Record);
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_timing_restore(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject);
+static void driver_timing_save(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, const SAL_XSPI_TimingTypeDef *Timing);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+#if EXTMEM_ASYNC == 1
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_async_start(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context);
+static EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_async_step(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject);
+static void driver_async_event(void *Context, SAL_XSPI_EventTypeDef Event);
+#endif /* EXTMEM_ASYNC == 1 */
 __weak void EXTMEM_MemCopy( uint32_t* destination_Address, const uint8_t* ptrData, uint32_t DataSize);
 
 /**
@@ -136,7 +237,10 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Init(void *Periphera
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
   SFPD_HeaderTypeDef JEDEC_SFDP_Header;
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0
   uint8_t FreqUpdate = 0u;
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 0 */
+  SFDP_StatusTypeDef sfdpStatus;
   uint8_t DataID[6];
   uint32_t ClockOut;
 
@@ -159,66 +263,48 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Init(void *Periphera
   /* Abort any ongoing XSPI action */
   (void)SAL_XSPI_DisableMapMode(&SFDPObject->sfpd_private.SALObject);
 
-  /* analyze the SFPD structure to get driver information */
-  SFDP_DEBUG_STR("4 - analyze the SFPD structure to get driver information")
-  if(EXTMEM_SFDP_OK != SFDP_GetHeader(SFDPObject, &JEDEC_SFDP_Header))
-  {
-    /*
-     *  for the future, we can try to get SFDP by using different mode
-     *  the SFDP read is only performed in 1S1S1S mode
-     */
-    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP")
-    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP;
-    goto error;
-  }
+  /* the memory reset drops its burst length: linear bursts until a XIP profile is set */
+  (void)SAL_XSPI_SetMapConfig(&SFDPObject->sfpd_private.SALObject, &DriverLinearMap);
 
-  /* Reset the memory */
-  SFDP_DEBUG_STR("5 - reset the memory")
-  if(EXTMEM_SFDP_OK != SFDP_MemoryReset(SFDPObject))
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1
+  /* the profile built on the host replaces steps 4 to 10 */
+  SFDP_DEBUG_STR("4 - apply the static profile")
+  retr = driver_apply_profile(SFDPObject, &sfdp_profile);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
   {
-    /*
-     *  for the future, we can try to get SFDP by using different mode
-     *  the SFDP read is only performed in 1S1S1S mode
-     */
-    SFDP_DEBUG_STR("ERROR::on the call of SFDP_MemoryReset but no error returned")
+    goto error;
   }
-
-  /* wait few ms after the reset operation, this is done to avoid issue on SFDP read */
-  HAL_Delay(10);
-
-  /* analyze the SFPD structure to get driver information after the reset */
-  SFDP_DEBUG_STR("6 - analyze the SFPD structure to get driver information")
-  if(EXTMEM_SFDP_OK != SFDP_GetHeader(SFDPObject, &JEDEC_SFDP_Header))
+#else
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+  /* a valid cache record replaces steps 4 to 8 when the same memory is fitted */
+  SFDP_DEBUG_STR("4 - look for a cached SFDP discovery")
+  if (EXTMEM_SFDP_OK == SFDP_CacheRestore(SFDPObject))
   {
-    /*
-     *  for the future, we can try to get SFDP by using different mode
-     *  the SFDP read is only perform in 1S1S1S mode
-     */
-    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP")
-    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP;
-    goto error;
+    /* wait the end of the reset with the legacy WIP polling, valid in 1S1S1S mode */
+    SFDPObject->sfpd_private.DriverInfo.ReadWIPCommand = 0x05u;
+    HAL_Delay(1);
+    (void)driver_check_FlagBUSY(SFDPObject, DRIVER_SFDP_RESET_TIMEOUT);
+
+    (void)SAL_XSPI_GetId(&SFDPObject->sfpd_private.SALObject, DataID, 4);
+    DEBUG_ID(DataID);
+    if (EXTMEM_SFDP_OK == SFDP_CacheCheckId(DataID))
+    {
+      SFDPObject->sfpd_private.ManuID = DataID[0];
+      SFDPObject->sfpd_private.ProfileCached = 1u;
+    }
   }
 
-  /* Save information from the SFDP table */
-  SFDPObject->sfpd_private.Sfdp_param_number = JEDEC_SFDP_Header.param_number;
-  SFDPObject->sfpd_private.Sfdp_AccessProtocol = JEDEC_SFDP_Header.AccessProtocol;
-
-  /* read the flash ID */
-  SFDP_DEBUG_STR("7 - read the flash ID")
-  (void)SAL_XSPI_GetId(&SFDPObject->sfpd_private.SALObject, DataID, 4);
-  DEBUG_ID(DataID);
-
-  /* keep manufacturer information, it could be used to help in
-     building of consistent driver */
-  SFDPObject->sfpd_private.ManuID = DataID[0];
-
-  /* get the SFDP data */
-  SFDP_DEBUG_STR("8 - collect the SFDP data")
-  if(EXTMEM_SFDP_OK != SFDP_CollectData(SFDPObject))
+  if (0u == SFDPObject->sfpd_private.ProfileCached)
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
   {
-    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP")
-    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP;
-    goto error;
+    retr = driver_discover(SFDPObject, DataID);
+    if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+    {
+      goto error;
+    }
+#if EXTMEM_DRIVER_NOR_SFDP_CACHE == 1
+    SFDP_CacheSave(SFDPObject, DataID);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_CACHE == 1 */
   }
 
   /* setup the generic driver information and prepare the physical layer */
@@ -236,9 +322,33 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Init(void *Periphera
     (void)SAL_XSPI_SetClock(&SFDPObject->sfpd_private.SALObject, ClockInput, SFDPObject->sfdp_public.MaxFreq, &ClockOut);
     SFDP_DEBUG_STR("--> new freq configured");
   }
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1 */
+
+  /* the calibration always starts from this timing */
+  (void)SAL_XSPI_GetTiming(&SFDPObject->sfpd_private.SALObject, &SFDPObject->sfpd_private.DefaultTiming);
+
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+  SFDP_DEBUG_STR("10b - apply the stored read timing")
+  if (EXTMEM_DRIVER_NOR_SFDP_OK == driver_timing_restore(SFDPObject))
+  {
+    SFDPObject->sfpd_private.TimingStored = 1u;
+  }
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
 
   SFDP_DEBUG_STR("11 - read again the SFDP header to adjust memory type if necessary")
-  if(EXTMEM_SFDP_OK != SFDP_ReadHeader(SFDPObject, &JEDEC_SFDP_Header))
+  sfdpStatus = SFDP_ReadHeader(SFDPObject, &JEDEC_SFDP_Header);
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+  if ((EXTMEM_SFDP_OK != sfdpStatus) && (1u == SFDPObject->sfpd_private.TimingStored))
+  {
+    /* the stored timing no longer fits the board, drop it and go back to the default timing */
+    SFDP_DEBUG_STR("--> stored read timing rejected")
+    DRIVER_TIMING_RECORD->Magic = 0u;
+    SFDPObject->sfpd_private.TimingStored = 0u;
+    (void)SAL_XSPI_SetTiming(&SFDPObject->sfpd_private.SALObject, ClockInput, &SFDPObject->sfpd_private.DefaultTiming);
+    sfdpStatus = SFDP_ReadHeader(SFDPObject, &JEDEC_SFDP_Header);
+  }
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+  if(EXTMEM_SFDP_OK != sfdpStatus)
   {
     SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_MEMTYPE_CHECK")
     retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_MEMTYPE_CHECK;
@@ -249,6 +359,25 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Init(void *Periphera
   (void)SAL_XSPI_GetId(&SFDPObject->sfpd_private.SALObject, DataID, 4);
   DEBUG_ID(DataID);
 
+#if EXTMEM_DRIVER_NOR_SFDP_OCTAL_DTR == 1
+  /* the 8 lines configuration must end in 8D8D8D with the data strobe, a fallback on a slower link is an error */
+  SFDP_DEBUG_STR("12 - check the octal DTR link")
+  if ((EXTMEM_LINK_CONFIG_8LINES == Config)
+      && ((PHY_LINK_8D8D8D != SFDPObject->sfpd_private.DriverInfo.SpiPhyLink)
+          || (HAL_XSPI_DQS_ENABLE != SFDPObject->sfpd_private.SALObject.Commandbase.DQSMode)))
+  {
+    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_OCTAL_DTR")
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_OCTAL_DTR;
+    goto error;
+  }
+#endif /* EXTMEM_DRIVER_NOR_SFDP_OCTAL_DTR == 1 */
+
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  /* the link is final, the commands of the read/write/erase functions are built once */
+  SFDP_DEBUG_STR("13 - precompile the commands")
+  driver_build_commands(SFDPObject);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+
 error:
   return retr;
 }
@@ -275,9 +404,123 @@ void EXTMEM_DRIVER_NOR_SFDP_GetFlashInfo(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *S
                               ((uint32_t)1u << SFDPObject->sfpd_private.DriverInfo.EraseType4Size);
 }
 
+void EXTMEM_DRIVER_NOR_SFDP_GetLinkInfo(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, EXTMEM_DRIVER_NOR_SFDP_LinkInfoTypeDef *LinkInfo)
+{
+  const SAL_XSPI_ObjectTypeDef *sal = &SFDPObject->sfpd_private.SALObject;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  LinkInfo->PhyLink                = SFDPObject->sfpd_private.DriverInfo.SpiPhyLink;
+  LinkInfo->Clock                  = sal->ClockOut;
+  LinkInfo->ReadDummyCycles        = driver_read_dummy(sal);
+  LinkInfo->DataStrobe             = (sal->Commandbase.DQSMode == HAL_XSPI_DQS_ENABLE) ? 1u : 0u;
+  LinkInfo->CommandExtension       = sal->CommandExtension;
+  LinkInfo->ReadInstruction        = SFDPObject->sfpd_private.DriverInfo.ReadInstruction;
+  LinkInfo->PageProgramInstruction = SFDPObject->sfpd_private.DriverInfo.PageProgramInstruction;
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Calibrate(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address,
+                                                                      const uint8_t *Pattern, uint32_t Size,
+                                                                      EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef *Result)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_CALIBRATION;
+  SAL_XSPI_ObjectTypeDef *sal = &SFDPObject->sfpd_private.SALObject;
+  uint32_t clockIn = SFDPObject->sfpd_private.DriverInfo.ClockIn;
+  SAL_XSPI_TimingTypeDef timing;
+  uint32_t passMap;
+  uint32_t tapCount;
+  uint32_t minWindow;
+  uint32_t start = 0u;
+  uint32_t width = 0u;
+  uint8_t delayLine;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  if ((NULL == Pattern) || (0u == Size))
+  {
+    goto error;
+  }
+
+  /* DTR reads are tuned with the sampling delay, STR reads with the sample shifting */
+  delayLine = ((sal->Commandbase.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) || (sal->PhyLink == PHY_LINK_4S4D4D)) ? 1u : 0u;
+  tapCount  = (1u == delayLine) ? ((XSPI_CALSIR_FINE_Msk >> XSPI_CALSIR_FINE_Pos) / DRIVER_CALIB_FINE_STEP) + 1u : 2u;
+  minWindow = (1u == delayLine) ? DRIVER_CALIB_MIN_WINDOW : 1u;
+
+  for (uint32_t step = 0u; (step < DRIVER_CALIB_PRESCALER_STEPS)
+       && (((uint32_t)SFDPObject->sfpd_private.DefaultTiming.Prescaler + step) <= (XSPI_DCR2_PRESCALER_Msk >> XSPI_DCR2_PRESCALER_Pos)); step++)
+  {
+    /* a new clock calibrates the delay lines again, the coarse delay of this clock is kept */
+    timing = SFDPObject->sfpd_private.DefaultTiming;
+    timing.Prescaler = (uint8_t)(timing.Prescaler + step);
+    (void)SAL_XSPI_SetTiming(sal, clockIn, &timing);
+    (void)SAL_XSPI_GetTiming(sal, &timing);
+
+    passMap = 0u;
+    for (uint32_t tap = 0u; tap < tapCount; tap++)
+    {
+      if (1u == delayLine)
+      {
+        timing.DelayFine = (uint8_t)(tap * DRIVER_CALIB_FINE_STEP);
+      }
+      else
+      {
+        timing.SampleShift = (uint8_t)tap;
+      }
+      (void)SAL_XSPI_SetTiming(sal, clockIn, &timing);
+      if (EXTMEM_DRIVER_NOR_SFDP_OK == driver_calib_check(SFDPObject, Address, Pattern, Size))
+      {
+        passMap |= (1uL << tap);
+      }
+    }
+
+    driver_calib_window(passMap, tapCount, &start, &width);
+    if (width >= minWindow)
+    {
+      /* keep the setting in the middle of the window, the most margin on both sides */
+      if (1u == delayLine)
+      {
+        timing.DelayFine = (uint8_t)((start + (width / 2u)) * DRIVER_CALIB_FINE_STEP);
+      }
+      else
+      {
+        timing.SampleShift = (uint8_t)(start + (width / 2u));
+      }
+      (void)SAL_XSPI_SetTiming(sal, clockIn, &timing);
+      retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+      break;
+    }
+  }
+
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+  {
+    DEBUG_DRIVER_ERROR("EXTMEM_DRIVER_NOR_SFDP_Calibrate::ERROR_CALIBRATION")
+    (void)SAL_XSPI_SetTiming(sal, clockIn, &SFDPObject->sfpd_private.DefaultTiming);
+    goto error;
+  }
+
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+  driver_timing_save(SFDPObject, &timing);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+
+  if (NULL != Result)
+  {
+    Result->Timing      = timing;
+    Result->Clock       = sal->ClockOut;
+    Result->TapCount    = (uint8_t)tapCount;
+    Result->WindowStart = (uint8_t)start;
+    Result->WindowWidth = (uint8_t)width;
+  }
+
+error:
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  /* the sample shifting is part of the commands */
+  driver_build_commands(SFDPObject);
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+  return retr;
+}
+
 EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Write(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, const uint8_t* Data, uint32_t Size)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
+  HAL_StatusTypeDef status;
   uint32_t size_write;
   uint32_t local_size = Size;
   uint32_t local_Address = Address;
@@ -320,7 +563,18 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Write(EXTMEM_DRIVER_
     }
 
     /* Write the data */
-    if (HAL_OK != SAL_XSPI_Write(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.PageProgramInstruction, local_Address, (uint8_t *)local_Data, size_write))
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+    if (1u == SFDPObject->sfpd_private.Commands.Ready)
+    {
+      status = SAL_XSPI_IssueWrite(&SFDPObject->sfpd_private.SALObject, &SFDPObject->sfpd_private.Commands.PageProgram,
+                                   local_Address, (const uint8_t *)local_Data, size_write);
+    }
+    else
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+    {
+      status = SAL_XSPI_Write(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.PageProgramInstruction, local_Address, (uint8_t *)local_Data, size_write);
+    }
+    if (HAL_OK != status)
     {
       DEBUG_DRIVER_ERROR("EXTMEM_DRIVER_NOR_SFDP_Write::ERROR_WRITE")
       retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_WRITE;
@@ -447,6 +701,7 @@ error:
 EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Read(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, uint8_t* Data, uint32_t Size)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
+  HAL_StatusTypeDef status;
   DEBUG_DRIVER((uint8_t *)__func__)
   /* check busy flag */
   retr = driver_check_FlagBUSY(SFDPObject, 5000);
@@ -456,7 +711,17 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Read(EXTMEM_DRIVER_N
     goto error;
   }
 
-  if (HAL_OK != SAL_XSPI_Read(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ReadInstruction, Address, Data, Size))
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  if ((1u == SFDPObject->sfpd_private.Commands.Ready) && (Size <= DRIVER_PRECOMPILED_READ_MAX))
+  {
+    status = SAL_XSPI_IssueRead(&SFDPObject->sfpd_private.SALObject, &SFDPObject->sfpd_private.Commands.Read, Address, Data, Size);
+  }
+  else
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+  {
+    status = SAL_XSPI_Read(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ReadInstruction, Address, Data, Size);
+  }
+  if (HAL_OK != status)
   {
     DEBUG_DRIVER_ERROR("EXTMEM_DRIVER_NOR_SFDP_Read::ERROR_READ")
     retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_READ;
@@ -468,79 +733,88 @@ error :
 EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SectorErase(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
-  uint8_t command, size;
-  uint32_t timeout;
+  uint32_t timeout = 0u;
   DEBUG_DRIVER((uint8_t *)__func__)
 
-  /* check if the selected sector type is available */
-  switch(SectorType)
+  retr = driver_launch_SectorErase(SFDPObject, Address, SectorType, &timeout);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
   {
-    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1:
-        command = SFDPObject->sfpd_private.DriverInfo.EraseType1Command;
-        size = SFDPObject->sfpd_private.DriverInfo.EraseType1Size;
-        timeout = SFDPObject->sfpd_private.DriverInfo.EraseType1Timing;
-      break;
-    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE2:
-        command = SFDPObject->sfpd_private.DriverInfo.EraseType2Command;
-        size = SFDPObject->sfpd_private.DriverInfo.EraseType2Size;
-        timeout = SFDPObject->sfpd_private.DriverInfo.EraseType2Timing;
-      break;
-    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE3:
-        command = SFDPObject->sfpd_private.DriverInfo.EraseType3Command;
-        size = SFDPObject->sfpd_private.DriverInfo.EraseType3Size;
-        timeout = SFDPObject->sfpd_private.DriverInfo.EraseType3Timing;
-      break;
-    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE4:
-        command = SFDPObject->sfpd_private.DriverInfo.EraseType4Command;
-        size = SFDPObject->sfpd_private.DriverInfo.EraseType4Size;
-        timeout = SFDPObject->sfpd_private.DriverInfo.EraseType4Timing;
-      break;
-    default :
-      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SECTORTYPE;
-      goto error;
-      break;
+    goto error;
   }
 
-  /* check if the command for this sector size is available */
-  if ( 0x0u == command )
+  /* check busy flag */
+  retr = driver_check_FlagBUSY(SFDPObject, timeout); /* the timeout is set according the memory characteristic */
+
+error:
+  return retr;
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SectorEraseStart(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType)
+{
+  uint32_t timeout = 0u;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  return driver_launch_SectorErase(SFDPObject, Address, SectorType, &timeout);
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_CheckBusy(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Timeout)
+{
+  DEBUG_DRIVER((uint8_t *)__func__)
+  return driver_check_FlagBUSY(SFDPObject, Timeout);
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Suspend(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  uint32_t delay;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  if (0u == SFDPObject->sfpd_private.DriverInfo.SuspendCommand)
   {
-    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SECTORTYPE_UNAVAILABLE;
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND_UNSUPPORTED;
     goto error;
   }
 
-  /* check @ alignment */
-  if (0x0u != (Address % ((uint32_t)1u << size)))
+  /* respect the minimum erase time between a resume and the next suspend, rounded up to the next tick */
+  delay = (SFDPObject->sfpd_private.DriverInfo.ResumeToSuspendDelay + 999u) / 1000u;
+  while ((HAL_GetTick() - SFDPObject->sfpd_private.ResumeTick) <= delay)
   {
-    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_ADDRESS_ALIGNMENT;
-    goto error;
   }
 
-  /* check busy flag */
-  retr = driver_check_FlagBUSY(SFDPObject, 5000u);
-  if ( EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+  if (HAL_OK != SAL_XSPI_CommandSendData(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.SuspendCommand, NULL, 0))
   {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND;
     goto error;
   }
 
-  /* wait for write enable flag */
-  retr = driver_set_FlagWEL(SFDPObject, DRIVER_DEFAULT_TIMEOUT);
-  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr )
+  /* the busy flag is released once the suspend is effective */
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != driver_check_FlagBUSY(SFDPObject, (SFDPObject->sfpd_private.DriverInfo.SuspendLatency / 1000u) + 1u))
   {
-    goto error;
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND;
   }
 
-  /* launch erase command */
-  (void)SAL_XSPI_CommandSendAddress(&SFDPObject->sfpd_private.SALObject, command, Address);
+error:
+  return retr;
+}
 
-  /* check busy flag */
-  retr = driver_check_FlagBUSY(SFDPObject, timeout); /* the timeout is set according the memory characteristic */
-  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Resume(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  if (0u == SFDPObject->sfpd_private.DriverInfo.ResumeCommand)
   {
-    goto error;
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND_UNSUPPORTED;
+  }
+  else if (HAL_OK != SAL_XSPI_CommandSendData(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ResumeCommand, NULL, 0))
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND;
+  }
+  else
+  {
+    SFDPObject->sfpd_private.ResumeTick = HAL_GetTick();
   }
 
-
-error:
   return retr;
 }
 
@@ -583,27 +857,77 @@ error:
   return retr;
 }
 
-EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Enable_MemoryMappedMode(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SetXipProfile(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject,
+                                                                          const EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef *Profile)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  DEBUG_DRIVER((uint8_t *)__func__)
 
-  /* enter the mapped mode */
-  if (HAL_OK != SAL_XSPI_EnableMapMode(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ReadInstruction,
-                                        (uint8_t)SFDPObject->sfpd_private.SALObject.Commandbase.DummyCycles,
-                                        SFDPObject->sfpd_private.DriverInfo.PageProgramInstruction, 0))
+  /* the steps are recorded commands, they only fit the link they have been written for */
+  if ((Profile->StepCount != 0u) && (Profile->PhyLink != SFDPObject->sfpd_private.SALObject.PhyLink))
   {
-    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_MAP_ENABLE;
+    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE")
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE;
+    goto error;
   }
 
+  /* burst length of the memory first, the XSPI must never wrap on a linear memory */
+  for (uint32_t index = 0u; index < Profile->StepCount; index++)
+  {
+    if (HAL_OK != SAL_XSPI_CommandStep(&SFDPObject->sfpd_private.SALObject, &Profile->Steps[index], DRIVER_DEFAULT_TIMEOUT))
+    {
+      SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE")
+      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE;
+      goto error;
+    }
+  }
+
+  if (HAL_OK != SAL_XSPI_SetMapConfig(&SFDPObject->sfpd_private.SALObject, &Profile->Map))
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE;
+  }
+
+error:
+  if (retr != EXTMEM_DRIVER_NOR_SFDP_OK)
+  {
+    (void)SAL_XSPI_SetMapConfig(&SFDPObject->sfpd_private.SALObject, &DriverLinearMap);
+  }
   return retr;
 }
 
-EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Disable_MemoryMappedMode(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Enable_MemoryMappedMode(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
 
-  /* exit the mapped mode */
-  if (HAL_OK != SAL_XSPI_DisableMapMode(&SFDPObject->sfpd_private.SALObject))
+  /* cache line fills are wrapped reads of the read command */
+  if (SFDPObject->sfpd_private.SALObject.hxspi->Init.WrapSize != HAL_XSPI_WRAP_NOT_SUPPORTED)
+  {
+    if (HAL_OK != SAL_XSPI_ConfigureWrappMode(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ReadInstruction,
+                                              (uint8_t)SFDPObject->sfpd_private.SALObject.Commandbase.DummyCycles))
+    {
+      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_MAP_ENABLE;
+      goto error;
+    }
+  }
+
+  /* enter the mapped mode */
+  if (HAL_OK != SAL_XSPI_EnableMapMode(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ReadInstruction,
+                                        (uint8_t)SFDPObject->sfpd_private.SALObject.Commandbase.DummyCycles,
+                                        SFDPObject->sfpd_private.DriverInfo.PageProgramInstruction, 0))
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_MAP_ENABLE;
+  }
+
+error:
+  return retr;
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Disable_MemoryMappedMode(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+
+  /* exit the mapped mode */
+  if (HAL_OK != SAL_XSPI_DisableMapMode(&SFDPObject->sfpd_private.SALObject))
   {
     retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_MAP_ENABLE;
   }
@@ -611,6 +935,85 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Disable_MemoryMapped
   return retr;
 }
 
+#if EXTMEM_ASYNC == 1
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_ReadAsync(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, uint8_t* Data, uint32_t Size,
+                                                                      EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  retr = driver_async_start(SFDPObject, Callback, Context);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK == retr)
+  {
+    SFDPObject->sfpd_private.Async.Operation = EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_READ;
+    SFDPObject->sfpd_private.Async.Address = Address;
+    SFDPObject->sfpd_private.Async.Data = Data;
+    SFDPObject->sfpd_private.Async.Size = Size;
+    retr = driver_async_step(SFDPObject);
+    if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+    {
+      SFDPObject->sfpd_private.Async.State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE;
+    }
+  }
+  return retr;
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_WriteAsync(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, const uint8_t* Data, uint32_t Size,
+                                                                       EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  retr = driver_async_start(SFDPObject, Callback, Context);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK == retr)
+  {
+    SFDPObject->sfpd_private.Async.Operation = EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_WRITE;
+    SFDPObject->sfpd_private.Async.Address = Address;
+    SFDPObject->sfpd_private.Async.Data = (uint8_t *)Data;
+    SFDPObject->sfpd_private.Async.Size = Size;
+    retr = driver_async_step(SFDPObject);
+    if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+    {
+      SFDPObject->sfpd_private.Async.State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE;
+    }
+  }
+  return retr;
+}
+
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SectorEraseAsync(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType,
+                                                                             EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
+  uint8_t command;
+  uint32_t timeout;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  retr = driver_get_SectorErase(SFDPObject, Address, SectorType, &command, &timeout);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+  {
+    goto error;
+  }
+
+  retr = driver_async_start(SFDPObject, Callback, Context);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK == retr)
+  {
+    SFDPObject->sfpd_private.Async.Operation = EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_ERASE;
+    SFDPObject->sfpd_private.Async.EraseCommand = command;
+    SFDPObject->sfpd_private.Async.Address = Address;
+    SFDPObject->sfpd_private.Async.Data = NULL;
+    /* the size only tells that the erase command is still to be sent */
+    SFDPObject->sfpd_private.Async.Size = 1u;
+    retr = driver_async_step(SFDPObject);
+    if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+    {
+      SFDPObject->sfpd_private.Async.State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE;
+    }
+  }
+
+error:
+  return retr;
+}
+#endif /* EXTMEM_ASYNC == 1 */
 
 /**
   * @}
@@ -640,26 +1043,680 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Disable_MemoryMapped
 EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_set_FlagWEL(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Timeout)
 {
   EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_WRITEENABLE;
+  const EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef *info = &SFDPObject->sfpd_private.DriverInfo;
+  uint8_t matchValue = (uint8_t)(((info->WELBusyPolarity == 0u) ? 1u: 0u) << info->WELPosition);
+  uint8_t matchMask = (uint8_t)(1u << info->WELPosition);
+  HAL_StatusTypeDef status;
   DEBUG_DRIVER((uint8_t *)__func__)
-  /* send the command write enable */
-  (void)SAL_XSPI_CommandSendData(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.WriteWELCommand, NULL, 0);
-
-  /* wait for write enable status */
-  if (0u != SFDPObject->sfpd_private.DriverInfo.ReadWELCommand)
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  if (1u == SFDPObject->sfpd_private.Commands.Ready)
   {
+    /* send the command write enable */
+    (void)SAL_XSPI_Issue(&SFDPObject->sfpd_private.SALObject, &SFDPObject->sfpd_private.Commands.WriteEnable, 0u);
+
     /* check if flag write enable is enabled */
-    if (HAL_OK == SAL_XSPI_CheckStatusRegister(&SFDPObject->sfpd_private.SALObject,
-                                               SFDPObject->sfpd_private.DriverInfo.ReadWELCommand,
-                                               SFDPObject->sfpd_private.DriverInfo.WELAddress,
-                                               ((SFDPObject->sfpd_private.DriverInfo.WELBusyPolarity == 0u) ? 1u: 0u) << SFDPObject->sfpd_private.DriverInfo.WELPosition,
-                                               1u << SFDPObject->sfpd_private.DriverInfo.WELPosition,
-                                               Timeout))
+    status = HAL_ERROR;
+    if (0u != info->ReadWELCommand)
     {
-      retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+      status = SAL_XSPI_IssuePolling(&SFDPObject->sfpd_private.SALObject, &SFDPObject->sfpd_private.Commands.ReadWEL,
+                                     info->WELAddress, matchValue, matchMask, Timeout);
+    }
+  }
+  else
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+  {
+    /* send the command write enable */
+    (void)SAL_XSPI_CommandSendData(&SFDPObject->sfpd_private.SALObject, info->WriteWELCommand, NULL, 0);
+
+    /* wait for write enable status */
+    status = HAL_ERROR;
+    if (0u != info->ReadWELCommand)
+    {
+      /* check if flag write enable is enabled */
+      status = SAL_XSPI_CheckStatusRegister(&SFDPObject->sfpd_private.SALObject, info->ReadWELCommand, info->WELAddress,
+                                            matchValue, matchMask, Timeout);
+    }
+  }
+
+  if (HAL_OK == status)
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  }
+  return retr;
+}
+
+#if EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1
+/**
+ * @brief This function replays the configuration sequence of a static profile and
+ *        restores the driver data without reading the SFDP tables
+ *
+ * @param SFDPObject memory object
+ * @param Profile profile generated by tools/sfdp_profile
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_apply_profile(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, const EXTMEM_DRIVER_NOR_SFDP_ProfileTypeDef *Profile)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  uint32_t ClockIn = SFDPObject->sfpd_private.DriverInfo.ClockIn;
+  uint32_t ClockOut;
+  uint8_t DevSize;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  /* the dummy cycles of the sequence have been computed for this clock */
+  if (Profile->ClockIn != ClockIn)
+  {
+    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_PROFILE")
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_PROFILE;
+    goto error;
+  }
+
+  /* reset the memory and switch it to its final link configuration */
+  for (uint32_t index = 0u; index < Profile->StepCount; index++)
+  {
+    if (HAL_OK != SAL_XSPI_CommandStep(&SFDPObject->sfpd_private.SALObject, &Profile->Steps[index], DRIVER_DEFAULT_TIMEOUT))
+    {
+      SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_PROFILE")
+      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_PROFILE;
+      goto error;
     }
   }
+
+  /* restore the result of the discovery */
+  SFDPObject->sfdp_public.MaxFreq                = Profile->MaxFreq;
+  SFDPObject->sfdp_public.DtrReadDummyCycle      = Profile->DtrReadDummyCycle;
+  SFDPObject->sfpd_private.ManuID                = Profile->ManuID;
+  SFDPObject->sfpd_private.FlashSize             = Profile->FlashSize;
+  SFDPObject->sfpd_private.PageSize              = Profile->PageSize;
+  SFDPObject->sfpd_private.DriverInfo            = Profile->DriverInfo;
+  SFDPObject->sfpd_private.DriverInfo.ClockIn    = ClockIn;
+  SFDPObject->sfpd_private.Sfdp_table_mask       = Profile->Sfdp_table_mask;
+  SFDPObject->sfpd_private.Reset_info            = Profile->Reset_info;
+  SFDPObject->sfpd_private.Sfdp_param_number     = Profile->Sfdp_param_number;
+  SFDPObject->sfpd_private.Sfdp_AccessProtocol   = Profile->Sfdp_AccessProtocol;
+  SFDPObject->sfpd_private.SALObject.Commandbase      = Profile->Commandbase;
+  SFDPObject->sfpd_private.SALObject.CommandExtension = Profile->CommandExtension;
+  SFDPObject->sfpd_private.SALObject.SFDPDummyCycle   = Profile->SFDPDummyCycle;
+  SFDPObject->sfpd_private.SALObject.PhyLink          = Profile->PhyLink;
+  SFDPObject->sfpd_private.SALObject.DTRDummyCycle    = Profile->DTRDummyCycle;
+  SFDPObject->sfpd_private.ProfileCached         = 1u;
+
+  /* configure the peripheral as SFDP_BuildGenericDriver does */
+  DevSize = Profile->FlashSize - 1u;
+  (void)SAL_XSPI_MemoryConfig(&SFDPObject->sfpd_private.SALObject, PARAM_FLASHSIZE, &DevSize);
+  (void)SAL_XSPI_SetClock(&SFDPObject->sfpd_private.SALObject, ClockIn, Profile->ClockRequested, &ClockOut);
+
+error:
   return retr;
 }
+#else
+/**
+ * @brief This function reads the SFDP tables of the memory (reset included)
+ *
+ * @param SFDPObject memory object
+ * @param DataID returns the JEDEC ID read in 1S1S1S mode (4 bytes)
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_discover(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint8_t *DataID)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  SFPD_HeaderTypeDef JEDEC_SFDP_Header;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  /* analyze the SFPD structure to get driver information */
+  SFDP_DEBUG_STR("4 - analyze the SFPD structure to get driver information")
+  if(EXTMEM_SFDP_OK != SFDP_GetHeader(SFDPObject, &JEDEC_SFDP_Header))
+  {
+    /*
+     *  for the future, we can try to get SFDP by using different mode
+     *  the SFDP read is only performed in 1S1S1S mode
+     */
+    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP")
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP;
+    goto error;
+  }
+
+  /* Reset the memory */
+  SFDP_DEBUG_STR("5 - reset the memory")
+  if(EXTMEM_SFDP_OK != SFDP_MemoryReset(SFDPObject))
+  {
+    /*
+     *  for the future, we can try to get SFDP by using different mode
+     *  the SFDP read is only performed in 1S1S1S mode
+     */
+    SFDP_DEBUG_STR("ERROR::on the call of SFDP_MemoryReset but no error returned")
+  }
+
+  /* wait few ms after the reset operation, this is done to avoid issue on SFDP read */
+  HAL_Delay(10);
+
+  /* analyze the SFPD structure to get driver information after the reset */
+  SFDP_DEBUG_STR("6 - analyze the SFPD structure to get driver information")
+  if(EXTMEM_SFDP_OK != SFDP_GetHeader(SFDPObject, &JEDEC_SFDP_Header))
+  {
+    /*
+     *  for the future, we can try to get SFDP by using different mode
+     *  the SFDP read is only perform in 1S1S1S mode
+     */
+    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP")
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP;
+    goto error;
+  }
+
+  /* Save information from the SFDP table */
+  SFDPObject->sfpd_private.Sfdp_param_number = JEDEC_SFDP_Header.param_number;
+  SFDPObject->sfpd_private.Sfdp_AccessProtocol = JEDEC_SFDP_Header.AccessProtocol;
+
+  /* read the flash ID */
+  SFDP_DEBUG_STR("7 - read the flash ID")
+  (void)SAL_XSPI_GetId(&SFDPObject->sfpd_private.SALObject, DataID, 4);
+  DEBUG_ID(DataID);
+
+  /* keep manufacturer information, it could be used to help in
+     building of consistent driver */
+  SFDPObject->sfpd_private.ManuID = DataID[0];
+
+  /* get the SFDP data */
+  SFDP_DEBUG_STR("8 - collect the SFDP data")
+  if(EXTMEM_SFDP_OK != SFDP_CollectData(SFDPObject))
+  {
+    SFDP_DEBUG_STR("ERROR::EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP")
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SFDP;
+    goto error;
+  }
+
+error:
+  return retr;
+}
+#endif /* EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE == 1 */
+
+/**
+ * @brief This function returns the erase command of a sector type and checks the address
+ *
+ * @param SFDPObject memory object
+ * @param Address memory address
+ * @param SectorType type of sector
+ * @param Command returns the erase command
+ * @param Timeout returns the erase timing of the sector type
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_get_SectorErase(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType, uint8_t *Command, uint32_t *Timeout)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  uint8_t size;
+
+  /* check if the selected sector type is available */
+  switch(SectorType)
+  {
+    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1:
+        *Command = SFDPObject->sfpd_private.DriverInfo.EraseType1Command;
+        size = SFDPObject->sfpd_private.DriverInfo.EraseType1Size;
+        *Timeout = SFDPObject->sfpd_private.DriverInfo.EraseType1Timing;
+      break;
+    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE2:
+        *Command = SFDPObject->sfpd_private.DriverInfo.EraseType2Command;
+        size = SFDPObject->sfpd_private.DriverInfo.EraseType2Size;
+        *Timeout = SFDPObject->sfpd_private.DriverInfo.EraseType2Timing;
+      break;
+    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE3:
+        *Command = SFDPObject->sfpd_private.DriverInfo.EraseType3Command;
+        size = SFDPObject->sfpd_private.DriverInfo.EraseType3Size;
+        *Timeout = SFDPObject->sfpd_private.DriverInfo.EraseType3Timing;
+      break;
+    case EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE4:
+        *Command = SFDPObject->sfpd_private.DriverInfo.EraseType4Command;
+        size = SFDPObject->sfpd_private.DriverInfo.EraseType4Size;
+        *Timeout = SFDPObject->sfpd_private.DriverInfo.EraseType4Timing;
+      break;
+    default :
+      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SECTORTYPE;
+      goto error;
+      break;
+  }
+
+  /* check if the command for this sector size is available */
+  if ( 0x0u == *Command )
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_SECTORTYPE_UNAVAILABLE;
+    goto error;
+  }
+
+  /* check @ alignment */
+  if (0x0u != (Address % ((uint32_t)1u << size)))
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_ADDRESS_ALIGNMENT;
+    goto error;
+  }
+
+error:
+  return retr;
+}
+
+/**
+ * @brief This function checks the sector parameters and launches the erase command
+ *
+ * @param SFDPObject memory object
+ * @param Address memory address
+ * @param SectorType type of sector
+ * @param Timeout returns the erase timing of the sector type
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_launch_SectorErase(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType, uint32_t *Timeout)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr;
+  uint8_t command;
+  DEBUG_DRIVER((uint8_t *)__func__)
+
+  retr = driver_get_SectorErase(SFDPObject, Address, SectorType, &command, Timeout);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+  {
+    goto error;
+  }
+
+  /* check busy flag */
+  retr = driver_check_FlagBUSY(SFDPObject, 5000u);
+  if ( EXTMEM_DRIVER_NOR_SFDP_OK != retr)
+  {
+    goto error;
+  }
+
+  /* wait for write enable flag */
+  retr = driver_set_FlagWEL(SFDPObject, DRIVER_DEFAULT_TIMEOUT);
+  if (EXTMEM_DRIVER_NOR_SFDP_OK != retr )
+  {
+    goto error;
+  }
+
+  /* launch erase command */
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  if (1u == SFDPObject->sfpd_private.Commands.Ready)
+  {
+    (void)SAL_XSPI_Issue(&SFDPObject->sfpd_private.SALObject, &SFDPObject->sfpd_private.Commands.Erase[SectorType], Address);
+  }
+  else
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+  {
+    (void)SAL_XSPI_CommandSendAddress(&SFDPObject->sfpd_private.SALObject, command, Address);
+  }
+
+error:
+  return retr;
+}
+
+/**
+ * @brief This function returns the dummy cycles of the data read
+ *
+ * @param SalXspi SAL XSPI handle
+ * @return number of dummy cycles
+ **/
+uint8_t driver_read_dummy(const SAL_XSPI_ObjectTypeDef *SalXspi)
+{
+  return (SalXspi->PhyLink == PHY_LINK_4S4D4D) ? SalXspi->DTRDummyCycle : (uint8_t)SalXspi->Commandbase.DummyCycles;
+}
+
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+/**
+ * @brief This function precompiles the commands of the read, write and erase functions
+ *        for the current link, the SAL functions are used while the table is not ready
+ *
+ * @param SFDPObject memory object
+ * @return none
+ **/
+void driver_build_commands(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+{
+  const SAL_XSPI_ObjectTypeDef *sal = &SFDPObject->sfpd_private.SALObject;
+  const EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef *info = &SFDPObject->sfpd_private.DriverInfo;
+  EXTMEM_DRIVER_NOR_SFDP_CommandTableTypeDef *table = &SFDPObject->sfpd_private.Commands;
+  const uint8_t eraseCommand[4] = { info->EraseType1Command, info->EraseType2Command,
+                                    info->EraseType3Command, info->EraseType4Command };
+  HAL_StatusTypeDef status;
+
+  table->Ready = 0u;
+  status = SAL_XSPI_BuildCommand(sal, SAL_XSPI_DESC_READ, info->ReadInstruction, &table->Read);
+  if (HAL_OK == status)
+  {
+    status = SAL_XSPI_BuildCommand(sal, SAL_XSPI_DESC_WRITE, info->PageProgramInstruction, &table->PageProgram);
+  }
+  if (HAL_OK == status)
+  {
+    status = SAL_XSPI_BuildCommand(sal, SAL_XSPI_DESC_INSTRUCTION, info->WriteWELCommand, &table->WriteEnable);
+  }
+  if (HAL_OK == status)
+  {
+    status = SAL_XSPI_BuildCommand(sal, SAL_XSPI_DESC_STATUS, info->ReadWIPCommand, &table->ReadWIP);
+  }
+  if (HAL_OK == status)
+  {
+    status = SAL_XSPI_BuildCommand(sal, SAL_XSPI_DESC_STATUS, info->ReadWELCommand, &table->ReadWEL);
+  }
+  for (uint32_t index = 0u; (HAL_OK == status) && (index < 4u); index++)
+  {
+    /* an unsupported sector type is rejected before its command is sent */
+    status = SAL_XSPI_BuildCommand(sal, SAL_XSPI_DESC_ADDRESS, eraseCommand[index], &table->Erase[index]);
+  }
+
+  if (HAL_OK == status)
+  {
+    table->Ready = 1u;
+  }
+}
+
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+/**
+ * @brief This function reads back the calibration pattern with the current timing
+ * @note the memory is idle during the calibration, the busy flag is not checked: with a wrong timing
+ *       the status read fails as well
+ *
+ * @param SFDPObject memory object
+ * @param Address address of the pattern
+ * @param Pattern expected content
+ * @param Size size of the pattern
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_calib_check(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, const uint8_t *Pattern, uint32_t Size)
+{
+  uint8_t buffer[DRIVER_CALIB_CHUNK];
+  uint32_t offset = 0u;
+  uint32_t length;
+
+  while (offset < Size)
+  {
+    length = Size - offset;
+    if (length > DRIVER_CALIB_CHUNK)
+    {
+      length = DRIVER_CALIB_CHUNK;
+    }
+
+    if ((HAL_OK != SAL_XSPI_Read(&SFDPObject->sfpd_private.SALObject, SFDPObject->sfpd_private.DriverInfo.ReadInstruction,
+                                 Address + offset, buffer, length))
+        || (0 != memcmp(buffer, &Pattern[offset], length)))
+    {
+      return EXTMEM_DRIVER_NOR_SFDP_ERROR_READ;
+    }
+    offset += length;
+  }
+  return EXTMEM_DRIVER_NOR_SFDP_OK;
+}
+
+/**
+ * @brief This function finds the widest run of passing settings
+ *
+ * @param PassMap bit n set when the setting n passes
+ * @param TapCount number of settings tested
+ * @param Start returns the first setting of the run
+ * @param Width returns the number of settings of the run, 0 if none passes
+ **/
+void driver_calib_window(uint32_t PassMap, uint32_t TapCount, uint32_t *Start, uint32_t *Width)
+{
+  uint32_t run = 0u;
+
+  *Start = 0u;
+  *Width = 0u;
+  for (uint32_t tap = 0u; tap < TapCount; tap++)
+  {
+    run = (0u != (PassMap & (1uL << tap))) ? (run + 1u) : 0u;
+    if (run > *Width)
+    {
+      *Width = run;
+      *Start = tap + 1u - run;
+    }
+  }
+}
+
+#if EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1
+/**
+ * @brief This function computes the check word of a timing record
+ *
+ * @param Record timing record
+ * @return check word
+ **/
+uint32_t driver_timing_check(const DRIVER_TimingRecordTypeDef *Record)
+{
+  const uint32_t *word = (const uint32_t *)Record;
+  uint32_t sum = 0u;
+
+  for (uint32_t index = 0u; index < (offsetof(DRIVER_TimingRecordTypeDef, Check) / sizeof(uint32_t)); index++)
+  {
+    sum += word[index];
+  }
+  return ~sum;
+}
+
+/**
+ * @brief This function applies the stored timing when it was calibrated for the same memory and link
+ *
+ * @param SFDPObject memory object
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_timing_restore(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+{
+  const DRIVER_TimingRecordTypeDef *record = DRIVER_TIMING_RECORD;
+  const SAL_XSPI_ObjectTypeDef *sal = &SFDPObject->sfpd_private.SALObject;
+
+  /* the record must start from the same default timing, the clock limit of the memory is then unchanged */
+  if ((record->Magic != DRIVER_TIMING_MAGIC) || (record->Check != driver_timing_check(record))
+      || (record->ClockIn != SFDPObject->sfpd_private.DriverInfo.ClockIn)
+      || (record->PhyLink != (uint8_t)SFDPObject->sfpd_private.DriverInfo.SpiPhyLink)
+      || (record->DummyCycles != driver_read_dummy(sal))
+      || (record->ManuID != SFDPObject->sfpd_private.ManuID)
+      || (record->Default.Prescaler != SFDPObject->sfpd_private.DefaultTiming.Prescaler)
+      || (record->Default.SampleShift != SFDPObject->sfpd_private.DefaultTiming.SampleShift))
+  {
+    return EXTMEM_DRIVER_NOR_SFDP_ERROR_CALIBRATION;
+  }
+
+  (void)SAL_XSPI_SetTiming(&SFDPObject->sfpd_private.SALObject, record->ClockIn, &record->Timing);
+  return EXTMEM_DRIVER_NOR_SFDP_OK;
+}
+
+/**
+ * @brief This function stores a calibrated timing
+ *
+ * @param SFDPObject memory object
+ * @param Timing calibrated timing
+ **/
+void driver_timing_save(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, const SAL_XSPI_TimingTypeDef *Timing)
+{
+  DRIVER_TimingRecordTypeDef *record = DRIVER_TIMING_RECORD;
+
+  (void)memset(record, 0x0, sizeof(DRIVER_TimingRecordTypeDef));
+  record->ClockIn     = SFDPObject->sfpd_private.DriverInfo.ClockIn;
+  record->PhyLink     = (uint8_t)SFDPObject->sfpd_private.DriverInfo.SpiPhyLink;
+  record->DummyCycles = driver_read_dummy(&SFDPObject->sfpd_private.SALObject);
+  record->ManuID      = SFDPObject->sfpd_private.ManuID;
+  record->Default     = SFDPObject->sfpd_private.DefaultTiming;
+  record->Timing      = *Timing;
+  record->Magic       = DRIVER_TIMING_MAGIC;
+  record->Check       = driver_timing_check(record);
+}
+#endif /* EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE == 1 */
+
+#if EXTMEM_ASYNC == 1
+/**
+ * @brief This function reserves the driver for an asynchronous operation
+ *
+ * @param SFDPObject memory object
+ * @param Callback completion callback
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_async_start(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+
+  if (EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE != SFDPObject->sfpd_private.Async.State)
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_ASYNC_BUSY;
+    goto error;
+  }
+
+  /* the end of each step is detected with the busy flag */
+  if (0u == SFDPObject->sfpd_private.DriverInfo.ReadWIPCommand)
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY;
+    goto error;
+  }
+
+  if (HAL_OK != SAL_XSPI_SetEventCallback(&SFDPObject->sfpd_private.SALObject, driver_async_event, SFDPObject))
+  {
+    retr = EXTMEM_DRIVER_NOR_SFDP_ERROR;
+    goto error;
+  }
+
+  SFDPObject->sfpd_private.Async.Callback = Callback;
+  SFDPObject->sfpd_private.Async.Context = Context;
+  SFDPObject->sfpd_private.Async.TransferSize = 0u;
+
+error:
+  return retr;
+}
+
+/**
+ * @brief This function starts the next step of the asynchronous operation according to
+ *        the step just completed, the state goes back to idle once the operation is over
+ *
+ * @param SFDPObject memory object
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef driver_async_step(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject)
+{
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+  EXTMEM_DRIVER_NOR_SFDP_AsyncTypeDef *async = &SFDPObject->sfpd_private.Async;
+  EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef *info = &SFDPObject->sfpd_private.DriverInfo;
+  SAL_XSPI_ObjectTypeDef *salobject = &SFDPObject->sfpd_private.SALObject;
+  uint32_t size;
+
+  /* the state is updated before each start, the completion may occur before the SAL returns */
+  if ((EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER == async->State) && (EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_WRITE == async->Operation))
+  {
+    /* wait for the end of the page program */
+    async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_READY;
+    if (HAL_OK != SAL_XSPI_CheckStatusRegisterAsync(salobject, info->ReadWIPCommand, info->WIPAddress,
+                                                    info->WIPBusyPolarity << info->WIPPosition, 1u << info->WIPPosition))
+    {
+      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY;
+    }
+  }
+  else if ((EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER == async->State) || (EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_READY == async->State))
+  {
+    if (0u == async->Size)
+    {
+      async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE;
+    }
+    else if (EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_READ == async->Operation)
+    {
+      size = MIN(async->Size, DRIVER_SFDP_ASYNC_READ_CHUNK);
+      async->TransferSize = size;
+      async->Size = async->Size - size;
+      async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER;
+      if (HAL_OK != SAL_XSPI_ReadAsync(salobject, info->ReadInstruction, async->Address, async->Data, size))
+      {
+        retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_READ;
+      }
+    }
+    else
+    {
+      /* send the write enable and wait for its activation */
+      (void)SAL_XSPI_CommandSendData(salobject, info->WriteWELCommand, NULL, 0);
+      async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_WEL;
+      if ((0u == info->ReadWELCommand)
+          || (HAL_OK != SAL_XSPI_CheckStatusRegisterAsync(salobject, info->ReadWELCommand, info->WELAddress,
+                                                          ((info->WELBusyPolarity == 0u) ? 1u: 0u) << info->WELPosition,
+                                                          1u << info->WELPosition)))
+      {
+        retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_WRITEENABLE;
+      }
+    }
+  }
+  else if (EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_WEL == async->State)
+  {
+    if (EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_ERASE == async->Operation)
+    {
+      /* launch the erase command and wait for its end */
+      async->Size = 0u;
+      async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_READY;
+      if ((HAL_OK != SAL_XSPI_CommandSendAddress(salobject, async->EraseCommand, async->Address))
+          || (HAL_OK != SAL_XSPI_CheckStatusRegisterAsync(salobject, info->ReadWIPCommand, info->WIPAddress,
+                                                          info->WIPBusyPolarity << info->WIPPosition, 1u << info->WIPPosition)))
+      {
+        retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY;
+      }
+    }
+    else
+    {
+      /* program up to the end of the page */
+      size = SFDPObject->sfpd_private.PageSize - (async->Address % SFDPObject->sfpd_private.PageSize);
+      size = MIN(async->Size, size);
+      async->TransferSize = size;
+      async->Size = async->Size - size;
+      async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER;
+      if (HAL_OK != SAL_XSPI_WriteAsync(salobject, info->PageProgramInstruction, async->Address, async->Data, size))
+      {
+        retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_WRITE;
+      }
+    }
+  }
+  else
+  {
+    /* start of the operation: wait until the memory is ready */
+    async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_READY;
+    if (HAL_OK != SAL_XSPI_CheckStatusRegisterAsync(salobject, info->ReadWIPCommand, info->WIPAddress,
+                                                    info->WIPBusyPolarity << info->WIPPosition, 1u << info->WIPPosition))
+    {
+      retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY;
+    }
+  }
+
+  return retr;
+}
+
+/**
+ * @brief This function is called by the SAL under interrupt at the end of each step
+ *
+ * @param Context memory object
+ * @param Event SAL event
+ **/
+void driver_async_event(void *Context, SAL_XSPI_EventTypeDef Event)
+{
+  EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject = (EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *)Context;
+  EXTMEM_DRIVER_NOR_SFDP_AsyncTypeDef *async = &SFDPObject->sfpd_private.Async;
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef retr = EXTMEM_DRIVER_NOR_SFDP_OK;
+
+  if (SAL_XSPI_EVENT_ERROR == Event)
+  {
+    switch (async->State)
+    {
+      case EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_WEL:
+        retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_WRITEENABLE;
+        break;
+      case EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER:
+        retr = (EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_READ == async->Operation) ? EXTMEM_DRIVER_NOR_SFDP_ERROR_READ : EXTMEM_DRIVER_NOR_SFDP_ERROR_WRITE;
+        break;
+      default:
+        retr = EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY;
+        break;
+    }
+  }
+  else
+  {
+    if (EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER == async->State)
+    {
+      async->Address = async->Address + async->TransferSize;
+      async->Data = &async->Data[async->TransferSize];
+    }
+    retr = driver_async_step(SFDPObject);
+  }
+
+  if ((EXTMEM_DRIVER_NOR_SFDP_OK != retr) || (EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE == async->State))
+  {
+    /* release the driver before the callback, which may start the next operation */
+    async->State = EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE;
+    if (NULL != async->Callback)
+    {
+      async->Callback(async->Context, (int32_t)retr);
+    }
+  }
+}
+#endif /* EXTMEM_ASYNC == 1 */
 
 __weak void EXTMEM_MemCopy(uint32_t* destination_Address, const uint8_t* ptrData, uint32_t DataSize)
 {
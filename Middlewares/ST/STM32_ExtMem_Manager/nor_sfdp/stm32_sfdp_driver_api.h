@@ -58,6 +58,14 @@ typedef enum  {
   EXTMEM_DRIVER_NOR_SFDP_ERROR_FLASHBUSY              = -12,
   EXTMEM_DRIVER_NOR_SFDP_ERROR_MAP_ENABLE             = -13,
   EXTMEM_DRIVER_NOR_SFDP_ERROR_MEMTYPE_CHECK          = -14,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND_UNSUPPORTED    = -15,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_SUSPEND                = -16,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_PROFILE                = -17,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_ASYNC_BUSY             = -18,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_OCTAL_DTR              = -19,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_CALIBRATION            = -20,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE            = -21,
+  EXTMEM_DRIVER_NOR_SFDP_ERROR_STATUS_READ            = -22,
   EXTMEM_DRIVER_NOR_SFDP_ERROR                        = -128,
 } EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef;
 
@@ -108,6 +116,48 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_DeInit(EXTMEM_DRIVER
  **/
 void EXTMEM_DRIVER_NOR_SFDP_GetFlashInfo(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, EXTMEM_NOR_SFDP_FlashInfoTypeDef *FlashInfo);
 
+/**
+ * @brief This function returns the link configured with the memory
+ *
+ * @param SFDPObject memory object
+ * @param LinkInfo pointer on link info structure
+ **/
+void EXTMEM_DRIVER_NOR_SFDP_GetLinkInfo(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, EXTMEM_DRIVER_NOR_SFDP_LinkInfoTypeDef *LinkInfo);
+
+/**
+ * @brief This function calibrates the read timing of the link on a pattern already programmed in the memory
+ * @note the clock prescaler is swept from the value set by the initialization (the fastest clock allowed
+ *       by the memory) to slower clocks. At each clock, the read sampling delay (DTR reads) or the sample
+ *       shifting (STR reads) is swept and the pattern read back. The fastest clock with a passing window
+ *       wide enough is kept, with the setting in the middle of the window. With
+ *       EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE the result is stored and applied by the next initialization.
+ *
+ * @param SFDPObject memory object
+ * @param Address address of the pattern in the memory
+ * @param Pattern expected content
+ * @param Size size of the pattern
+ * @param Result pointer on the calibration result, can be NULL
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef, EXTMEM_DRIVER_NOR_SFDP_ERROR_CALIBRATION when no
+ *         clock passes, the timing of the initialization is then restored
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Calibrate(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address,
+                                                                      const uint8_t *Pattern, uint32_t Size,
+                                                                      EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef *Result);
+
+/**
+ * @brief This function sets the execute in place profile used by the next memory-mapped mode
+ * @note the steps configure the burst length of the memory, the wrapped bursts of the XSPI must have
+ *       the same length. With a wrap size, the mapped mode issues the cache line fills as wrapped reads
+ *       with the read command. The initialization goes back to linear bursts without timeout.
+ *
+ * @param SFDPObject memory object
+ * @param Profile profile to apply, it must have been written for the link configured by the initialization
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef, EXTMEM_DRIVER_NOR_SFDP_ERROR_XIP_PROFILE when the
+ *         link differs or when the memory rejects a step, the linear profile is then restored
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SetXipProfile(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject,
+                                                                          const EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef *Profile);
+
 /**
  * @brief This function reads the memory
  *
@@ -159,6 +209,94 @@ EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_MassErase(EXTMEM_DRI
  **/
 EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SectorErase(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType);
 
+/**
+ * @brief This function launches a sector erase without waiting for its completion
+ *
+ * @param SFDPObject memory object
+ * @param Address memory address
+ * @param SectorType type of sector
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ *
+ * @note the end of the erase is checked with @ref EXTMEM_DRIVER_NOR_SFDP_CheckBusy, meanwhile the
+ *       erase can be suspended to access the memory (mapped mode included) and resumed afterwards.
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SectorEraseStart(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType);
+
+/**
+ * @brief This function waits until the memory is no longer busy
+ *
+ * @param SFDPObject memory object
+ * @param Timeout maximum waiting time in ms
+ * @return EXTMEM_DRIVER_NOR_SFDP_OK when the memory is ready, EXTMEM_DRIVER_NOR_SFDP_ERROR_BUSY when it is
+ *         still busy at the timeout, EXTMEM_DRIVER_NOR_SFDP_ERROR_STATUS_READ when the status could not be polled
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_CheckBusy(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Timeout);
+
+/**
+ * @brief This function suspends the ongoing erase
+ *
+ * @param SFDPObject memory object
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ *
+ * @note on success the memory accepts read commands and can be switched to mapped mode,
+ *       @ref EXTMEM_DRIVER_NOR_SFDP_Resume must be called once the mapped mode is disabled.
+ *       If the erase already completed, the suspend has no effect and the resume is ignored.
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Suspend(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject);
+
+/**
+ * @brief This function resumes a suspended erase
+ *
+ * @param SFDPObject memory object
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_Resume(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject);
+
+#if EXTMEM_ASYNC == 1
+/**
+ * @brief This function starts the read of data from the memory and returns immediately
+ *
+ * @param SFDPObject memory object
+ * @param Address memory address
+ * @param Data pointer on the data, aligned on a cache line when a DMA channel is linked
+ * @param Size data size
+ * @param Callback function called under interrupt at the end of the read
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_ReadAsync(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, uint8_t* Data, uint32_t Size,
+                                                                      EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context);
+
+/**
+ * @brief This function starts the write of data in the memory and returns immediately
+ *
+ * @param SFDPObject memory object
+ * @param Address memory address
+ * @param Data pointer on the data, must stay valid until the callback
+ * @param Size data size
+ * @param Callback function called under interrupt once the last page is programmed
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ *
+ * @note the page programs and the status pollings are chained under interrupt
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_WriteAsync(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, const uint8_t* Data, uint32_t Size,
+                                                                       EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context);
+
+/**
+ * @brief This function starts the erase of a sector and returns immediately
+ *
+ * @param SFDPObject memory object
+ * @param Address memory address
+ * @param SectorType type of sector
+ * @param Callback function called under interrupt at the end of the erase
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef
+ **/
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef EXTMEM_DRIVER_NOR_SFDP_SectorEraseAsync(EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *SFDPObject, uint32_t Address, EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType,
+                                                                             EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef Callback, void *Context);
+#endif /* EXTMEM_ASYNC == 1 */
+
 /**
  * @brief This function enables the memory mapped mode
  *
@@ -83,9 +83,106 @@ typedef struct {
   uint32_t EraseType3Timing;                         /*!< erase 3 timing */
   uint32_t EraseType4Timing;                         /*!< erase 4 timing */
   uint32_t EraseChipTiming;                          /*!< erase chip timing */
+
+  /* Erase suspend/resume management */
+  uint8_t SuspendCommand;                            /*!< erase suspend command, zero if not supported */
+  uint8_t ResumeCommand;                             /*!< erase resume command */
+  uint32_t SuspendLatency;                           /*!< max suspend latency in us */
+  uint32_t ResumeToSuspendDelay;                     /*!< min delay between a resume and the next suspend in us */
 } EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef;
 
 
+/**
+ * @brief link information, as configured at the end of the initialization
+ */
+typedef struct {
+  SAL_XSPI_PhysicalLinkTypeDef PhyLink;              /*!< physical link */
+  uint32_t Clock;                                    /*!< memory clock in Hz */
+  uint8_t  ReadDummyCycles;                          /*!< dummy cycles of the data read */
+  uint8_t  DataStrobe;                               /*!< 1 when the read data are sampled with DQS */
+  uint8_t  CommandExtension;                         /*!< 8D8D8D only, 0: same as the command 1: inverted */
+  uint8_t  ReadInstruction;                          /*!< read command */
+  uint8_t  PageProgramInstruction;                   /*!< page program command */
+} EXTMEM_DRIVER_NOR_SFDP_LinkInfoTypeDef;
+
+/**
+ * @brief result of the read timing calibration
+ */
+typedef struct {
+  SAL_XSPI_TimingTypeDef Timing;                     /*!< timing applied, in the middle of the passing window */
+  uint32_t Clock;                                    /*!< memory clock in Hz with this timing */
+  uint8_t  TapCount;                                 /*!< number of settings tested at this clock */
+  uint8_t  WindowStart;                              /*!< first passing setting of the window */
+  uint8_t  WindowWidth;                              /*!< number of passing settings in the window */
+} EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef;
+
+/**
+ * @brief execute in place profile: how the memory-mapped mode fetches the code, see EXTMEM_DRIVER_NOR_SFDP_SetXipProfile
+ */
+typedef struct {
+  SAL_XSPI_MapConfigTypeDef          Map;                  /*!< wrap size and timeout of the memory-mapped mode */
+  SAL_XSPI_PhysicalLinkTypeDef       PhyLink;              /*!< link the steps have been written for */
+  const SAL_XSPI_CommandStepTypeDef  *Steps;               /*!< burst length configuration sent to the memory, NULL if none */
+  uint32_t                           StepCount;            /*!< number of steps */
+} EXTMEM_DRIVER_NOR_SFDP_XipProfileTypeDef;
+
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+/**
+ * @brief commands of the memory, precompiled once the link is configured
+ */
+typedef struct {
+  SAL_XSPI_CommandDescTypeDef Read;                  /*!< data read */
+  SAL_XSPI_CommandDescTypeDef PageProgram;           /*!< page program */
+  SAL_XSPI_CommandDescTypeDef WriteEnable;           /*!< write enable */
+  SAL_XSPI_CommandDescTypeDef ReadWIP;               /*!< read of the write in progress flag */
+  SAL_XSPI_CommandDescTypeDef ReadWEL;               /*!< read of the write enable flag */
+  SAL_XSPI_CommandDescTypeDef Erase[4];              /*!< erase of each sector type */
+  uint8_t                     Ready;                 /*!< 1 when the commands match the current link and timing */
+} EXTMEM_DRIVER_NOR_SFDP_CommandTableTypeDef;
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+
+#if EXTMEM_ASYNC == 1
+/**
+ * @brief completion callback of the asynchronous functions, called under interrupt
+ *        with a @ref EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef value
+ */
+typedef void (*EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef)(void *Context, int32_t Status);
+
+/**
+ * @brief asynchronous operations
+ */
+typedef enum {
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_READ,           /*!< data read */
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_WRITE,          /*!< page programs */
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_OP_ERASE,          /*!< sector erase */
+} EXTMEM_DRIVER_NOR_SFDP_AsyncOpTypeDef;
+
+/**
+ * @brief states of the asynchronous operation
+ */
+typedef enum {
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_IDLE,              /*!< no operation ongoing */
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_READY,        /*!< status polling on the busy flag */
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_WAIT_WEL,          /*!< status polling on the write enable flag */
+  EXTMEM_DRIVER_NOR_SFDP_ASYNC_TRANSFER,          /*!< data transfer */
+} EXTMEM_DRIVER_NOR_SFDP_AsyncStateTypeDef;
+
+/**
+ * @brief context of the asynchronous operation
+ */
+typedef struct {
+  volatile EXTMEM_DRIVER_NOR_SFDP_AsyncStateTypeDef State;  /*!< current step */
+  EXTMEM_DRIVER_NOR_SFDP_AsyncOpTypeDef    Operation;       /*!< requested operation */
+  uint8_t                                  EraseCommand;    /*!< erase command of the sector type */
+  uint32_t                                 Address;         /*!< address of the next transfer */
+  uint8_t                                  *Data;           /*!< data of the next transfer */
+  uint32_t                                 Size;            /*!< remaining size, 0 once the last step is started */
+  uint32_t                                 TransferSize;    /*!< size of the ongoing transfer */
+  EXTMEM_DRIVER_NOR_SFDP_CallbackTypeDef   Callback;        /*!< completion callback */
+  void                                     *Context;        /*!< parameter given back to the callback */
+} EXTMEM_DRIVER_NOR_SFDP_AsyncTypeDef;
+#endif /* EXTMEM_ASYNC == 1 */
+
 /**
  * @brief driver SFDP Object definition
  */
@@ -107,9 +204,45 @@ typedef struct {
   uint32_t                  Reset_info;            /*!< this bit is a copy of JEDEC Basic 16 Reset/Rescue info */
   uint8_t                   Sfdp_param_number;     /*!< Number of param from the SFDP header table */
   uint8_t                   Sfdp_AccessProtocol;   /*!< Access protocol from the SFDP header table */
+  uint32_t                  ResumeTick;            /*!< tick of the last erase resume command */
+  uint8_t                   ProfileCached;         /*!< 1 when the SFDP discovery comes from the cache or a static profile */
+  SAL_XSPI_TimingTypeDef    DefaultTiming;         /*!< read timing set by the initialization, before any calibration */
+  uint8_t                   TimingStored;          /*!< 1 when the read timing comes from a stored calibration */
+#if EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1
+  EXTMEM_DRIVER_NOR_SFDP_CommandTableTypeDef Commands; /*!< precompiled commands */
+#endif /* EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS == 1 */
+#if EXTMEM_ASYNC == 1
+  EXTMEM_DRIVER_NOR_SFDP_AsyncTypeDef Async;       /*!< asynchronous operation */
+#endif /* EXTMEM_ASYNC == 1 */
   } sfpd_private;
 } EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef;
 
+/**
+ * @brief static driver profile, generated on a host from a SFDP dump (see tools/sfdp_profile)
+ *        and applied by EXTMEM_DRIVER_NOR_SFDP_Init when EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE is set
+ */
+typedef struct {
+  uint32_t                           ClockIn;              /*!< XSPI kernel clock the profile has been built for */
+  uint32_t                           ClockRequested;       /*!< memory clock requested at the end of the discovery */
+  uint32_t                           MaxFreq;              /*!< copy of sfdp_public.MaxFreq */
+  uint8_t                            DtrReadDummyCycle;    /*!< copy of sfdp_public.DtrReadDummyCycle */
+  uint8_t                            ManuID;               /*!< manufacturer ID */
+  uint8_t                            FlashSize;            /*!< Flash size in power of two */
+  uint32_t                           PageSize;             /*!< Page size */
+  EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef DriverInfo;           /*!< driver information, ClockIn excepted */
+  uint32_t                           Sfdp_table_mask;      /*!< sfdp table mask */
+  uint32_t                           Reset_info;           /*!< copy of JEDEC Basic 16 Reset/Rescue info */
+  uint8_t                            Sfdp_param_number;    /*!< Number of param from the SFDP header table */
+  uint8_t                            Sfdp_AccessProtocol;  /*!< Access protocol from the SFDP header table */
+  XSPI_RegularCmdTypeDef             Commandbase;          /*!< SAL command base once the link is configured */
+  uint8_t                            CommandExtension;     /*!< SAL command extension */
+  uint8_t                            SFDPDummyCycle;       /*!< SAL SFDP dummy cycle */
+  SAL_XSPI_PhysicalLinkTypeDef       PhyLink;              /*!< SAL physical link */
+  uint8_t                            DTRDummyCycle;        /*!< SAL DTR read dummy cycle */
+  const SAL_XSPI_CommandStepTypeDef  *Steps;               /*!< reset and link configuration sequence sent to the memory */
+  uint32_t                           StepCount;            /*!< number of steps */
+} EXTMEM_DRIVER_NOR_SFDP_ProfileTypeDef;
+
 /**
   * @}
   */
@@ -106,6 +106,13 @@ const uint8_t phylink_string[][17] = {"PHY_LINK_1S1S1S",
 
 #define SAL_XSPI_TIMEOUT_DEFAULT_VALUE (100U) 
 
+/**
+  * @brief functional modes of the CR register, used to issue the precompiled commands
+  */
+#define SAL_XSPI_FMODE_INDIRECT_WRITE  (0U)
+#define SAL_XSPI_FMODE_INDIRECT_READ   (XSPI_CR_FMODE_0)
+#define SAL_XSPI_FMODE_AUTO_POLLING    (XSPI_CR_FMODE_1 | XSPI_CR_APMS)
+
 /**
   * @}
   */
@@ -133,18 +140,54 @@ volatile SAL_XSPI_TRANSFER_STATUS salXSPI_status = SALXSPI_TRANSFER_NONE;
   */
 #endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
 
+#if EXTMEM_ASYNC == 1
+/** @defgroup SAL_XSPI_Private_Async SAL XSPI asynchronous transfer management definition
+  * @{
+  */
+/**
+  * @brief number of XSPI instances able to run asynchronous transactions
+  */
+#define SAL_XSPI_ASYNC_INSTANCES 2u
+
+/**
+  * @brief SAL objects attached to the XSPI handles, used to route the HAL callbacks
+  */
+static SAL_XSPI_ObjectTypeDef *salXSPI_async[SAL_XSPI_ASYNC_INSTANCES];
+
+/**
+  * @}
+  */
+#endif /* EXTMEM_ASYNC == 1 */
+
 /* Private typedefs ---------------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /** @defgroup SAL_XSPI_Private_Functions SAL XSP Private Functions
   * @{
   */
 uint16_t XSPI_FormatCommand(uint8_t CommandExtension, uint32_t InstructionWidth, uint8_t Command);
+void XSPI_ReadCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd);
+void XSPI_WriteCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd);
+void XSPI_StatusCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, XSPI_RegularCmdTypeDef *Cmd);
+void XSPI_AddressCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, XSPI_RegularCmdTypeDef *Cmd);
+void XSPI_InstructionCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd);
+HAL_StatusTypeDef XSPI_WaitFlag(XSPI_HandleTypeDef *hxspi, uint32_t Flag, FlagStatus State, uint32_t Tickstart, uint32_t Timeout);
+HAL_StatusTypeDef XSPI_IssueStart(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc, uint32_t Mode,
+                                  uint32_t Address, uint32_t DataSize, uint32_t Tickstart);
 HAL_StatusTypeDef XSPI_Transmit(SAL_XSPI_ObjectTypeDef *SalXspi, const uint8_t *Data);
 HAL_StatusTypeDef XSPI_Receive(SAL_XSPI_ObjectTypeDef *SalXspi,  uint8_t *Data);
+uint8_t XSPI_ReadDelayType(const SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t *DelayType);
 #if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
 void SAL_XSPI_ErrorCallback(struct __XSPI_HandleTypeDef *hxspi);
 void SAL_XSPI_CompleteCallback(struct __XSPI_HandleTypeDef *hxspi);
 #endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+#if EXTMEM_ASYNC == 1
+void XSPI_DCacheClean(const uint8_t *Data, uint32_t DataSize);
+void XSPI_DCacheInvalidate(uint8_t *Data, uint32_t DataSize);
+void XSPI_AsyncEvent(XSPI_HandleTypeDef *hxspi, SAL_XSPI_EventTypeDef Event);
+#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
+void SAL_XSPI_StatusMatchCallback(struct __XSPI_HandleTypeDef *hxspi);
+#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+#endif /* EXTMEM_ASYNC == 1 */
 
 /**
   * @}
@@ -190,6 +233,7 @@ HAL_StatusTypeDef SAL_XSPI_SetClock(SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t Cl
 
     /* real clock calculation */
     *ClockReal = ClockIn / (divider + 1u);
+    SalXspi->ClockOut = *ClockReal;
 
     DEBUG_PARAM_BEGIN(); DEBUG_PARAM_DATA("::CLOCK::"); DEBUG_PARAM_INT(divider); DEBUG_PARAM_END();
     MODIFY_REG(SalXspi->hxspi->Instance->DCR2, XSPI_DCR2_PRESCALER, (uint32_t)divider << XSPI_DCR2_PRESCALER_Pos);
@@ -198,6 +242,50 @@ HAL_StatusTypeDef SAL_XSPI_SetClock(SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t Cl
   return retr;
 }
 
+HAL_StatusTypeDef SAL_XSPI_GetTiming(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_TimingTypeDef *Timing)
+{
+  HAL_StatusTypeDef retr = HAL_OK;
+  XSPI_HSCalTypeDef delay = {0};
+
+  Timing->Prescaler   = (uint8_t)((SalXspi->hxspi->Instance->DCR2 & XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos);
+  Timing->SampleShift = (SalXspi->hxspi->Init.SampleShifting == HAL_XSPI_SAMPLE_SHIFT_HALFCYCLE) ? 1u : 0u;
+  Timing->DelayCoarse = 0u;
+  Timing->DelayFine   = 0u;
+
+  if (1u == XSPI_ReadDelayType(SalXspi, &delay.DelayValueType))
+  {
+    retr = HAL_XSPI_GetDelayValue(SalXspi->hxspi, &delay);
+    Timing->DelayCoarse = (uint8_t)delay.CoarseCalibrationUnit;
+    Timing->DelayFine   = (uint8_t)delay.FineCalibrationUnit;
+  }
+
+  return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_SetTiming(SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t ClockIn, const SAL_XSPI_TimingTypeDef *Timing)
+{
+  HAL_StatusTypeDef retr = HAL_OK;
+  XSPI_HSCalTypeDef delay = {0};
+
+  /* the prescaler first, a new clock restarts the calibration of the delay lines */
+  MODIFY_REG(SalXspi->hxspi->Instance->DCR2, XSPI_DCR2_PRESCALER, (uint32_t)Timing->Prescaler << XSPI_DCR2_PRESCALER_Pos);
+  SalXspi->ClockOut = ClockIn / ((uint32_t)Timing->Prescaler + 1u);
+  DEBUG_PARAM_BEGIN(); DEBUG_PARAM_DATA("::TIMING::"); DEBUG_PARAM_INT(Timing->Prescaler); DEBUG_PARAM_END();
+
+  /* the HAL only sets the sample shifting on STR reads, it is cleared here */
+  SalXspi->hxspi->Init.SampleShifting = (Timing->SampleShift == 1u) ? HAL_XSPI_SAMPLE_SHIFT_HALFCYCLE : HAL_XSPI_SAMPLE_SHIFT_NONE;
+  MODIFY_REG(SalXspi->hxspi->Instance->TCR, XSPI_TCR_SSHIFT, SalXspi->hxspi->Init.SampleShifting);
+
+  if (1u == XSPI_ReadDelayType(SalXspi, &delay.DelayValueType))
+  {
+    delay.CoarseCalibrationUnit = Timing->DelayCoarse;
+    delay.FineCalibrationUnit   = Timing->DelayFine;
+    retr = HAL_XSPI_SetDelayValue(SalXspi->hxspi, &delay);
+  }
+
+  return retr;
+}
+
 /*
 * This function is used to configure the way to discuss with the memory
 *
@@ -237,6 +325,10 @@ HAL_StatusTypeDef SAL_XSPI_Init(SAL_XSPI_ObjectTypeDef *SalXspi, void *HALHandle
   HAL_XSPI_RegisterCallback(SalXspi->hxspi,HAL_XSPI_TX_CPLT_CB_ID, SAL_XSPI_CompleteCallback);
   /* set the error callback */
   HAL_XSPI_RegisterCallback(SalXspi->hxspi,HAL_XSPI_ERROR_CB_ID, SAL_XSPI_ErrorCallback);
+#if EXTMEM_ASYNC == 1
+  /* set the status match callback used by the asynchronous polling */
+  HAL_XSPI_RegisterCallback(SalXspi->hxspi,HAL_XSPI_STATUS_MATCH_CB_ID, SAL_XSPI_StatusMatchCallback);
+#endif /* EXTMEM_ASYNC == 1 */
 #endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
 
   return HAL_OK;
@@ -491,37 +583,9 @@ error:
 HAL_StatusTypeDef SAL_XSPI_Read(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint8_t *Data, uint32_t DataSize)
 {
   HAL_StatusTypeDef retr;
-  XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
-
-  /* Initialize the read ID command */
-  s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
+  XSPI_RegularCmdTypeDef s_command;
 
-  s_command.Address           = Address;
-  s_command.DataLength        = DataSize;
-
-  /* DTR management for single/dual/quad */
-  switch(SalXspi->PhyLink)
-  {
-   case PHY_LINK_4S4D4D :{
-     s_command.AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
-     s_command.DataDTRMode    = HAL_XSPI_DATA_DTR_ENABLE;
-     s_command.DummyCycles = SalXspi->DTRDummyCycle;
-   break;
-   }
-   case PHY_LINK_1S2S2S :{
-     s_command.AddressMode = HAL_XSPI_ADDRESS_2_LINES;
-     s_command.DataMode = HAL_XSPI_DATA_2_LINES;
-   break;
-   }
-   case PHY_LINK_1S1S2S :{
-     s_command.DataMode = HAL_XSPI_DATA_2_LINES;
-   break;
-   }
-   default :{
-     /* keep default parameters */
-   break;
-   }
-  }
+  XSPI_ReadCommand(SalXspi, Command, Address, DataSize, &s_command);
 
   /* Configure the command */
   retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
@@ -545,15 +609,9 @@ error:
 HAL_StatusTypeDef SAL_XSPI_Write(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, const uint8_t *Data, uint32_t DataSize)
 {
   HAL_StatusTypeDef retr;
-  XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
-
-  /* Initialize the read ID command */
-  s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
+  XSPI_RegularCmdTypeDef s_command;
 
-  s_command.Address           = Address;
-  s_command.DataLength        = DataSize;
-  s_command.DummyCycles       = 0u;
-  s_command.DQSMode           = HAL_XSPI_DQS_DISABLE;
+  XSPI_WriteCommand(SalXspi, Command, Address, DataSize, &s_command);
 
   /* Configure the command */
   retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
@@ -578,20 +636,9 @@ HAL_StatusTypeDef SAL_XSPI_CommandSendAddress(SAL_XSPI_ObjectTypeDef *SalXspi, u
                                        uint32_t Address)
 {
   HAL_StatusTypeDef retr;
-  XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
-
-  /* Initialize the writing of status register */
-  s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
+  XSPI_RegularCmdTypeDef s_command;
 
-  if (s_command.InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
-  {
-    s_command.AddressMode = HAL_XSPI_ADDRESS_1_LINE;
-  }
-
-  s_command.Address           = Address;
-  s_command.DummyCycles       = 0U;
-  s_command.DataMode          = HAL_XSPI_DATA_NONE;
-  s_command.DQSMode           = HAL_XSPI_DQS_DISABLE;
+  XSPI_AddressCommand(SalXspi, Command, Address, &s_command);
 
   /* Send the command */
   retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
@@ -606,21 +653,10 @@ HAL_StatusTypeDef SAL_XSPI_CommandSendAddress(SAL_XSPI_ObjectTypeDef *SalXspi, u
 HAL_StatusTypeDef SAL_XSPI_CommandSendData(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command,
                                            uint8_t *Data, uint16_t DataSize)
 {
-  XSPI_RegularCmdTypeDef   s_command = SalXspi->Commandbase;
+  XSPI_RegularCmdTypeDef   s_command;
   HAL_StatusTypeDef retr;
 
-  /* Initialize the writing of status register */
-  s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
-
-  s_command.AddressMode        = HAL_XSPI_ADDRESS_NONE;
-  s_command.DummyCycles        = 0U;
-  s_command.DataLength         = DataSize;
-  s_command.DQSMode            = HAL_XSPI_DQS_DISABLE;
-
-  if (DataSize == 0u)
-  {
-    s_command.DataMode         = HAL_XSPI_DATA_NONE;
-  }
+  XSPI_InstructionCommand(SalXspi, Command, DataSize, &s_command);
 
   /* Send the command */
   retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
@@ -707,7 +743,7 @@ HAL_StatusTypeDef SAL_XSPI_CommandSendReadAddress(SAL_XSPI_ObjectTypeDef *SalXsp
 
 HAL_StatusTypeDef SAL_XSPI_CheckStatusRegister(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint8_t MatchValue, uint8_t MatchMask, uint32_t Timeout)
 {
-  XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
+  XSPI_RegularCmdTypeDef s_command;
   XSPI_AutoPollingTypeDef  s_config = {
                                        .MatchValue    = MatchValue,
                                        .MatchMask     = MatchMask,
@@ -717,27 +753,7 @@ HAL_StatusTypeDef SAL_XSPI_CheckStatusRegister(SAL_XSPI_ObjectTypeDef *SalXspi,
                                       };
   HAL_StatusTypeDef retr;
 
-  /* Initialize the writing of status register */
-  s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
-
-  s_command.DataLength     = 1u;
-  s_command.DQSMode        = HAL_XSPI_DQS_DISABLE;
-
-  if (s_command.InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
-  {
-    // patch cypress to force 1 line on status read
-    s_command.DataMode    = HAL_XSPI_DATA_1_LINE;
-    s_command.AddressMode = HAL_XSPI_DATA_NONE;
-    s_command.DummyCycles = 0u;
-  }
-
-  /* @ is used only in 8 LINES format */
-  if (s_command.DataMode == HAL_XSPI_DATA_8_LINES)
-  {
-    s_command.AddressMode    = HAL_XSPI_ADDRESS_8_LINES;
-    s_command.AddressWidth   = HAL_XSPI_ADDRESS_32_BITS;
-    s_command.Address        = Address;
-  }
+  XSPI_StatusCommand(SalXspi, Command, Address, &s_command);
 
   /* Send the command */
   retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
@@ -756,6 +772,22 @@ HAL_StatusTypeDef SAL_XSPI_CheckStatusRegister(SAL_XSPI_ObjectTypeDef *SalXspi,
   return retr;
 }
 
+HAL_StatusTypeDef SAL_XSPI_SetMapConfig(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_MapConfigTypeDef *Config)
+{
+  /* DCR2 can only change while no memory-mapped access may be ongoing */
+  if (SalXspi->hxspi->State != HAL_XSPI_STATE_READY)
+  {
+    return HAL_BUSY;
+  }
+
+  SalXspi->hxspi->Init.WrapSize = Config->WrapSize;
+  MODIFY_REG(SalXspi->hxspi->Instance->DCR2, XSPI_DCR2_WRAPSIZE, Config->WrapSize);
+  SalXspi->MapTimeout = Config->Timeout;
+  DEBUG_PARAM_BEGIN(); DEBUG_PARAM_DATA("::MAP::"); DEBUG_PARAM_INT(Config->WrapSize); DEBUG_PARAM_INT(Config->Timeout); DEBUG_PARAM_END();
+
+  return HAL_OK;
+}
+
 HAL_StatusTypeDef SAL_XSPI_ConfigureWrappMode(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t WrapCommand, uint8_t WrapDummy)
 {
   HAL_StatusTypeDef retr;
@@ -811,11 +843,23 @@ HAL_StatusTypeDef SAL_XSPI_EnableMapMode(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_
     goto error;
   }
 
-  /* Activation of memory-mapped mode */
-  sMemMappedCfg.TimeOutActivation  = HAL_XSPI_TIMEOUT_COUNTER_DISABLE;
-  sMemMappedCfg.TimeoutPeriodClock = 0x50;
+  /* Activation of memory-mapped mode, the timeout counter releases nCS and stops the prefetch */
+  if (SalXspi->MapTimeout != 0u)
+  {
+    sMemMappedCfg.TimeOutActivation  = HAL_XSPI_TIMEOUT_COUNTER_ENABLE;
+    sMemMappedCfg.TimeoutPeriodClock = SalXspi->MapTimeout;
+  }
+  else
+  {
+    sMemMappedCfg.TimeOutActivation  = HAL_XSPI_TIMEOUT_COUNTER_DISABLE;
+    sMemMappedCfg.TimeoutPeriodClock = 0x50;
+  }
   retr = HAL_XSPI_MemoryMapped(SalXspi->hxspi, &sMemMappedCfg);
 
+  /* the counter releases nCS by itself: its interrupt is not used, the code executed
+     in place may not even have the XSPI handler */
+  HAL_XSPI_DISABLE_IT(SalXspi->hxspi, HAL_XSPI_IT_TO);
+
 error:
   if (retr != HAL_OK )
   {
@@ -866,128 +910,777 @@ HAL_StatusTypeDef SAL_XSPI_Abort(SAL_XSPI_ObjectTypeDef *SalXspi)
   return HAL_XSPI_Abort(SalXspi->hxspi);
 }
 
-/**
-  * @}
-  */
-
-/** @defgroup SAL_XSPI_Private_Functions SAL XSP Private Functions
-  * @{
-  */
-/**
-  * @brief This function return a formatted command
-  *
-  * @param CommandExtension type of the command extension 0: the complement  1 : the same
-  * @param InstructionWidth instruction width
-  * @param Command command
-  * @return the formatted command
-  */
-uint16_t XSPI_FormatCommand(uint8_t CommandExtension, uint32_t InstructionWidth, uint8_t Command)
+HAL_StatusTypeDef SAL_XSPI_CommandStep(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandStepTypeDef *Step, uint32_t Timeout)
 {
-  uint16_t retr;
-  if  (InstructionWidth == HAL_XSPI_INSTRUCTION_16_BITS)
+  XSPI_RegularCmdTypeDef s_command = Step->Command;
+  XSPI_AutoPollingTypeDef  s_config = {
+                                       .MatchValue    = Step->MatchValue,
+                                       .MatchMask     = Step->MatchMask,
+                                       .MatchMode     = HAL_XSPI_MATCH_MODE_AND,
+                                       .AutomaticStop = HAL_XSPI_AUTOMATIC_STOP_ENABLE,
+                                       .IntervalTime  = 0x10
+                                      };
+  HAL_StatusTypeDef retr;
+
+  /* Send the command */
+  retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  if (retr == HAL_OK)
   {
-    /* 0b00 The Command Extension is the same as the Command. (The Command / Command Extension has the same value for the whole clock period.)*/
-    /* 0b01 The Command Extension is the inverse of the Command. The Command Extension acts as a confirmation of the Command */
-    /* 0b11 Command and Command Extension forms a 16 bit command word :: Not yes handled */
-    retr = ((uint16_t)Command << 8u);
-    if (CommandExtension == 1u)
+    if (Step->Polling == 1u)
     {
-       retr|=  (uint8_t)(~Command & 0xFFu);
+      retr = HAL_XSPI_AutoPolling(SalXspi->hxspi, &s_config, Timeout);
+    }
+    else if (Step->Data != NULL)
+    {
+      retr = HAL_XSPI_Transmit(SalXspi->hxspi, (uint8_t *)Step->Data, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
     }
     else
     {
-       retr|=  (uint8_t)(Command & 0xFFu);
+      /* command without data phase */
     }
   }
+
+  if (retr != HAL_OK )
+  {
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(SalXspi->hxspi);
+  }
+  else if (Step->Delay != 0u)
+  {
+    /* respect the timing of the recorded sequence (reset recovery for instance) */
+    HAL_Delay(Step->Delay);
+  }
   else
   {
-    retr = Command;
+    /* nothing to wait */
   }
-
   return retr;
 }
 
-/**
-  * @brief This function trasnmits the data
-  *
-  * @param SalXspi handle on the XSPI IP
-  * @param Data data pointer
-  * @return none
-  */
-HAL_StatusTypeDef XSPI_Transmit(SAL_XSPI_ObjectTypeDef *SalXspi, const uint8_t *Data)
+HAL_StatusTypeDef SAL_XSPI_BuildCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_CommandKindTypeDef Kind,
+                                        uint8_t Command, SAL_XSPI_CommandDescTypeDef *Desc)
 {
-HAL_StatusTypeDef retr;
+  const XSPI_HandleTypeDef *hxspi = SalXspi->hxspi;
+  XSPI_RegularCmdTypeDef s_command;
 
-#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
-  if (SalXspi->hxspi->hdmatx == NULL)
-#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+  /* build the command exactly as the SAL function of the same kind */
+  switch (Kind)
   {
-    /* transmit data */
-    retr = HAL_XSPI_Transmit(SalXspi->hxspi, Data, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    case SAL_XSPI_DESC_READ:
+      XSPI_ReadCommand(SalXspi, Command, 0u, 1u, &s_command);
+      break;
+    case SAL_XSPI_DESC_WRITE:
+      XSPI_WriteCommand(SalXspi, Command, 0u, 1u, &s_command);
+      break;
+    case SAL_XSPI_DESC_STATUS:
+      XSPI_StatusCommand(SalXspi, Command, 0u, &s_command);
+      break;
+    case SAL_XSPI_DESC_ADDRESS:
+      XSPI_AddressCommand(SalXspi, Command, 0u, &s_command);
+      break;
+    case SAL_XSPI_DESC_INSTRUCTION:
+      XSPI_InstructionCommand(SalXspi, Command, 0u, &s_command);
+      break;
+    default:
+      return HAL_ERROR;
   }
-#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
-  else
+
+  /* the alternate bytes are never used by the SAL commands */
+  if ((s_command.InstructionMode == HAL_XSPI_INSTRUCTION_NONE)
+      || (s_command.AlternateBytesMode != HAL_XSPI_ALT_BYTES_NONE)
+      || (s_command.OperationType != HAL_XSPI_OPTYPE_COMMON_CFG))
   {
-    /* set completion call back */
-    salXSPI_status = SALXSPI_TRANSFER_NONE;
+    return HAL_ERROR;
+  }
 
-    /* Reception of the data */
-    retr = HAL_XSPI_Transmit_DMA(SalXspi->hxspi, (uint8_t *)Data);
+  /* encode the registers as XSPI_ConfigCmd of the HAL */
+  Desc->Address = (s_command.AddressMode != HAL_XSPI_ADDRESS_NONE) ? 1u : 0u;
+  Desc->Data    = (s_command.DataMode != HAL_XSPI_DATA_NONE) ? 1u : 0u;
+  Desc->IR      = s_command.Instruction;
+  Desc->CCR     = s_command.DQSMode | s_command.InstructionMode | s_command.InstructionDTRMode | s_command.InstructionWidth;
+  if (Desc->Address == 1u)
+  {
+    Desc->CCR |= s_command.AddressMode | s_command.AddressDTRMode | s_command.AddressWidth;
+  }
+  if (Desc->Data == 1u)
+  {
+    Desc->CCR |= s_command.DataMode | s_command.DataDTRMode;
+  }
+  else if ((hxspi->Init.DelayHoldQuarterCycle == HAL_XSPI_DHQC_ENABLE)
+           && (s_command.InstructionDTRMode == HAL_XSPI_INSTRUCTION_DTR_ENABLE))
+  {
+    /* The DHQC bit is linked with DDTR bit which should be activated */
+    Desc->CCR |= HAL_XSPI_DATA_DTR_ENABLE;
+  }
+  else
+  {
+    /* nothing to add */
+  }
 
-    if (retr ==  HAL_OK)
+  Desc->TCR     = s_command.DummyCycles;
+  Desc->TCRMask = XSPI_TCR_DCYC;
+  if (Desc->Data == 1u)
+  {
+    if (s_command.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE)
     {
-      /* wait data completion */
-      while(salXSPI_status == SALXSPI_TRANSFER_NONE);
-      if (salXSPI_status == SALXSPI_TRANSFER_ERROR)
-      {
-        retr = HAL_ERROR;
-      }
+      /* no sample shifting on DTR data */
+      Desc->TCRMask |= XSPI_TCR_SSHIFT;
+    }
+    else if (hxspi->Init.SampleShifting == HAL_XSPI_SAMPLE_SHIFT_HALFCYCLE)
+    {
+      Desc->TCR     |= XSPI_TCR_SSHIFT;
+      Desc->TCRMask |= XSPI_TCR_SSHIFT;
+    }
+    else
+    {
+      /* the sample shifting is kept */
     }
   }
-#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
 
-  return retr;
+  Desc->CR     = 0u;
+  Desc->CRMask = 0u;
+  if (hxspi->Init.MemoryMode == HAL_XSPI_SINGLE_MEM)
+  {
+    Desc->CR     = s_command.IOSelect;
+    Desc->CRMask = XSPI_CR_MSEL;
+  }
+
+  return HAL_OK;
 }
 
-/**
-  * @brief this is called to start the data transfer in polling mode or DMA
-  *
-  * @param SalXspi handle on the XSPI IP
-  * @param Data data pointer
-  * @return none
-  */
-HAL_StatusTypeDef XSPI_Receive(SAL_XSPI_ObjectTypeDef *SalXspi,  uint8_t *Data)
+HAL_StatusTypeDef SAL_XSPI_Issue(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc, uint32_t Address)
 {
-HAL_StatusTypeDef retr;
+  uint32_t tickstart = HAL_GetTick();
+  HAL_StatusTypeDef retr;
 
-#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
-  if (SalXspi->hxspi->hdmarx == NULL)
-#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+  retr = XSPI_IssueStart(SalXspi, Desc, SAL_XSPI_FMODE_INDIRECT_WRITE, Address, 0u, tickstart);
+  if (retr == HAL_OK)
   {
-    /* Reception of the data */
-    retr = HAL_XSPI_Receive(SalXspi->hxspi, Data, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    /* no data phase: the command is sent as soon as the configuration is done */
+    retr = XSPI_WaitFlag(SalXspi->hxspi, HAL_XSPI_FLAG_BUSY, RESET, tickstart, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    HAL_XSPI_CLEAR_FLAG(SalXspi->hxspi, HAL_XSPI_FLAG_TC);
   }
-#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
-  else
+
+  if (retr != HAL_OK )
   {
-    /* set completion call back */
-    salXSPI_status = SALXSPI_TRANSFER_NONE;
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(SalXspi->hxspi);
+  }
+  return retr;
+}
 
-    /* Reception of the data */
-    retr = HAL_XSPI_Receive_DMA(SalXspi->hxspi, Data);
+HAL_StatusTypeDef SAL_XSPI_IssueRead(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                     uint32_t Address, uint8_t *Data, uint32_t DataSize)
+{
+  XSPI_HandleTypeDef *hxspi = SalXspi->hxspi;
+  __IO uint8_t *data_reg = (__IO uint8_t *)&hxspi->Instance->DR;
+  uint32_t tickstart = HAL_GetTick();
+  HAL_StatusTypeDef retr;
 
-    if (retr ==  HAL_OK)
+  if ((Desc->Data == 0u) || (DataSize == 0u))
+  {
+    return HAL_ERROR;
+  }
+
+  retr = XSPI_IssueStart(SalXspi, Desc, SAL_XSPI_FMODE_INDIRECT_READ, Address, DataSize, tickstart);
+  for (uint32_t index = 0u; (retr == HAL_OK) && (index < DataSize); index++)
+  {
+    /* Wait till fifo threshold or transfer complete flags are set to read received data */
+    retr = XSPI_WaitFlag(hxspi, (HAL_XSPI_FLAG_FT | HAL_XSPI_FLAG_TC), SET, tickstart, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    if (retr == HAL_OK)
     {
-      /* wait data completion */
-      while(salXSPI_status == SALXSPI_TRANSFER_NONE);
-      if (salXSPI_status == SALXSPI_TRANSFER_ERROR)
-      {
-        retr = HAL_ERROR;
-      }
+      Data[index] = *data_reg;
     }
   }
-#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
-  return retr;
+
+  if (retr == HAL_OK)
+  {
+    retr = XSPI_WaitFlag(hxspi, HAL_XSPI_FLAG_TC, SET, tickstart, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    HAL_XSPI_CLEAR_FLAG(hxspi, HAL_XSPI_FLAG_TC);
+  }
+
+  if (retr != HAL_OK )
+  {
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(hxspi);
+  }
+  return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_IssueWrite(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                      uint32_t Address, const uint8_t *Data, uint32_t DataSize)
+{
+  XSPI_HandleTypeDef *hxspi = SalXspi->hxspi;
+  __IO uint8_t *data_reg = (__IO uint8_t *)&hxspi->Instance->DR;
+  uint32_t tickstart = HAL_GetTick();
+  HAL_StatusTypeDef retr;
+
+  if ((Desc->Data == 0u) || (DataSize == 0u))
+  {
+    return HAL_ERROR;
+  }
+
+  retr = XSPI_IssueStart(SalXspi, Desc, SAL_XSPI_FMODE_INDIRECT_WRITE, Address, DataSize, tickstart);
+  for (uint32_t index = 0u; (retr == HAL_OK) && (index < DataSize); index++)
+  {
+    /* Wait till fifo threshold flag is set to send data */
+    retr = XSPI_WaitFlag(hxspi, HAL_XSPI_FLAG_FT, SET, tickstart, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    if (retr == HAL_OK)
+    {
+      *data_reg = Data[index];
+    }
+  }
+
+  if (retr == HAL_OK)
+  {
+    retr = XSPI_WaitFlag(hxspi, HAL_XSPI_FLAG_TC, SET, tickstart, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+    HAL_XSPI_CLEAR_FLAG(hxspi, HAL_XSPI_FLAG_TC);
+  }
+
+  if (retr != HAL_OK )
+  {
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(hxspi);
+  }
+  return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_IssuePolling(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                        uint32_t Address, uint8_t MatchValue, uint8_t MatchMask, uint32_t Timeout)
+{
+  XSPI_HandleTypeDef *hxspi = SalXspi->hxspi;
+  uint32_t tickstart = HAL_GetTick();
+  HAL_StatusTypeDef retr = HAL_ERROR;
+
+  if (Desc->Data == 1u)
+  {
+    /* same setting as SAL_XSPI_CheckStatusRegister, one status byte */
+    WRITE_REG(hxspi->Instance->PSMAR, MatchValue);
+    WRITE_REG(hxspi->Instance->PSMKR, MatchMask);
+    WRITE_REG(hxspi->Instance->PIR, 0x10u);
+    CLEAR_BIT(hxspi->Instance->CR, XSPI_CR_PMM);
+    retr = XSPI_IssueStart(SalXspi, Desc, SAL_XSPI_FMODE_AUTO_POLLING, Address, 1u, tickstart);
+  }
+
+  if (retr == HAL_OK)
+  {
+    retr = XSPI_WaitFlag(hxspi, HAL_XSPI_FLAG_SM, SET, tickstart, Timeout);
+    HAL_XSPI_CLEAR_FLAG(hxspi, HAL_XSPI_FLAG_SM);
+    DEBUG_AUTOPOLLING(hxspi->Instance->DR, MatchValue, MatchMask)
+  }
+
+  if (retr != HAL_OK )
+  {
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(hxspi);
+  }
+  return retr;
+}
+
+#if EXTMEM_ASYNC == 1
+HAL_StatusTypeDef SAL_XSPI_SetEventCallback(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_EventCallbackTypeDef Callback, void *Context)
+{
+  HAL_StatusTypeDef retr = HAL_ERROR;
+
+  SalXspi->EventCallback = Callback;
+  SalXspi->EventContext  = Context;
+  SalXspi->AsyncPending  = 0u;
+  SalXspi->RxData        = NULL;
+  SalXspi->RxSize        = 0u;
+
+  /* attach the object to its XSPI handle, the table is filled in order */
+  for (uint32_t index = 0u; index < SAL_XSPI_ASYNC_INSTANCES; index++)
+  {
+    if ((salXSPI_async[index] == NULL) || (salXSPI_async[index]->hxspi == SalXspi->hxspi))
+    {
+      salXSPI_async[index] = SalXspi;
+      retr = HAL_OK;
+      break;
+    }
+  }
+
+  return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_ReadAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint8_t *Data, uint32_t DataSize)
+{
+  HAL_StatusTypeDef retr;
+  XSPI_RegularCmdTypeDef s_command;
+
+  XSPI_ReadCommand(SalXspi, Command, Address, DataSize, &s_command);
+
+  /* Configure the command */
+  retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  if ( retr  != HAL_OK)
+  {
+    goto error;
+  }
+
+  SalXspi->AsyncPending = 1u;
+  if (SalXspi->hxspi->hdmarx == NULL)
+  {
+    /* the FIFO is served under interrupt */
+    SalXspi->RxData = NULL;
+    retr = HAL_XSPI_Receive_IT(SalXspi->hxspi, Data);
+  }
+  else
+  {
+    /* no dirty line of the buffer may be evicted over the DMA data */
+    SalXspi->RxData = Data;
+    SalXspi->RxSize = DataSize;
+    XSPI_DCacheInvalidate(Data, DataSize);
+    retr = HAL_XSPI_Receive_DMA(SalXspi->hxspi, Data);
+  }
+
+error:
+  if (retr != HAL_OK )
+  {
+    SalXspi->AsyncPending = 0u;
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(SalXspi->hxspi);
+  }
+  return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_WriteAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, const uint8_t *Data, uint32_t DataSize)
+{
+  HAL_StatusTypeDef retr;
+  XSPI_RegularCmdTypeDef s_command;
+
+  XSPI_WriteCommand(SalXspi, Command, Address, DataSize, &s_command);
+
+  /* Configure the command */
+  retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  if (HAL_OK != retr)
+  {
+    goto error;
+  }
+
+  SalXspi->AsyncPending = 1u;
+  SalXspi->RxData = NULL;
+  if (SalXspi->hxspi->hdmatx == NULL)
+  {
+    /* the FIFO is served under interrupt */
+    retr = HAL_XSPI_Transmit_IT(SalXspi->hxspi, Data);
+  }
+  else
+  {
+    /* the DMA reads the memory, not the cache */
+    XSPI_DCacheClean(Data, DataSize);
+    retr = HAL_XSPI_Transmit_DMA(SalXspi->hxspi, Data);
+  }
+
+error:
+  if (retr != HAL_OK )
+  {
+    SalXspi->AsyncPending = 0u;
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(SalXspi->hxspi);
+  }
+  return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_CheckStatusRegisterAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                                    uint8_t MatchValue, uint8_t MatchMask)
+{
+  XSPI_RegularCmdTypeDef s_command;
+  XSPI_AutoPollingTypeDef  s_config = {
+                                       .MatchValue    = MatchValue,
+                                       .MatchMask     = MatchMask,
+                                       .MatchMode     = HAL_XSPI_MATCH_MODE_AND,
+                                       .AutomaticStop = HAL_XSPI_AUTOMATIC_STOP_ENABLE,
+                                       .IntervalTime  = 0x10
+                                      };
+  HAL_StatusTypeDef retr;
+
+  XSPI_StatusCommand(SalXspi, Command, Address, &s_command);
+
+  /* Send the command */
+  retr = HAL_XSPI_Command(SalXspi->hxspi, &s_command, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  if ( retr == HAL_OK)
+  {
+    SalXspi->AsyncPending = 1u;
+    SalXspi->RxData = NULL;
+    retr = HAL_XSPI_AutoPolling_IT(SalXspi->hxspi, &s_config);
+  }
+
+  if (retr != HAL_OK )
+  {
+    SalXspi->AsyncPending = 0u;
+    /* abort any ongoing transaction for the next action */
+    (void)HAL_XSPI_Abort(SalXspi->hxspi);
+  }
+  return retr;
+}
+#endif /* EXTMEM_ASYNC == 1 */
+
+/**
+  * @}
+  */
+
+/** @defgroup SAL_XSPI_Private_Functions SAL XSP Private Functions
+  * @{
+  */
+/**
+  * @brief This function return a formatted command
+  *
+  * @param CommandExtension type of the command extension 0: the complement  1 : the same
+  * @param InstructionWidth instruction width
+  * @param Command command
+  * @return the formatted command
+  */
+uint16_t XSPI_FormatCommand(uint8_t CommandExtension, uint32_t InstructionWidth, uint8_t Command)
+{
+  uint16_t retr;
+  if  (InstructionWidth == HAL_XSPI_INSTRUCTION_16_BITS)
+  {
+    /* 0b00 The Command Extension is the same as the Command. (The Command / Command Extension has the same value for the whole clock period.)*/
+    /* 0b01 The Command Extension is the inverse of the Command. The Command Extension acts as a confirmation of the Command */
+    /* 0b11 Command and Command Extension forms a 16 bit command word :: Not yes handled */
+    retr = ((uint16_t)Command << 8u);
+    if (CommandExtension == 1u)
+    {
+       retr|=  (uint8_t)(~Command & 0xFFu);
+    }
+    else
+    {
+       retr|=  (uint8_t)(Command & 0xFFu);
+    }
+  }
+  else
+  {
+    retr = Command;
+  }
+
+  return retr;
+}
+
+/**
+  * @brief This function builds the command of a data read
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Command command
+  * @param Address address to read the data
+  * @param DataSize size of the data to read
+  * @param Cmd command to build
+  * @return none
+  */
+void XSPI_ReadCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd)
+{
+  *Cmd = SalXspi->Commandbase;
+
+  /* Initialize the read ID command */
+  Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+
+  Cmd->Address           = Address;
+  Cmd->DataLength        = DataSize;
+
+  /* DTR management for single/dual/quad */
+  switch(SalXspi->PhyLink)
+  {
+   case PHY_LINK_4S4D4D :{
+     Cmd->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
+     Cmd->DataDTRMode    = HAL_XSPI_DATA_DTR_ENABLE;
+     Cmd->DummyCycles = SalXspi->DTRDummyCycle;
+   break;
+   }
+   case PHY_LINK_1S2S2S :{
+     Cmd->AddressMode = HAL_XSPI_ADDRESS_2_LINES;
+     Cmd->DataMode = HAL_XSPI_DATA_2_LINES;
+   break;
+   }
+   case PHY_LINK_1S1S2S :{
+     Cmd->DataMode = HAL_XSPI_DATA_2_LINES;
+   break;
+   }
+   default :{
+     /* keep default parameters */
+   break;
+   }
+  }
+}
+
+/**
+  * @brief This function builds the command of a data write
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Command command
+  * @param Address address to write the data
+  * @param DataSize size of the data to write
+  * @param Cmd command to build
+  * @return none
+  */
+void XSPI_WriteCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd)
+{
+  *Cmd = SalXspi->Commandbase;
+
+  Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+
+  Cmd->Address           = Address;
+  Cmd->DataLength        = DataSize;
+  Cmd->DummyCycles       = 0u;
+  Cmd->DQSMode           = HAL_XSPI_DQS_DISABLE;
+}
+
+/**
+  * @brief This function builds the command of a status register read
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Command command
+  * @param Address address of the status register (8 lines only)
+  * @param Cmd command to build
+  * @return none
+  */
+void XSPI_StatusCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, XSPI_RegularCmdTypeDef *Cmd)
+{
+  *Cmd = SalXspi->Commandbase;
+
+  /* Initialize the writing of status register */
+  Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+
+  Cmd->DataLength     = 1u;
+  Cmd->DQSMode        = HAL_XSPI_DQS_DISABLE;
+
+  if (Cmd->InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
+  {
+    // patch cypress to force 1 line on status read
+    Cmd->DataMode    = HAL_XSPI_DATA_1_LINE;
+    Cmd->AddressMode = HAL_XSPI_DATA_NONE;
+    Cmd->DummyCycles = 0u;
+  }
+
+  /* @ is used only in 8 LINES format */
+  if (Cmd->DataMode == HAL_XSPI_DATA_8_LINES)
+  {
+    Cmd->AddressMode    = HAL_XSPI_ADDRESS_8_LINES;
+    Cmd->AddressWidth   = HAL_XSPI_ADDRESS_32_BITS;
+    Cmd->Address        = Address;
+  }
+}
+
+/**
+  * @brief This function builds a command made of an instruction and an address
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Command command
+  * @param Address address sent with the command
+  * @param Cmd command to build
+  * @return none
+  */
+void XSPI_AddressCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, XSPI_RegularCmdTypeDef *Cmd)
+{
+  *Cmd = SalXspi->Commandbase;
+
+  Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+
+  if (Cmd->InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
+  {
+    Cmd->AddressMode = HAL_XSPI_ADDRESS_1_LINE;
+  }
+
+  Cmd->Address           = Address;
+  Cmd->DummyCycles       = 0U;
+  Cmd->DataMode          = HAL_XSPI_DATA_NONE;
+  Cmd->DQSMode           = HAL_XSPI_DQS_DISABLE;
+}
+
+/**
+  * @brief This function builds a command made of an instruction and optional data
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Command command
+  * @param DataSize size of the data, 0 for an instruction only
+  * @param Cmd command to build
+  * @return none
+  */
+void XSPI_InstructionCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd)
+{
+  *Cmd = SalXspi->Commandbase;
+
+  Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+
+  Cmd->AddressMode        = HAL_XSPI_ADDRESS_NONE;
+  Cmd->DummyCycles        = 0U;
+  Cmd->DataLength         = DataSize;
+  Cmd->DQSMode            = HAL_XSPI_DQS_DISABLE;
+
+  if (DataSize == 0u)
+  {
+    Cmd->DataMode         = HAL_XSPI_DATA_NONE;
+  }
+}
+
+/**
+  * @brief This function waits a flag of the XSPI, as the HAL does
+  *
+  * @param hxspi handle on the XSPI IP
+  * @param Flag flag to check
+  * @param State expected state of the flag
+  * @param Tickstart tick of the start of the operation
+  * @param Timeout timeout in ms
+  * @return @ref HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef XSPI_WaitFlag(XSPI_HandleTypeDef *hxspi, uint32_t Flag, FlagStatus State, uint32_t Tickstart, uint32_t Timeout)
+{
+  while (HAL_XSPI_GET_FLAG(hxspi, Flag) != State)
+  {
+    if ((HAL_GetTick() - Tickstart) > Timeout)
+    {
+      hxspi->ErrorCode |= HAL_XSPI_ERROR_TIMEOUT;
+      return HAL_TIMEOUT;
+    }
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief This function writes the registers of a precompiled command, the last write starts it
+  * @note the HAL handle stays in the ready state, the HAL functions can be mixed with the precompiled commands
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Desc precompiled command
+  * @param Mode functional mode of the transfer
+  * @param Address address, ignored if the command has no address phase
+  * @param DataSize size of the data phase
+  * @param Tickstart tick of the start of the operation
+  * @return @ref HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef XSPI_IssueStart(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc, uint32_t Mode,
+                                  uint32_t Address, uint32_t DataSize, uint32_t Tickstart)
+{
+  XSPI_HandleTypeDef *hxspi = SalXspi->hxspi;
+  XSPI_TypeDef *instance = hxspi->Instance;
+  HAL_StatusTypeDef retr;
+
+  /* mapped mode or a transfer of the HAL is ongoing */
+  if (hxspi->State != HAL_XSPI_STATE_READY)
+  {
+    return HAL_BUSY;
+  }
+
+  retr = XSPI_WaitFlag(hxspi, HAL_XSPI_FLAG_BUSY, RESET, Tickstart, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  if (retr == HAL_OK)
+  {
+    hxspi->ErrorCode = HAL_XSPI_ERROR_NONE;
+    MODIFY_REG(instance->CR, (XSPI_CR_FMODE | XSPI_CR_APMS | Desc->CRMask), (Mode | Desc->CR));
+    if (Desc->Data == 1u)
+    {
+      instance->DLR = DataSize - 1u;
+    }
+    MODIFY_REG(instance->TCR, Desc->TCRMask, Desc->TCR);
+    instance->CCR = Desc->CCR;
+    instance->IR  = Desc->IR;
+    if (Desc->Address == 1u)
+    {
+      instance->AR = Address;
+    }
+  }
+  return retr;
+}
+
+/**
+  * @brief This function gives the delay line used to sample the data of the reads
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param DelayType delay type, @ref XSPI_DelayType
+  * @return 1 if the reads are sampled through a delay line, 0 for STR reads
+  */
+uint8_t XSPI_ReadDelayType(const SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t *DelayType)
+{
+  if (SalXspi->Commandbase.DQSMode == HAL_XSPI_DQS_ENABLE)
+  {
+    *DelayType = HAL_XSPI_CAL_DQS_INPUT_DELAY;
+    return 1u;
+  }
+  if ((SalXspi->Commandbase.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) || (SalXspi->PhyLink == PHY_LINK_4S4D4D))
+  {
+    *DelayType = HAL_XSPI_CAL_FEEDBACK_CLK_DELAY;
+    return 1u;
+  }
+  return 0u;
+}
+
+/**
+  * @brief This function trasnmits the data
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Data data pointer
+  * @return none
+  */
+HAL_StatusTypeDef XSPI_Transmit(SAL_XSPI_ObjectTypeDef *SalXspi, const uint8_t *Data)
+{
+HAL_StatusTypeDef retr;
+
+#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
+  if (SalXspi->hxspi->hdmatx == NULL)
+#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+  {
+    /* transmit data */
+    retr = HAL_XSPI_Transmit(SalXspi->hxspi, Data, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  }
+#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
+  else
+  {
+    /* set completion call back */
+    salXSPI_status = SALXSPI_TRANSFER_NONE;
+
+    /* Reception of the data */
+    retr = HAL_XSPI_Transmit_DMA(SalXspi->hxspi, (uint8_t *)Data);
+
+    if (retr ==  HAL_OK)
+    {
+      /* wait data completion */
+      while(salXSPI_status == SALXSPI_TRANSFER_NONE);
+      if (salXSPI_status == SALXSPI_TRANSFER_ERROR)
+      {
+        retr = HAL_ERROR;
+      }
+    }
+  }
+#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+
+  return retr;
+}
+
+/**
+  * @brief this is called to start the data transfer in polling mode or DMA
+  *
+  * @param SalXspi handle on the XSPI IP
+  * @param Data data pointer
+  * @return none
+  */
+HAL_StatusTypeDef XSPI_Receive(SAL_XSPI_ObjectTypeDef *SalXspi,  uint8_t *Data)
+{
+HAL_StatusTypeDef retr;
+
+#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
+  if (SalXspi->hxspi->hdmarx == NULL)
+#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+  {
+    /* Reception of the data */
+    retr = HAL_XSPI_Receive(SalXspi->hxspi, Data, SAL_XSPI_TIMEOUT_DEFAULT_VALUE);
+  }
+#if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
+  else
+  {
+    /* set completion call back */
+    salXSPI_status = SALXSPI_TRANSFER_NONE;
+
+    /* Reception of the data */
+    retr = HAL_XSPI_Receive_DMA(SalXspi->hxspi, Data);
+
+    if (retr ==  HAL_OK)
+    {
+      /* wait data completion */
+      while(salXSPI_status == SALXSPI_TRANSFER_NONE);
+      if (salXSPI_status == SALXSPI_TRANSFER_ERROR)
+      {
+        retr = HAL_ERROR;
+      }
+    }
+  }
+#endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+  return retr;
 }
 
 #if defined (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U)
@@ -1000,6 +1693,9 @@ HAL_StatusTypeDef retr;
 void SAL_XSPI_ErrorCallback(struct __XSPI_HandleTypeDef *hxspi)
 {
   salXSPI_status = SALXSPI_TRANSFER_ERROR;
+#if EXTMEM_ASYNC == 1
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_ERROR);
+#endif /* EXTMEM_ASYNC == 1 */
 }
 
 /**
@@ -1011,8 +1707,148 @@ void SAL_XSPI_ErrorCallback(struct __XSPI_HandleTypeDef *hxspi)
 void SAL_XSPI_CompleteCallback(struct __XSPI_HandleTypeDef *hxspi)
 {
   salXSPI_status = SALXSPI_TRANSFER_OK;
+#if EXTMEM_ASYNC == 1
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_TRANSFER_CPLT);
+#endif /* EXTMEM_ASYNC == 1 */
+}
+
+#if EXTMEM_ASYNC == 1
+/**
+  * @brief this is called when an auto-polling started under interrupt matches
+  *
+  * @param hxspi handle on the XSPI IP
+  * @return none
+  */
+void SAL_XSPI_StatusMatchCallback(struct __XSPI_HandleTypeDef *hxspi)
+{
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_STATUS_MATCH);
+}
+#endif /* EXTMEM_ASYNC == 1 */
+#elif EXTMEM_ASYNC == 1
+/**
+  * @brief HAL reception complete callback, routed to the asynchronous SAL functions
+  *
+  * @param hxspi handle on the XSPI IP
+  * @return none
+  */
+void HAL_XSPI_RxCpltCallback(XSPI_HandleTypeDef *hxspi)
+{
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_TRANSFER_CPLT);
+}
+
+/**
+  * @brief HAL transmission complete callback, routed to the asynchronous SAL functions
+  *
+  * @param hxspi handle on the XSPI IP
+  * @return none
+  */
+void HAL_XSPI_TxCpltCallback(XSPI_HandleTypeDef *hxspi)
+{
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_TRANSFER_CPLT);
+}
+
+/**
+  * @brief HAL status match callback, routed to the asynchronous SAL functions
+  *
+  * @param hxspi handle on the XSPI IP
+  * @return none
+  */
+void HAL_XSPI_StatusMatchCallback(XSPI_HandleTypeDef *hxspi)
+{
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_STATUS_MATCH);
+}
+
+/**
+  * @brief HAL error callback, routed to the asynchronous SAL functions
+  *
+  * @param hxspi handle on the XSPI IP
+  * @return none
+  */
+void HAL_XSPI_ErrorCallback(XSPI_HandleTypeDef *hxspi)
+{
+  XSPI_AsyncEvent(hxspi, SAL_XSPI_EVENT_ERROR);
 }
 #endif /* (USE_HAL_XSPI_REGISTER_CALLBACKS) && (USE_HAL_XSPI_REGISTER_CALLBACKS == 1U) */
+
+#if EXTMEM_ASYNC == 1
+/**
+  * @brief this function cleans the data cache lines of a buffer read by the DMA
+  *
+  * @param Data buffer
+  * @param DataSize buffer size
+  * @return none
+  */
+void XSPI_DCacheClean(const uint8_t *Data, uint32_t DataSize)
+{
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+  if ((SCB->CCR & SCB_CCR_DC_Msk) != 0u)
+  {
+    SCB_CleanDCache_by_Addr((volatile void *)Data, (int32_t)DataSize);
+  }
+#else
+  (void)Data;
+  (void)DataSize;
+#endif /* defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U) */
+}
+
+/**
+  * @brief this function invalidates the data cache lines of a buffer written by the DMA
+  *
+  * @param Data buffer, aligned on a cache line
+  * @param DataSize buffer size
+  * @return none
+  */
+void XSPI_DCacheInvalidate(uint8_t *Data, uint32_t DataSize)
+{
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+  if ((SCB->CCR & SCB_CCR_DC_Msk) != 0u)
+  {
+    SCB_InvalidateDCache_by_Addr((volatile void *)Data, (int32_t)DataSize);
+  }
+#else
+  (void)Data;
+  (void)DataSize;
+#endif /* defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U) */
+}
+
+/**
+  * @brief this function reports an HAL event to the SAL object waiting for it
+  *
+  * @param hxspi handle on the XSPI IP
+  * @param Event event to report
+  * @return none
+  */
+void XSPI_AsyncEvent(XSPI_HandleTypeDef *hxspi, SAL_XSPI_EventTypeDef Event)
+{
+  SAL_XSPI_ObjectTypeDef *salxspi = NULL;
+
+  for (uint32_t index = 0u; index < SAL_XSPI_ASYNC_INSTANCES; index++)
+  {
+    if ((salXSPI_async[index] != NULL) && (salXSPI_async[index]->hxspi == hxspi))
+    {
+      salxspi = salXSPI_async[index];
+      break;
+    }
+  }
+
+  /* events of the synchronous functions are not reported */
+  if ((salxspi != NULL) && (salxspi->AsyncPending == 1u))
+  {
+    salxspi->AsyncPending = 0u;
+    if (salxspi->RxData != NULL)
+    {
+      /* drop the lines speculatively loaded during the DMA reception */
+      XSPI_DCacheInvalidate(salxspi->RxData, salxspi->RxSize);
+      salxspi->RxData = NULL;
+    }
+
+    if (salxspi->EventCallback != NULL)
+    {
+      salxspi->EventCallback(salxspi->EventContext, Event);
+    }
+  }
+}
+#endif /* EXTMEM_ASYNC == 1 */
 /**
   * @}
   */
@@ -161,6 +161,25 @@ HAL_StatusTypeDef SAL_XSPI_CommandSendAddress(SAL_XSPI_ObjectTypeDef* SalXspi, u
  **/
 HAL_StatusTypeDef SAL_XSPI_SetClock(SAL_XSPI_ObjectTypeDef* SalXspi, uint32_t ClockIn, uint32_t ClockRequested, uint32_t* ClockReal);
 
+/**
+ * @brief This function gets the read timing currently applied on the link
+ * @param SalXspi SAL XSPI handle
+ * @param Timing pointer on the timing
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_GetTiming(SAL_XSPI_ObjectTypeDef* SalXspi, SAL_XSPI_TimingTypeDef* Timing);
+
+/**
+ * @brief This function applies a read timing on the link
+ * @note the delay sets the DQS input delay when the reads use the data strobe, the feedback clock
+ *       delay for the other DTR reads, it is ignored for STR reads. The sample shift only applies to STR reads.
+ * @param SalXspi SAL XSPI handle
+ * @param ClockIn clock in input
+ * @param Timing timing to apply
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_SetTiming(SAL_XSPI_ObjectTypeDef* SalXspi, uint32_t ClockIn, const SAL_XSPI_TimingTypeDef* Timing);
+
 /**
  * @brief This function sets a configuration parameter
  * @param SalXspi SAL XSPI handle
@@ -179,6 +198,17 @@ HAL_StatusTypeDef SAL_XSPI_MemoryConfig(SAL_XSPI_ObjectTypeDef* SalXspi, SAL_XSP
  **/
 HAL_StatusTypeDef SAL_XSPI_ConfigureWrappMode(SAL_XSPI_ObjectTypeDef* SalXspi, uint8_t WrapCommand, uint8_t WrapDummy);
 
+/**
+ * @brief This function sets the options of the next memory mapped mode
+ * @note the wrap size is written in the XSPI at once, the link must not be in memory mapped mode.
+ *       A wrap size other than HAL_XSPI_WRAP_NOT_SUPPORTED needs SAL_XSPI_ConfigureWrappMode
+ *       before SAL_XSPI_EnableMapMode, and a memory configured for the same burst length.
+ * @param SalXspi SAL XSPI handle
+ * @param Config memory mapped options
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_SetMapConfig(SAL_XSPI_ObjectTypeDef* SalXspi, const SAL_XSPI_MapConfigTypeDef* Config);
+
 /**
  * @brief This function enables the memory mapped mode
  * @param SalXspi SAL XSPI handle
@@ -213,6 +243,121 @@ HAL_StatusTypeDef SAL_XSPI_UpdateMemoryType(SAL_XSPI_ObjectTypeDef *SalXspi, SAL
  **/
 HAL_StatusTypeDef SAL_XSPI_Abort(SAL_XSPI_ObjectTypeDef *SalXspi);
 
+/**
+ * @brief This function replays a recorded transaction
+ * @param SalXspi SAL XSPI handle
+ * @param Step transaction to execute
+ * @param Timeout timeout used for the polling transaction
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_CommandStep(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandStepTypeDef *Step, uint32_t Timeout);
+
+/**
+ * @brief This function precompiles a command, the register values are computed once
+ *        from the current link configuration
+ * @param SalXspi SAL XSPI handle
+ * @param Kind kind of command, @ref SAL_XSPI_CommandKindTypeDef
+ * @param Command command to execute
+ * @param Desc command built
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_BuildCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_CommandKindTypeDef Kind,
+                                        uint8_t Command, SAL_XSPI_CommandDescTypeDef *Desc);
+
+/**
+ * @brief This function sends a precompiled command without data phase
+ * @param SalXspi SAL XSPI handle
+ * @param Desc precompiled command
+ * @param Address address, ignored if the command has no address phase
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_Issue(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc, uint32_t Address);
+
+/**
+ * @brief This function reads data with a precompiled command, the FIFO is served by the CPU
+ * @param SalXspi SAL XSPI handle
+ * @param Desc precompiled command
+ * @param Address address to read the data
+ * @param Data Data pointer
+ * @param DataSize size of the data to read
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_IssueRead(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                     uint32_t Address, uint8_t *Data, uint32_t DataSize);
+
+/**
+ * @brief This function writes data with a precompiled command, the FIFO is served by the CPU
+ * @param SalXspi SAL XSPI handle
+ * @param Desc precompiled command
+ * @param Address address to write the data
+ * @param Data Data pointer
+ * @param DataSize size of the data to write
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_IssueWrite(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                      uint32_t Address, const uint8_t *Data, uint32_t DataSize);
+
+/**
+ * @brief This function polls the status register with a precompiled command
+ * @param SalXspi SAL XSPI handle
+ * @param Desc precompiled command
+ * @param Address specify the address
+ * @param MatchValue  expected value
+ * @param MatchMask   mask used to control the expected value
+ * @param Timeout timeout parameter
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_IssuePolling(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                        uint32_t Address, uint8_t MatchValue, uint8_t MatchMask, uint32_t Timeout);
+
+#if EXTMEM_ASYNC == 1
+/**
+ * @brief This function sets the callback of the asynchronous functions
+ * @param SalXspi SAL XSPI handle
+ * @param Callback function called under interrupt when a transaction completes
+ * @param Context parameter given back to the callback
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_SetEventCallback(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_EventCallbackTypeDef Callback, void *Context);
+
+/**
+ * @brief This function starts the read of data from the flash,
+ *        SAL_XSPI_EVENT_TRANSFER_CPLT is reported when the data are available
+ * @param SalXspi SAL XSPI handle
+ * @param Command command to execute
+ * @param Address address to read the data
+ * @param Data Data pointer, aligned on a cache line when a DMA channel is linked
+ * @param DataSize size of the data to read
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_ReadAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint8_t *Data, uint32_t DataSize);
+
+/**
+ * @brief This function starts the write of data at an Address,
+ *        SAL_XSPI_EVENT_TRANSFER_CPLT is reported when the data have been sent
+ * @param SalXspi SAL XSPI handle
+ * @param Command command to execute
+ * @param Address address to write the data
+ * @param Data Data pointer, must stay valid until the completion
+ * @param DataSize size of the data to write
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_WriteAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, const uint8_t *Data, uint32_t DataSize);
+
+/**
+ * @brief This function starts the polling of the status register under interrupt,
+ *        SAL_XSPI_EVENT_STATUS_MATCH is reported when the expected value is read
+ * @param SalXspi SAL XSPI handle
+ * @param Command command to execute
+ * @param Address specify the address
+ * @param MatchValue  expected value
+ * @param MatchMask   mask used to control the expected value
+ * @return @ref HAL_StatusTypeDef
+ **/
+HAL_StatusTypeDef SAL_XSPI_CheckStatusRegisterAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                                    uint8_t MatchValue, uint8_t MatchMask);
+#endif /* EXTMEM_ASYNC == 1 */
+
 /**
   * @}
   */
@@ -69,6 +69,20 @@ typedef enum {
 #endif /* defined(HAL_XSPI_DATA_16_LINES) */
 } SAL_XSPI_PhysicalLinkTypeDef;
 
+/**
+ * @brief events reported by the asynchronous SAL functions
+ */
+typedef enum {
+  SAL_XSPI_EVENT_TRANSFER_CPLT,  /*!< data phase completed */
+  SAL_XSPI_EVENT_STATUS_MATCH,   /*!< status register polling matched */
+  SAL_XSPI_EVENT_ERROR,          /*!< transfer or polling error */
+} SAL_XSPI_EventTypeDef;
+
+/**
+ * @brief callback called under interrupt when an asynchronous SAL function completes
+ */
+typedef void (*SAL_XSPI_EventCallbackTypeDef)(void *Context, SAL_XSPI_EventTypeDef Event);
+
 typedef struct {
    XSPI_HandleTypeDef           *hxspi;            /*!< handle on the XSPI instance */
    XSPI_RegularCmdTypeDef       Commandbase;       /*!< command base configuration */
@@ -76,8 +90,74 @@ typedef struct {
    uint8_t                      SFDPDummyCycle;    /*!< SDPF dummy cycle */
    SAL_XSPI_PhysicalLinkTypeDef PhyLink;           /*!< Only used for data Read in 4S4D4d 2S2D2D 1S1D1D */
    uint8_t                      DTRDummyCycle;     /*!< Specify that DTR read only valid for data read using DTRDummyCycle value */
+   uint32_t                     ClockOut;          /*!< memory clock set by the last SAL_XSPI_SetClock */
+   uint16_t                     MapTimeout;        /*!< memory-mapped timeout in clock cycles, 0 when the counter is disabled */
+#if EXTMEM_ASYNC == 1
+   SAL_XSPI_EventCallbackTypeDef EventCallback;    /*!< completion callback of the asynchronous functions */
+   void                         *EventContext;     /*!< context given back to EventCallback */
+   uint8_t                      AsyncPending;      /*!< 1 while an asynchronous transaction is ongoing */
+   uint8_t                      *RxData;           /*!< buffer of the ongoing DMA reception, for the cache maintenance */
+   uint32_t                     RxSize;            /*!< size of the ongoing DMA reception */
+#endif /* EXTMEM_ASYNC == 1 */
 } SAL_XSPI_ObjectTypeDef;
 
+/**
+  * @brief read timing of the link, it sets how the XSPI samples the data sent by the memory
+  */
+typedef struct {
+   uint8_t                      Prescaler;         /*!< DCR2 prescaler, the memory clock is ClockIn / (Prescaler + 1) */
+   uint8_t                      SampleShift;       /*!< 1 to sample the data half a cycle later, STR reads only */
+   uint8_t                      DelayCoarse;       /*!< coarse unit of the read sampling delay, DTR reads only */
+   uint8_t                      DelayFine;         /*!< fine unit of the read sampling delay, DTR reads only */
+} SAL_XSPI_TimingTypeDef;
+
+/**
+  * @brief memory-mapped mode options, they set how the XSPI fetches the data of the CPU accesses
+  */
+typedef struct {
+   uint32_t                     WrapSize;          /*!< HAL_XSPI_WRAP_xx: size of the wrapped bursts, HAL_XSPI_WRAP_NOT_SUPPORTED for linear bursts only */
+   uint16_t                     Timeout;           /*!< clock cycles without access before nCS is released, 0 to keep nCS low
+                                                        and the prefetch running until the next non sequential access */
+} SAL_XSPI_MapConfigTypeDef;
+
+/**
+  * @brief kind of a precompiled command, it tells which SAL function the command is built like
+  */
+typedef enum {
+  SAL_XSPI_DESC_READ,            /*!< data read, as SAL_XSPI_Read */
+  SAL_XSPI_DESC_WRITE,           /*!< data write, as SAL_XSPI_Write */
+  SAL_XSPI_DESC_STATUS,          /*!< status register read, as SAL_XSPI_CheckStatusRegister */
+  SAL_XSPI_DESC_ADDRESS,         /*!< instruction and address, as SAL_XSPI_CommandSendAddress */
+  SAL_XSPI_DESC_INSTRUCTION,     /*!< instruction only, as SAL_XSPI_CommandSendData without data */
+} SAL_XSPI_CommandKindTypeDef;
+
+/**
+  * @brief precompiled command: register values of a regular command, written as is by the SAL_XSPI_Issue functions
+  * @note the values depend on the link and on the read timing, the command is built again when they change
+  */
+typedef struct {
+   uint32_t                     CCR;               /*!< communication configuration: modes, widths, DTR and DQS */
+   uint32_t                     TCR;               /*!< dummy cycles and sample shifting */
+   uint32_t                     TCRMask;           /*!< TCR fields set by the command, the others are kept */
+   uint32_t                     IR;                /*!< formatted instruction */
+   uint32_t                     CR;                /*!< memory selection */
+   uint32_t                     CRMask;            /*!< CR fields set by the command, FMODE excepted */
+   uint8_t                      Address;           /*!< 1 when the command has an address phase */
+   uint8_t                      Data;              /*!< 1 when the command has a data phase */
+} SAL_XSPI_CommandDescTypeDef;
+
+/**
+  * @brief one recorded XSPI transaction, used to replay a memory configuration sequence
+  */
+typedef struct {
+   XSPI_RegularCmdTypeDef       Command;           /*!< command exactly as sent to the HAL */
+   const uint8_t                *Data;             /*!< data to transmit, NULL if the command has no data phase */
+   uint32_t                     Delay;             /*!< delay in ms to wait once the command is completed */
+   uint8_t                      Polling;           /*!< 1 if the command is a status polling */
+   uint8_t                      MatchValue;        /*!< polling expected value */
+   uint8_t                      MatchMask;         /*!< polling mask */
+} SAL_XSPI_CommandStepTypeDef;
+
 /**
   * @brief define the list of the parameter
   */
@@ -112,7 +112,151 @@
   */
 
 /* Private typedefs ---------------------------------------------------------*/
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+/**
+  * @brief erase type of a NOR SFDP memory, as used by the erase planner
+  */
+typedef struct
+{
+  EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef SectorType;  /*!< driver sector type */
+  uint32_t Size;                                        /*!< sector size */
+  uint32_t Time;                                        /*!< sector erase time */
+} EXTMEM_EraseTypeTypeDef;
+
+/**
+  * @brief number of words read at once by the indirect blank check
+  */
+#define EXTMEM_BLANK_CHECK_WORDS 64u
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+
+#if EXTMEM_ASYNC == 1
+/** @defgroup EXTMEM_Private_Async External Memory asynchronous operations
+  * @{
+  */
+/**
+  * @brief maximum number of queued asynchronous operations, the running one included
+  */
+#ifndef EXTMEM_ASYNC_QUEUE_SIZE
+#define EXTMEM_ASYNC_QUEUE_SIZE 4u
+#endif /* EXTMEM_ASYNC_QUEUE_SIZE */
+
+/**
+  * @brief asynchronous operations
+  */
+typedef enum
+{
+  EXTMEM_ASYNC_READ,
+  EXTMEM_ASYNC_WRITE,
+  EXTMEM_ASYNC_ERASE
+} EXTMEM_AsyncOperationTypeDef;
+
+/**
+  * @brief queued asynchronous operation
+  */
+typedef struct
+{
+  EXTMEM_AsyncOperationTypeDef Operation;   /*!< operation */
+  uint32_t MemId;                           /*!< memory id */
+  uint32_t Address;                         /*!< location of the data memory, next sector for an erase */
+  uint8_t *Data;                            /*!< data pointer */
+  uint32_t Size;                            /*!< data size, remaining size for an erase */
+  uint32_t SectorSize;                      /*!< size of the sector being erased */
+  EXTMEM_CallbackTypeDef Callback;          /*!< completion callback */
+  void *Context;                            /*!< parameter given back to the callback */
+} EXTMEM_AsyncRequestTypeDef;
+
+/**
+  * @brief queue of the asynchronous operations, the head is the running one
+  */
+static EXTMEM_AsyncRequestTypeDef extmem_async_queue[EXTMEM_ASYNC_QUEUE_SIZE];
+static uint32_t extmem_async_head;
+static volatile uint32_t extmem_async_count;
+static volatile uint32_t extmem_async_running;
+
+/**
+  * @}
+  */
+#endif /* EXTMEM_ASYNC == 1 */
+
 /* Private functions ---------------------------------------------------------*/
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+/**
+ * @brief This function selects the largest sector erasable at an address
+ *
+ * @param Object memory object
+ * @param Address location of the data memory
+ * @param Size remaining size to erase
+ * @param SectorType returns the sector type
+ * @param SectorSize returns the sector size
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef extmem_nor_sfdp_sector(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, uint32_t Address, uint32_t Size,
+                                                   EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef *SectorType, uint32_t *SectorSize)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_OK;
+  uint32_t sector_size = (uint32_t)1u << Object->sfpd_private.DriverInfo.EraseType4Size;
+
+  /* if address is a modulo a sector size if sector  */
+  if ((Object->sfpd_private.DriverInfo.EraseType4Size != 0u) 
+      && (Size >= sector_size) 
+        && ((Address % sector_size) == 0u))
+  {
+    *SectorType = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE4;
+  }
+  else
+  {
+    sector_size = (uint32_t)1u << Object->sfpd_private.DriverInfo.EraseType3Size;
+    if ((Object->sfpd_private.DriverInfo.EraseType3Size != 0u) 
+        && (Size >= sector_size) 
+          && ((Address % sector_size) == 0u))
+    {
+      *SectorType = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE3;
+    }
+    else
+    {
+      sector_size = (uint32_t)1u << Object->sfpd_private.DriverInfo.EraseType2Size;
+      if ((Object->sfpd_private.DriverInfo.EraseType2Size != 0u) 
+          && (Size >= sector_size) 
+            && ((Address % sector_size) == 0u))
+      {
+        *SectorType = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE2;
+      }
+      else
+      {
+        sector_size = (uint32_t)1u << Object->sfpd_private.DriverInfo.EraseType1Size;
+        if ((Object->sfpd_private.DriverInfo.EraseType1Size != 0u) 
+            && ((Address % sector_size) == 0u))
+        {
+          *SectorType = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1;
+        }
+        else
+        {
+          retr = EXTMEM_ERROR_SECTOR_SIZE;
+        }
+      }
+    }
+  }
+
+  *SectorSize = sector_size;
+  return retr;
+}
+
+static uint32_t extmem_nor_sfdp_erase_types(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, EXTMEM_EraseTypeTypeDef *Types);
+static EXTMEM_StatusTypeDef extmem_nor_sfdp_blank(uint32_t MemId, EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object,
+                                                  uint32_t Address, uint32_t Size, uint8_t *Blank);
+static EXTMEM_StatusTypeDef extmem_nor_sfdp_plan_block(uint32_t MemId, EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object,
+                                                       const EXTMEM_EraseTypeTypeDef *Types, uint32_t Level,
+                                                       uint32_t Address, EXTMEM_ErasePlanTypeDef *Plan, uint32_t *Time);
+static void extmem_plan_add(EXTMEM_ErasePlanTypeDef *Plan, uint32_t Address, const EXTMEM_EraseTypeTypeDef *Type);
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+#if EXTMEM_ASYNC == 1
+static EXTMEM_StatusTypeDef extmem_async_queue_request(const EXTMEM_AsyncRequestTypeDef *Request);
+static EXTMEM_StatusTypeDef extmem_async_start(EXTMEM_AsyncRequestTypeDef *Request);
+static uint32_t extmem_async_claim(void);
+static EXTMEM_AsyncRequestTypeDef extmem_async_release(void);
+static void extmem_async_launch(void);
+static void extmem_async_done(void *Context, int32_t Status);
+#endif /* EXTMEM_ASYNC == 1 */
 /* Exported variables ---------------------------------------------------------*/
 /** @defgroup EXTMEM_Exported_Functions External Memory Exported Functions
   * @{
@@ -448,49 +592,10 @@ EXTMEM_StatusTypeDef EXTMEM_EraseSector(uint32_t MemId, uint32_t Address, uint32
       EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef sector_type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1;
       uint32_t local_address = Address;
       uint32_t local_size = Size;
-      uint32_t sector_size = (uint32_t)1u << object->sfpd_private.DriverInfo.EraseType4Size;
+      uint32_t sector_size = 0u;
       
       while (local_size != 0u) {
-        /* if address is a modulo a sector size if sector  */
-        if ((object->sfpd_private.DriverInfo.EraseType4Size != 0u) 
-            && (local_size >= sector_size) 
-              && ((local_address % sector_size) == 0u))
-        {
-          sector_type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE4;
-        }
-        else
-        {
-          sector_size = (uint32_t)1u << object->sfpd_private.DriverInfo.EraseType3Size;
-          if ((object->sfpd_private.DriverInfo.EraseType3Size != 0u) 
-              && (local_size >= sector_size) 
-                && ((local_address % sector_size) == 0u))
-          {
-            sector_type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE3;
-          }
-          else
-          {
-            sector_size = (uint32_t)1u << object->sfpd_private.DriverInfo.EraseType2Size;
-            if ((object->sfpd_private.DriverInfo.EraseType2Size != 0u) 
-                && (local_size >= sector_size) 
-                  && ((local_address % sector_size) == 0u))
-            {
-              sector_type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE2;
-            }
-            else
-            {
-              sector_size = (uint32_t)1u << object->sfpd_private.DriverInfo.EraseType1Size;
-              if ((object->sfpd_private.DriverInfo.EraseType1Size != 0u) 
-                  && ((local_address % sector_size) == 0u))
-              {
-                sector_type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1;
-              }
-              else
-              {
-                retr = EXTMEM_ERROR_SECTOR_SIZE;
-              }
-            }
-          }
-        }
+        retr = extmem_nor_sfdp_sector(object, local_address, local_size, &sector_type, &sector_size);
         
         if (retr == EXTMEM_OK)
         {
@@ -623,6 +728,113 @@ EXTMEM_StatusTypeDef EXTMEM_EraseAll(uint32_t MemId)
   return retr;
 }
 
+EXTMEM_StatusTypeDef EXTMEM_PlanErase(uint32_t MemId, uint32_t Address, uint32_t Size, EXTMEM_ErasePlanTypeDef *Plan)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_ERROR_INVALID_ID;
+  EXTMEM_FUNC_CALL()
+
+  /* control the memory ID */
+  if (MemId < (sizeof(extmem_list_config) / sizeof(EXTMEM_DefinitionTypeDef)))
+  {
+    retr = EXTMEM_OK;
+    Plan->MemId = MemId;
+    Plan->StepCount = 0u;
+    Plan->EraseTime = 0u;
+    Plan->BlankSize = 0u;
+
+    switch (extmem_list_config[MemId].MemType)
+    {
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+    case EXTMEM_NOR_SFDP:{
+      EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object = &extmem_list_config[MemId].NorSfdpObject;
+      EXTMEM_EraseTypeTypeDef types[4];
+      uint32_t count = extmem_nor_sfdp_erase_types(object, types);
+      uint32_t local_address = Address;
+      uint32_t end;
+      uint32_t level;
+      uint32_t time;
+
+      if ((count == 0u) || ((Address % types[0].Size) != 0u))
+      {
+        retr = EXTMEM_ERROR_SECTOR_SIZE;
+        break;
+      }
+
+      end = Address + Size + types[0].Size - 1u;
+      end = end - (end % types[0].Size);
+
+      /* split the range in the largest aligned sectors, each one is then planned
+         by comparing its erase time with the best plan of its sub-sectors */
+      while ((retr == EXTMEM_OK) && (local_address < end))
+      {
+        level = count - 1u;
+        while ((level != 0u)
+               && (((local_address % types[level].Size) != 0u) || ((end - local_address) < types[level].Size)))
+        {
+          level--;
+        }
+
+        retr = extmem_nor_sfdp_plan_block(MemId, object, types, level, local_address, Plan, &time);
+        Plan->EraseTime += time;
+        local_address += types[level].Size;
+      }
+
+      if ((retr == EXTMEM_OK) && (Plan->StepCount > Plan->MaxSteps))
+      {
+        retr = EXTMEM_ERROR_PARAM;
+      }
+      break;
+    }
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+    default:{
+      retr = EXTMEM_ERROR_NOTSUPPORTED;
+      break;
+    }
+    }
+  }
+  return retr;
+}
+
+EXTMEM_StatusTypeDef EXTMEM_ExecuteErasePlan(const EXTMEM_ErasePlanTypeDef *Plan)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_ERROR_INVALID_ID;
+  EXTMEM_FUNC_CALL()
+
+  /* control the memory ID */
+  if (Plan->MemId < (sizeof(extmem_list_config) / sizeof(EXTMEM_DefinitionTypeDef)))
+  {
+    retr = EXTMEM_OK;
+    switch (extmem_list_config[Plan->MemId].MemType)
+    {
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+    case EXTMEM_NOR_SFDP:{
+      if (Plan->StepCount > Plan->MaxSteps)
+      {
+        retr = EXTMEM_ERROR_PARAM;
+        break;
+      }
+
+      for (uint32_t index = 0u; (retr == EXTMEM_OK) && (index < Plan->StepCount); index++)
+      {
+        if (EXTMEM_DRIVER_NOR_SFDP_OK != EXTMEM_DRIVER_NOR_SFDP_SectorErase(&extmem_list_config[Plan->MemId].NorSfdpObject,
+                                            Plan->Steps[index].Address,
+                                            (EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef)(Plan->Steps[index].Type - 1u)))
+        {
+          retr = EXTMEM_ERROR_DRIVER;
+        }
+      }
+      break;
+    }
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+    default:{
+      retr = EXTMEM_ERROR_NOTSUPPORTED;
+      break;
+    }
+    }
+  }
+  return retr;
+}
+
 EXTMEM_StatusTypeDef EXTMEM_GetInfo(uint32_t MemId, void *Info)
 {
   EXTMEM_StatusTypeDef retr = EXTMEM_ERROR_INVALID_ID;
@@ -839,9 +1051,476 @@ EXTMEM_StatusTypeDef EXTMEM_GetMapAddress(uint32_t MemId, uint32_t *BaseAddress)
   }
   return retr;
 }
+
+#if EXTMEM_ASYNC == 1
+EXTMEM_StatusTypeDef EXTMEM_ReadAsync(uint32_t MemId, uint32_t Address, uint8_t* Data, uint32_t Size,
+                                      EXTMEM_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_AsyncRequestTypeDef request = {
+    .Operation = EXTMEM_ASYNC_READ,
+    .MemId     = MemId,
+    .Address   = Address,
+    .Data      = Data,
+    .Size      = Size,
+    .Callback  = Callback,
+    .Context   = Context
+  };
+  EXTMEM_FUNC_CALL()
+
+  return extmem_async_queue_request(&request);
+}
+
+EXTMEM_StatusTypeDef EXTMEM_WriteAsync(uint32_t MemId, uint32_t Address, const uint8_t* Data, uint32_t Size,
+                                       EXTMEM_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_AsyncRequestTypeDef request = {
+    .Operation = EXTMEM_ASYNC_WRITE,
+    .MemId     = MemId,
+    .Address   = Address,
+    .Data      = (uint8_t *)Data,
+    .Size      = Size,
+    .Callback  = Callback,
+    .Context   = Context
+  };
+  EXTMEM_FUNC_CALL()
+
+  return extmem_async_queue_request(&request);
+}
+
+EXTMEM_StatusTypeDef EXTMEM_EraseAsync(uint32_t MemId, uint32_t Address, uint32_t Size,
+                                       EXTMEM_CallbackTypeDef Callback, void *Context)
+{
+  EXTMEM_AsyncRequestTypeDef request = {
+    .Operation = EXTMEM_ASYNC_ERASE,
+    .MemId     = MemId,
+    .Address   = Address,
+    .Data      = NULL,
+    .Size      = Size,
+    .Callback  = Callback,
+    .Context   = Context
+  };
+  EXTMEM_FUNC_CALL()
+
+  return extmem_async_queue_request(&request);
+}
+#endif /* EXTMEM_ASYNC == 1 */
+/**
+  * @}
+  */
+
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+/** @defgroup EXTMEM_Private_ErasePlan External Memory erase planner
+  * @{
+  */
+
+/**
+ * @brief This function lists the erase types of the memory by increasing size
+ *
+ * @param Object memory object
+ * @param Types array of 4 elements receiving the erase types
+ * @return number of erase types
+ **/
+static uint32_t extmem_nor_sfdp_erase_types(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object, EXTMEM_EraseTypeTypeDef *Types)
+{
+  const uint8_t sizes[4] = {
+    Object->sfpd_private.DriverInfo.EraseType1Size, Object->sfpd_private.DriverInfo.EraseType2Size,
+    Object->sfpd_private.DriverInfo.EraseType3Size, Object->sfpd_private.DriverInfo.EraseType4Size };
+  const uint8_t commands[4] = {
+    Object->sfpd_private.DriverInfo.EraseType1Command, Object->sfpd_private.DriverInfo.EraseType2Command,
+    Object->sfpd_private.DriverInfo.EraseType3Command, Object->sfpd_private.DriverInfo.EraseType4Command };
+  const uint32_t times[4] = {
+    Object->sfpd_private.DriverInfo.EraseType1Timing, Object->sfpd_private.DriverInfo.EraseType2Timing,
+    Object->sfpd_private.DriverInfo.EraseType3Timing, Object->sfpd_private.DriverInfo.EraseType4Timing };
+  uint32_t count = 0u;
+  uint32_t index;
+
+  for (uint32_t type = 0u; type < 4u; type++)
+  {
+    if ((sizes[type] == 0u) || (commands[type] == 0u))
+    {
+      continue;
+    }
+
+    /* insertion by increasing size */
+    index = count;
+    while ((index != 0u) && (Types[index - 1u].Size > ((uint32_t)1u << sizes[type])))
+    {
+      Types[index] = Types[index - 1u];
+      index--;
+    }
+    Types[index].SectorType = (EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef)type;
+    Types[index].Size = (uint32_t)1u << sizes[type];
+    Types[index].Time = times[type];
+    count++;
+  }
+
+  return count;
+}
+
+/**
+ * @brief This function checks if an area of the memory is erased
+ *
+ * @param MemId memory id
+ * @param Object memory object
+ * @param Address location of the data memory
+ * @param Size size of the area, multiple of 4 * EXTMEM_BLANK_CHECK_WORDS
+ * @param Blank returns 1 if all the bytes of the area are 0xFF
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef extmem_nor_sfdp_blank(uint32_t MemId, EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object,
+                                                  uint32_t Address, uint32_t Size, uint8_t *Blank)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_OK;
+  uint32_t buffer[EXTMEM_BLANK_CHECK_WORDS];
+  const volatile uint32_t *mapped;
+  uint32_t base;
+
+  *Blank = 1u;
+
+  if ((Object->sfpd_private.SALObject.hxspi->State == HAL_XSPI_STATE_BUSY_MEM_MAPPED)
+      && (EXTMEM_GetMapAddress(MemId, &base) == EXTMEM_OK))
+  {
+    /* the cache may hold lines read before the last program of the area */
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    SCB_InvalidateDCache_by_Addr((void *)(base + Address), (int32_t)Size);
+#endif /* __DCACHE_PRESENT */
+    mapped = (const volatile uint32_t *)(base + Address);
+    for (uint32_t index = 0u; (*Blank == 1u) && (index < (Size / sizeof(uint32_t))); index++)
+    {
+      if (mapped[index] != 0xFFFFFFFFu)
+      {
+        *Blank = 0u;
+      }
+    }
+  }
+  else
+  {
+    for (uint32_t offset = 0u; (*Blank == 1u) && (retr == EXTMEM_OK) && (offset < Size); offset += sizeof(buffer))
+    {
+      if (EXTMEM_DRIVER_NOR_SFDP_OK != EXTMEM_DRIVER_NOR_SFDP_Read(Object, Address + offset, (uint8_t *)buffer, sizeof(buffer)))
+      {
+        retr = EXTMEM_ERROR_DRIVER;
+        break;
+      }
+
+      for (uint32_t index = 0u; (*Blank == 1u) && (index < EXTMEM_BLANK_CHECK_WORDS); index++)
+      {
+        if (buffer[index] != 0xFFFFFFFFu)
+        {
+          *Blank = 0u;
+        }
+      }
+    }
+  }
+
+  return retr;
+}
+
+/**
+ * @brief This function plans the erase of an aligned sector of a given erase type: the sector
+ *        is either erased at once or split in the best plan of its sub-sectors
+ *
+ * @param MemId memory id
+ * @param Object memory object
+ * @param Types erase types by increasing size
+ * @param Level index in Types of the sector
+ * @param Address sector address, aligned on its size
+ * @param Plan plan receiving the steps
+ * @param Time returns the erase time of the steps added
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef extmem_nor_sfdp_plan_block(uint32_t MemId, EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *Object,
+                                                       const EXTMEM_EraseTypeTypeDef *Types, uint32_t Level,
+                                                       uint32_t Address, EXTMEM_ErasePlanTypeDef *Plan, uint32_t *Time)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_OK;
+  uint32_t first_step = Plan->StepCount;
+  uint32_t first_blank = Plan->BlankSize;
+  uint32_t sub_time;
+  uint8_t blank;
+
+  *Time = 0u;
+
+  if (Level == 0u)
+  {
+    retr = extmem_nor_sfdp_blank(MemId, Object, Address, Types[0].Size, &blank);
+    if ((retr == EXTMEM_OK) && (blank == 1u))
+    {
+      Plan->BlankSize += Types[0].Size;
+    }
+    else if (retr == EXTMEM_OK)
+    {
+      extmem_plan_add(Plan, Address, &Types[0]);
+      *Time = Types[0].Time;
+    }
+    else
+    {
+      /* nothing to do, the error is returned */
+    }
+    return retr;
+  }
+
+  for (uint32_t sub = Address; (retr == EXTMEM_OK) && (sub < (Address + Types[Level].Size)); sub += Types[Level - 1u].Size)
+  {
+    retr = extmem_nor_sfdp_plan_block(MemId, Object, Types, Level - 1u, sub, Plan, &sub_time);
+    *Time += sub_time;
+  }
+
+  /* one erase of the whole sector is faster than its sub-sectors plan */
+  if ((retr == EXTMEM_OK) && (*Time > Types[Level].Time))
+  {
+    Plan->StepCount = first_step;
+    Plan->BlankSize = first_blank;
+    extmem_plan_add(Plan, Address, &Types[Level]);
+    *Time = Types[Level].Time;
+  }
+
+  return retr;
+}
+
+/**
+ * @brief This function appends a sector erase to a plan, the step is only stored when the
+ *        array has room but always counted
+ *
+ * @param Plan erase plan
+ * @param Address sector address
+ * @param Type erase type of the sector
+ **/
+static void extmem_plan_add(EXTMEM_ErasePlanTypeDef *Plan, uint32_t Address, const EXTMEM_EraseTypeTypeDef *Type)
+{
+  if (Plan->StepCount < Plan->MaxSteps)
+  {
+    Plan->Steps[Plan->StepCount].Address = Address;
+    Plan->Steps[Plan->StepCount].Size = Type->Size;
+    Plan->Steps[Plan->StepCount].Time = Type->Time;
+    Plan->Steps[Plan->StepCount].Type = (uint8_t)((uint8_t)Type->SectorType + 1u);
+  }
+  Plan->StepCount++;
+}
+
+/**
+  * @}
+  */
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+
+#if EXTMEM_ASYNC == 1
+/** @addtogroup EXTMEM_Private_Async
+  * @{
+  */
+
+/**
+ * @brief This function checks a request and adds it at the end of the queue
+ *
+ * @param Request operation to queue
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef extmem_async_queue_request(const EXTMEM_AsyncRequestTypeDef *Request)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_ERROR_INVALID_ID;
+  uint32_t primask_bit;
+
+  /* control the memory ID */
+  if (Request->MemId < (sizeof(extmem_list_config) / sizeof(EXTMEM_DefinitionTypeDef)))
+  {
+    retr = EXTMEM_OK;
+    switch (extmem_list_config[Request->MemId].MemType)
+    {
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+      case EXTMEM_NOR_SFDP:{
+        break;
+      }
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+      case EXTMEM_SDCARD :
+      case EXTMEM_PSRAM :
+      case EXTMEM_USER :
+        retr = EXTMEM_ERROR_NOTSUPPORTED;
+        break;
+      default:{
+        EXTMEM_DEBUG("\terror unknown type\n");
+        retr = EXTMEM_ERROR_UNKNOWNMEMORY;
+        break;
+      }
+    }
+  }
+
+  if ((retr == EXTMEM_OK) && ((Request->Size == 0u) || (Request->Callback == NULL)))
+  {
+    retr = EXTMEM_ERROR_PARAM;
+  }
+
+  if (retr == EXTMEM_OK)
+  {
+    primask_bit = __get_PRIMASK();
+    __disable_irq();
+    if (extmem_async_count < EXTMEM_ASYNC_QUEUE_SIZE)
+    {
+      extmem_async_queue[(extmem_async_head + extmem_async_count) % EXTMEM_ASYNC_QUEUE_SIZE] = *Request;
+      extmem_async_count++;
+    }
+    else
+    {
+      retr = EXTMEM_ERROR_BUSY;
+    }
+    __set_PRIMASK(primask_bit);
+  }
+
+  /* start the request if the memory is idle */
+  if ((retr == EXTMEM_OK) && (extmem_async_claim() == 1u))
+  {
+    extmem_async_launch();
+  }
+
+  return retr;
+}
+
+/**
+ * @brief This function starts a request, or the next sector of an erase, on the driver
+ *
+ * @param Request operation to start
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef extmem_async_start(EXTMEM_AsyncRequestTypeDef *Request)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_OK;
+#if EXTMEM_DRIVER_NOR_SFDP == 1
+  EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object = &extmem_list_config[Request->MemId].NorSfdpObject;
+  EXTMEM_DRIVER_NOR_SFDP_SectorTypeTypeDef sector_type = EXTMEM_DRIVER_NOR_SFDP_SECTOR_TYPE1;
+  EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status;
+
+  switch (Request->Operation)
+  {
+    case EXTMEM_ASYNC_READ:
+      status = EXTMEM_DRIVER_NOR_SFDP_ReadAsync(object, Request->Address, Request->Data, Request->Size,
+                                                extmem_async_done, Request);
+      break;
+    case EXTMEM_ASYNC_WRITE:
+      status = EXTMEM_DRIVER_NOR_SFDP_WriteAsync(object, Request->Address, Request->Data, Request->Size,
+                                                 extmem_async_done, Request);
+      break;
+    default:
+      retr = extmem_nor_sfdp_sector(object, Request->Address, Request->Size, &sector_type, &Request->SectorSize);
+      status = EXTMEM_DRIVER_NOR_SFDP_OK;
+      if (retr == EXTMEM_OK)
+      {
+        status = EXTMEM_DRIVER_NOR_SFDP_SectorEraseAsync(object, Request->Address, sector_type,
+                                                         extmem_async_done, Request);
+      }
+      break;
+  }
+
+  if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+  {
+    retr = EXTMEM_ERROR_DRIVER;
+  }
+#else
+  (void)Request;
+  retr = EXTMEM_ERROR_NOTSUPPORTED;
+#endif /* EXTMEM_DRIVER_NOR_SFDP == 1 */
+  return retr;
+}
+
+/**
+ * @brief This function marks the head of the queue as running if nothing runs
+ *
+ * @return 1 if the caller must start the head of the queue, 0 otherwise
+ **/
+static uint32_t extmem_async_claim(void)
+{
+  uint32_t retr = 0u;
+  uint32_t primask_bit = __get_PRIMASK();
+
+  __disable_irq();
+  if ((extmem_async_running == 0u) && (extmem_async_count != 0u))
+  {
+    extmem_async_running = 1u;
+    retr = 1u;
+  }
+  __set_PRIMASK(primask_bit);
+
+  return retr;
+}
+
+/**
+ * @brief This function removes the running request from the queue
+ *
+ * @return copy of the removed request
+ **/
+static EXTMEM_AsyncRequestTypeDef extmem_async_release(void)
+{
+  EXTMEM_AsyncRequestTypeDef request;
+  uint32_t primask_bit = __get_PRIMASK();
+
+  __disable_irq();
+  request = extmem_async_queue[extmem_async_head];
+  extmem_async_head = (extmem_async_head + 1u) % EXTMEM_ASYNC_QUEUE_SIZE;
+  extmem_async_count--;
+  extmem_async_running = 0u;
+  __set_PRIMASK(primask_bit);
+
+  return request;
+}
+
+/**
+ * @brief This function starts the claimed head of the queue, requests which cannot
+ *        be started are completed with their error
+ **/
+static void extmem_async_launch(void)
+{
+  EXTMEM_AsyncRequestTypeDef request;
+  EXTMEM_StatusTypeDef retr;
+
+  do
+  {
+    retr = extmem_async_start(&extmem_async_queue[extmem_async_head]);
+    if (retr == EXTMEM_OK)
+    {
+      break;
+    }
+    request = extmem_async_release();
+    request.Callback(request.MemId, retr, request.Context);
+  } while (extmem_async_claim() == 1u);
+}
+
+/**
+ * @brief This function is called by the driver under interrupt at the end of an operation
+ *
+ * @param Context running request
+ * @param Status driver status
+ **/
+static void extmem_async_done(void *Context, int32_t Status)
+{
+  EXTMEM_AsyncRequestTypeDef *running = (EXTMEM_AsyncRequestTypeDef *)Context;
+  EXTMEM_AsyncRequestTypeDef request;
+  EXTMEM_StatusTypeDef retr = (Status == 0) ? EXTMEM_OK : EXTMEM_ERROR_DRIVER;
+
+  if ((retr == EXTMEM_OK) && (running->Operation == EXTMEM_ASYNC_ERASE))
+  {
+    /* continue with the next sector */
+    running->Address = running->Address + running->SectorSize;
+    running->Size = (running->SectorSize > running->Size) ? 0u : (running->Size - running->SectorSize);
+    if (running->Size != 0u)
+    {
+      retr = extmem_async_start(running);
+      if (retr == EXTMEM_OK)
+      {
+        return;
+      }
+    }
+  }
+
+  request = extmem_async_release();
+  request.Callback(request.MemId, retr, request.Context);
+
+  if (extmem_async_claim() == 1u)
+  {
+    extmem_async_launch();
+  }
+}
+
 /**
   * @}
   */
+#endif /* EXTMEM_ASYNC == 1 */
 
 /**
   * @}
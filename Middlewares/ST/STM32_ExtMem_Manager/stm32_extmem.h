@@ -66,6 +66,7 @@ typedef enum
   EXTMEM_ERROR_SECTOR_SIZE  = -4, /*!< inconsistency between the size an the sector size of the memory */
   EXTMEM_ERROR_INVALID_ID   = -5, /*!< the memory ID is invalid */
   EXTMEM_ERROR_PARAM        = -6, /*!< parameter value error */
+  EXTMEM_ERROR_BUSY         = -7, /*!< the queue of asynchronous operations is full */
 } EXTMEM_StatusTypeDef;
 
 /**
@@ -113,6 +114,33 @@ typedef struct {
   uint32_t CardSpeed;       /*!< Specifies the card speed                        */
 } EXTMEM_DRIVER_SDCARD_InfoTypeDef;
 
+/**
+ * @brief Completion callback of the asynchronous operations, called under interrupt
+ */
+typedef void (*EXTMEM_CallbackTypeDef)(uint32_t MemId, EXTMEM_StatusTypeDef Status, void *Context);
+
+/**
+ * @brief One sector erase of an erase plan
+ */
+typedef struct {
+  uint32_t Address;           /*!< sector address */
+  uint32_t Size;              /*!< sector size */
+  uint32_t Time;              /*!< erase time of the sector given by the memory (SFDP), in ms */
+  uint8_t  Type;              /*!< erase type of the memory used, 1 to 4 */
+} EXTMEM_EraseStepTypeDef;
+
+/**
+ * @brief Erase plan, Steps and MaxSteps are set by the caller, the other fields by @ref EXTMEM_PlanErase
+ */
+typedef struct {
+  uint32_t MemId;                   /*!< memory id */
+  EXTMEM_EraseStepTypeDef *Steps;   /*!< array receiving the sector erases to execute */
+  uint32_t MaxSteps;                /*!< number of elements of Steps */
+  uint32_t StepCount;               /*!< number of sector erases of the plan */
+  uint32_t EraseTime;               /*!< sum of the erase times of the steps, in ms */
+  uint32_t BlankSize;               /*!< bytes of the range already erased and left as they are */
+} EXTMEM_ErasePlanTypeDef;
+
 /**
  * @brief Number of physical I/O line(s) connected with the memory
  */
@@ -208,6 +236,33 @@ EXTMEM_StatusTypeDef EXTMEM_EraseSector(uint32_t MemId, uint32_t Address, uint32
  **/
 EXTMEM_StatusTypeDef EXTMEM_EraseAll(uint32_t MemId);
 
+/**
+ * @brief This function computes the sector erases needed to erase a range. The sectors
+ *        already erased are skipped and the erase types reported by the memory are mixed
+ *        to minimize the total erase time.
+ *
+ * @param MemId memory id
+ * @param Address location of the data memory, aligned on the smallest sector
+ * @param Size data size in bytes, rounded up to the smallest sector
+ * @param Plan plan to fill, Steps and MaxSteps must be set
+ * @return @ref EXTMEM_StatusTypeDef, EXTMEM_ERROR_PARAM with the needed StepCount when
+ *         MaxSteps is too small
+ *
+ * @note the blank check reads the memory through the mapped window when the memory is
+ *       mapped, with indirect reads otherwise. Only NOR SFDP memories are supported.
+ **/
+EXTMEM_StatusTypeDef EXTMEM_PlanErase(uint32_t MemId, uint32_t Address, uint32_t Size, EXTMEM_ErasePlanTypeDef *Plan);
+
+/**
+ * @brief This function executes the sector erases of a plan
+ *
+ * @param Plan plan computed by @ref EXTMEM_PlanErase
+ * @return @ref EXTMEM_StatusTypeDef
+ *
+ * @note the memory mapped mode must be disabled
+ **/
+EXTMEM_StatusTypeDef EXTMEM_ExecuteErasePlan(const EXTMEM_ErasePlanTypeDef *Plan);
+
 /**
  * @brief This function returns information about the memory
  *
@@ -235,6 +290,50 @@ EXTMEM_StatusTypeDef EXTMEM_MemoryMappedMode(uint32_t MemId, EXTMEM_StateTypeDef
  **/
 EXTMEM_StatusTypeDef EXTMEM_GetMapAddress(uint32_t MemId, uint32_t *BaseAddress);
 
+/**
+ * @brief This function queues the read of a buffer from the memory
+ *
+ * @param MemId memory id
+ * @param Address location of the data memory
+ * @param Data data pointer, aligned on a cache line when the XSPI has a DMA channel
+ * @param Size data size in bytes
+ * @param Callback function called under interrupt once the data are available
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_StatusTypeDef
+ *
+ * @note the asynchronous functions are available when EXTMEM_ASYNC is set to 1, the callback
+ *       is called exactly once for each operation accepted with EXTMEM_OK.
+ **/
+EXTMEM_StatusTypeDef EXTMEM_ReadAsync(uint32_t MemId, uint32_t Address, uint8_t* Data, uint32_t Size,
+                                      EXTMEM_CallbackTypeDef Callback, void *Context);
+
+/**
+ * @brief This function queues the write of data to the memory
+ *
+ * @param MemId memory id
+ * @param Address location of the data memory
+ * @param Data data pointer, must stay valid until the callback
+ * @param Size data size in bytes
+ * @param Callback function called under interrupt once the data are programmed
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_WriteAsync(uint32_t MemId, uint32_t Address, const uint8_t* Data, uint32_t Size,
+                                       EXTMEM_CallbackTypeDef Callback, void *Context);
+
+/**
+ * @brief This function queues the erase of a number of sector
+ *
+ * @param MemId memory id
+ * @param Address location of the data memory
+ * @param Size data size in bytes
+ * @param Callback function called under interrupt once the last sector is erased
+ * @param Context parameter given back to the callback
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_EraseAsync(uint32_t MemId, uint32_t Address, uint32_t Size,
+                                       EXTMEM_CallbackTypeDef Callback, void *Context);
+
 /**
   * @}
   */
@@ -0,0 +1,346 @@
+/**
+  ******************************************************************************
+  * @file    stm32_extmem_wcache.c
+  * @author  MCD Application Team
+  * @brief   This file implements a write-back cache in front of EXTMEM_Write:
+  *          small or unaligned writes are gathered in a RAM buffer so that
+  *          each page of the memory is programmed once.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32_extmem.h"
+#include "stm32_extmem_wcache.h"
+#include <string.h>
+
+/** @defgroup EXTMEM_WCACHE External Memory write cache
+  * @ingroup EXTMEM
+  * @{
+  */
+
+/* Private typedefs ----------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
+/** @defgroup EXTMEM_WCACHE_Private_Defines External Memory write cache private defines
+  * @{
+  */
+
+/**
+  * @brief value of an erased byte, programming it leaves the memory unchanged
+  */
+#define WCACHE_ERASED_VALUE 0xFFu
+
+/**
+  * @}
+  */
+
+/* Private macros ------------------------------------------------------------*/
+/** @defgroup EXTMEM_WCACHE_Private_Macros External Memory write cache private macros
+  * @{
+  */
+
+#define WCACHE_IS_ERASED(_CACHE_, _INDEX_)  \
+  (((_CACHE_)->Init.EraseMap[(_INDEX_) / 32u] & (1uL << ((_INDEX_) % 32u))) != 0u)
+
+#define WCACHE_SET_ERASED(_CACHE_, _INDEX_) \
+  (_CACHE_)->Init.EraseMap[(_INDEX_) / 32u] |= (1uL << ((_INDEX_) % 32u))
+
+/**
+  * @}
+  */
+
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/** @defgroup EXTMEM_WCACHE_Private_Functions External Memory write cache private functions
+  * @{
+  */
+static EXTMEM_StatusTypeDef wcache_check_range(const EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address, uint32_t Size);
+static EXTMEM_StatusTypeDef wcache_prepare(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address, uint32_t Size);
+static EXTMEM_StatusTypeDef wcache_program(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address,
+                                           const uint8_t *Data, uint32_t Size);
+/**
+  * @}
+  */
+
+/* Exported functions --------------------------------------------------------*/
+/** @addtogroup EXTMEM_WCACHE_Exported_Functions
+  * @{
+  */
+
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Init(EXTMEM_WCACHE_HandleTypeDef *Cache, const EXTMEM_WCACHE_InitTypeDef *Init)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_ERROR_PARAM;
+
+  if ((Cache != NULL) && (Init != NULL) && (Init->Buffer != NULL) && (Init->EraseMap != NULL)
+      && (Init->PageSize != 0u) && (Init->BufferSize != 0u) && ((Init->BufferSize % Init->PageSize) == 0u)
+      && (Init->EraseSize != 0u) && ((Init->EraseSize % Init->PageSize) == 0u)
+      && ((Init->RegionAddress % Init->EraseSize) == 0u) && ((Init->RegionSize % Init->EraseSize) == 0u))
+  {
+    Cache->Init = *Init;
+    retr = EXTMEM_WCACHE_Reset(Cache);
+  }
+
+  return retr;
+}
+
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Write(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address,
+                                         const uint8_t *Data, uint32_t Size)
+{
+  EXTMEM_StatusTypeDef retr;
+  uint32_t offset;
+  uint32_t length;
+
+  retr = wcache_check_range(Cache, Address, Size);
+
+  while ((retr == EXTMEM_OK) && (Size != 0u))
+  {
+    /* whole pages covering at least the buffer are programmed without copy */
+    if ((Cache->DirtyEnd == 0u) && ((Address % Cache->Init.PageSize) == 0u) && (Size >= Cache->Init.BufferSize))
+    {
+      length = Size - (Size % Cache->Init.PageSize);
+      retr = wcache_program(Cache, Address, Data, length);
+      Cache->WindowValid = 0u;
+      Address += length;
+      Data += length;
+      Size -= length;
+      continue;
+    }
+
+    /* move the window on the page of the data, the pending data are programmed first */
+    if ((Cache->WindowValid == 0u) || (Address < Cache->WindowAddress)
+        || ((Address - Cache->WindowAddress) >= Cache->Init.BufferSize))
+    {
+      retr = EXTMEM_WCACHE_Sync(Cache);
+      if (retr != EXTMEM_OK)
+      {
+        break;
+      }
+      Cache->WindowAddress = Address - (Address % Cache->Init.PageSize);
+      Cache->WindowValid = 1u;
+    }
+
+    offset = Address - Cache->WindowAddress;
+    length = Cache->Init.BufferSize - offset;
+    if (length > Size)
+    {
+      length = Size;
+    }
+
+    memcpy(&Cache->Init.Buffer[offset], Data, length);
+    if ((Cache->DirtyEnd == 0u) || (offset < Cache->DirtyStart))
+    {
+      Cache->DirtyStart = offset;
+    }
+    if ((offset + length) > Cache->DirtyEnd)
+    {
+      Cache->DirtyEnd = offset + length;
+    }
+
+    Address += length;
+    Data += length;
+    Size -= length;
+
+    /* the buffer is full up to its last page */
+    if (Cache->DirtyEnd == Cache->Init.BufferSize)
+    {
+      retr = EXTMEM_WCACHE_Sync(Cache);
+    }
+  }
+
+  return retr;
+}
+
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Sync(EXTMEM_WCACHE_HandleTypeDef *Cache)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_OK;
+  uint32_t start;
+  uint32_t end;
+  uint32_t limit;
+
+  if (Cache->DirtyEnd == 0u)
+  {
+    return EXTMEM_OK;
+  }
+
+  /* program whole pages, the bytes not written are still erased in the buffer */
+  start = Cache->DirtyStart - (Cache->DirtyStart % Cache->Init.PageSize);
+  end = Cache->DirtyEnd + Cache->Init.PageSize - 1u;
+  end = end - (end % Cache->Init.PageSize);
+  limit = Cache->Init.RegionAddress + Cache->Init.RegionSize - Cache->WindowAddress;
+  if (end > limit)
+  {
+    end = limit;
+  }
+
+  retr = wcache_program(Cache, Cache->WindowAddress + start, &Cache->Init.Buffer[start], end - start);
+
+  /* on error the data are kept, a new sync programs them again */
+  if (retr == EXTMEM_OK)
+  {
+    memset(&Cache->Init.Buffer[start], WCACHE_ERASED_VALUE, end - start);
+    Cache->DirtyStart = 0u;
+    Cache->DirtyEnd = 0u;
+  }
+
+  return retr;
+}
+
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_MarkErased(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address, uint32_t Size)
+{
+  EXTMEM_StatusTypeDef retr;
+  uint32_t index;
+
+  retr = wcache_check_range(Cache, Address, Size);
+  if ((retr == EXTMEM_OK)
+      && (((Address % Cache->Init.EraseSize) != 0u) || ((Size % Cache->Init.EraseSize) != 0u)))
+  {
+    retr = EXTMEM_ERROR_SECTOR_SIZE;
+  }
+
+  if (retr == EXTMEM_OK)
+  {
+    for (index = (Address - Cache->Init.RegionAddress) / Cache->Init.EraseSize;
+         index < ((Address - Cache->Init.RegionAddress + Size) / Cache->Init.EraseSize); index++)
+    {
+      WCACHE_SET_ERASED(Cache, index);
+    }
+  }
+
+  return retr;
+}
+
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Reset(EXTMEM_WCACHE_HandleTypeDef *Cache)
+{
+  memset(Cache->Init.Buffer, WCACHE_ERASED_VALUE, Cache->Init.BufferSize);
+  memset(Cache->Init.EraseMap, 0x0,
+         EXTMEM_WCACHE_MAP_WORDS(Cache->Init.RegionSize, Cache->Init.EraseSize) * sizeof(uint32_t));
+  Cache->WindowAddress = 0u;
+  Cache->WindowValid = 0u;
+  Cache->DirtyStart = 0u;
+  Cache->DirtyEnd = 0u;
+  Cache->PageProgramCount = 0u;
+  Cache->EraseCount = 0u;
+
+  return EXTMEM_OK;
+}
+
+/**
+  * @}
+  */
+
+/** @addtogroup EXTMEM_WCACHE_Private_Functions
+  * @{
+  */
+
+/**
+ * @brief This function checks that an area is inside the region of the cache
+ *
+ * @param Cache cache handle
+ * @param Address memory address
+ * @param Size size of the area
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef wcache_check_range(const EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address, uint32_t Size)
+{
+  if ((Address < Cache->Init.RegionAddress)
+      || ((Address - Cache->Init.RegionAddress) > Cache->Init.RegionSize)
+      || (Size > (Cache->Init.RegionSize - (Address - Cache->Init.RegionAddress))))
+  {
+    return EXTMEM_ERROR_PARAM;
+  }
+  return EXTMEM_OK;
+}
+
+/**
+ * @brief This function erases the sectors of an area which are not yet erased
+ *
+ * @param Cache cache handle
+ * @param Address memory address
+ * @param Size size of the area
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef wcache_prepare(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address, uint32_t Size)
+{
+  EXTMEM_StatusTypeDef retr = EXTMEM_OK;
+  uint32_t index = (Address - Cache->Init.RegionAddress) / Cache->Init.EraseSize;
+  uint32_t last = (Address - Cache->Init.RegionAddress + Size - 1u) / Cache->Init.EraseSize;
+  uint32_t sector;
+
+  for (; (retr == EXTMEM_OK) && (index <= last); index++)
+  {
+    if (WCACHE_IS_ERASED(Cache, index))
+    {
+      continue;
+    }
+
+    sector = Cache->Init.RegionAddress + (index * Cache->Init.EraseSize);
+    if (Cache->Init.Erase != NULL)
+    {
+      retr = Cache->Init.Erase(Cache->Init.Context, sector, Cache->Init.EraseSize);
+    }
+    else
+    {
+      retr = EXTMEM_EraseSector(Cache->Init.MemId, sector, Cache->Init.EraseSize);
+    }
+
+    if (retr == EXTMEM_OK)
+    {
+      WCACHE_SET_ERASED(Cache, index);
+      Cache->EraseCount++;
+    }
+  }
+
+  return retr;
+}
+
+/**
+ * @brief This function erases the area if needed and programs it
+ *
+ * @param Cache cache handle
+ * @param Address memory address, page aligned
+ * @param Data data pointer
+ * @param Size size of the data
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+static EXTMEM_StatusTypeDef wcache_program(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address,
+                                           const uint8_t *Data, uint32_t Size)
+{
+  EXTMEM_StatusTypeDef retr;
+
+  retr = wcache_prepare(Cache, Address, Size);
+  if (retr == EXTMEM_OK)
+  {
+    if (Cache->Init.Program != NULL)
+    {
+      retr = Cache->Init.Program(Cache->Init.Context, Address, Data, Size);
+    }
+    else
+    {
+      retr = EXTMEM_Write(Cache->Init.MemId, Address, Data, Size);
+    }
+  }
+
+  if (retr == EXTMEM_OK)
+  {
+    Cache->PageProgramCount += (Size + Cache->Init.PageSize - 1u) / Cache->Init.PageSize;
+  }
+
+  return retr;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,169 @@
+/**
+  ******************************************************************************
+  * @file    stm32_extmem_wcache.h
+  * @author  MCD Application Team
+  * @brief   This file contains the external memory write cache functions
+  *          prototypes.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32_EXTMEM_WCACHE_H_
+#define __STM32_EXTMEM_WCACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32_extmem.h"
+
+/** @addtogroup EXTMEM_WCACHE
+  * @{
+  */
+
+/* Exported types ------------------------------------------------------------*/
+/** @defgroup EXTMEM_WCACHE_Exported_Types External Memory write cache exported types
+  * @{
+  */
+
+/**
+  * @brief program function used by the cache, EXTMEM_Write is used when none is given
+  */
+typedef EXTMEM_StatusTypeDef (*EXTMEM_WCACHE_ProgramTypeDef)(void *Context, uint32_t Address,
+                                                              const uint8_t *Data, uint32_t Size);
+
+/**
+  * @brief erase function used by the cache, EXTMEM_EraseSector is used when none is given
+  */
+typedef EXTMEM_StatusTypeDef (*EXTMEM_WCACHE_EraseTypeDef)(void *Context, uint32_t Address, uint32_t Size);
+
+/**
+  * @brief write cache configuration
+  */
+typedef struct
+{
+  uint32_t MemId;                        /*!< memory id used by the default program and erase functions */
+  uint32_t RegionAddress;                /*!< start of the region owned by the cache, aligned on EraseSize */
+  uint32_t RegionSize;                   /*!< size of the region owned by the cache, multiple of EraseSize */
+  uint32_t PageSize;                     /*!< program page size of the memory */
+  uint32_t EraseSize;                    /*!< erase granularity, multiple of PageSize */
+  uint8_t *Buffer;                       /*!< RAM buffer holding the pending data */
+  uint32_t BufferSize;                   /*!< buffer size, multiple of PageSize */
+  uint32_t *EraseMap;                    /*!< one bit per erase sector of the region, see EXTMEM_WCACHE_MAP_WORDS */
+  EXTMEM_WCACHE_ProgramTypeDef Program;  /*!< program function, NULL for EXTMEM_Write */
+  EXTMEM_WCACHE_EraseTypeDef Erase;      /*!< erase function, NULL for EXTMEM_EraseSector */
+  void *Context;                         /*!< parameter given to Program and Erase */
+} EXTMEM_WCACHE_InitTypeDef;
+
+/**
+  * @brief write cache handle
+  */
+typedef struct
+{
+  EXTMEM_WCACHE_InitTypeDef Init;        /*!< configuration */
+  uint32_t WindowAddress;                /*!< memory address of the first buffer byte, page aligned */
+  uint8_t  WindowValid;                  /*!< 1 once WindowAddress has been set */
+  uint32_t DirtyStart;                   /*!< buffer offset of the first pending byte */
+  uint32_t DirtyEnd;                     /*!< buffer offset after the last pending byte, 0 if nothing is pending */
+  uint32_t PageProgramCount;             /*!< number of page programs issued */
+  uint32_t EraseCount;                   /*!< number of sector erases issued */
+} EXTMEM_WCACHE_HandleTypeDef;
+
+/**
+  * @}
+  */
+
+/* Exported macros -----------------------------------------------------------*/
+/** @defgroup EXTMEM_WCACHE_Exported_Macros External Memory write cache exported macros
+  * @{
+  */
+
+/**
+  * @brief number of 32-bit words of the erase map for a region
+  */
+#define EXTMEM_WCACHE_MAP_WORDS(_REGION_SIZE_, _ERASE_SIZE_) ((((_REGION_SIZE_) / (_ERASE_SIZE_)) + 31u) / 32u)
+
+/**
+  * @}
+  */
+
+/* Exported functions --------------------------------------------------------*/
+/** @defgroup EXTMEM_WCACHE_Exported_Functions External Memory write cache exported functions
+  * @{
+  */
+
+/**
+ * @brief This function initializes a write cache, the whole region is considered
+ *        as not erased
+ *
+ * @param Cache cache handle
+ * @param Init cache configuration, the buffer and the erase map must stay allocated
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Init(EXTMEM_WCACHE_HandleTypeDef *Cache, const EXTMEM_WCACHE_InitTypeDef *Init);
+
+/**
+ * @brief This function writes data through the cache. The data are copied in the buffer
+ *        and programmed once the buffer is full, when a write falls outside the buffer
+ *        or on @ref EXTMEM_WCACHE_Sync. The sectors are erased before their first program.
+ *
+ * @param Cache cache handle
+ * @param Address memory address, inside the region of the cache
+ * @param Data data pointer
+ * @param Size size of the data
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Write(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address,
+                                         const uint8_t *Data, uint32_t Size);
+
+/**
+ * @brief This function programs the pending data
+ *
+ * @param Cache cache handle
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Sync(EXTMEM_WCACHE_HandleTypeDef *Cache);
+
+/**
+ * @brief This function records sectors erased outside of the cache
+ *
+ * @param Cache cache handle
+ * @param Address memory address, aligned on the erase size
+ * @param Size size of the erased area, multiple of the erase size
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_MarkErased(EXTMEM_WCACHE_HandleTypeDef *Cache, uint32_t Address, uint32_t Size);
+
+/**
+ * @brief This function drops the pending data and the erase state, the statistics
+ *        are cleared
+ *
+ * @param Cache cache handle
+ * @return @ref EXTMEM_StatusTypeDef
+ **/
+EXTMEM_StatusTypeDef EXTMEM_WCACHE_Reset(EXTMEM_WCACHE_HandleTypeDef *Cache);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32_EXTMEM_WCACHE_H_ */
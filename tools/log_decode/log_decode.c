@@ -0,0 +1,470 @@
+/**
+ ******************************************************************************
+ * @file    log_decode.c
+ * @brief   Rebuild the text of a UART4 capture with tokenized log frames
+ *
+ * Usage:
+ *   log_decode [-o text_file] elf_file capture_file
+ *
+ * The capture is the raw UART4 log of an image built with LOG_TOKENIZED 1
+ * (or of modem_sim built with LOG_TOKENIZED=1 and run with -T). Each LOG_xxx
+ * call sent a frame (log.h): the offset of its format in the log_fmt section
+ * of the ELF and the raw arguments. The frames are replaced by their text,
+ * formatted here with the format from the ELF; the bytes between the frames
+ * (Log_Write, printf) are copied unchanged and the trace dumps of trace.h
+ * are left out. The ELF is the one of the image that made the capture:
+ * 32-bit (Cortex-M7) or 64-bit (host build of the sims).
+ *
+ * Checks: at least one frame is decoded, and no frame has a bad sum or
+ * arguments that do not match its format (wrong ELF), or the exit code is 1.
+ ******************************************************************************
+ */
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          DEFINITIONS                                       */
+/*============================================================================*/
+
+/* Frame of a LOG_xxx call (must match log.h!) */
+#define LOG_FRAME_SYNC          0x1EU
+#define LOG_FRAME_HEADER        4U
+
+#define DECODE_SECTION          "log_fmt"
+#define DECODE_SPEC_MAX         32U
+#define DECODE_TEXT_MAX         1024U
+
+typedef struct {
+    uint32_t frames;            /* frames decoded */
+    uint32_t badSum;            /* sync byte followed by a bad sum or offset: sent as text */
+    uint32_t badArgs;           /* payload that does not match the format */
+    uint64_t frameBytes;        /* bytes of the frames on the line */
+    uint64_t frameText;         /* bytes of text they stand for */
+    uint64_t textBytes;         /* bytes copied as they are */
+    uint32_t dumps;             /* trace dumps left out */
+} Decode_Stats_t;
+
+static const uint8_t *formats;  /* log_fmt section */
+static size_t formatsSize;
+static Decode_Stats_t stats;
+static FILE *out;
+
+/*============================================================================*/
+/*                          FILES AND ELF                                     */
+/*============================================================================*/
+
+static uint8_t *Decode_Load(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    (void)fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    (void)fseek(f, 0, SEEK_SET);
+    data = malloc(*size + 1U);
+    if ((data == NULL) || (fread(data, 1U, *size, f) != *size))
+    {
+        fprintf(stderr, "log_decode: cannot read %s\n", path);
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static uint64_t Decode_Read(const uint8_t *p, uint32_t size)
+{
+    uint64_t value = 0;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        value |= (uint64_t)p[i] << (8U * i);
+    }
+    return value;
+}
+
+/**
+ * @brief  Find the log_fmt section of a little-endian ELF, 32 or 64-bit
+ * @retval 0 if found
+ */
+static int Decode_FindFormats(const uint8_t *elf, size_t size)
+{
+    uint32_t is64;
+    uint64_t shoff;
+    uint32_t shentsize;
+    uint32_t shnum;
+    uint32_t shstrndx;
+    const uint8_t *names;
+    uint64_t namesSize;
+
+    if ((size < 64U) || (memcmp(elf, "\177ELF", 4) != 0) || (elf[5] != 1U))
+    {
+        fprintf(stderr, "log_decode: not a little-endian ELF\n");
+        return -1;
+    }
+    is64 = (elf[4] == 2U);
+    shoff = is64 ? Decode_Read(&elf[0x28], 8U) : Decode_Read(&elf[0x20], 4U);
+    shentsize = (uint32_t)Decode_Read(&elf[is64 ? 0x3AU : 0x2EU], 2U);
+    shnum = (uint32_t)Decode_Read(&elf[is64 ? 0x3CU : 0x30U], 2U);
+    shstrndx = (uint32_t)Decode_Read(&elf[is64 ? 0x3EU : 0x32U], 2U);
+    if ((shstrndx >= shnum) || ((shoff + ((uint64_t)shnum * shentsize)) > size))
+    {
+        fprintf(stderr, "log_decode: bad section table\n");
+        return -1;
+    }
+
+#define SECTION(i)      (&elf[shoff + ((uint64_t)(i) * shentsize)])
+#define SH_NAME(s)      ((uint32_t)Decode_Read(&(s)[0x00], 4U))
+#define SH_OFFSET(s)    (is64 ? Decode_Read(&(s)[0x18], 8U) : Decode_Read(&(s)[0x10], 4U))
+#define SH_SIZE(s)      (is64 ? Decode_Read(&(s)[0x20], 8U) : Decode_Read(&(s)[0x14], 4U))
+
+    names = &elf[SH_OFFSET(SECTION(shstrndx))];
+    namesSize = SH_SIZE(SECTION(shstrndx));
+    for (uint32_t i = 0; i < shnum; i++)
+    {
+        const uint8_t *section = SECTION(i);
+
+        if ((SH_NAME(section) < namesSize) && (strcmp((const char *)&names[SH_NAME(section)], DECODE_SECTION) == 0))
+        {
+            if ((SH_OFFSET(section) + SH_SIZE(section)) > size)
+            {
+                break;
+            }
+            formats = &elf[SH_OFFSET(section)];
+            formatsSize = (size_t)SH_SIZE(section);
+            return 0;
+        }
+    }
+    fprintf(stderr, "log_decode: no %s section (image built without LOG_TOKENIZED?)\n", DECODE_SECTION);
+    return -1;
+}
+
+/*============================================================================*/
+/*                          FRAMES                                            */
+/*============================================================================*/
+
+/**
+ * @brief  Format the payload of a frame as printf would have
+ * @retval 0 if the payload holds the arguments of the format, no more, no
+ *         less: an argument missing at the end (frame full) prints as "?"
+ */
+static int Decode_Format(const char *format, const uint8_t *payload, uint32_t len, char *text, size_t textSize)
+{
+    uint32_t pos = 0;
+    size_t used = 0;
+    int missing = 0;
+
+#define EMIT(...)                                                               \
+    do {                                                                        \
+        int n = snprintf(&text[used], textSize - used, __VA_ARGS__);            \
+        used += ((n > 0) && ((size_t)n < (textSize - used))) ? (size_t)n : 0U;  \
+    } while (0)
+
+    while (*format != '\0')
+    {
+        char spec[DECODE_SPEC_MAX];
+        size_t s = 0;
+        uint32_t longs = 0;
+        char conv;
+
+        if (*format != '%')
+        {
+            EMIT("%c", *format++);
+            continue;
+        }
+        if (format[1] == '%')
+        {
+            EMIT("%%");
+            format += 2;
+            continue;
+        }
+
+        /* Flags, width and precision are kept, the length is read here */
+        spec[s++] = *format++;
+        while ((*format != '\0') && (strchr("-+ #0123456789.*", *format) != NULL) && (s < (DECODE_SPEC_MAX - 4U)))
+        {
+            if (*format == '*')
+            {
+                /* width or precision argument: an int */
+                int value = (pos + 4U <= len) ? (int)(int32_t)Decode_Read(&payload[pos], 4U) : 0;
+
+                pos += 4U;
+                s += (size_t)snprintf(&spec[s], DECODE_SPEC_MAX - s, "%d", value);
+                format++;
+                continue;
+            }
+            spec[s++] = *format++;
+        }
+        while ((*format != '\0') && (strchr("hlLqjzt", *format) != NULL))
+        {
+            longs += ((*format == 'l') || (*format == 'L') || (*format == 'q') || (*format == 'j')) ? 1U : 0U;
+            format++;
+        }
+        conv = *format;
+        if (conv == '\0')
+        {
+            break;
+        }
+        format++;
+
+        if (conv == 's')
+        {
+            char str[256];
+            uint32_t slen;
+
+            if (pos >= len)
+            {
+                EMIT("?");
+                missing = 1;
+                continue;
+            }
+            slen = payload[pos++];
+            if ((pos + slen) > len)
+            {
+                return -1;
+            }
+            memcpy(str, &payload[pos], slen);
+            str[slen] = '\0';
+            pos += slen;
+            spec[s++] = 's';
+            spec[s] = '\0';
+            EMIT(spec, str);
+            continue;
+        }
+
+        if (strchr("fFeEgGaA", conv) != NULL)
+        {
+            double d;
+            uint64_t raw;
+
+            if ((pos + 8U) > len)
+            {
+                EMIT("?");
+                missing = 1;
+                pos = len;
+                continue;
+            }
+            raw = Decode_Read(&payload[pos], 8U);
+            memcpy(&d, &raw, sizeof(d));
+            pos += 8U;
+            spec[s++] = conv;
+            spec[s] = '\0';
+            EMIT(spec, d);
+            continue;
+        }
+
+        if (strchr("diouxXcp", conv) == NULL)
+        {
+            return -1;      /* %n or not a conversion */
+        }
+        {
+            /* 4 bytes, 8 for long long: long is 32 bits on the Cortex-M7 */
+            uint32_t size = (longs >= 2U) ? 8U : 4U;
+            uint64_t value;
+
+            if ((pos + size) > len)
+            {
+                EMIT("?");
+                missing = 1;
+                pos = len;
+                continue;
+            }
+            value = Decode_Read(&payload[pos], size);
+            pos += size;
+
+            if (conv == 'p')
+            {
+                EMIT("0x%lx", (unsigned long)value);
+                continue;
+            }
+            if (conv == 'c')
+            {
+                spec[s++] = 'c';
+                spec[s] = '\0';
+                EMIT(spec, (int)value);
+                continue;
+            }
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = conv;
+            spec[s] = '\0';
+            if ((conv == 'd') || (conv == 'i'))
+            {
+                long long signedValue = (size == 4U) ? (long long)(int32_t)value : (long long)value;
+                EMIT(spec, signedValue);
+            }
+            else
+            {
+                EMIT(spec, (unsigned long long)value);
+            }
+        }
+    }
+#undef EMIT
+
+    /* An argument cut short ends the payload: nothing may be left over */
+    return ((pos == len) || (missing && (pos >= len))) ? 0 : -1;
+}
+
+/**
+ * @brief  Decode the frame at p
+ * @retval Size of the frame in bytes, 0 if it is not a valid one
+ */
+static size_t Decode_Frame(const uint8_t *p, size_t avail)
+{
+    char text[DECODE_TEXT_MAX];
+    uint32_t len;
+    uint32_t offset;
+    uint8_t sum = 0;
+
+    if (avail < (LOG_FRAME_HEADER + 1U))
+    {
+        return 0;
+    }
+    len = p[1];
+    offset = (uint32_t)Decode_Read(&p[2], 2U);
+    if ((avail < (LOG_FRAME_HEADER + len + 1U)) || (offset >= formatsSize)
+        || ((offset != 0U) && (formats[offset - 1U] != '\0')))
+    {
+        return 0;
+    }
+    for (uint32_t i = 2U; i < (LOG_FRAME_HEADER + len); i++)
+    {
+        sum += p[i];
+    }
+    if (sum != p[LOG_FRAME_HEADER + len])
+    {
+        return 0;
+    }
+
+    if (Decode_Format((const char *)&formats[offset], &p[LOG_FRAME_HEADER], len, text, sizeof(text)) != 0)
+    {
+        fprintf(stderr, "frame of \"%.40s\": arguments do not match the format\n", (const char *)&formats[offset]);
+        stats.badArgs++;
+    }
+    fputs(text, out);
+    stats.frames++;
+    stats.frameBytes += LOG_FRAME_HEADER + len + 1U;
+    stats.frameText += strlen(text);
+    return LOG_FRAME_HEADER + len + 1U;
+}
+
+/**
+ * @brief  Size of the trace dump at p, to leave it out, 0 if there is none
+ */
+static size_t Decode_TraceDump(const uint8_t *p, size_t avail)
+{
+    size_t size;
+
+    if ((avail < (sizeof(Trace_DumpHeader_t) + 4U)) || (Decode_Read(p, 4U) != TRACE_DUMP_MAGIC)
+        || (p[5] != sizeof(Trace_Event_t)))
+    {
+        return 0;
+    }
+    size = sizeof(Trace_DumpHeader_t) + ((size_t)Decode_Read(&p[6], 2U) * sizeof(Trace_Event_t)) + 4U;
+    return (size <= avail) ? size : 0;
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+int main(int argc, char **argv)
+{
+    const char *outPath = NULL;
+    uint8_t *elf;
+    uint8_t *capture;
+    size_t elfSize;
+    size_t size;
+    size_t pos = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o': outPath = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-o text_file] elf_file capture_file\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != (argc - 2))
+    {
+        fprintf(stderr, "usage: %s [-o text_file] elf_file capture_file\n", argv[0]);
+        return 2;
+    }
+
+    elf = Decode_Load(argv[optind], &elfSize);
+    if ((elf == NULL) || (Decode_FindFormats(elf, elfSize) != 0))
+    {
+        return 1;
+    }
+    capture = Decode_Load(argv[optind + 1], &size);
+    if (capture == NULL)
+    {
+        return 1;
+    }
+    out = (outPath != NULL) ? fopen(outPath, "w") : stdout;
+    if (out == NULL)
+    {
+        perror(outPath);
+        return 1;
+    }
+
+    while (pos < size)
+    {
+        size_t skip;
+
+        if (capture[pos] == LOG_FRAME_SYNC)
+        {
+            skip = Decode_Frame(&capture[pos], size - pos);
+            if (skip != 0U)
+            {
+                pos += skip;
+                continue;
+            }
+            stats.badSum++;
+        }
+        else if (capture[pos] == (uint8_t)TRACE_DUMP_MAGIC)
+        {
+            skip = Decode_TraceDump(&capture[pos], size - pos);
+            if (skip != 0U)
+            {
+                stats.dumps++;
+                pos += skip;
+                continue;
+            }
+        }
+        fputc(capture[pos++], out);
+        stats.textBytes++;
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    free(capture);
+    free(elf);
+
+    fprintf(stderr, "%lu frames: %llu bytes for %llu bytes of text (%.1f%%), %llu bytes of plain text, "
+                    "%lu trace dumps left out\n",
+            (unsigned long)stats.frames, (unsigned long long)stats.frameBytes,
+            (unsigned long long)stats.frameText,
+            (stats.frameText != 0U) ? ((100.0 * (double)stats.frameBytes) / (double)stats.frameText) : 0.0,
+            (unsigned long long)stats.textBytes, (unsigned long)stats.dumps);
+    if ((stats.badSum != 0U) || (stats.badArgs != 0U))
+    {
+        fprintf(stderr, "%lu sync bytes without a valid frame, %lu frames with bad arguments\n",
+                (unsigned long)stats.badSum, (unsigned long)stats.badArgs);
+    }
+    return ((stats.frames != 0U) && (stats.badSum == 0U) && (stats.badArgs == 0U)) ? 0 : 1;
+}
@@ -0,0 +1,396 @@
+/**
+ ******************************************************************************
+ * @file    modem_sim.c
+ * @brief   OTA download of the Appli run against the SIM8262E-M2 model
+ *
+ * Usage:
+ *   modem_sim [-i image] [-n size_kb] [-l latency_ms] [-a action_ms]
+ *             [-b bandwidth_kbps] [-p packet_size] [-w write_size] [-z]
+ *             [-q poll_us] [-f fault]... [-r] [-v] [-T capture_file]
+ *
+ * modem.c and usb_host.c of the Appli are linked unmodified against
+ * sim8262_sim.c and tools/port. Time is virtual, or the host clock with -r
+ * (the delays and the polling then take their real time). The program runs what the Appli main does: Modem_Init,
+ * then OTA_TestDownload into Slot B, with OTA_Flash_Begin/Write/Finish
+ * keeping the staged file in RAM and checking its header and CRC as
+ * ota_flash.c does.
+ *
+ * Checks:
+ *  - the modem comes up and answers the AT commands of Modem_Init
+ *  - the download ends with MODEM_OK and the staged file is the served one
+ *  - the firmware never reports success with a file that differs
+ *
+ * Faults (-f, repeatable) are given as kind:N for every N-th AT+HTTPREAD
+ * or kind@N for the N-th one only, kind one of drop, error, short, corrupt,
+ * urc, delay.
+ *
+ * With -T the trace dumps of the Appli (USB enumeration and AT commands of
+ * Modem_Init, then the download and each OTA chunk) are written to
+ * capture_file, as the Appli main sends them on UART4, for
+ * tools/trace_decode. Built with LOG_TOKENIZED=1, the log frames of the
+ * firmware go to the same file, for tools/log_decode.
+ ******************************************************************************
+ */
+
+#include "modem.h"
+#include "ota_flash.h"
+#include "modem_sim.h"
+#include "hal_port.h"
+#include "trace.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          BOARD STUBS (HOST)                                */
+/*============================================================================*/
+
+#define SIM_IMAGE_SIZE_KB       256U
+#define SIM_IMAGE_VERSION       0x00010002U
+#define SIM_STAGE_MAX           (16U * 1024U * 1024U)
+
+static uint8_t  *simImage;
+static uint32_t  simImageSize;
+static uint8_t  *simStage;
+static uint32_t  simStageSize;
+static uint32_t  simStageWritten;
+static uint8_t   simStageActive;
+static uint8_t   simStageFinished;
+static int       simTrace;
+
+UART_HandleTypeDef huart4;
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler\n");
+    exit(1);
+}
+
+static uint32_t Sim_Crc32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint32_t j = 0; j < 8U; j++)
+        {
+            crc = (crc & 1U) ? ((crc >> 1) ^ 0xEDB88320U) : (crc >> 1);
+        }
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+OTA_Flash_Status_t OTA_Flash_Begin(uint32_t fileSize)
+{
+    if ((fileSize <= OTA_HEADER_SIZE) || ((fileSize - OTA_HEADER_SIZE) > OTA_SLOT_MAX_FW_SIZE) ||
+        (fileSize > SIM_STAGE_MAX))
+    {
+        return OTA_FLASH_INVALID_FW;
+    }
+
+    memset(simStage, 0xFF, fileSize);
+    simStageSize = fileSize;
+    simStageWritten = 0;
+    simStageActive = 1;
+    simStageFinished = 0;
+    return OTA_FLASH_OK;
+}
+
+OTA_Flash_Status_t OTA_Flash_Write(uint32_t fileOffset, const uint8_t *data, uint32_t len)
+{
+    if (!simStageActive)
+    {
+        return OTA_FLASH_NOT_READY;
+    }
+    if ((fileOffset + len) > simStageSize)
+    {
+        return OTA_FLASH_INVALID_FW;
+    }
+
+    memcpy(&simStage[fileOffset], data, len);
+    simStageWritten += len;
+    return OTA_FLASH_OK;
+}
+
+OTA_Flash_Status_t OTA_Flash_Finish(void)
+{
+    uint32_t magic, fwSize, expectedCRC;
+
+    if (!simStageActive)
+    {
+        return OTA_FLASH_NOT_READY;
+    }
+    simStageActive = 0;
+
+    memcpy(&magic,       &simStage[0], 4);
+    memcpy(&fwSize,      &simStage[4], 4);
+    memcpy(&expectedCRC, &simStage[8], 4);
+
+    if ((magic != OTA_MAGIC) || ((fwSize + OTA_HEADER_SIZE) != simStageSize))
+    {
+        return OTA_FLASH_INVALID_FW;
+    }
+    if (Sim_Crc32(&simStage[OTA_HEADER_SIZE], fwSize) != expectedCRC)
+    {
+        return OTA_FLASH_VERIFY_ERROR;
+    }
+
+    simStageFinished = 1;
+    return OTA_FLASH_OK;
+}
+
+void OTA_Flash_RequestBoot(void)
+{
+}
+
+/*============================================================================*/
+/*                          IMAGE                                             */
+/*============================================================================*/
+
+/**
+ * @brief  OTA file with its 16-byte header and a pseudo-random payload
+ */
+static int Sim_MakeImage(uint32_t sizeKb)
+{
+    uint32_t fwSize = sizeKb * 1024U;
+    uint32_t seed = 0x12345678U;
+    uint32_t magic = OTA_MAGIC;
+    uint32_t version = SIM_IMAGE_VERSION;
+    uint32_t crc;
+
+    simImageSize = fwSize + OTA_HEADER_SIZE;
+    simImage = malloc(simImageSize);
+    if (simImage == NULL)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < fwSize; i++)
+    {
+        seed = (seed * 1103515245U) + 12345U;
+        simImage[OTA_HEADER_SIZE + i] = (uint8_t)(seed >> 16);
+    }
+
+    crc = Sim_Crc32(&simImage[OTA_HEADER_SIZE], fwSize);
+    memcpy(&simImage[0],  &magic,   4);
+    memcpy(&simImage[4],  &fwSize,  4);
+    memcpy(&simImage[8],  &crc,     4);
+    memcpy(&simImage[12], &version, 4);
+    return 0;
+}
+
+static int Sim_LoadImage(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long size;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if ((size <= 0) || ((unsigned long)size > SIM_STAGE_MAX))
+    {
+        fprintf(stderr, "%s: bad size\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    simImageSize = (uint32_t)size;
+    simImage = malloc(simImageSize);
+    if ((simImage == NULL) || (fread(simImage, 1, simImageSize, f) != simImageSize))
+    {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+/*============================================================================*/
+/*                          RUN                                               */
+/*============================================================================*/
+
+static int Sim_Init(void)
+{
+    Modem_Status_t status;
+
+    MX_USB_HOST_Init();
+    status = Modem_Init();
+    printf("  %-40s %s\n", "Modem_Init", (status == MODEM_OK) ? "ok" : "FAILED");
+    printf("    modem ready at %lu ms\n", (unsigned long)(ModemSim_NowUs() / 1000U));
+    return (status == MODEM_OK) ? 0 : 1;
+}
+
+static int Sim_Download(uint32_t faultCount)
+{
+    ModemSim_Stats_t stats;
+    Modem_Status_t status;
+    uint64_t startUs;
+    uint64_t us;
+    int matches;
+    int failures = 0;
+
+    ModemSim_ResetStats();
+    startUs = ModemSim_NowUs();
+
+    status = OTA_TestDownload();
+
+    us = ModemSim_NowUs() - startUs;
+    ModemSim_GetStats(&stats);
+
+    matches = simStageFinished && (simStageSize == simImageSize) &&
+              (memcmp(simStage, simImage, simImageSize) == 0);
+
+    printf("  %-40s %s\n", "OTA_TestDownload", (status == MODEM_OK) ? "ok" : "FAILED");
+    printf("    %lu bytes staged of %lu, %lu AT+HTTPREAD (%lu repeated), %lu faults injected\n",
+           (unsigned long)simStageWritten, (unsigned long)simImageSize, (unsigned long)stats.httpReads,
+           (unsigned long)stats.repeatedReads, (unsigned long)stats.faults);
+    printf("    %lu commands, %lu ERROR, %lu bulk IN transfers, %lu stalled without ZLP\n",
+           (unsigned long)stats.commands, (unsigned long)stats.errors, (unsigned long)stats.transfers,
+           (unsigned long)stats.stalls);
+    printf("    %lu ms, %lu B/s, %lu bytes in, %lu bytes out\n",
+           (unsigned long)(us / 1000U), (unsigned long)((us != 0U) ? ((uint64_t)simStageWritten * 1000000U) / us : 0U),
+           (unsigned long)stats.bytesIn, (unsigned long)stats.bytesOut);
+    printf("    firmware on the host: %lu us parsing (%lu ns per KB in), %lu us polling over %lu passes\n",
+           (unsigned long)(stats.parseNs / 1000U),
+           (unsigned long)((stats.bytesIn != 0U) ? (stats.parseNs * 1024U) / stats.bytesIn : 0U),
+           (unsigned long)(stats.idleNs / 1000U), (unsigned long)stats.polls);
+
+    if ((status == MODEM_OK) && !matches)
+    {
+        printf("    staged file differs from the served one\n");
+        failures++;
+    }
+    else if (status != MODEM_OK)
+    {
+        printf("    download failed%s\n", (faultCount != 0U) ? " on an injected fault" : "");
+        failures++;
+    }
+    return failures;
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+int main(int argc, char **argv)
+{
+    ModemSim_Config_t cfg = {
+        .latencyMs  = 20U,
+        .actionMs   = 1500U,
+        .bandwidth  = 1000U * 1024U,
+        .packetSize = 512U,
+        .writeSize  = 0U,
+        .noZlp      = 0U,
+        .pollUs     = 10U,
+        .usbMs      = 8000U,
+        .readyMs    = 12000U,
+    };
+    Port_Config_t portConfig = { PORT_TIME_VIRTUAL, 0U, stdout };
+    const char *path = NULL;
+    uint32_t sizeKb = SIM_IMAGE_SIZE_KB;
+    int failures = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:n:l:a:b:p:w:zq:f:rvT:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': path = optarg; break;
+        case 'n': sizeKb = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'l': cfg.latencyMs = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'a': cfg.actionMs = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'b': cfg.bandwidth = (uint32_t)strtoul(optarg, NULL, 0) * 1024U; break;
+        case 'p': cfg.packetSize = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'w': cfg.writeSize = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'z': cfg.noZlp = 1U; break;
+        case 'q': cfg.pollUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'r': portConfig.timeMode = PORT_TIME_REAL; break;
+        case 'v': ModemSim_SetVerbose(1); break;
+        case 'T':
+            portConfig.uart = fopen(optarg, "wb");
+            portConfig.uartRaw = 1U;
+            simTrace = 1;
+            if (portConfig.uart == NULL)
+            {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'f':
+            if ((cfg.faultCount < (sizeof(cfg.faults) / sizeof(cfg.faults[0]))) &&
+                (ModemSim_ParseFault(optarg, &cfg.faults[cfg.faultCount]) == 0))
+            {
+                cfg.faultCount++;
+                break;
+            }
+            fprintf(stderr, "bad fault %s\n", optarg);
+            return 2;
+        default:
+            fprintf(stderr, "usage: %s [-i image] [-n size_kb] [-l latency_ms] [-a action_ms] [-b bandwidth_kbps]\n"
+                            "       [-p packet_size] [-w write_size] [-z] [-q poll_us] [-f kind:N|kind@N]... [-r] [-v]\n"
+                            "       [-T capture_file]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    if (((path != NULL) ? Sim_LoadImage(path) : Sim_MakeImage(sizeKb)) != 0)
+    {
+        return 1;
+    }
+    simStage = malloc(SIM_STAGE_MAX);
+    if ((simStage == NULL) || (Port_Open(&portConfig) != 0)
+        || (ModemSim_Open(&cfg, simImage, simImageSize) != 0))
+    {
+        fprintf(stderr, "bad configuration\n");
+        return 1;
+    }
+
+#if LOG_TOKENIZED == 1
+    if (simTrace)
+    {
+        /* The LOG_xxx calls of the firmware send frames, not printf */
+        Log_Init(&huart4);
+    }
+#endif
+
+    printf("%lu byte file, %lu byte HTTPREAD chunks, latency %lu ms, HTTPACTION %lu ms, %lu KB/s\n",
+           (unsigned long)simImageSize, (unsigned long)OTA_CHUNK_SIZE, (unsigned long)cfg.latencyMs,
+           (unsigned long)cfg.actionMs, (unsigned long)(cfg.bandwidth / 1024U));
+    printf("%lu byte packets, modem writes of %lu bytes (0: whole), %s, %lu fault rules\n\n",
+           (unsigned long)cfg.packetSize, (unsigned long)cfg.writeSize, cfg.noZlp ? "no ZLP" : "ZLP",
+           (unsigned long)cfg.faultCount);
+
+    Trace_Init(TRACE_IMAGE_APPLI);
+
+    printf("1. modem power-on\n");
+    failures += Sim_Init();
+    if (simTrace)
+    {
+        Trace_Dump(&huart4);
+    }
+
+    if (failures == 0)
+    {
+        printf("2. OTA download\n");
+        failures += Sim_Download(cfg.faultCount);
+    }
+
+    if (simTrace)
+    {
+        Trace_Dump(&huart4);
+        (void)fclose(portConfig.uart);
+    }
+    Port_Close();
+    printf("\n%s\n", (failures == 0) ? "all scenarios passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
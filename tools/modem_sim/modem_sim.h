@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ * @file    modem_sim.h
+ * @brief   SIM8262E-M2 model behind the USB host CDC class, host only
+ ******************************************************************************
+ */
+
+#ifndef MODEM_SIM_H
+#define MODEM_SIM_H
+
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef enum {
+    MODEM_SIM_FAULT_DROP = 0,   /* no answer at all */
+    MODEM_SIM_FAULT_ERROR,      /* ERROR instead of the data */
+    MODEM_SIM_FAULT_SHORT,      /* half of the requested length */
+    MODEM_SIM_FAULT_CORRUPT,    /* one data byte flipped */
+    MODEM_SIM_FAULT_URC,        /* unsolicited result code before the data */
+    MODEM_SIM_FAULT_DELAY,      /* answer 5 s late */
+    MODEM_SIM_FAULT_COUNT
+} ModemSim_Fault_t;
+
+typedef struct {
+    ModemSim_Fault_t kind;
+    uint32_t         index;     /* 1-based AT+HTTPREAD number */
+    uint8_t          periodic;  /* 1: every index-th read, 0: that read only */
+} ModemSim_FaultRule_t;
+
+typedef struct {
+    uint32_t latencyMs;         /* command received to first byte of the answer */
+    uint32_t actionMs;          /* AT+HTTPACTION to its +HTTPACTION URC */
+    uint32_t bandwidth;         /* modem to host bytes per second */
+    uint32_t packetSize;        /* bulk IN max packet size */
+    uint32_t writeSize;         /* largest write of the modem, 0: whole answer parts */
+    uint8_t  noZlp;             /* 1: no zero length packet after a full last packet */
+    uint32_t pollUs;            /* time of one pass of the USB host process */
+    uint32_t usbMs;             /* reset release to USB enumeration */
+    uint32_t readyMs;           /* reset release to first AT answer */
+    ModemSim_FaultRule_t faults[8];
+    uint32_t faultCount;
+} ModemSim_Config_t;
+
+typedef struct {
+    uint32_t commands;          /* command lines executed */
+    uint32_t errors;            /* ERROR answers, injected ones included */
+    uint32_t httpReads;         /* AT+HTTPREAD=<offset>,<len> */
+    uint32_t repeatedReads;     /* reads of the same offset as the previous one */
+    uint32_t faults;            /* faults injected */
+    uint32_t transfers;         /* bulk IN transfers completed */
+    uint32_t bytesIn;           /* modem to host */
+    uint32_t bytesOut;          /* host to modem */
+    uint32_t stalls;            /* transfers left open by a missing ZLP */
+    uint32_t polls;             /* passes of the USB host process */
+    uint64_t parseNs;           /* host time of the firmware after a transfer to the host */
+    uint64_t idleNs;            /* host time of the firmware after an empty pass */
+} ModemSim_Stats_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Load the file served by AT+HTTPACTION and the link parameters
+ * @param  file: HTTP body, kept by the caller
+ * @retval 0 on success
+ */
+int ModemSim_Open(const ModemSim_Config_t *config, const uint8_t *file, uint32_t size);
+
+/**
+ * @brief  Parse a fault rule: kind:N for every N-th read, kind@N for the
+ *         N-th read only, kind one of drop, error, short, corrupt, urc, delay
+ * @retval 0 on success
+ */
+int ModemSim_ParseFault(const char *spec, ModemSim_FaultRule_t *rule);
+
+/**
+ * @brief  Print the firmware printf output to stdout instead of dropping it
+ */
+void ModemSim_SetVerbose(int verbose);
+
+uint64_t ModemSim_NowUs(void);
+
+/**
+ * @brief  Counters since the last reset. The firmware host time is taken
+ *         between its calls into the model: after a call that handed data
+ *         to the host it is the cost of the ring buffer and the parsing of
+ *         modem.c, after an empty pass the cost of polling.
+ */
+void ModemSim_GetStats(ModemSim_Stats_t *stats);
+void ModemSim_ResetStats(void);
+
+#endif /* MODEM_SIM_H */
@@ -0,0 +1,26 @@
+/**
+ ******************************************************************************
+ * @file    modem_sim_port.h
+ * @brief   Forced in front of the firmware sources of the host build
+ *
+ * The firmware formats uint32_t with %lu: on the Cortex-M7 it is an unsigned
+ * long, on a 64-bit host an unsigned int. printf and sscanf of modem.c and
+ * usb_host.c go through the model, which drops the l length modifier, and
+ * printf is only shown with -v. The HAL and the Cortex-M core come from
+ * tools/port, so the trace spans read the port cycle counter.
+ ******************************************************************************
+ */
+
+#ifndef MODEM_SIM_PORT_H
+#define MODEM_SIM_PORT_H
+
+#include <stdio.h>
+#include "hal_port_cmsis.h"
+
+int ModemSim_Printf(const char *format, ...) __attribute__((format(printf, 1, 0)));
+int ModemSim_Sscanf(const char *str, const char *format, ...) __attribute__((format(scanf, 2, 0)));
+
+#define printf  ModemSim_Printf
+#define sscanf  ModemSim_Sscanf
+
+#endif /* MODEM_SIM_PORT_H */
@@ -0,0 +1,902 @@
+/**
+ ******************************************************************************
+ * @file    sim8262_sim.c
+ * @brief   SIM8262E-M2 model behind the USB host CDC class, host only
+ *
+ * Takes the place of the USB host library (usbh_core.c, usbh_cdc.c) under
+ * Appli/USB_HOST/App/usb_host.c, so the USB_CDC_* functions, their ring
+ * buffer and modem.c run unmodified. The HAL comes from tools/port: the
+ * model takes the modem GPIOs through its hook, and HAL_Delay to keep the
+ * delays out of the firmware time.
+ *
+ * The modem answers the AT commands of modem.c: basic and network queries,
+ * PDP context, and the HTTP(S) service (HTTPINIT, HTTPPARA, HTTPACTION,
+ * HTTPHEAD, HTTPREAD, HTTPTERM) serving a file given by the caller.
+ *
+ * Time is the port time, in microseconds. HAL_Delay moves it, and so does
+ * every pass of the USB host process (pollUs), the loops of modem.c that
+ * poll without a delay included; on real time both sleep instead. Each answer of the modem is queued as writes
+ * on the bulk IN endpoint, timed by the command latency and the link
+ * bandwidth. A receive armed by USBH_CDC_Receive completes, one per pass
+ * of the host process, at the end of a write (short packet or ZLP) or when
+ * its buffer is full, as the CDC class does.
+ ******************************************************************************
+ */
+
+#include "modem_sim.h"
+#include "hal_port.h"
+#include "main.h"
+#include "usbh_core.h"
+#include "usbh_cdc.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*============================================================================*/
+/*                          MODEL STATE                                       */
+/*============================================================================*/
+
+#define SIM_QUEUE_DEPTH         32U
+#define SIM_WRITE_MAX           4200U       /* answer part: 4KB of data and its framing */
+#define SIM_READ_MAX            4096U       /* largest AT+HTTPREAD length served */
+#define SIM_LINE_MAX            600U
+#define SIM_TX_MAX              2048U
+#define SIM_ENUM_US             100000U     /* connection to class active */
+#define SIM_FAULT_DELAY_US      5000000U
+#define SIM_IMEI                "860000000000001"
+
+typedef struct {
+    uint64_t startUs;           /* first byte on the bus */
+    uint64_t readyUs;           /* last byte on the bus */
+    uint32_t len;
+    uint32_t pos;               /* bytes already given to the host */
+    uint8_t  stallCounted;
+    uint8_t  data[SIM_WRITE_MAX];
+} SimWrite_t;
+
+static ModemSim_Config_t simCfg;
+static ModemSim_Stats_t  simStats;
+static const uint8_t    *simFile;
+static uint32_t          simFileSize;
+static int               simVerbose;
+
+/* Host time of the firmware between two calls into the model, split by
+ * what the model did in the call before: data given to the host or not */
+static uint32_t simModelDepth;
+static uint64_t simLeaveNs;
+static uint8_t  simHandedData;
+
+/* Power, reset and USB connection */
+static uint8_t  simPowered;
+static uint8_t  simInReset;
+static uint64_t simBootUs;
+static uint8_t  simConnected;
+static uint8_t  simClassActive;
+static void   (*simUserProcess)(USBH_HandleTypeDef *phost, uint8_t id);
+
+/* Bulk OUT */
+static uint8_t  simTxData[SIM_TX_MAX];
+static uint32_t simTxLen;
+static uint8_t  simTxPending;
+static uint64_t simTxDoneUs;
+
+/* Bulk IN */
+static SimWrite_t simQueue[SIM_QUEUE_DEPTH];
+static uint32_t   simQueueHead;
+static uint32_t   simQueueCount;
+static uint64_t   simLinkFreeUs;
+static uint8_t   *simRxData;
+static uint32_t   simRxSize;
+static uint8_t    simRxArmed;
+static uint16_t   simRxLast;
+
+/* AT interpreter */
+static char     simLine[SIM_LINE_MAX];
+static uint32_t simLineLen;
+static uint8_t  simEcho;
+static uint64_t simModemFreeUs;
+
+/* HTTP service */
+static uint8_t  simHttpInit;
+static uint8_t  simHttpDone;
+static uint64_t simHttpReadyUs;
+static uint32_t simLastReadOffset;
+
+extern USBH_HandleTypeDef hUsbHostHS;
+USBH_ClassTypeDef CDC_Class;
+
+static const char *const simFaultNames[MODEM_SIM_FAULT_COUNT] = {
+    "drop", "error", "short", "corrupt", "urc", "delay"
+};
+
+/* Queries answered with a fixed information text before OK */
+static const struct {
+    const char *command;
+    const char *answer;
+} simQueries[] = {
+    { "AT",            "" },
+    { "ATI",           "\r\nManufacturer: SIMCOM INCORPORATED\r\nModel: SIM8262E-M2\r\n"
+                       "Revision: SIM8262M2_HOST_MODEL\r\nIMEI: " SIM_IMEI "\r\n" },
+    { "AT+CGSN",       "\r\n" SIM_IMEI "\r\n" },
+    { "AT+CPIN?",      "\r\n+CPIN: READY\r\n" },
+    { "AT+CSQ",        "\r\n+CSQ: 24,99\r\n" },
+    { "AT+CREG?",      "\r\n+CREG: 0,1\r\n" },
+    { "AT+CGREG?",     "\r\n+CGREG: 0,1\r\n" },
+    { "AT+CEREG?",     "\r\n+CEREG: 0,1\r\n" },
+    { "AT+COPS?",      "\r\n+COPS: 0,0,\"HOST MODEL\",13\r\n" },
+    { "AT+CPSI?",      "\r\n+CPSI: NR5G_SA,Online,001-01,0x000001,1,0,0,0,-80,-10,20\r\n" },
+    { "AT+CGACT?",     "\r\n+CGACT: 1,1\r\n" },
+    { "AT+CGPADDR=1",  "\r\n+CGPADDR: 1,10.0.0.2\r\n" },
+};
+
+static uint64_t ModemSim_HostNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void ModemSim_Enter(void)
+{
+    if ((simModelDepth++ == 0U) && (simLeaveNs != 0U))
+    {
+        uint64_t ns = ModemSim_HostNs() - simLeaveNs;
+
+        if (simHandedData)
+        {
+            simStats.parseNs += ns;
+        }
+        else
+        {
+            simStats.idleNs += ns;
+        }
+        simHandedData = 0;
+    }
+}
+
+static void ModemSim_Leave(void)
+{
+    if (--simModelDepth == 0U)
+    {
+        simLeaveNs = ModemSim_HostNs();
+    }
+}
+
+/*============================================================================*/
+/*                          BULK IN (MODEM TO HOST)                           */
+/*============================================================================*/
+
+static uint64_t ModemSim_BusUs(uint32_t len)
+{
+    return (((uint64_t)len * 1000000ULL) + simCfg.bandwidth - 1U) / simCfg.bandwidth;
+}
+
+static void ModemSim_QueueWrite(const uint8_t *data, uint32_t len, uint64_t atUs)
+{
+    SimWrite_t *w;
+
+    if (simQueueCount == SIM_QUEUE_DEPTH)
+    {
+        fprintf(stderr, "modem_sim: bulk IN queue full, %lu bytes lost\n", (unsigned long)len);
+        return;
+    }
+
+    w = &simQueue[(simQueueHead + simQueueCount) % SIM_QUEUE_DEPTH];
+    simQueueCount++;
+
+    w->startUs = (atUs > simLinkFreeUs) ? atUs : simLinkFreeUs;
+    w->readyUs = w->startUs + ModemSim_BusUs(len);
+    w->len = len;
+    w->pos = 0;
+    w->stallCounted = 0;
+    memcpy(w->data, data, len);
+    simLinkFreeUs = w->readyUs;
+}
+
+/**
+ * @brief  Queue an answer part, cut in writes of writeSize bytes if set
+ */
+static void ModemSim_Emit(const void *data, uint32_t len, uint64_t atUs)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t limit = ((simCfg.writeSize != 0U) && (simCfg.writeSize < SIM_WRITE_MAX)) ?
+                     simCfg.writeSize : SIM_WRITE_MAX;
+
+    while (len > 0U)
+    {
+        uint32_t n = (len > limit) ? limit : len;
+        ModemSim_QueueWrite(p, n, atUs);
+        p += n;
+        len -= n;
+    }
+}
+
+static void ModemSim_EmitText(const char *text, uint64_t atUs)
+{
+    ModemSim_Emit(text, (uint32_t)strlen(text), atUs);
+}
+
+/**
+ * @brief  Complete the armed receive if the queued writes allow it now
+ */
+static void ModemSim_DeliverIn(USBH_HandleTypeDef *phost)
+{
+    uint32_t n = 0;
+    uint32_t idx = simQueueHead;
+    uint32_t left = simQueueCount;
+    uint64_t doneUs = 0;
+
+    if (!simRxArmed || (simQueueCount == 0U) || (simQueue[idx].startUs > ModemSim_NowUs()))
+    {
+        return;
+    }
+
+    while (left > 0U)
+    {
+        SimWrite_t *w = &simQueue[idx];
+        uint32_t avail = w->len - w->pos;
+        uint32_t room = simRxSize - n;
+
+        if (avail >= room)
+        {
+            /* Buffer full inside this write */
+            doneUs = w->startUs + (((uint64_t)(w->pos + room) * (w->readyUs - w->startUs)) / w->len);
+            n += room;
+            break;
+        }
+
+        n += avail;
+        doneUs = w->readyUs;
+
+        /* A short packet or a ZLP ends the transfer at the end of the write */
+        if (!simCfg.noZlp || ((avail % simCfg.packetSize) != 0U))
+        {
+            break;
+        }
+
+        idx = (idx + 1U) % SIM_QUEUE_DEPTH;
+        left--;
+        if (left == 0U)
+        {
+            /* Last packet full and no ZLP: the transfer waits for more data */
+            if ((doneUs <= ModemSim_NowUs()) && !w->stallCounted)
+            {
+                w->stallCounted = 1;
+                simStats.stalls++;
+            }
+            return;
+        }
+    }
+
+    if (doneUs > ModemSim_NowUs())
+    {
+        return;
+    }
+
+    simRxLast = (uint16_t)n;
+    simRxArmed = 0;
+    while (n > 0U)
+    {
+        SimWrite_t *w = &simQueue[simQueueHead];
+        uint32_t take = w->len - w->pos;
+
+        if (take > n)
+        {
+            take = n;
+        }
+        memcpy(&simRxData[simRxLast - n], &w->data[w->pos], take);
+        w->pos += take;
+        n -= take;
+        if (w->pos == w->len)
+        {
+            simQueueHead = (simQueueHead + 1U) % SIM_QUEUE_DEPTH;
+            simQueueCount--;
+        }
+    }
+
+    simStats.transfers++;
+    simStats.bytesIn += simRxLast;
+    simHandedData = 1;
+    USBH_CDC_ReceiveCallback(phost);
+}
+
+/*============================================================================*/
+/*                          AT INTERPRETER                                    */
+/*============================================================================*/
+
+static void ModemSim_Final(const char *result, uint64_t atUs)
+{
+    if (strcmp(result, "ERROR") == 0)
+    {
+        simStats.errors++;
+        ModemSim_EmitText("\r\nERROR\r\n", atUs);
+    }
+    else
+    {
+        ModemSim_EmitText("\r\nOK\r\n", atUs);
+    }
+}
+
+static int ModemSim_FaultFor(uint32_t readNumber)
+{
+    for (uint32_t i = 0; i < simCfg.faultCount; i++)
+    {
+        const ModemSim_FaultRule_t *rule = &simCfg.faults[i];
+
+        if (rule->periodic ? ((readNumber % rule->index) == 0U) : (readNumber == rule->index))
+        {
+            return (int)rule->kind;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  AT+HTTPREAD=<offset>,<len>: OK, then the data framed by
+ *         +HTTPREAD: DATA,<n> and +HTTPREAD: 0
+ */
+static void ModemSim_HttpRead(uint32_t offset, uint32_t len, uint64_t atUs)
+{
+    static uint8_t block[SIM_WRITE_MAX];
+    uint32_t n;
+    uint32_t head;
+    int fault;
+
+    simStats.httpReads++;
+    if ((simStats.httpReads > 1U) && (offset == simLastReadOffset))
+    {
+        simStats.repeatedReads++;
+    }
+    simLastReadOffset = offset;
+
+    if (!simHttpDone || (ModemSim_NowUs() < simHttpReadyUs) || (offset >= simFileSize) || (len == 0U))
+    {
+        ModemSim_Final("ERROR", atUs);
+        return;
+    }
+
+    n = simFileSize - offset;
+    if (n > len)
+    {
+        n = len;
+    }
+    if (n > SIM_READ_MAX)
+    {
+        n = SIM_READ_MAX;
+    }
+
+    fault = ModemSim_FaultFor(simStats.httpReads);
+    if (fault >= 0)
+    {
+        simStats.faults++;
+    }
+
+    switch (fault)
+    {
+        case MODEM_SIM_FAULT_DROP:
+            return;
+        case MODEM_SIM_FAULT_ERROR:
+            ModemSim_Final("ERROR", atUs);
+            return;
+        case MODEM_SIM_FAULT_SHORT:
+            n = (n + 1U) / 2U;
+            break;
+        case MODEM_SIM_FAULT_DELAY:
+            atUs += SIM_FAULT_DELAY_US;
+            break;
+        default:
+            break;
+    }
+
+    ModemSim_Final("OK", atUs);
+    if (fault == MODEM_SIM_FAULT_URC)
+    {
+        ModemSim_EmitText("\r\n+CGEV: NW MODIFY 1,0\r\n", atUs);
+    }
+
+    head = (uint32_t)snprintf((char *)block, sizeof(block), "\r\n+HTTPREAD: DATA,%lu\r\n", (unsigned long)n);
+    memcpy(&block[head], &simFile[offset], n);
+    if (fault == MODEM_SIM_FAULT_CORRUPT)
+    {
+        block[head + (n / 2U)] ^= 0x01U;
+    }
+    memcpy(&block[head + n], "\r\n+HTTPREAD: 0\r\n", 16);
+    ModemSim_Emit(block, head + n + 16U, atUs);
+}
+
+static void ModemSim_Http(const char *line, uint64_t atUs)
+{
+    char text[160];
+    unsigned long a, b;
+
+    if (strcmp(line, "AT+HTTPINIT") == 0)
+    {
+        ModemSim_Final(simHttpInit ? "ERROR" : "OK", atUs);
+        simHttpInit = 1;
+        simHttpDone = 0;
+    }
+    else if (strcmp(line, "AT+HTTPTERM") == 0)
+    {
+        ModemSim_Final(simHttpInit ? "OK" : "ERROR", atUs);
+        simHttpInit = 0;
+        simHttpDone = 0;
+    }
+    else if (!simHttpInit)
+    {
+        ModemSim_Final("ERROR", atUs);
+    }
+    else if (strncmp(line, "AT+HTTPPARA=", 12) == 0)
+    {
+        ModemSim_Final("OK", atUs);
+    }
+    else if (sscanf(line, "AT+HTTPACTION=%lu", &a) == 1)
+    {
+        int status = (a == 0U) ? 200 : 405;
+
+        ModemSim_Final("OK", atUs);
+        simHttpReadyUs = atUs + ((uint64_t)simCfg.actionMs * 1000U);
+        simHttpDone = (status == 200);
+        snprintf(text, sizeof(text), "\r\n+HTTPACTION: %lu,%d,%lu\r\n", a, status,
+                 (unsigned long)(simHttpDone ? simFileSize : 0U));
+        ModemSim_EmitText(text, simHttpReadyUs);
+    }
+    else if (strcmp(line, "AT+HTTPHEAD") == 0)
+    {
+        char head[128];
+
+        if (!simHttpDone || (ModemSim_NowUs() < simHttpReadyUs))
+        {
+            ModemSim_Final("ERROR", atUs);
+            return;
+        }
+        snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                 "Content-Length: %lu\r\n", (unsigned long)simFileSize);
+        snprintf(text, sizeof(text), "\r\n+HTTPHEAD: %lu\r\n%s", (unsigned long)strlen(head), head);
+        ModemSim_EmitText(text, atUs);
+        ModemSim_Final("OK", atUs);
+    }
+    else if (strcmp(line, "AT+HTTPREAD?") == 0)
+    {
+        snprintf(text, sizeof(text), "\r\n+HTTPREAD: LEN,%lu\r\n",
+                 (unsigned long)(simHttpDone ? simFileSize : 0U));
+        ModemSim_EmitText(text, atUs);
+        ModemSim_Final("OK", atUs);
+    }
+    else if (sscanf(line, "AT+HTTPREAD=%lu,%lu", &a, &b) == 2)
+    {
+        ModemSim_HttpRead((uint32_t)a, (uint32_t)b, atUs);
+    }
+    else
+    {
+        ModemSim_Final("ERROR", atUs);
+    }
+}
+
+static void ModemSim_Execute(const char *line)
+{
+    uint64_t atUs = ((simModemFreeUs > ModemSim_NowUs()) ? simModemFreeUs : ModemSim_NowUs()) +
+                    ((uint64_t)simCfg.latencyMs * 1000U);
+
+    simStats.commands++;
+    simModemFreeUs = atUs;
+
+    for (uint32_t i = 0; i < (sizeof(simQueries) / sizeof(simQueries[0])); i++)
+    {
+        if (strcmp(line, simQueries[i].command) == 0)
+        {
+            ModemSim_EmitText(simQueries[i].answer, atUs);
+            ModemSim_Final("OK", atUs);
+            return;
+        }
+    }
+
+    if ((strcmp(line, "ATE0") == 0) || (strcmp(line, "ATE1") == 0))
+    {
+        simEcho = (uint8_t)(line[3] - '0');
+        ModemSim_Final("OK", atUs);
+    }
+    else if ((strncmp(line, "AT+CGACT=", 9) == 0) || (strncmp(line, "AT+CGDCONT=", 11) == 0))
+    {
+        ModemSim_Final("OK", atUs);
+    }
+    else if (strncmp(line, "AT+HTTP", 7) == 0)
+    {
+        ModemSim_Http(line, atUs);
+    }
+    else
+    {
+        ModemSim_Final("ERROR", atUs);
+    }
+}
+
+/**
+ * @brief  Bytes of a completed bulk OUT transfer: echo and command lines
+ */
+static void ModemSim_Input(const uint8_t *data, uint32_t len)
+{
+    if (ModemSim_NowUs() < (simBootUs + ((uint64_t)simCfg.readyMs * 1000U)))
+    {
+        return;     /* AT interpreter not started yet */
+    }
+
+    simStats.bytesOut += len;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        char c = (char)data[i];
+
+        if ((c == '\n') || (c == '\0'))
+        {
+            continue;
+        }
+        if (c != '\r')
+        {
+            if (simLineLen < (SIM_LINE_MAX - 1U))
+            {
+                simLine[simLineLen++] = c;
+            }
+            continue;
+        }
+
+        simLine[simLineLen] = '\0';
+        if (simEcho)
+        {
+            simLine[simLineLen] = '\r';
+            ModemSim_Emit(simLine, simLineLen + 1U, ModemSim_NowUs());
+            simLine[simLineLen] = '\0';
+        }
+        if (simLineLen > 0U)
+        {
+            ModemSim_Execute(simLine);
+        }
+        simLineLen = 0;
+    }
+}
+
+/*============================================================================*/
+/*                          POWER AND CONNECTION                              */
+/*============================================================================*/
+
+static void ModemSim_Disconnect(USBH_HandleTypeDef *phost)
+{
+    simQueueCount = 0;
+    simRxArmed = 0;
+    simTxPending = 0;
+    simLineLen = 0;
+    simHttpInit = 0;
+    simHttpDone = 0;
+
+    if (simConnected)
+    {
+        simConnected = 0;
+        simClassActive = 0;
+        phost->gState = HOST_IDLE;
+        if (simUserProcess != NULL)
+        {
+            simUserProcess(phost, HOST_USER_DISCONNECTION);
+        }
+    }
+}
+
+static void ModemSim_Boot(void)
+{
+    simBootUs = ModemSim_NowUs();
+    simEcho = 1;
+    simModemFreeUs = 0;
+    simLinkFreeUs = 0;
+}
+
+/**
+ * @brief  GPIO hook of the port: power enable and reset of the modem
+ */
+static void ModemSim_Gpio(void *port, uint16_t pin, int set)
+{
+    ModemSim_Enter();
+    if ((port == MODEM_PWR_EN_GPIO_Port) && (pin == MODEM_PWR_EN_Pin))
+    {
+        if (set && !simPowered)
+        {
+            ModemSim_Boot();
+        }
+        else if (!set)
+        {
+            ModemSim_Disconnect(&hUsbHostHS);
+        }
+        simPowered = (uint8_t)set;
+    }
+    else if ((port == MODEM_RESET_GPIO_Port) && (pin == MODEM_RESET_Pin))
+    {
+        /* Reset is held while the pin is high, the modem boots on release */
+        if (set)
+        {
+            ModemSim_Disconnect(&hUsbHostHS);
+        }
+        else if (simInReset)
+        {
+            ModemSim_Boot();
+        }
+        simInReset = (uint8_t)set;
+    }
+    ModemSim_Leave();
+}
+
+/*============================================================================*/
+/*                          USB HOST LIBRARY                                  */
+/*============================================================================*/
+
+USBH_StatusTypeDef USBH_Init(USBH_HandleTypeDef *phost,
+                             void (*pUsrFunc)(USBH_HandleTypeDef *phost, uint8_t id), uint8_t id)
+{
+    memset(phost, 0, sizeof(*phost));
+    phost->id = id;
+    phost->gState = HOST_IDLE;
+    phost->pUser = pUsrFunc;
+    simUserProcess = pUsrFunc;
+    return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_RegisterClass(USBH_HandleTypeDef *phost, USBH_ClassTypeDef *pclass)
+{
+    (void)phost;
+    (void)pclass;
+    return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_Start(USBH_HandleTypeDef *phost)
+{
+    (void)phost;
+    return USBH_OK;
+}
+
+/**
+ * @brief  One pass of the host process: enumeration, then at most one bulk
+ *         OUT completion and one bulk IN completion
+ */
+USBH_StatusTypeDef USBH_Process(USBH_HandleTypeDef *phost)
+{
+    uint64_t usbUs = simBootUs + ((uint64_t)simCfg.usbMs * 1000U);
+
+    ModemSim_Enter();
+    Port_AdvanceNs((uint64_t)simCfg.pollUs * 1000U);
+    simStats.polls++;
+
+    if (simPowered && !simInReset)
+    {
+        if (!simConnected && (ModemSim_NowUs() >= usbUs))
+        {
+            simConnected = 1;
+            phost->gState = HOST_ENUMERATION;
+            simUserProcess(phost, HOST_USER_CONNECTION);
+        }
+        if (simConnected && !simClassActive && (ModemSim_NowUs() >= (usbUs + SIM_ENUM_US)))
+        {
+            simClassActive = 1;
+            phost->gState = HOST_CLASS;
+            simUserProcess(phost, HOST_USER_CLASS_ACTIVE);
+        }
+    }
+
+    if (simClassActive)
+    {
+        if (simTxPending && (ModemSim_NowUs() >= simTxDoneUs))
+        {
+            simTxPending = 0;
+            ModemSim_Input(simTxData, simTxLen);
+            USBH_CDC_TransmitCallback(phost);
+        }
+        ModemSim_DeliverIn(phost);
+    }
+
+    ModemSim_Leave();
+    return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_CDC_Transmit(USBH_HandleTypeDef *phost, uint8_t *pbuff, uint32_t length)
+{
+    (void)phost;
+
+    if (!simClassActive || simTxPending || (length > SIM_TX_MAX))
+    {
+        return USBH_BUSY;
+    }
+
+    ModemSim_Enter();
+    memcpy(simTxData, pbuff, length);
+    simTxLen = length;
+    simTxPending = 1;
+    simTxDoneUs = ModemSim_NowUs() + ModemSim_BusUs(length) + 125U;     /* next microframe */
+    ModemSim_Leave();
+    return USBH_OK;
+}
+
+USBH_StatusTypeDef USBH_CDC_Receive(USBH_HandleTypeDef *phost, uint8_t *pbuff, uint32_t length)
+{
+    (void)phost;
+
+    if (!simClassActive)
+    {
+        return USBH_BUSY;
+    }
+
+    simRxData = pbuff;
+    simRxSize = length;
+    simRxArmed = 1;
+    return USBH_OK;
+}
+
+uint16_t USBH_CDC_GetLastReceivedDataSize(USBH_HandleTypeDef *phost)
+{
+    (void)phost;
+    return simRxLast;
+}
+
+USBH_StatusTypeDef USBH_CDC_Stop(USBH_HandleTypeDef *phost)
+{
+    (void)phost;
+    simRxArmed = 0;
+    return USBH_OK;
+}
+
+void USBH_MEM_Report(void)
+{
+}
+
+/*============================================================================*/
+/*                          HAL TIME BASE                                     */
+/*============================================================================*/
+
+/* Overrides the weak one of the port, so a delay is not firmware time */
+void HAL_Delay(uint32_t Delay)
+{
+    ModemSim_Enter();
+    Port_AdvanceNs((uint64_t)Delay * 1000000U);
+    ModemSim_Leave();
+}
+
+/*============================================================================*/
+/*                          FIRMWARE STDIO                                    */
+/*============================================================================*/
+
+/**
+ * @brief  Drop the l length modifier: uint32_t is an unsigned int here
+ */
+static const char *ModemSim_FixFormat(const char *format, char *out, size_t size)
+{
+    size_t o = 0;
+
+    while ((*format != '\0') && ((o + 2U) < size))
+    {
+        char c = *format++;
+
+        out[o++] = c;
+        if (c != '%')
+        {
+            continue;
+        }
+        if (*format == '%')
+        {
+            out[o++] = *format++;
+            continue;
+        }
+        while ((*format != '\0') && (strchr("-+ #0123456789.*", *format) != NULL) && ((o + 2U) < size))
+        {
+            out[o++] = *format++;
+        }
+        if ((format[0] == 'l') && (format[1] != 'l'))
+        {
+            format++;
+        }
+    }
+    out[o] = '\0';
+    return out;
+}
+
+int ModemSim_Printf(const char *format, ...)
+{
+    char fixed[256];
+    char text[4096];
+    va_list args;
+    int n;
+
+    if (!simVerbose)
+    {
+        return 0;
+    }
+
+    va_start(args, format);
+    n = vsnprintf(text, sizeof(text), ModemSim_FixFormat(format, fixed, sizeof(fixed)), args);
+    va_end(args);
+
+    for (const char *p = text; *p != '\0'; p++)
+    {
+        if (*p != '\r')
+        {
+            putchar(*p);
+        }
+    }
+    return n;
+}
+
+int ModemSim_Sscanf(const char *str, const char *format, ...)
+{
+    char fixed[256];
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsscanf(str, ModemSim_FixFormat(format, fixed, sizeof(fixed)), args);
+    va_end(args);
+    return n;
+}
+
+/*============================================================================*/
+/*                          MODEL API                                         */
+/*============================================================================*/
+
+int ModemSim_Open(const ModemSim_Config_t *config, const uint8_t *file, uint32_t size)
+{
+    if ((config->bandwidth == 0U) || (config->packetSize == 0U) || (config->pollUs == 0U))
+    {
+        return -1;
+    }
+
+    simCfg = *config;
+    simFile = file;
+    simFileSize = size;
+    memset(&simStats, 0, sizeof(simStats));
+    Port_SetGpioHook(ModemSim_Gpio);
+    return 0;
+}
+
+int ModemSim_ParseFault(const char *spec, ModemSim_FaultRule_t *rule)
+{
+    const char *sep = strpbrk(spec, ":@");
+    char *end;
+    unsigned long index;
+
+    if (sep == NULL)
+    {
+        return -1;
+    }
+
+    for (uint32_t k = 0; k < MODEM_SIM_FAULT_COUNT; k++)
+    {
+        if ((strlen(simFaultNames[k]) == (size_t)(sep - spec)) &&
+            (strncmp(spec, simFaultNames[k], (size_t)(sep - spec)) == 0))
+        {
+            index = strtoul(sep + 1, &end, 0);
+            if ((*end != '\0') || (index == 0U))
+            {
+                return -1;
+            }
+            rule->kind = (ModemSim_Fault_t)k;
+            rule->index = (uint32_t)index;
+            rule->periodic = (*sep == ':');
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void ModemSim_SetVerbose(int verbose)
+{
+    simVerbose = verbose;
+}
+
+uint64_t ModemSim_NowUs(void)
+{
+    return Port_NowNs() / 1000U;
+}
+
+void ModemSim_GetStats(ModemSim_Stats_t *stats)
+{
+    *stats = simStats;
+}
+
+void ModemSim_ResetStats(void)
+{
+    memset(&simStats, 0, sizeof(simStats));
+    simLeaveNs = 0;
+    simHandedData = 0;
+}
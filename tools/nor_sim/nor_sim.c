@@ -0,0 +1,447 @@
+/**
+ ******************************************************************************
+ * @file    nor_sim.c
+ * @brief   Flash paths of the Boot and the ExtMemLoader run on the NOR model
+ *
+ * Usage:
+ *   nor_sim [-f array_file] [-k kernel_clock_hz] [-t time_scale_percent] [-T capture_file]
+ *
+ * The ExtMem Manager, the NOR SFDP driver, the image programming of the
+ * Boot (Boot/Core/Src/ota_bootloader.c, included below so its static
+ * functions can be called) and the loader entry points of the ExtMemLoader
+ * are linked unmodified against sal_xspi_sim.c and tools/port, which gives
+ * the HAL time base, the UART and the backup registers and mailbox.
+ *
+ * Scenarios, each one checks the data and the model counters:
+ *  1. cold power-on: SFDP discovery, octal DTR entry, mapped mode
+ *  2. power-on with the backup SRAM kept: discovery from the SFDP cache
+ *  3. MCU reset with the memory left in octal DTR
+ *  4. EXTMEM erase, write and read, page program only clearing bits
+ *  5. Boot_WriteFirmwareToFlash of an image into Slot B, then of a delta,
+ *     then the repair of bad pages by the verify
+ *  6. OTA_Bootloader_Process with the boot flag and the mailbox of tools/port
+ *  7. loader Init, SectorErase, Write and Verify
+ *  8. model checks: a write without WREN and a bad mapped read are caught
+ *
+ * With -T the UART goes to capture_file, unchanged, and each run of
+ * scenario 6 ends with the trace dump of the Boot, for tools/trace_decode.
+ ******************************************************************************
+ */
+
+#include "ota_bootloader.c"
+#include "nor_sim.h"
+#include "stm32_sal_xspi_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          BOARD STUBS (HOST)                                */
+/*============================================================================*/
+
+#define SIM_IMAGE_SIZE          0x40000U        /* 256KB, 4 blocks of 64KB */
+#define SIM_DELTA_OFFSET        0x12345U        /* byte changed 1->0 by the delta */
+#define SIM_DELTA_ERASE_OFFSET  0x2A000U        /* byte changed 0->1 by the delta */
+#define SIM_REPAIR_OFFSET       0x31000U        /* sector with bad pages for the verify */
+#define SIM_REPAIR_PAGES        4U              /* more than FLASH_VERIFY_RETRIES */
+#define SIM_LOADER_ADDR         0x70800000U
+#define SIM_LOADER_SIZE         0x3000U
+#define SIM_MAILBOX_SIZE        0x8000U         /* 32KB image left by the Appli */
+
+UART_HandleTypeDef huart4;
+EXTMEM_DefinitionTypeDef extmem_list_config[1];
+
+/* Start and end of the loader .bss: empty, the loader globals are kept */
+int simLoaderBss;
+
+/* Loader entry points, stm32_loader_api.h pulls in the loader configuration */
+uint32_t Init(void);
+uint32_t Write(uint32_t Address, uint32_t Size, uint8_t *buffer);
+uint32_t SectorErase(uint32_t EraseStartAddress, uint32_t EraseEndAddress);
+uint64_t Verify(uint32_t MemoryAddr, uint32_t RAMBufferAddr, uint32_t Size, uint32_t missalignement);
+
+static uint32_t simClock = 200000000U;
+static int      simTrace;
+static uint8_t  simImage[SIM_IMAGE_SIZE];
+static uint8_t  simBuffer[SIM_IMAGE_SIZE];
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler\n");
+    exit(1);
+}
+
+/* ExtMemLoader/Core/Src/extmemloader_init.c: the board init is the model reset */
+uint32_t extmemloader_Init(void)
+{
+    NorSim_McuReset();
+    memset(extmem_list_config, 0, sizeof(extmem_list_config));
+    extmem_list_config[0].MemType = EXTMEM_NOR_SFDP;
+    extmem_list_config[0].Handle = (void *)&hxspi2;
+    extmem_list_config[0].ConfigType = EXTMEM_LINK_CONFIG_8LINES;
+    return (EXTMEM_Init(EXTMEMORY_1, simClock) == EXTMEM_OK) ? 0U : 1U;
+}
+
+/*============================================================================*/
+/*                          SCENARIOS                                         */
+/*============================================================================*/
+
+/* Boot/Core/Src/main.c and extmem_manager.c */
+static EXTMEM_StatusTypeDef Sim_ExtMemInit(void)
+{
+    EXTMEM_StatusTypeDef status;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(extmem_list_config, 0, sizeof(extmem_list_config));
+    extmem_list_config[0].MemType = EXTMEM_NOR_SFDP;
+    extmem_list_config[0].Handle = (void *)&hxspi2;
+    extmem_list_config[0].ConfigType = EXTMEM_LINK_CONFIG_8LINES;
+
+    TRACE_BEGIN(TRACE_ID_EXTMEM_INIT, 0);
+    status = EXTMEM_Init(EXTMEMORY_1, simClock);
+    TRACE_END(TRACE_ID_EXTMEM_INIT, status);
+    return status;
+}
+
+/**
+ * @brief  Print the model counters of a scenario and check them: commands
+ *         ignored by the memory are only counted, the driver probes with some
+ * @retval number of failed checks
+ */
+static int Sim_Report(const char *name, int ok)
+{
+    static uint64_t startNs;
+    NorSim_Stats_t stats;
+    int failures = ok ? 0 : 1;
+
+    /* The Boot lines of the scenario come before its result */
+    Log_Flush(LOG_BLOCKING_TIMEOUT);
+    NorSim_GetStats(&stats);
+    if ((stats.rejected != 0U) || (stats.corrupted != 0U) || (stats.busyViolations != 0U)
+        || (stats.timeouts != 0U) || (stats.mapErrors != 0U))
+    {
+        failures++;
+    }
+    printf("  %-40s %s\n", name, (failures == 0) ? "ok" : "FAILED");
+    printf("    %lu commands (%lu ignored), %lu programs, %lu erases, %lu us\n",
+           (unsigned long)stats.commands, (unsigned long)stats.mismatched,
+           (unsigned long)stats.programs, (unsigned long)stats.erases,
+           (unsigned long)((NorSim_NowNs() - startNs) / 1000U));
+    if (failures != 0)
+    {
+        printf("    rejected %lu, corrupted %lu, busy violations %lu, timeouts %lu, map errors %lu\n",
+               (unsigned long)stats.rejected, (unsigned long)stats.corrupted,
+               (unsigned long)stats.busyViolations, (unsigned long)stats.timeouts,
+               (unsigned long)stats.mapErrors);
+    }
+    NorSim_ResetStats();
+    startNs = NorSim_NowNs();
+    return failures;
+}
+
+/**
+ * @brief  EXTMEM_Init must end in octal DTR with the mapped read of the mode
+ */
+static int Sim_CheckInit(const char *name, uint8_t cached)
+{
+    EXTMEM_StatusTypeDef status = Sim_ExtMemInit();
+    const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *nor = &extmem_list_config[EXTMEMORY_1].NorSfdpObject;
+    int ok;
+
+    ok = (status == EXTMEM_OK)
+         && (strcmp(NorSim_ModeName(), "DOPI") == 0)
+         && (nor->sfpd_private.SALObject.PhyLink == PHY_LINK_8D8D8D)
+         && (nor->sfpd_private.ProfileCached == cached)
+         && (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_ENABLE) == EXTMEM_OK)
+         && (memcmp((const void *)SLOT_A_CPU_ADDR, NorSim_Array(), 0x1000U) == 0)
+         && (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE) == EXTMEM_OK);
+    printf("  init %d, memory %s with %u dummy cycles, link %s at %lu MHz\n", (int)status, NorSim_ModeName(),
+           NorSim_DummyCycles(), (nor->sfpd_private.SALObject.PhyLink == PHY_LINK_8D8D8D) ? "8D8D8D" : "other",
+           (unsigned long)(nor->sfpd_private.SALObject.ClockOut / 1000000U));
+    return Sim_Report(name, ok);
+}
+
+static int Sim_ExtMemReadWrite(void)
+{
+    static const uint8_t pattern[4] = { 0xF0, 0x0F, 0xAA, 0x55 };
+    const uint32_t addr = 0x00400000U;
+    int ok = 1;
+
+    for (uint32_t i = 0; i < 0x2000U; i++)
+    {
+        simImage[i] = (uint8_t)(i * 7U);
+    }
+    ok = ok && (EXTMEM_EraseSector(EXTMEMORY_1, addr, 0x2000U) == EXTMEM_OK);
+    ok = ok && (NorSim_Array()[addr] == 0xFFU) && (NorSim_Array()[addr + 0x1FFFU] == 0xFFU);
+    /* Unaligned start, several pages */
+    ok = ok && (EXTMEM_Write(EXTMEMORY_1, addr + 0x10U, simImage, 0x1F00U) == EXTMEM_OK);
+    ok = ok && (memcmp(&NorSim_Array()[addr + 0x10U], simImage, 0x1F00U) == 0);
+    ok = ok && (EXTMEM_Read(EXTMEMORY_1, addr + 0x10U, simBuffer, 0x1F00U) == EXTMEM_OK);
+    ok = ok && (memcmp(simBuffer, simImage, 0x1F00U) == 0);
+
+    /* Programming again only clears bits */
+    ok = ok && (EXTMEM_Write(EXTMEMORY_1, addr + 0x10U, pattern, sizeof(pattern)) == EXTMEM_OK);
+    for (uint32_t i = 0; i < sizeof(pattern); i++)
+    {
+        ok = ok && (NorSim_Array()[addr + 0x10U + i] == (simImage[i] & pattern[i]));
+    }
+
+    /* The window shows the array in mapped mode */
+    ok = ok && (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_ENABLE) == EXTMEM_OK);
+    ok = ok && (memcmp((const void *)(SLOT_A_CPU_ADDR + addr + 0x100U), &simImage[0xF0U], 0x1000U) == 0);
+    ok = ok && (EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE) == EXTMEM_OK);
+    return Sim_Report("EXTMEM erase, write, read", ok);
+}
+
+static int Sim_BootWrite(void)
+{
+    uint32_t seed = 0x12345678U;
+    int ok;
+
+    for (uint32_t i = 0; i < SIM_IMAGE_SIZE; i++)
+    {
+        seed = (seed * 1664525U) + 1013904223U;
+        simImage[i] = (uint8_t)(seed >> 24);
+    }
+    ok = (Boot_WriteFirmwareToFlash(SLOT_B_FLASH_ADDR, simImage, SIM_IMAGE_SIZE) == OTA_BOOT_OK)
+         && (memcmp(&NorSim_Array()[SLOT_B_FLASH_ADDR], simImage, SIM_IMAGE_SIZE) == 0);
+    (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    if (Sim_Report("Boot_WriteFirmwareToFlash, full image", ok) != 0)
+    {
+        return 1;
+    }
+
+    /* Delta: one block only programmed, one erased, the others unchanged */
+    simImage[SIM_DELTA_OFFSET] &= 0x0FU;
+    simImage[SIM_DELTA_ERASE_OFFSET] |= 0x81U;
+    if (NorSim_Array()[SLOT_B_FLASH_ADDR + SIM_DELTA_ERASE_OFFSET] == simImage[SIM_DELTA_ERASE_OFFSET])
+    {
+        simImage[SIM_DELTA_ERASE_OFFSET] = 0xFFU;
+    }
+    ok = (Boot_WriteFirmwareToFlash(SLOT_B_FLASH_ADDR, simImage, SIM_IMAGE_SIZE) == OTA_BOOT_OK)
+         && (memcmp(&NorSim_Array()[SLOT_B_FLASH_ADDR], simImage, SIM_IMAGE_SIZE) == 0);
+    if (Sim_Report("Boot_WriteFirmwareToFlash, delta", ok) != 0)
+    {
+        (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+        return 1;
+    }
+
+    /* More bad pages in one sector than retries: each one is repaired by a
+     * page program, the sector is not given up */
+    for (uint32_t page = 0; page < SIM_REPAIR_PAGES; page++)
+    {
+        ((uint8_t *)NorSim_Array())[SLOT_B_FLASH_ADDR + SIM_REPAIR_OFFSET + (page * FLASH_PAGE_SIZE)] = 0xFFU;
+        simImage[SIM_REPAIR_OFFSET + (page * FLASH_PAGE_SIZE)] = 0x00U;
+    }
+    ok = (Boot_VerifyFlash(SLOT_B_FLASH_ADDR, simImage, SIM_IMAGE_SIZE) == OTA_BOOT_OK)
+         && (memcmp(&NorSim_Array()[SLOT_B_FLASH_ADDR], simImage, SIM_IMAGE_SIZE) == 0);
+    (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    return Sim_Report("Boot_VerifyFlash, bad pages in one sector repaired", ok);
+}
+
+/**
+ * @brief  The Appli leaves an image in the mailbox and the update flag in the
+ *         backup registers, then resets: OTA_Bootloader_Process of the Boot
+ * @retval Slot address returned by OTA_Bootloader_Process
+ */
+static uint32_t Sim_BootProcess(uint32_t flag)
+{
+    uint32_t slot;
+
+    TAMP->BKP0R = flag;
+    NorSim_McuReset();
+    Log_Init(&huart4);
+    Trace_Init(TRACE_IMAGE_BOOT);
+    if (Sim_ExtMemInit() != EXTMEM_OK)
+    {
+        return 0U;
+    }
+    TRACE_BEGIN(TRACE_ID_BOOT_UPDATE, 0);
+    slot = OTA_Bootloader_Process();
+    TRACE_END(TRACE_ID_BOOT_UPDATE, slot);
+    (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    if (simTrace)
+    {
+        Trace_Dump(&huart4);
+    }
+    return slot;
+}
+
+static int Sim_BootUpdate(void)
+{
+    uint32_t seed = 0x9E3779B9U;
+    int failures = 0;
+    int ok;
+
+    ok = (Sim_BootProcess(BOOT_FLAG_NORMAL) == SLOT_A_CPU_ADDR)
+         && (OTA_Bootloader_UpdatePending() == 0U);
+    failures += Sim_Report("no update pending: Slot A", ok);
+
+    for (uint32_t i = 0; i < SIM_MAILBOX_SIZE; i++)
+    {
+        seed = (seed * 1664525U) + 1013904223U;
+        OTA_MAILBOX->fwData[i] = (uint8_t)(seed >> 24);
+    }
+    OTA_MAILBOX->magic = OTA_MAGIC;
+    OTA_MAILBOX->fwSize = SIM_MAILBOX_SIZE;
+    OTA_MAILBOX->version = 2U;
+    OTA_MAILBOX->expectedCRC = Boot_CalculateCRC32(OTA_MAILBOX->fwData, SIM_MAILBOX_SIZE) ^ 1U;
+    ok = (Sim_BootProcess(BOOT_FLAG_UPDATE) == SLOT_A_CPU_ADDR)
+         && (TAMP->BKP0R == BOOT_FLAG_NORMAL) && (OTA_Bootloader_UpdatePending() != 0U)
+         && (memcmp(&NorSim_Array()[SLOT_B_FLASH_ADDR], OTA_MAILBOX->fwData, SIM_MAILBOX_SIZE) != 0);
+    failures += Sim_Report("mailbox with a bad CRC: Slot A", ok);
+
+    OTA_MAILBOX->expectedCRC ^= 1U;
+    ok = (Sim_BootProcess(BOOT_FLAG_UPDATE) == SLOT_B_CPU_ADDR)
+         && (TAMP->BKP0R == BOOT_FLAG_NORMAL) && (OTA_MAILBOX->magic == 0U)
+         && (memcmp(&NorSim_Array()[SLOT_B_FLASH_ADDR], OTA_MAILBOX->fwData, SIM_MAILBOX_SIZE) == 0);
+    failures += Sim_Report("mailbox written to Slot B", ok);
+    return failures;
+}
+
+static int Sim_Loader(void)
+{
+    uint64_t verify;
+    int ok;
+
+    for (uint32_t i = 0; i < SIM_LOADER_SIZE; i++)
+    {
+        simBuffer[i] = (uint8_t)(0xA5U ^ i);
+    }
+    ok = (Init() == 1U)
+         && (SectorErase(SIM_LOADER_ADDR, SIM_LOADER_ADDR + SIM_LOADER_SIZE - 1U) == 1U)
+         && (Write(SIM_LOADER_ADDR, SIM_LOADER_SIZE, simBuffer) == 1U);
+    verify = ok ? Verify(SIM_LOADER_ADDR, (uint32_t)(uintptr_t)simBuffer, SIM_LOADER_SIZE / 4U, 0U) : 1U;
+    ok = ok && ((uint32_t)verify == 0U)
+         && (memcmp(&NorSim_Array()[SIM_LOADER_ADDR - SLOT_A_CPU_ADDR], simBuffer, SIM_LOADER_SIZE) == 0);
+
+    /* A corrupted byte must be reported at its address */
+    simBuffer[0x123U] ^= 0x01U;
+    verify = ok ? Verify(SIM_LOADER_ADDR, (uint32_t)(uintptr_t)simBuffer, SIM_LOADER_SIZE / 4U, 0U) : 0U;
+    ok = ok && ((uint32_t)verify != 0U);
+    return Sim_Report("loader Init, SectorErase, Write, Verify", ok);
+}
+
+/**
+ * @brief  The model must catch the faults it is there for
+ */
+static int Sim_ModelCheck(void)
+{
+    SAL_XSPI_ObjectTypeDef *sal = &extmem_list_config[EXTMEMORY_1].NorSfdpObject.sfpd_private.SALObject;
+    static const uint8_t data[4] = { 0x00, 0x00, 0x00, 0x00 };
+    NorSim_Stats_t stats;
+    Log_Stats_t logStats;
+    int failures = 0;
+
+    (void)EXTMEM_MemoryMappedMode(EXTMEMORY_1, EXTMEM_DISABLE);
+    NorSim_ResetStats();
+
+    /* Page program without write enable */
+    (void)SAL_XSPI_Write(sal, 0x12U, 0x00600000U, data, sizeof(data));
+    NorSim_GetStats(&stats);
+    printf("  page program without WREN: %s\n", (stats.rejected != 0U) ? "rejected" : "NOT DETECTED");
+    failures += (stats.rejected != 0U) ? 0 : 1;
+
+    /* Mapped reads with the dummy cycles of the SFDP read */
+    (void)SAL_XSPI_EnableMapMode(sal, 0xEEU, 8U, 0x12U, 0U);
+    (void)SAL_XSPI_DisableMapMode(sal);
+    NorSim_GetStats(&stats);
+    printf("  mapped mode with 8 dummy cycles: %s\n", (stats.mapErrors != 0U) ? "rejected" : "NOT DETECTED");
+    failures += (stats.mapErrors != 0U) ? 0 : 1;
+
+    /* Log ring of the Boot over the whole run */
+    Log_Flush(LOG_BLOCKING_TIMEOUT);
+    Log_GetStats(&logStats);
+    printf("  Boot log: %lu bytes, %lu dropped, ring peak %lu\n", (unsigned long)logStats.written,
+           (unsigned long)logStats.dropped, (unsigned long)logStats.highWater);
+    failures += (logStats.dropped == 0U) ? 0 : 1;
+
+    NorSim_ResetStats();
+    return failures;
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+int main(int argc, char **argv)
+{
+    const char *path = "nor_sim.bin";
+    Port_Config_t portConfig = { PORT_TIME_VIRTUAL, 1000U, stdout };    /* each HAL_GetTick costs 1 us */
+    uint32_t timeScale = 100U;
+    int failures = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:k:t:T:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': path = optarg; break;
+        case 'k': simClock = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't': timeScale = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'T':
+            portConfig.uart = fopen(optarg, "wb");
+            portConfig.uartRaw = 1U;
+            simTrace = 1;
+            if (portConfig.uart == NULL)
+            {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-f array_file] [-k kernel_clock_hz] [-t time_scale_percent]"
+                    " [-T capture_file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((simClock == 0U) || (Port_Open(&portConfig) != 0) || (NorSim_Open(path, simClock, timeScale) != 0))
+    {
+        return 1;
+    }
+    Log_Init(&huart4);
+    printf("XSPI kernel clock %lu MHz, program and erase at %lu%% of the typical times, array %s\n\n",
+           (unsigned long)(simClock / 1000000U), (unsigned long)timeScale, path);
+
+    printf("1. cold power-on\n");
+    failures += Sim_CheckInit("SFDP discovery", 0U);
+
+    printf("2. power-on, backup SRAM kept\n");
+    NorSim_PowerOn(1);
+    failures += Sim_CheckInit("discovery from the SFDP cache", 1U);
+
+    /* The cache restore resets the memory in 1S1S1S: ignored in octal DTR,
+     * the ID check fails and the discovery runs again from 8D8D8D */
+    printf("3. MCU reset, memory left in octal DTR\n");
+    NorSim_McuReset();
+    failures += Sim_CheckInit("full discovery after a warm reset", 0U);
+
+    printf("4. ExtMem Manager\n");
+    failures += Sim_ExtMemReadWrite();
+
+    printf("5. Boot image programming\n");
+    failures += Sim_BootWrite();
+
+    printf("6. Boot update check\n");
+    failures += Sim_BootUpdate();
+
+    printf("7. ExtMemLoader\n");
+    NorSim_PowerOn(0);
+    failures += Sim_Loader();
+
+    printf("8. model checks\n");
+    failures += Sim_ModelCheck();
+
+    NorSim_Close();
+    Port_Close();
+    if (simTrace)
+    {
+        (void)fclose(portConfig.uart);
+    }
+    printf("\n%s\n", (failures == 0) ? "all scenarios passed" : "FAILED");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file    nor_sim.h
+ * @brief   MX25UW25645G model behind the SAL XSPI interface, host only
+ ******************************************************************************
+ */
+
+#ifndef NOR_SIM_H
+#define NOR_SIM_H
+
+#include <stdint.h>
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef struct {
+    uint32_t commands;          /* transactions seen on the bus */
+    uint32_t mismatched;        /* sent in another protocol than the memory mode: ignored */
+    uint32_t rejected;          /* program, erase or register write without WEL */
+    uint32_t corrupted;         /* array or SFDP reads returned with bad data */
+    uint32_t busyViolations;    /* commands other than a status read while WIP is set */
+    uint32_t timeouts;          /* status pollings that never matched */
+    uint32_t mapErrors;         /* mapped mode entered with a bad read command or while busy */
+    uint32_t programs;          /* page programs */
+    uint32_t erases;            /* sector, block and chip erases */
+} NorSim_Stats_t;
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Map the host pages of the model and open the flash array file
+ * @param  path: array file, created erased if missing
+ * @param  kernelClock: XSPI kernel clock in Hz
+ * @param  timeScale: program and erase times in percent of the typical times
+ * @retval 0 on success
+ */
+int NorSim_Open(const char *path, uint32_t kernelClock, uint32_t timeScale);
+
+void NorSim_Close(void);
+
+/**
+ * @brief  Power cycle: the memory is back in SPI mode with its default
+ *         configuration, the XSPI registers and handle and the port are reset
+ * @param  keepBackupSram: 1 if VBAT keeps the backup SRAM and registers
+ */
+void NorSim_PowerOn(int keepBackupSram);
+
+/**
+ * @brief  Reset of the MCU only: the memory keeps its mode and configuration
+ */
+void NorSim_McuReset(void);
+
+/**
+ * @brief  Wait for the XSPI interrupt: the model time jumps to the end of the
+ *         asynchronous transaction, then its SAL event is delivered
+ */
+void NorSim_WaitForInterrupt(void);
+
+uint64_t NorSim_NowNs(void);
+void NorSim_GetStats(NorSim_Stats_t *stats);
+void NorSim_ResetStats(void);
+const char *NorSim_ModeName(void);
+
+/**
+ * @brief  Read dummy cycles set in the memory configuration register 2
+ */
+uint8_t NorSim_DummyCycles(void);
+
+/**
+ * @brief  Direct view of the flash array, for the checks of the scenarios
+ */
+const uint8_t *NorSim_Array(void);
+
+#endif /* NOR_SIM_H */
@@ -0,0 +1,1846 @@
+/**
+ ******************************************************************************
+ * @file    sal_xspi_sim.c
+ * @brief   SAL XSPI on a model of the MX25UW25645G, for nor_sim
+ *
+ * Replaces Middlewares/ST/STM32_ExtMem_Manager/sal/stm32_sal_xspi.c on the
+ * host. Every SAL_XSPI_* function builds its command as the SAL of the
+ * board does, then the command goes to the memory model instead of the
+ * XSPI. The precompiled commands are decoded back from their register
+ * values, the HAL constants being the CCR fields.
+ *
+ * Host mapping, at the addresses of the device:
+ *  - XSPI2 registers: a zeroed page the SAL and the driver read and write
+ *  - backup SRAM: the SFDP cache and the timing store
+ *  - XSPI2 window: the flash array file mapped a second time, readable
+ *    only while the mapped mode is enabled
+ *
+ * Timing: the model time only moves with the bus. Every transaction costs
+ * its instruction, address, dummy and data cycles at the memory clock set
+ * in DCR2, plus the chip select high time. A status polling costs one
+ * status read and the SAL polling interval per poll. Page program and
+ * erase keep the memory busy for their typical datasheet time. The
+ * asynchronous functions only schedule their event, NorSim_WaitForInterrupt
+ * (the __WFI of the port) moves the time to it. Mapped reads are not timed.
+ * The model time is the virtual time of tools/port, which DWT->CYCCNT and
+ * HAL_GetTick follow.
+ *
+ * Checks, a failed check corrupts the transfer like the memory would:
+ *  - SPI mode takes 1S commands, DOPI mode 8D commands with the inverse of
+ *    the opcode as extension; other commands are ignored, reads return 0x00
+ *  - array reads need the dummy cycles of the opcode (SPI) or of CR2
+ *    (DOPI), a wrong count moves the data; SFDP reads need 8 (SPI) or 20
+ *    (DOPI) dummy cycles
+ *  - array reads need a clock inside the limit of the opcode and of the
+ *    dummy cycles, and DQS on DTR reads above SIM_NO_DQS_MAX_HZ
+ *  - program, erase and register writes need the write enable latch
+ *  - only a status read is allowed while the memory is busy
+ ******************************************************************************
+ */
+
+#include "stm32_sal_xspi_api.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*============================================================================*/
+/*                          MEMORY MODEL                                      */
+/*============================================================================*/
+
+#define SIM_FLASH_SIZE          0x02000000U     /* 256 Mbit */
+#define SIM_PAGE_SIZE           256U
+#define SIM_SFDP_SIZE           256U
+#define SIM_HOST_PAGE           0x1000U
+#define SIM_BKPSRAM_SIZE        0x1000U
+#define SIM_CS_HIGH_CYCLES      2U              /* ChipSelectHighTimeCycle of MX_XSPI2_Init */
+#define SIM_POLL_INTERVAL       0x10U           /* IntervalTime of SAL_XSPI_CheckStatusRegister */
+#define SIM_ASYNC_TIMEOUT_NS    1000000000ULL   /* interrupt polling still not matching this long after the end of busy */
+
+/* Typical datasheet times */
+#define SIM_TPP_NS              150000ULL       /* page program */
+#define SIM_TSE_NS              25000000ULL     /* 4KB sector erase */
+#define SIM_TBE32_NS            150000000ULL    /* 32KB block erase */
+#define SIM_TBE_NS              220000000ULL    /* 64KB block erase */
+#define SIM_TCE_NS              75000000000ULL  /* chip erase */
+
+#define SIM_SPI_READ_MAX_HZ     50000000U       /* READ, no dummy cycle */
+#define SIM_SPI_FAST_MAX_HZ     133000000U      /* FAST_READ and SFDP in SPI mode */
+#define SIM_SPI_FAST_DUMMY      8U
+#define SIM_OPI_SFDP_DUMMY      20U
+#define SIM_NO_DQS_MAX_HZ       133000000U
+
+#define SIM_STATUS_WIP          0x01U
+#define SIM_STATUS_WEL          0x02U
+
+#define SIM_CR2_MODE            0x00000000U     /* CR2 address of the I/O mode */
+#define SIM_CR2_DUMMY           0x00000300U     /* CR2 address of the read dummy cycles */
+#define SIM_CR2_SPI             0x00U
+#define SIM_CR2_DOPI            0x02U
+
+typedef enum {
+    SIM_MODE_SPI,               /* 1S1S1S */
+    SIM_MODE_DOPI               /* 8D8D8D */
+} Sim_Mode_t;
+
+/* Read dummy cycles selected by CR2 0x300 and the clock they allow */
+static const struct {
+    uint8_t  dummy;
+    uint32_t maxHz;
+} simCr2Dummy[8] = {
+    { 20U, 200000000U }, { 18U, 200000000U }, { 16U, 166000000U }, { 14U, 133000000U },
+    { 12U, 120000000U }, { 10U, 100000000U }, {  8U,  84000000U }, {  6U,  66000000U },
+};
+
+XSPI_HandleTypeDef hxspi2;
+
+static uint8_t *flash;          /* model view of the array */
+static uint8_t *window;         /* CPU view, at the XSPI2 window */
+static int      flashFd = -1;
+static uint8_t  simSfdp[SIM_SFDP_SIZE];
+static Sim_Mode_t simMode;
+static uint8_t  simWel;
+static uint8_t  simCr2DummyIndex;
+static uint8_t  simResetEnabled;
+static uint64_t simBusyUntilNs;
+static uint32_t simKernelClock = 200000000U;
+static uint32_t simTimeScale = 100U;
+static NorSim_Stats_t simStats;
+
+/* Event of the ongoing asynchronous transaction */
+static SAL_XSPI_ObjectTypeDef *simAsyncObject;
+static struct {
+    uint8_t  armed;
+    uint64_t at;
+    SAL_XSPI_EventTypeDef event;
+} simEvent;
+
+static uint32_t Sim_Clock(void)
+{
+    uint32_t prescaler = (XSPI2->DCR2 & XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos;
+    return simKernelClock / (prescaler + 1U);
+}
+
+static uint64_t Sim_Ns(uint64_t cycles)
+{
+    return (cycles * 1000000000ULL) / Sim_Clock();
+}
+
+static uint64_t Sim_Scaled(uint64_t ns)
+{
+    return (ns * simTimeScale) / 100U;
+}
+
+static uint32_t Sim_Lines(uint32_t mode, uint32_t one, uint32_t two, uint32_t four, uint32_t eight)
+{
+    if (mode == one)   return 1U;
+    if (mode == two)   return 2U;
+    if (mode == four)  return 4U;
+    if (mode == eight) return 8U;
+    return 0U;
+}
+
+/**
+ * @brief  Bus cycles of a phase of 'bits' bits
+ */
+static uint64_t Sim_PhaseCycles(uint64_t bits, uint32_t lines, uint32_t dtr)
+{
+    uint64_t perCycle = (uint64_t)lines * (dtr ? 2U : 1U);
+    return (lines == 0U) ? 0U : ((bits + perCycle - 1U) / perCycle);
+}
+
+/**
+ * @brief  Cycles of the command, address and dummy phases
+ */
+static uint64_t Sim_HeaderCycles(const XSPI_RegularCmdTypeDef *cmd)
+{
+    uint32_t iLines = Sim_Lines(cmd->InstructionMode, HAL_XSPI_INSTRUCTION_1_LINE, HAL_XSPI_INSTRUCTION_2_LINES,
+                                HAL_XSPI_INSTRUCTION_4_LINES, HAL_XSPI_INSTRUCTION_8_LINES);
+    uint32_t aLines = Sim_Lines(cmd->AddressMode, HAL_XSPI_ADDRESS_1_LINE, HAL_XSPI_ADDRESS_2_LINES,
+                                HAL_XSPI_ADDRESS_4_LINES, HAL_XSPI_ADDRESS_8_LINES);
+    uint32_t iBits = (cmd->InstructionWidth == HAL_XSPI_INSTRUCTION_16_BITS) ? 16U : 8U;
+    uint32_t aBits = (cmd->AddressWidth == HAL_XSPI_ADDRESS_32_BITS) ? 32U : 24U;
+
+    return SIM_CS_HIGH_CYCLES
+           + Sim_PhaseCycles(iBits, iLines, cmd->InstructionDTRMode == HAL_XSPI_INSTRUCTION_DTR_ENABLE)
+           + Sim_PhaseCycles(aBits, aLines, cmd->AddressDTRMode == HAL_XSPI_ADDRESS_DTR_ENABLE)
+           + cmd->DummyCycles;
+}
+
+static uint32_t Sim_DataLines(const XSPI_RegularCmdTypeDef *cmd)
+{
+    return Sim_Lines(cmd->DataMode, HAL_XSPI_DATA_1_LINE, HAL_XSPI_DATA_2_LINES,
+                     HAL_XSPI_DATA_4_LINES, HAL_XSPI_DATA_8_LINES);
+}
+
+static uint64_t Sim_DataCycles(const XSPI_RegularCmdTypeDef *cmd, uint32_t size)
+{
+    return Sim_PhaseCycles((uint64_t)size * 8U, Sim_DataLines(cmd), cmd->DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE);
+}
+
+/**
+ * @brief  Opcode of a command the memory takes in its current mode
+ * @retval 0 if a phase does not fit the mode, the memory ignores the command
+ */
+static int Sim_Opcode(const XSPI_RegularCmdTypeDef *cmd, uint8_t *op)
+{
+    if (simMode == SIM_MODE_SPI)
+    {
+        if ((cmd->InstructionMode != HAL_XSPI_INSTRUCTION_1_LINE)
+            || (cmd->InstructionWidth != HAL_XSPI_INSTRUCTION_8_BITS)
+            || (cmd->InstructionDTRMode == HAL_XSPI_INSTRUCTION_DTR_ENABLE)
+            || ((cmd->AddressMode != HAL_XSPI_ADDRESS_NONE)
+                && ((cmd->AddressMode != HAL_XSPI_ADDRESS_1_LINE) || (cmd->AddressDTRMode == HAL_XSPI_ADDRESS_DTR_ENABLE)))
+            || ((cmd->DataMode != HAL_XSPI_DATA_NONE)
+                && ((cmd->DataMode != HAL_XSPI_DATA_1_LINE) || (cmd->DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE))))
+        {
+            return 0;
+        }
+        *op = (uint8_t)cmd->Instruction;
+        return 1;
+    }
+
+    /* DOPI: 8 lines DTR, command extension is the inverse of the command */
+    *op = (uint8_t)(cmd->Instruction >> 8);
+    if ((cmd->InstructionMode != HAL_XSPI_INSTRUCTION_8_LINES)
+        || (cmd->InstructionWidth != HAL_XSPI_INSTRUCTION_16_BITS)
+        || (cmd->InstructionDTRMode != HAL_XSPI_INSTRUCTION_DTR_ENABLE)
+        || ((uint8_t)cmd->Instruction != (uint8_t)~*op)
+        || ((cmd->AddressMode != HAL_XSPI_ADDRESS_NONE)
+            && ((cmd->AddressMode != HAL_XSPI_ADDRESS_8_LINES) || (cmd->AddressDTRMode != HAL_XSPI_ADDRESS_DTR_ENABLE)))
+        || ((cmd->DataMode != HAL_XSPI_DATA_NONE)
+            && ((cmd->DataMode != HAL_XSPI_DATA_8_LINES) || (cmd->DataDTRMode != HAL_XSPI_DATA_DTR_ENABLE))))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  Address bytes the opcode takes, 0 if it has no address
+ */
+static uint32_t Sim_AddressBytes(uint8_t op)
+{
+    if (simMode == SIM_MODE_DOPI)
+    {
+        return 4U;
+    }
+    switch (op)
+    {
+    case 0x03: case 0x0B: case 0x02: case 0x20: case 0x52: case 0xD8: case 0x5A:
+        return 3U;
+    case 0x13: case 0x0C: case 0x12: case 0x21: case 0x5C: case 0xDC: case 0x71: case 0x72:
+        return 4U;
+    default:
+        return 0U;
+    }
+}
+
+static uint8_t Sim_Status(uint64_t at)
+{
+    /* WEL stays set until the end of the program or erase */
+    if (at < simBusyUntilNs)
+    {
+        return SIM_STATUS_WIP | SIM_STATUS_WEL;
+    }
+    return simWel ? SIM_STATUS_WEL : 0U;
+}
+
+/**
+ * @brief  Byte of the data stream starting at 'offset', 'bit' bits later
+ *         (earlier if negative: the memory still drives the dummy cycles high)
+ */
+static uint8_t Sim_StreamByte(const uint8_t *src, uint32_t size, uint32_t offset, int64_t bit)
+{
+    uint8_t value = 0U;
+
+    for (uint32_t i = 0; i < 8U; i++)
+    {
+        int64_t pos = bit + (int64_t)i;
+        uint8_t b = 1U;
+
+        if (pos >= 0)
+        {
+            uint64_t index = (uint64_t)offset + (uint64_t)(pos / 8);
+            if (size == SIM_FLASH_SIZE)
+            {
+                index %= SIM_FLASH_SIZE;
+            }
+            b = (index < size) ? (uint8_t)((src[index] >> (7U - (uint32_t)(pos % 8))) & 1U) : 1U;
+        }
+        value = (uint8_t)((value << 1) | b);
+    }
+    return value;
+}
+
+/**
+ * @brief  Data of a read as the XSPI samples them
+ * @param  need: dummy cycles the memory waits, the data move by the difference
+ * @param  maxHz: clock limit of the read
+ */
+static void Sim_ReadOut(const XSPI_RegularCmdTypeDef *cmd, const uint8_t *src, uint32_t size, uint32_t offset,
+                        uint8_t need, uint32_t maxHz, uint8_t *out, uint32_t len)
+{
+    uint32_t dtr = (cmd->DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) ? 1U : 0U;
+    int64_t shift = ((int64_t)cmd->DummyCycles - need) * (int64_t)Sim_DataLines(cmd) * (dtr ? 2 : 1);
+    uint32_t clock = Sim_Clock();
+    int sampling = (clock > maxHz) || (dtr && (clock > SIM_NO_DQS_MAX_HZ) && (cmd->DQSMode != HAL_XSPI_DQS_ENABLE));
+
+    if ((cmd->DQSMode == HAL_XSPI_DQS_ENABLE) && (shift < 0))
+    {
+        /* The XSPI samples on the strobe: it waits for the first data */
+        shift = 0;
+    }
+
+    if ((shift == 0) && (size == SIM_FLASH_SIZE))
+    {
+        uint32_t first = ((offset + len) <= SIM_FLASH_SIZE) ? len : (SIM_FLASH_SIZE - offset);
+        memcpy(out, &src[offset], first);
+        memcpy(&out[first], src, len - first);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < len; i++)
+        {
+            out[i] = Sim_StreamByte(src, size, offset, ((int64_t)i * 8) + shift);
+        }
+    }
+    if (sampling)
+    {
+        /* Sampled in the wrong data eye */
+        for (uint32_t i = 0; i < len; i++)
+        {
+            out[i] = (uint8_t)((out[i] << 1) | (out[i] >> 7));
+        }
+    }
+    if ((shift != 0) || sampling)
+    {
+        simStats.corrupted++;
+    }
+}
+
+/**
+ * @brief  Dummy cycles and clock limit of an array read opcode
+ * @retval 0 if the opcode is not an array read in the current mode
+ */
+static int Sim_ArrayRead(uint8_t op, uint8_t *need, uint32_t *maxHz)
+{
+    if (simMode == SIM_MODE_DOPI)
+    {
+        *need = simCr2Dummy[simCr2DummyIndex].dummy;
+        *maxHz = simCr2Dummy[simCr2DummyIndex].maxHz;
+        return (op == 0xEEU) ? 1 : 0;
+    }
+    switch (op)
+    {
+    case 0x03: case 0x13:   /* READ, READ4B */
+        *need = 0U;
+        *maxHz = SIM_SPI_READ_MAX_HZ;
+        return 1;
+    case 0x0B: case 0x0C:   /* FAST_READ, FAST_READ4B */
+        *need = SIM_SPI_FAST_DUMMY;
+        *maxHz = SIM_SPI_FAST_MAX_HZ;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void Sim_Program(uint32_t address, const uint8_t *data, uint32_t len, uint64_t end)
+{
+    if (!simWel)
+    {
+        simStats.rejected++;
+        return;
+    }
+    /* Page program: wraps inside the page, only clears bits */
+    address &= SIM_FLASH_SIZE - 1U;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        uint32_t pos = (address & ~(SIM_PAGE_SIZE - 1U)) | ((address + i) & (SIM_PAGE_SIZE - 1U));
+        flash[pos] &= data[i];
+    }
+    simWel = 0U;
+    simBusyUntilNs = end + Sim_Scaled(SIM_TPP_NS);
+    simStats.programs++;
+}
+
+static void Sim_Erase(uint32_t address, uint32_t size, uint64_t duration, uint64_t end)
+{
+    if (!simWel)
+    {
+        simStats.rejected++;
+        return;
+    }
+    address &= (SIM_FLASH_SIZE - 1U) & ~(size - 1U);
+    memset(&flash[address], 0xFF, size);
+    simWel = 0U;
+    simBusyUntilNs = end + Sim_Scaled(duration);
+    simStats.erases++;
+}
+
+static void Sim_WriteCr2(uint32_t address, uint8_t value)
+{
+    if (!simWel)
+    {
+        simStats.rejected++;
+        return;
+    }
+    simWel = 0U;
+    if (address == SIM_CR2_MODE)
+    {
+        if (value == SIM_CR2_DOPI)
+        {
+            simMode = SIM_MODE_DOPI;
+        }
+        else if (value == SIM_CR2_SPI)
+        {
+            simMode = SIM_MODE_SPI;
+        }
+        else
+        {
+            /* STR OPI is not modelled */
+            simStats.rejected++;
+        }
+    }
+    else if (address == SIM_CR2_DUMMY)
+    {
+        simCr2DummyIndex = value & 0x07U;
+    }
+    else
+    {
+        /* Other CR2 fields are not modelled */
+    }
+}
+
+static uint8_t Sim_ReadCr2(uint32_t address)
+{
+    if (address == SIM_CR2_MODE)
+    {
+        return (simMode == SIM_MODE_DOPI) ? SIM_CR2_DOPI : SIM_CR2_SPI;
+    }
+    return (address == SIM_CR2_DUMMY) ? simCr2DummyIndex : 0x00U;
+}
+
+/**
+ * @brief  Register value output by the memory: repeated in SPI mode, every
+ *         byte twice in DOPI mode (one per clock edge)
+ */
+static void Sim_RegisterOut(const uint8_t *value, uint32_t count, uint8_t *out, uint32_t len)
+{
+    uint32_t div = (simMode == SIM_MODE_DOPI) ? 2U : 1U;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        out[i] = value[(i / div) % count];
+    }
+}
+
+static void Sim_Reset(void)
+{
+    simMode = SIM_MODE_SPI;
+    simWel = 0U;
+    simCr2DummyIndex = 0U;
+    simResetEnabled = 0U;
+}
+
+/**
+ * @brief  One transaction on the bus, its effects start at its end
+ * @param  rx: data read, NULL for a write
+ * @param  tx: data written, NULL for a read
+ * @retval duration of the transaction
+ */
+static uint64_t Sim_Execute(const XSPI_RegularCmdTypeDef *cmd, uint8_t *rx, const uint8_t *tx)
+{
+    static const uint8_t id[3] = { 0xC2, 0x81, 0x39 };
+    uint32_t len = (cmd->DataMode == HAL_XSPI_DATA_NONE) ? 0U : cmd->DataLength;
+    uint64_t duration = Sim_Ns(Sim_HeaderCycles(cmd) + Sim_DataCycles(cmd, len));
+    uint64_t end = Port_NowNs() + duration;
+    uint32_t address = cmd->Address;
+    uint32_t addressBytes;
+    uint8_t need;
+    uint32_t maxHz;
+    uint8_t value;
+    uint8_t op;
+
+    simStats.commands++;
+    if (rx != NULL)
+    {
+        memset(rx, 0x00, len);
+    }
+    if (!Sim_Opcode(cmd, &op))
+    {
+        simStats.mismatched++;
+        simResetEnabled = 0U;
+        return duration;
+    }
+    if ((Port_NowNs() < simBusyUntilNs) && (op != 0x05U))
+    {
+        simStats.busyViolations++;
+        return duration;
+    }
+    addressBytes = Sim_AddressBytes(op);
+    if ((cmd->AddressMode != HAL_XSPI_ADDRESS_NONE) && (addressBytes != 0U)
+        && ((cmd->AddressWidth == HAL_XSPI_ADDRESS_32_BITS) != (addressBytes == 4U)))
+    {
+        /* The memory takes another address length than the one sent */
+        simStats.rejected++;
+        return duration;
+    }
+
+    if ((op == 0x99U) && simResetEnabled)
+    {
+        Sim_Reset();
+        return duration;
+    }
+    simResetEnabled = (op == 0x66U) ? 1U : 0U;
+
+    if ((rx != NULL) && Sim_ArrayRead(op, &need, &maxHz))
+    {
+        Sim_ReadOut(cmd, flash, SIM_FLASH_SIZE, address & (SIM_FLASH_SIZE - 1U), need, maxHz, rx, len);
+        return duration;
+    }
+
+    switch (op)
+    {
+    case 0x66:  /* RSTEN */
+        break;
+    case 0x06:  /* WREN */
+        simWel = 1U;
+        break;
+    case 0x04:  /* WRDI */
+        simWel = 0U;
+        break;
+    case 0x05:  /* RDSR */
+        if (rx != NULL)
+        {
+            value = Sim_Status(Port_NowNs());
+            Sim_RegisterOut(&value, 1U, rx, len);
+        }
+        break;
+    case 0x9F:  /* RDID */
+        if (rx != NULL)
+        {
+            Sim_RegisterOut(id, sizeof(id), rx, len);
+        }
+        break;
+    case 0x5A:  /* RDSFDP */
+        if (rx != NULL)
+        {
+            need = (simMode == SIM_MODE_DOPI) ? SIM_OPI_SFDP_DUMMY : SIM_SPI_FAST_DUMMY;
+            maxHz = (simMode == SIM_MODE_DOPI) ? simCr2Dummy[0].maxHz : SIM_SPI_FAST_MAX_HZ;
+            Sim_ReadOut(cmd, simSfdp, SIM_SFDP_SIZE, address, need, maxHz, rx, len);
+        }
+        break;
+    case 0x71:  /* RDCR2 */
+        if (rx != NULL)
+        {
+            value = Sim_ReadCr2(address);
+            Sim_RegisterOut(&value, 1U, rx, len);
+        }
+        break;
+    case 0x72:  /* WRCR2, the SPI form may carry its address in the data */
+        if ((tx != NULL) && (cmd->AddressMode == HAL_XSPI_ADDRESS_NONE) && (len >= 5U))
+        {
+            address = ((uint32_t)tx[0] << 24) | ((uint32_t)tx[1] << 16) | ((uint32_t)tx[2] << 8) | tx[3];
+            Sim_WriteCr2(address, tx[4]);
+        }
+        else if ((tx != NULL) && (cmd->AddressMode != HAL_XSPI_ADDRESS_NONE) && (len >= 1U))
+        {
+            Sim_WriteCr2(address, tx[0]);
+        }
+        else
+        {
+            simStats.rejected++;
+        }
+        break;
+    case 0x02:  /* PP */
+    case 0x12:  /* PP4B */
+        if ((tx != NULL) && (len != 0U))
+        {
+            Sim_Program(address, tx, len, end);
+        }
+        break;
+    case 0x20:  /* SE */
+    case 0x21:  /* SE4B */
+        Sim_Erase(address, 0x1000U, SIM_TSE_NS, end);
+        break;
+    case 0x52:  /* BE32K */
+    case 0x5C:  /* BE32K4B */
+        Sim_Erase(address, 0x8000U, SIM_TBE32_NS, end);
+        break;
+    case 0xD8:  /* BE */
+    case 0xDC:  /* BE4B */
+        Sim_Erase(address, 0x10000U, SIM_TBE_NS, end);
+        break;
+    case 0x60:  /* CE */
+    case 0xC7:
+        Sim_Erase(0U, SIM_FLASH_SIZE, SIM_TCE_NS, end);
+        break;
+    default:
+        /* Not an instruction of the memory */
+        simStats.mismatched++;
+        break;
+    }
+    return duration;
+}
+
+/**
+ * @brief  Automatic status polling, as the XSPI runs it
+ * @param  at: time of the matching read, or the deadline
+ * @retval 1 if the status matched before the deadline
+ */
+static int Sim_Poll(const XSPI_RegularCmdTypeDef *cmd, uint8_t match, uint8_t mask, uint64_t deadline, uint64_t *at)
+{
+    uint64_t read = Sim_Ns(Sim_HeaderCycles(cmd) + Sim_DataCycles(cmd, 1U));
+    uint64_t period = read + Sim_Ns(SIM_POLL_INTERVAL);
+    uint64_t t = Port_NowNs() + read;
+    int status;
+    uint8_t op;
+
+    simStats.commands++;
+    status = Sim_Opcode(cmd, &op) && (op == 0x05U);
+    if (!status)
+    {
+        /* The memory does not answer: the XSPI reads 0x00 */
+        simStats.mismatched++;
+    }
+    while (t <= deadline)
+    {
+        if (((status ? Sim_Status(t) : 0U) & mask) == match)
+        {
+            *at = t;
+            return 1;
+        }
+        if (t >= simBusyUntilNs)
+        {
+            /* The status does not change any more */
+            break;
+        }
+        /* Skip the polls that cannot match */
+        t += ((simBusyUntilNs - t + period - 1U) / period) * period;
+    }
+    *at = deadline;
+    return 0;
+}
+
+/**
+ * @brief  A CPU access to the window: it can only read in mapped mode
+ */
+static void Sim_WindowFault(int sig, siginfo_t *info, void *context)
+{
+    static const char msg[] = "nor_sim: XSPI2 window accessed while mapped mode is off\n";
+    uintptr_t addr = (uintptr_t)info->si_addr;
+
+    (void)context;
+    if ((addr >= XSPI2_BASE) && (addr < (XSPI2_BASE + SIM_FLASH_SIZE)))
+    {
+        (void)write(STDERR_FILENO, msg, sizeof(msg) - 1U);
+        _exit(1);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/*============================================================================*/
+/*                          HAL LEVEL                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Command with its data phase, the call returns at its end
+ */
+static HAL_StatusTypeDef Sim_Transfer(XSPI_HandleTypeDef *hxspi, const XSPI_RegularCmdTypeDef *cmd,
+                                      uint8_t *rx, const uint8_t *tx)
+{
+    if (hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    Port_AdvanceNs(Sim_Execute(cmd, rx, tx));
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef Sim_Polling(XSPI_HandleTypeDef *hxspi, const XSPI_RegularCmdTypeDef *cmd,
+                                     uint8_t match, uint8_t mask, uint32_t timeout)
+{
+    uint64_t at;
+
+    if (hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    if (!Sim_Poll(cmd, match, mask, Port_NowNs() + ((uint64_t)timeout * 1000000ULL), &at))
+    {
+        simStats.timeouts++;
+        Port_AdvanceTo(at);
+        return HAL_TIMEOUT;
+    }
+    Port_AdvanceTo(at);
+    return HAL_OK;
+}
+
+#if EXTMEM_ASYNC == 1
+static void Sim_Arm(XSPI_HandleTypeDef *hxspi, uint32_t state, uint64_t at, SAL_XSPI_EventTypeDef event)
+{
+    hxspi->State = state;
+    simEvent.armed = 1U;
+    simEvent.at = at;
+    simEvent.event = event;
+}
+#endif /* EXTMEM_ASYNC == 1 */
+
+static HAL_StatusTypeDef Sim_Abort(XSPI_HandleTypeDef *hxspi)
+{
+    if (hxspi->State == HAL_XSPI_STATE_BUSY_MEM_MAPPED)
+    {
+        (void)mprotect(window, SIM_FLASH_SIZE, PROT_NONE);
+    }
+    simEvent.armed = 0U;
+    hxspi->State = HAL_XSPI_STATE_READY;
+    return HAL_OK;
+}
+
+static uint16_t XSPI_FormatCommand(uint8_t CommandExtension, uint32_t InstructionWidth, uint8_t Command)
+{
+    uint16_t retr = Command;
+
+    if (InstructionWidth == HAL_XSPI_INSTRUCTION_16_BITS)
+    {
+        retr = (uint16_t)(((uint16_t)Command << 8) | ((CommandExtension == 1U) ? (uint8_t)~Command : Command));
+    }
+    return retr;
+}
+
+static void XSPI_ReadCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                             uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd)
+{
+    *Cmd = SalXspi->Commandbase;
+    Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+    Cmd->Address     = Address;
+    Cmd->DataLength  = DataSize;
+    switch (SalXspi->PhyLink)
+    {
+    case PHY_LINK_4S4D4D:
+        Cmd->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
+        Cmd->DataDTRMode    = HAL_XSPI_DATA_DTR_ENABLE;
+        Cmd->DummyCycles    = SalXspi->DTRDummyCycle;
+        break;
+    case PHY_LINK_1S2S2S:
+        Cmd->AddressMode = HAL_XSPI_ADDRESS_2_LINES;
+        Cmd->DataMode    = HAL_XSPI_DATA_2_LINES;
+        break;
+    case PHY_LINK_1S1S2S:
+        Cmd->DataMode = HAL_XSPI_DATA_2_LINES;
+        break;
+    default:
+        break;
+    }
+}
+
+static void XSPI_WriteCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                              uint32_t DataSize, XSPI_RegularCmdTypeDef *Cmd)
+{
+    *Cmd = SalXspi->Commandbase;
+    Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+    Cmd->Address     = Address;
+    Cmd->DataLength  = DataSize;
+    Cmd->DummyCycles = 0U;
+    Cmd->DQSMode     = HAL_XSPI_DQS_DISABLE;
+}
+
+static void XSPI_StatusCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                               XSPI_RegularCmdTypeDef *Cmd)
+{
+    *Cmd = SalXspi->Commandbase;
+    Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+    Cmd->DataLength  = 1U;
+    Cmd->DQSMode     = HAL_XSPI_DQS_DISABLE;
+    if (Cmd->InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
+    {
+        Cmd->DataMode    = HAL_XSPI_DATA_1_LINE;
+        Cmd->AddressMode = HAL_XSPI_ADDRESS_NONE;
+        Cmd->DummyCycles = 0U;
+    }
+    if (Cmd->DataMode == HAL_XSPI_DATA_8_LINES)
+    {
+        Cmd->AddressMode  = HAL_XSPI_ADDRESS_8_LINES;
+        Cmd->AddressWidth = HAL_XSPI_ADDRESS_32_BITS;
+        Cmd->Address      = Address;
+    }
+}
+
+static void XSPI_AddressCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                XSPI_RegularCmdTypeDef *Cmd)
+{
+    *Cmd = SalXspi->Commandbase;
+    Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+    if (Cmd->InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
+    {
+        Cmd->AddressMode = HAL_XSPI_ADDRESS_1_LINE;
+    }
+    Cmd->Address     = Address;
+    Cmd->DummyCycles = 0U;
+    Cmd->DataMode    = HAL_XSPI_DATA_NONE;
+    Cmd->DQSMode     = HAL_XSPI_DQS_DISABLE;
+}
+
+static void XSPI_InstructionCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t DataSize,
+                                    XSPI_RegularCmdTypeDef *Cmd)
+{
+    *Cmd = SalXspi->Commandbase;
+    Cmd->Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, Cmd->InstructionWidth, Command);
+    Cmd->AddressMode = HAL_XSPI_ADDRESS_NONE;
+    Cmd->DummyCycles = 0U;
+    Cmd->DataLength  = DataSize;
+    Cmd->DQSMode     = HAL_XSPI_DQS_DISABLE;
+    if (DataSize == 0U)
+    {
+        Cmd->DataMode = HAL_XSPI_DATA_NONE;
+    }
+}
+
+static uint8_t XSPI_ReadDelayType(const SAL_XSPI_ObjectTypeDef *SalXspi, volatile uint32_t **Reg)
+{
+    if (SalXspi->Commandbase.DQSMode == HAL_XSPI_DQS_ENABLE)
+    {
+        *Reg = &SalXspi->hxspi->Instance->CALSIR;
+        return 1U;
+    }
+    if ((SalXspi->Commandbase.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) || (SalXspi->PhyLink == PHY_LINK_4S4D4D))
+    {
+        *Reg = &SalXspi->hxspi->Instance->CALMR;
+        return 1U;
+    }
+    return 0U;
+}
+
+/**
+ * @brief  Command of a precompiled descriptor, decoded from its register values
+ */
+static void Sim_Decode(const SAL_XSPI_CommandDescTypeDef *Desc, uint32_t Address, uint32_t DataSize,
+                       XSPI_RegularCmdTypeDef *Cmd)
+{
+    memset(Cmd, 0, sizeof(*Cmd));
+    Cmd->OperationType      = HAL_XSPI_OPTYPE_COMMON_CFG;
+    Cmd->Instruction        = Desc->IR;
+    Cmd->InstructionMode    = Desc->CCR & XSPI_CCR_IMODE;
+    Cmd->InstructionWidth   = Desc->CCR & XSPI_CCR_ISIZE;
+    Cmd->InstructionDTRMode = Desc->CCR & XSPI_CCR_IDTR;
+    Cmd->AddressMode        = HAL_XSPI_ADDRESS_NONE;
+    Cmd->DataMode           = HAL_XSPI_DATA_NONE;
+    if (Desc->Address == 1U)
+    {
+        Cmd->AddressMode    = Desc->CCR & XSPI_CCR_ADMODE;
+        Cmd->AddressWidth   = Desc->CCR & XSPI_CCR_ADSIZE;
+        Cmd->AddressDTRMode = Desc->CCR & XSPI_CCR_ADDTR;
+        Cmd->Address        = Address;
+    }
+    if (Desc->Data == 1U)
+    {
+        Cmd->DataMode    = Desc->CCR & XSPI_CCR_DMODE;
+        Cmd->DataDTRMode = Desc->CCR & XSPI_CCR_DDTR;
+        Cmd->DataLength  = DataSize;
+    }
+    Cmd->DummyCycles = Desc->TCR & XSPI_TCR_DCYC;
+    Cmd->DQSMode     = Desc->CCR & XSPI_CCR_DQSE;
+}
+
+/*============================================================================*/
+/*                          SAL FUNCTIONS                                     */
+/*============================================================================*/
+
+HAL_StatusTypeDef SAL_XSPI_SetClock(SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t ClockIn, uint32_t ClockRequested,
+                                    uint32_t *ClockReal)
+{
+    uint32_t divider;
+
+    if (ClockRequested == 0U)
+    {
+        return HAL_ERROR;
+    }
+    divider = ClockIn / ClockRequested;
+    if (divider >= 1U)
+    {
+        *ClockReal = ClockIn / divider;
+        if (*ClockReal <= ClockRequested)
+        {
+            divider--;
+        }
+    }
+    *ClockReal = ClockIn / (divider + 1U);
+    SalXspi->ClockOut = *ClockReal;
+    MODIFY_REG(SalXspi->hxspi->Instance->DCR2, XSPI_DCR2_PRESCALER, divider << XSPI_DCR2_PRESCALER_Pos);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_GetTiming(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_TimingTypeDef *Timing)
+{
+    volatile uint32_t *reg;
+
+    Timing->Prescaler   = (uint8_t)((SalXspi->hxspi->Instance->DCR2 & XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos);
+    Timing->SampleShift = (SalXspi->hxspi->Init.SampleShifting == HAL_XSPI_SAMPLE_SHIFT_HALFCYCLE) ? 1U : 0U;
+    Timing->DelayCoarse = 0U;
+    Timing->DelayFine   = 0U;
+    if (1U == XSPI_ReadDelayType(SalXspi, &reg))
+    {
+        Timing->DelayCoarse = (uint8_t)((*reg & XSPI_CALSIR_COARSE) >> XSPI_CALSIR_COARSE_Pos);
+        Timing->DelayFine   = (uint8_t)(*reg & XSPI_CALSIR_FINE);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_SetTiming(SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t ClockIn, const SAL_XSPI_TimingTypeDef *Timing)
+{
+    volatile uint32_t *reg;
+
+    MODIFY_REG(SalXspi->hxspi->Instance->DCR2, XSPI_DCR2_PRESCALER, (uint32_t)Timing->Prescaler << XSPI_DCR2_PRESCALER_Pos);
+    SalXspi->ClockOut = ClockIn / ((uint32_t)Timing->Prescaler + 1U);
+    SalXspi->hxspi->Init.SampleShifting = (Timing->SampleShift == 1U) ? HAL_XSPI_SAMPLE_SHIFT_HALFCYCLE : HAL_XSPI_SAMPLE_SHIFT_NONE;
+    MODIFY_REG(SalXspi->hxspi->Instance->TCR, XSPI_TCR_SSHIFT, SalXspi->hxspi->Init.SampleShifting);
+    if (1U == XSPI_ReadDelayType(SalXspi, &reg))
+    {
+        *reg = Timing->DelayFine | ((uint32_t)Timing->DelayCoarse << XSPI_CALSIR_COARSE_Pos);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_Init(SAL_XSPI_ObjectTypeDef *SalXspi, void *HALHandle)
+{
+    XSPI_RegularCmdTypeDef s_commandbase = {
+        .OperationType      = HAL_XSPI_OPTYPE_COMMON_CFG,
+        .IOSelect           = HAL_XSPI_SELECT_IO_7_0,
+        .InstructionMode    = HAL_XSPI_INSTRUCTION_1_LINE,
+        .Instruction        = 0x5A,
+        .InstructionWidth   = HAL_XSPI_INSTRUCTION_8_BITS,
+        .InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_DISABLE,
+        .AlternateBytesMode = HAL_XSPI_ALT_BYTES_NONE,
+        .AddressMode        = HAL_XSPI_ADDRESS_1_LINE,
+        .AddressWidth       = HAL_XSPI_ADDRESS_24_BITS,
+        .Address            = 0x0,
+        .AddressDTRMode     = HAL_XSPI_ADDRESS_DTR_DISABLE,
+        .DataMode           = HAL_XSPI_DATA_1_LINE,
+        .DataLength         = 0x0,
+        .DataDTRMode        = HAL_XSPI_DATA_DTR_DISABLE,
+        .DummyCycles        = 8,
+        .DQSMode            = HAL_XSPI_DQS_DISABLE,
+    };
+
+    SalXspi->hxspi = (XSPI_HandleTypeDef *)HALHandle;
+    SalXspi->Commandbase = s_commandbase;
+    SalXspi->CommandExtension = 0;
+    SalXspi->PhyLink = PHY_LINK_1S1S1S;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_MemoryConfig(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_MemParamTypeTypeDef ParametersType,
+                                        void *ParamVal)
+{
+    HAL_StatusTypeDef retr = HAL_OK;
+    XSPI_RegularCmdTypeDef *base = &SalXspi->Commandbase;
+
+    switch (ParametersType)
+    {
+    case PARAM_PHY_LINK:
+        SalXspi->PhyLink = *((SAL_XSPI_PhysicalLinkTypeDef *)ParamVal);
+        switch (SalXspi->PhyLink)
+        {
+        case PHY_LINK_1S1D1D:
+        case PHY_LINK_1S2S2S:
+        case PHY_LINK_1S1S2S:
+        case PHY_LINK_1S1S1S:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_1_LINE;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_8_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_DISABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_1_LINE;
+            base->AddressWidth = HAL_XSPI_ADDRESS_24_BITS;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_DISABLE;
+            base->DataMode = HAL_XSPI_DATA_1_LINE;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_DISABLE;
+            base->DummyCycles = 8;
+            base->DQSMode = HAL_XSPI_DQS_DISABLE;
+            break;
+        case PHY_LINK_4S4D4D:
+        case PHY_LINK_4S4S4S:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_4_LINES;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_8_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_DISABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_4_LINES;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_DISABLE;
+            base->AddressWidth = HAL_XSPI_ADDRESS_24_BITS;
+            base->DataMode = HAL_XSPI_DATA_4_LINES;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_DISABLE;
+            base->DummyCycles = 6;
+            base->DQSMode = HAL_XSPI_DQS_DISABLE;
+            break;
+        case PHY_LINK_4D4D4D:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_4_LINES;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_8_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_ENABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_4_LINES;
+            base->AddressWidth = HAL_XSPI_ADDRESS_24_BITS;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
+            base->DataMode = HAL_XSPI_DATA_4_LINES;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_ENABLE;
+            base->DummyCycles = 6;
+            base->DQSMode = HAL_XSPI_DQS_DISABLE;
+            break;
+        case PHY_LINK_1S8S8S:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_1_LINE;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_8_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_DISABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_8_LINES;
+            base->AddressWidth = HAL_XSPI_ADDRESS_32_BITS;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_DISABLE;
+            base->DataMode = HAL_XSPI_DATA_8_LINES;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_DISABLE;
+            base->DummyCycles = 8;
+            base->DQSMode = HAL_XSPI_DQS_DISABLE;
+            break;
+        case PHY_LINK_8S8D8D:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_8_LINES;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_8_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_DISABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_8_LINES;
+            base->AddressWidth = HAL_XSPI_ADDRESS_32_BITS;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
+            base->DataMode = HAL_XSPI_DATA_8_LINES;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_ENABLE;
+            base->DummyCycles = 8;
+            base->DQSMode = HAL_XSPI_DQS_ENABLE;
+            break;
+        case PHY_LINK_8D8D8D:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_8_LINES;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_16_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_ENABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_8_LINES;
+            base->AddressWidth = HAL_XSPI_ADDRESS_32_BITS;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
+            base->DataMode = HAL_XSPI_DATA_8_LINES;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_ENABLE;
+            base->DummyCycles = 20;
+            base->DQSMode = HAL_XSPI_DQS_ENABLE;
+            break;
+        case PHY_LINK_RAM8:
+            base->InstructionMode = HAL_XSPI_INSTRUCTION_8_LINES;
+            base->InstructionWidth = HAL_XSPI_INSTRUCTION_8_BITS;
+            base->InstructionDTRMode = HAL_XSPI_INSTRUCTION_DTR_DISABLE;
+            base->AddressMode = HAL_XSPI_ADDRESS_8_LINES;
+            base->AddressWidth = HAL_XSPI_ADDRESS_32_BITS;
+            base->AddressDTRMode = HAL_XSPI_ADDRESS_DTR_ENABLE;
+            base->AlternateBytesMode = HAL_XSPI_ALT_BYTES_NONE;
+            base->DataMode = HAL_XSPI_DATA_8_LINES;
+            base->DataDTRMode = HAL_XSPI_DATA_DTR_ENABLE;
+            base->DummyCycles = 10;
+            base->DQSMode = HAL_XSPI_DQS_ENABLE;
+            break;
+        default:
+            retr = HAL_ERROR;
+            break;
+        }
+        break;
+    case PARAM_ADDRESS_4BITS:
+        base->AddressWidth = HAL_XSPI_ADDRESS_32_BITS;
+        break;
+    case PARAM_FLASHSIZE:
+        MODIFY_REG(SalXspi->hxspi->Instance->DCR1, XSPI_DCR1_DEVSIZE,
+                   ((uint32_t)*((uint8_t *)ParamVal)) << XSPI_DCR1_DEVSIZE_Pos);
+        break;
+    case PARAM_DUMMY_CYCLES:
+        base->DummyCycles = *((uint8_t *)ParamVal);
+        break;
+    default:
+        retr = HAL_ERROR;
+        break;
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_GetSFDP(SAL_XSPI_ObjectTypeDef *SalXspi, uint32_t Address, uint8_t *Data, uint32_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
+
+    s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, 0x5A);
+    s_command.Address     = Address;
+    s_command.DataLength  = DataSize;
+    s_command.DummyCycles = SalXspi->SFDPDummyCycle;
+    if (s_command.AddressMode == HAL_XSPI_ADDRESS_1_LINE)
+    {
+        s_command.AddressWidth = HAL_XSPI_ADDRESS_24_BITS;
+    }
+    s_command.DQSMode = (s_command.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) ? HAL_XSPI_DQS_ENABLE : HAL_XSPI_DQS_DISABLE;
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, Data, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_GetId(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t *Data, uint32_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
+
+    s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, 0x9F);
+    s_command.DataLength  = DataSize;
+    s_command.AddressMode = HAL_XSPI_ADDRESS_NONE;
+    if (s_command.InstructionMode == HAL_XSPI_INSTRUCTION_1_LINE)
+    {
+        s_command.DummyCycles = 0;
+        s_command.DataMode    = HAL_XSPI_DATA_1_LINE;
+    }
+    else
+    {
+        s_command.Address     = 0;
+        s_command.DummyCycles = 8;
+    }
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, Data, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_Read(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint8_t *Data,
+                                uint32_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command;
+
+    XSPI_ReadCommand(SalXspi, Command, Address, DataSize, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, Data, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_Write(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                 const uint8_t *Data, uint32_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command;
+
+    XSPI_WriteCommand(SalXspi, Command, Address, DataSize, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, NULL, Data);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_CommandSendAddress(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command;
+
+    XSPI_AddressCommand(SalXspi, Command, Address, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, NULL, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_CommandSendData(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint8_t *Data,
+                                           uint16_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command;
+
+    XSPI_InstructionCommand(SalXspi, Command, DataSize, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, NULL, (DataSize != 0U) ? Data : NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_SendReadCommand(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint8_t *Data,
+                                           uint16_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
+
+    s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
+    s_command.AddressMode = HAL_XSPI_ADDRESS_NONE;
+    s_command.DummyCycles = 0U;
+    s_command.DataLength  = DataSize;
+    s_command.DQSMode     = HAL_XSPI_DQS_DISABLE;
+    if (DataSize == 0U)
+    {
+        s_command.DataMode = HAL_XSPI_DATA_NONE;
+    }
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, (DataSize != 0U) ? Data : NULL, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_CommandSendReadAddress(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                                  uint8_t *Data, uint16_t DataSize)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
+
+    s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, Command);
+    s_command.Address     = Address;
+    s_command.DummyCycles = SalXspi->SFDPDummyCycle;
+    s_command.DataLength  = DataSize;
+    s_command.DQSMode     = HAL_XSPI_DQS_DISABLE;
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, Data, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_CheckStatusRegister(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                               uint8_t MatchValue, uint8_t MatchMask, uint32_t Timeout)
+{
+    HAL_StatusTypeDef retr;
+    XSPI_RegularCmdTypeDef s_command;
+
+    XSPI_StatusCommand(SalXspi, Command, Address, &s_command);
+    retr = Sim_Polling(SalXspi->hxspi, &s_command, MatchValue, MatchMask, Timeout);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_SetMapConfig(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_MapConfigTypeDef *Config)
+{
+    if (SalXspi->hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+    SalXspi->hxspi->Init.WrapSize = Config->WrapSize;
+    MODIFY_REG(SalXspi->hxspi->Instance->DCR2, XSPI_DCR2_WRAPSIZE, Config->WrapSize);
+    SalXspi->MapTimeout = Config->Timeout;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_ConfigureWrappMode(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t WrapCommand, uint8_t WrapDummy)
+{
+    /* The wrapped reads are not modelled, the mapped reads are linear */
+    (void)WrapCommand;
+    (void)WrapDummy;
+    return (SalXspi->hxspi->State == HAL_XSPI_STATE_READY) ? HAL_OK : HAL_BUSY;
+}
+
+HAL_StatusTypeDef SAL_XSPI_EnableMapMode(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t CommandRead, uint8_t DummyRead,
+                                         uint8_t CommandWrite, uint8_t DummyWrite)
+{
+    XSPI_RegularCmdTypeDef s_command = SalXspi->Commandbase;
+    uint8_t need;
+    uint32_t maxHz;
+    uint8_t op;
+
+    (void)CommandWrite;
+    (void)DummyWrite;
+    if (SalXspi->hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+        return HAL_BUSY;
+    }
+    s_command.OperationType = HAL_XSPI_OPTYPE_READ_CFG;
+    s_command.Instruction = XSPI_FormatCommand(SalXspi->CommandExtension, s_command.InstructionWidth, CommandRead);
+    s_command.DummyCycles = DummyRead;
+
+    /* Every CPU read is sent with this command: it must read the array right */
+    if (!Sim_Opcode(&s_command, &op) || !Sim_ArrayRead(op, &need, &maxHz) || (s_command.DummyCycles != need)
+        || (Sim_Clock() > maxHz)
+        || ((s_command.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) && (Sim_Clock() > SIM_NO_DQS_MAX_HZ)
+            && (s_command.DQSMode != HAL_XSPI_DQS_ENABLE))
+        || (Port_NowNs() < simBusyUntilNs))
+    {
+        simStats.mapErrors++;
+    }
+    (void)mprotect(window, SIM_FLASH_SIZE, PROT_READ);
+    SalXspi->hxspi->State = HAL_XSPI_STATE_BUSY_MEM_MAPPED;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_DisableMapMode(SAL_XSPI_ObjectTypeDef *SalXspi)
+{
+    return Sim_Abort(SalXspi->hxspi);
+}
+
+HAL_StatusTypeDef SAL_XSPI_UpdateMemoryType(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_DataOrderTypeDef DataOrder)
+{
+    /* The model does not swap the bytes of the DTR reads, the type is only kept in DCR1 */
+    uint32_t memorytype = READ_REG(SalXspi->hxspi->Instance->DCR1) & XSPI_DCR1_MTYP;
+
+    if (DataOrder != SAL_XSPI_ORDERINVERTED)
+    {
+        return HAL_ERROR;
+    }
+    if (memorytype == HAL_XSPI_MEMTYPE_MICRON)
+    {
+        memorytype = HAL_XSPI_MEMTYPE_MACRONIX;
+    }
+    else if (memorytype == HAL_XSPI_MEMTYPE_MACRONIX)
+    {
+        memorytype = HAL_XSPI_MEMTYPE_MICRON;
+    }
+    else
+    {
+        return HAL_ERROR;
+    }
+    MODIFY_REG(SalXspi->hxspi->Instance->DCR1, XSPI_DCR1_MTYP, memorytype);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_Abort(SAL_XSPI_ObjectTypeDef *SalXspi)
+{
+    return Sim_Abort(SalXspi->hxspi);
+}
+
+HAL_StatusTypeDef SAL_XSPI_CommandStep(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandStepTypeDef *Step,
+                                       uint32_t Timeout)
+{
+    HAL_StatusTypeDef retr;
+
+    if (Step->Polling == 1U)
+    {
+        retr = Sim_Polling(SalXspi->hxspi, &Step->Command, Step->MatchValue, Step->MatchMask, Timeout);
+    }
+    else
+    {
+        retr = Sim_Transfer(SalXspi->hxspi, &Step->Command, NULL, Step->Data);
+    }
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    else if (Step->Delay != 0U)
+    {
+        HAL_Delay(Step->Delay);
+    }
+    else
+    {
+        /* nothing to wait */
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_BuildCommand(const SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_CommandKindTypeDef Kind,
+                                        uint8_t Command, SAL_XSPI_CommandDescTypeDef *Desc)
+{
+    const XSPI_HandleTypeDef *hxspi = SalXspi->hxspi;
+    XSPI_RegularCmdTypeDef s_command;
+
+    switch (Kind)
+    {
+    case SAL_XSPI_DESC_READ:
+        XSPI_ReadCommand(SalXspi, Command, 0U, 1U, &s_command);
+        break;
+    case SAL_XSPI_DESC_WRITE:
+        XSPI_WriteCommand(SalXspi, Command, 0U, 1U, &s_command);
+        break;
+    case SAL_XSPI_DESC_STATUS:
+        XSPI_StatusCommand(SalXspi, Command, 0U, &s_command);
+        break;
+    case SAL_XSPI_DESC_ADDRESS:
+        XSPI_AddressCommand(SalXspi, Command, 0U, &s_command);
+        break;
+    case SAL_XSPI_DESC_INSTRUCTION:
+        XSPI_InstructionCommand(SalXspi, Command, 0U, &s_command);
+        break;
+    default:
+        return HAL_ERROR;
+    }
+    if ((s_command.InstructionMode == HAL_XSPI_INSTRUCTION_NONE)
+        || (s_command.AlternateBytesMode != HAL_XSPI_ALT_BYTES_NONE)
+        || (s_command.OperationType != HAL_XSPI_OPTYPE_COMMON_CFG))
+    {
+        return HAL_ERROR;
+    }
+    Desc->Address = (s_command.AddressMode != HAL_XSPI_ADDRESS_NONE) ? 1U : 0U;
+    Desc->Data    = (s_command.DataMode != HAL_XSPI_DATA_NONE) ? 1U : 0U;
+    Desc->IR      = s_command.Instruction;
+    Desc->CCR     = s_command.DQSMode | s_command.InstructionMode | s_command.InstructionDTRMode | s_command.InstructionWidth;
+    if (Desc->Address == 1U)
+    {
+        Desc->CCR |= s_command.AddressMode | s_command.AddressDTRMode | s_command.AddressWidth;
+    }
+    if (Desc->Data == 1U)
+    {
+        Desc->CCR |= s_command.DataMode | s_command.DataDTRMode;
+    }
+    else if ((hxspi->Init.DelayHoldQuarterCycle == HAL_XSPI_DHQC_ENABLE)
+             && (s_command.InstructionDTRMode == HAL_XSPI_INSTRUCTION_DTR_ENABLE))
+    {
+        Desc->CCR |= HAL_XSPI_DATA_DTR_ENABLE;
+    }
+    else
+    {
+        /* nothing to add */
+    }
+    Desc->TCR     = s_command.DummyCycles;
+    Desc->TCRMask = XSPI_TCR_DCYC;
+    if (Desc->Data == 1U)
+    {
+        if (s_command.DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE)
+        {
+            Desc->TCRMask |= XSPI_TCR_SSHIFT;
+        }
+        else if (hxspi->Init.SampleShifting == HAL_XSPI_SAMPLE_SHIFT_HALFCYCLE)
+        {
+            Desc->TCR     |= XSPI_TCR_SSHIFT;
+            Desc->TCRMask |= XSPI_TCR_SSHIFT;
+        }
+        else
+        {
+            /* the sample shifting is kept */
+        }
+    }
+    Desc->CR     = 0U;
+    Desc->CRMask = 0U;
+    if (hxspi->Init.MemoryMode == HAL_XSPI_SINGLE_MEM)
+    {
+        Desc->CR     = s_command.IOSelect;
+        Desc->CRMask = XSPI_CR_MSEL;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_Issue(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc, uint32_t Address)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    HAL_StatusTypeDef retr;
+
+    Sim_Decode(Desc, Address, 0U, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, NULL, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_IssueRead(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                     uint32_t Address, uint8_t *Data, uint32_t DataSize)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    HAL_StatusTypeDef retr;
+
+    if ((Desc->Data == 0U) || (DataSize == 0U))
+    {
+        return HAL_ERROR;
+    }
+    Sim_Decode(Desc, Address, DataSize, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, Data, NULL);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_IssueWrite(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                      uint32_t Address, const uint8_t *Data, uint32_t DataSize)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    HAL_StatusTypeDef retr;
+
+    if ((Desc->Data == 0U) || (DataSize == 0U))
+    {
+        return HAL_ERROR;
+    }
+    Sim_Decode(Desc, Address, DataSize, &s_command);
+    retr = Sim_Transfer(SalXspi->hxspi, &s_command, NULL, Data);
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+HAL_StatusTypeDef SAL_XSPI_IssuePolling(SAL_XSPI_ObjectTypeDef *SalXspi, const SAL_XSPI_CommandDescTypeDef *Desc,
+                                        uint32_t Address, uint8_t MatchValue, uint8_t MatchMask, uint32_t Timeout)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    HAL_StatusTypeDef retr = HAL_ERROR;
+
+    if (Desc->Data == 1U)
+    {
+        Sim_Decode(Desc, Address, 1U, &s_command);
+        retr = Sim_Polling(SalXspi->hxspi, &s_command, MatchValue, MatchMask, Timeout);
+    }
+    if (retr != HAL_OK)
+    {
+        (void)Sim_Abort(SalXspi->hxspi);
+    }
+    return retr;
+}
+
+#if EXTMEM_ASYNC == 1
+HAL_StatusTypeDef SAL_XSPI_SetEventCallback(SAL_XSPI_ObjectTypeDef *SalXspi, SAL_XSPI_EventCallbackTypeDef Callback,
+                                            void *Context)
+{
+    SalXspi->EventCallback = Callback;
+    SalXspi->EventContext  = Context;
+    SalXspi->AsyncPending  = 0U;
+    SalXspi->RxData        = NULL;
+    SalXspi->RxSize        = 0U;
+    simAsyncObject = SalXspi;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_ReadAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address, uint8_t *Data,
+                                     uint32_t DataSize)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    uint64_t duration;
+
+    XSPI_ReadCommand(SalXspi, Command, Address, DataSize, &s_command);
+    if (SalXspi->hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        SalXspi->AsyncPending = 0U;
+        (void)Sim_Abort(SalXspi->hxspi);
+        return HAL_BUSY;
+    }
+    SalXspi->AsyncPending = 1U;
+    SalXspi->RxData = NULL;
+    duration = Sim_Execute(&s_command, Data, NULL);
+    Sim_Arm(SalXspi->hxspi, HAL_XSPI_STATE_BUSY_RX, Port_NowNs() + duration, SAL_XSPI_EVENT_TRANSFER_CPLT);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_WriteAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                      const uint8_t *Data, uint32_t DataSize)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    uint64_t duration;
+
+    XSPI_WriteCommand(SalXspi, Command, Address, DataSize, &s_command);
+    if (SalXspi->hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        SalXspi->AsyncPending = 0U;
+        (void)Sim_Abort(SalXspi->hxspi);
+        return HAL_BUSY;
+    }
+    SalXspi->AsyncPending = 1U;
+    SalXspi->RxData = NULL;
+    duration = Sim_Execute(&s_command, NULL, Data);
+    Sim_Arm(SalXspi->hxspi, HAL_XSPI_STATE_BUSY_TX, Port_NowNs() + duration, SAL_XSPI_EVENT_TRANSFER_CPLT);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SAL_XSPI_CheckStatusRegisterAsync(SAL_XSPI_ObjectTypeDef *SalXspi, uint8_t Command, uint32_t Address,
+                                                    uint8_t MatchValue, uint8_t MatchMask)
+{
+    XSPI_RegularCmdTypeDef s_command;
+    uint64_t at;
+
+    XSPI_StatusCommand(SalXspi, Command, Address, &s_command);
+    if (SalXspi->hxspi->State != HAL_XSPI_STATE_READY)
+    {
+        SalXspi->AsyncPending = 0U;
+        (void)Sim_Abort(SalXspi->hxspi);
+        return HAL_BUSY;
+    }
+    SalXspi->AsyncPending = 1U;
+    SalXspi->RxData = NULL;
+    /* The XSPI polls until the status matches: the model gives up once the memory is idle */
+    if (Sim_Poll(&s_command, MatchValue, MatchMask,
+                 ((simBusyUntilNs > Port_NowNs()) ? simBusyUntilNs : Port_NowNs()) + SIM_ASYNC_TIMEOUT_NS, &at))
+    {
+        Sim_Arm(SalXspi->hxspi, HAL_XSPI_STATE_BUSY_AUTO_POLLING, at, SAL_XSPI_EVENT_STATUS_MATCH);
+    }
+    else
+    {
+        /* The XSPI would poll forever, the model reports an error instead */
+        simStats.timeouts++;
+        Sim_Arm(SalXspi->hxspi, HAL_XSPI_STATE_BUSY_AUTO_POLLING, at, SAL_XSPI_EVENT_ERROR);
+    }
+    return HAL_OK;
+}
+#endif /* EXTMEM_ASYNC == 1 */
+
+/*============================================================================*/
+/*                          SFDP                                              */
+/*============================================================================*/
+
+static void Sim_Put32(uint32_t offset, uint32_t value)
+{
+    simSfdp[offset]      = (uint8_t)value;
+    simSfdp[offset + 1U] = (uint8_t)(value >> 8);
+    simSfdp[offset + 2U] = (uint8_t)(value >> 16);
+    simSfdp[offset + 3U] = (uint8_t)(value >> 24);
+}
+
+static void Sim_PutTable(uint32_t header, uint8_t idLsb, uint8_t minor, uint32_t pointer,
+                         const uint32_t *dwords, uint8_t count)
+{
+    simSfdp[header]      = idLsb;
+    simSfdp[header + 1U] = minor;
+    simSfdp[header + 2U] = 0x01U;
+    simSfdp[header + 3U] = count;
+    simSfdp[header + 4U] = (uint8_t)pointer;
+    simSfdp[header + 5U] = (uint8_t)(pointer >> 8);
+    simSfdp[header + 6U] = (uint8_t)(pointer >> 16);
+    simSfdp[header + 7U] = 0xFFU;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Sim_Put32(pointer + (i * 4U), dwords[i]);
+    }
+}
+
+/**
+ * @brief  SFDP of the MX25UW25645G, rebuilt from the tables of its datasheet:
+ *         the fields the NOR SFDP driver reads are set, the others are 0
+ */
+static void Sim_BuildSfdp(void)
+{
+    static const uint32_t basic[20] = {
+        0x01U | (1U << 2) | (1U << 4) | (0x20U << 8) | (1U << 17),         /* 4KB erase 20h, 3 or 4 byte address */
+        0x0FFFFFFFU,                                                        /* 256 Mbit */
+        0U, 0U, 0U, 0U, 0U,
+        12U | (0x20U << 8) | (15U << 16) | (0x52U << 24),                   /* 4KB 20h, 32KB 52h */
+        16U | (0xD8U << 8),                                                 /* 64KB D8h */
+        1U | (24U << 4) | (0U << 9) | (9U << 11) | (1U << 16) | (13U << 18) | (1U << 23), /* erase times */
+        1U | (8U << 4) | (2U << 8) | (1U << 13) | (18U << 24) | (2U << 29), /* page 256, program times */
+        1UL << 31,                                                          /* no suspend */
+        0U,
+        1U << 2,                                                            /* busy: RDSR WIP */
+        0U,
+        0x01U | (0x10U << 8) | (0x20U << 24),                               /* 4-byte entry, soft reset 66h 99h */
+        0U,
+        1U << 29,                                                           /* DTR octal */
+        0U,
+        8UL << 28,                                                          /* octal DTR byte order */
+    };
+    static const uint32_t fourByte[2] = {
+        (1U << 0) | (1U << 1) | (1U << 6) | (1U << 9) | (1U << 10) | (1U << 11),
+        0x21U | (0x5CU << 8) | (0xDCU << 16),                               /* 4KB, 32KB, 64KB erase opcodes */
+    };
+    static const uint32_t xspi[6] = {
+        0xEEU << 8,                                                         /* 8D8D8D read EEh */
+        0U, 0U,
+        20U << 7,                                                           /* 200 MHz: 20 dummy cycles */
+        (5U << 2) | (10U << 7) | (3U << 12) | (14U << 17) | (2U << 22) | (16UL << 27),
+        20U,
+    };
+    static const uint32_t sccr[10] = {
+        0U, 0U, 0U, 0U,
+        (0x05U << 8) | (1U << 28) | (1UL << 31),                            /* WIP in RDSR bit 0 */
+        (0x05U << 8) | (1U << 24) | (1UL << 31),                            /* WEL in RDSR bit 1 */
+        0U, 0U,
+        0x72U | (0x71U << 8) | (0x03U << 16) | (1U << 27) | (1U << 28) | (1U << 29) | (1UL << 31), /* CR2 dummy */
+        0U,
+    };
+    static const uint32_t octal[8] = {
+        (1U << 24) | (0x06U << 16),                                         /* WREN */
+        0U,
+        (6U << 24) | (0x72U << 16),                                         /* WRCR2 00000000h 02h */
+        0x02U << 8,
+        0U, 0U, 0U, 0U,
+    };
+
+    memset(simSfdp, 0xFF, sizeof(simSfdp));
+    simSfdp[0] = 'S';
+    simSfdp[1] = 'F';
+    simSfdp[2] = 'D';
+    simSfdp[3] = 'P';
+    simSfdp[4] = 0x08U;     /* minor */
+    simSfdp[5] = 0x01U;     /* major */
+    simSfdp[6] = 0x04U;     /* parameter headers - 1 */
+    simSfdp[7] = 0xFDU;     /* access protocol: 8D8D8D with 20 dummy cycles */
+    Sim_PutTable(0x08U, 0x00U, 0x08U, 0x30U, basic, 20U);
+    Sim_PutTable(0x10U, 0x84U, 0x00U, 0x80U, fourByte, 2U);
+    Sim_PutTable(0x18U, 0x05U, 0x00U, 0x88U, xspi, 6U);
+    Sim_PutTable(0x20U, 0x87U, 0x00U, 0xA0U, sccr, 10U);
+    Sim_PutTable(0x28U, 0x0AU, 0x00U, 0xC8U, octal, 8U);
+}
+
+/*============================================================================*/
+/*                          PLATFORM HOOKS (HOST)                             */
+/*============================================================================*/
+
+static void *Sim_MapFixed(uintptr_t address, size_t size, int prot, int flags, int fd)
+{
+    void *map = mmap((void *)address, size, prot, flags | MAP_FIXED_NOREPLACE, fd, 0);
+
+    if (map != (void *)address)
+    {
+        fprintf(stderr, "nor_sim: cannot map 0x%08lx\n", (unsigned long)address);
+        return NULL;
+    }
+    return map;
+}
+
+int NorSim_Open(const char *path, uint32_t kernelClock, uint32_t timeScale)
+{
+    struct sigaction action;
+    struct stat st;
+
+    simKernelClock = kernelClock;
+    simTimeScale = timeScale;
+    Sim_BuildSfdp();
+
+    flashFd = open(path, O_RDWR | O_CREAT, 0644);
+    if (flashFd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    if ((fstat(flashFd, &st) != 0) || (st.st_size != (off_t)SIM_FLASH_SIZE))
+    {
+        /* New array: erased */
+        static uint8_t erased[SIM_HOST_PAGE];
+        memset(erased, 0xFF, sizeof(erased));
+        if (ftruncate(flashFd, 0) != 0)
+        {
+            perror(path);
+            return -1;
+        }
+        for (uint32_t i = 0; i < SIM_FLASH_SIZE; i += SIM_HOST_PAGE)
+        {
+            if (write(flashFd, erased, sizeof(erased)) != (ssize_t)sizeof(erased))
+            {
+                perror(path);
+                return -1;
+            }
+        }
+    }
+
+    flash = mmap(NULL, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, flashFd, 0);
+    window = Sim_MapFixed(XSPI2_BASE, SIM_FLASH_SIZE, PROT_NONE, MAP_SHARED, flashFd);
+    if ((flash == MAP_FAILED) || (window == NULL)
+        || (Sim_MapFixed(XSPI2_R_BASE, SIM_HOST_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1) == NULL)
+        || (Sim_MapFixed(BKPSRAM_BASE, SIM_BKPSRAM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1) == NULL))
+    {
+        return -1;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = Sim_WindowFault;
+    action.sa_flags = SA_SIGINFO;
+    sigaction(SIGSEGV, &action, NULL);
+
+    Port_SetWfiHook(NorSim_WaitForInterrupt);
+    NorSim_PowerOn(0);
+    return 0;
+}
+
+void NorSim_Close(void)
+{
+    (void)munmap(flash, SIM_FLASH_SIZE);
+    (void)munmap(window, SIM_FLASH_SIZE);
+    (void)munmap((void *)XSPI2_R_BASE, SIM_HOST_PAGE);
+    (void)munmap((void *)BKPSRAM_BASE, SIM_BKPSRAM_SIZE);
+    (void)close(flashFd);
+    flashFd = -1;
+}
+
+void NorSim_PowerOn(int keepBackupSram)
+{
+    /* A power cycle ends any program or erase */
+    simBusyUntilNs = Port_NowNs();
+    Sim_Reset();
+    if (!keepBackupSram)
+    {
+        memset((void *)BKPSRAM_BASE, 0, SIM_BKPSRAM_SIZE);
+    }
+    Port_PowerCycle(keepBackupSram);
+    NorSim_McuReset();
+}
+
+void NorSim_McuReset(void)
+{
+    if (hxspi2.State == HAL_XSPI_STATE_BUSY_MEM_MAPPED)
+    {
+        (void)mprotect(window, SIM_FLASH_SIZE, PROT_NONE);
+    }
+    simEvent.armed = 0U;
+    simAsyncObject = NULL;
+    Port_McuReset();
+    memset((void *)XSPI2_R_BASE, 0, SIM_HOST_PAGE);
+
+    /* MX_XSPI2_Init */
+    memset(&hxspi2, 0, sizeof(hxspi2));
+    hxspi2.Instance = XSPI2;
+    hxspi2.Init.FifoThresholdByte = 1;
+    hxspi2.Init.MemoryMode = HAL_XSPI_SINGLE_MEM;
+    hxspi2.Init.MemoryType = HAL_XSPI_MEMTYPE_MACRONIX;
+    hxspi2.Init.MemorySize = HAL_XSPI_SIZE_256MB;
+    hxspi2.Init.ChipSelectHighTimeCycle = SIM_CS_HIGH_CYCLES;
+    hxspi2.Init.WrapSize = HAL_XSPI_WRAP_NOT_SUPPORTED;
+    hxspi2.Init.SampleShifting = HAL_XSPI_SAMPLE_SHIFT_NONE;
+    hxspi2.Init.DelayHoldQuarterCycle = HAL_XSPI_DHQC_ENABLE;
+    hxspi2.Init.MemorySelect = HAL_XSPI_CSSEL_NCS1;
+    hxspi2.Instance->DCR1 = HAL_XSPI_MEMTYPE_MACRONIX | (HAL_XSPI_SIZE_256MB << XSPI_DCR1_DEVSIZE_Pos)
+                            | ((SIM_CS_HIGH_CYCLES - 1U) << XSPI_DCR1_CSHT_Pos);
+    hxspi2.State = HAL_XSPI_STATE_READY;
+}
+
+void NorSim_WaitForInterrupt(void)
+{
+    SAL_XSPI_ObjectTypeDef *object = simAsyncObject;
+
+    if (!simEvent.armed)
+    {
+        /* Nothing pending: the next interrupt is the SysTick */
+        Port_AdvanceNs(1000000ULL);
+        return;
+    }
+    simEvent.armed = 0U;
+    Port_AdvanceTo(simEvent.at);
+    hxspi2.State = HAL_XSPI_STATE_READY;
+#if EXTMEM_ASYNC == 1
+    if ((object != NULL) && (object->AsyncPending == 1U))
+    {
+        object->AsyncPending = 0U;
+        object->EventCallback(object->EventContext, simEvent.event);
+    }
+#else
+    (void)object;
+#endif /* EXTMEM_ASYNC == 1 */
+}
+
+uint64_t NorSim_NowNs(void)
+{
+    return Port_NowNs();
+}
+
+void NorSim_GetStats(NorSim_Stats_t *stats)
+{
+    *stats = simStats;
+}
+
+void NorSim_ResetStats(void)
+{
+    memset(&simStats, 0, sizeof(simStats));
+}
+
+const char *NorSim_ModeName(void)
+{
+    return (simMode == SIM_MODE_DOPI) ? "DOPI" : "SPI";
+}
+
+uint8_t NorSim_DummyCycles(void)
+{
+    return simCr2Dummy[simCr2DummyIndex].dummy;
+}
+
+const uint8_t *NorSim_Array(void)
+{
+    return flash;
+}
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @file    stm32_extmem_conf.h
+ * @brief   ExtMem Manager configuration for the host build of nor_sim.
+ *          Same options as the Boot: asynchronous functions, precompiled
+ *          commands, SFDP cache and timing store in backup SRAM, octal DTR.
+ *          The HAL and the Cortex-M core come from tools/port.
+ ******************************************************************************
+ */
+
+#ifndef __STM32_EXTMEM_CONF__H__
+#define __STM32_EXTMEM_CONF__H__
+
+#define EXTMEM_DRIVER_NOR_SFDP   1
+#define EXTMEM_DRIVER_PSRAM      0
+#define EXTMEM_DRIVER_SDCARD     0
+#define EXTMEM_DRIVER_USER       0
+
+#define EXTMEM_SAL_XSPI   1
+#define EXTMEM_SAL_SD     0
+
+#define EXTMEM_ASYNC      1
+
+/* The model implements the SAL, so the precompiled commands reach it through
+ * SAL_XSPI_Issue* like the other functions */
+#define EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS  1
+
+/* HAL and Cortex-M core of tools/port: SCB, DWT, __WFI and the intrinsics */
+#include "hal_port_cmsis.h"
+#include "nor_sim.h"
+
+#include "stm32_extmem.h"
+#include "stm32_extmem_type.h"
+#include "boot/stm32_boot_xip.h"
+
+extern XSPI_HandleTypeDef hxspi2;
+
+/* Memory table of the Boot */
+enum {
+  EXTMEMORY_1  = 0
+};
+
+#define EXTMEM_MEMORY_BOOTXIP  EXTMEMORY_1
+
+/* The SFDP discovery runs on the model, as on the Boot */
+#define EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE 0
+
+#define EXTMEM_DRIVER_NOR_SFDP_CACHE          1
+#define EXTMEM_DRIVER_NOR_SFDP_CACHE_ADDRESS  BKPSRAM_BASE
+#define EXTMEM_DRIVER_NOR_SFDP_CACHE_SIZE     1024u
+
+#define EXTMEM_DRIVER_NOR_SFDP_OCTAL_DTR      1
+
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE          1
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_ADDRESS  (BKPSRAM_BASE + EXTMEM_DRIVER_NOR_SFDP_CACHE_SIZE)
+#define EXTMEM_DRIVER_NOR_SFDP_TIMING_STORE_SIZE     64u
+
+/* Forced in before stm32_extmem.c defines EXTMEM_C: the table is in nor_sim.c */
+extern EXTMEM_DefinitionTypeDef extmem_list_config[1];
+
+#endif /* __STM32_EXTMEM_CONF__H__ */
@@ -0,0 +1,367 @@
+/**
+ ******************************************************************************
+ * @file    hal_port.c
+ * @brief   Host port of the HAL services used by the Boot and Appli logic
+ *
+ * Time is kept in nanoseconds. On virtual time it only moves with
+ * Port_Advance*, HAL_Delay and the cost of HAL_GetTick, so a run gives the
+ * same times on any host and under valgrind. On real time it is the host
+ * monotonic clock from Port_Open, and the same calls sleep instead.
+ *
+ * The device pages are anonymous memory at the device addresses: the
+ * program must not be loaded there, which holds for the usual x86-64 and
+ * AArch64 layouts, PIE or not.
+ ******************************************************************************
+ */
+
+#include "hal_port_cmsis.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+/*============================================================================*/
+/*                          PORT STATE                                        */
+/*============================================================================*/
+
+#define PORT_PAGE               0x1000UL
+#define PORT_CORE_CLOCK         600000000U      /* SYSCLK of the Boot and the Appli */
+#define PORT_GPIO_PORTS         16U
+#define PORT_TICK_NS            1000000ULL
+
+/* system_stm32h7rsxx.c after SystemCoreClockUpdate */
+uint32_t SystemCoreClock = PORT_CORE_CLOCK;
+
+SCB_Type       portScb;
+DWT_Type       portDwt;
+CoreDebug_Type portCoreDebug;
+
+/* Device pages: RCC and PWR share one */
+static const uintptr_t portPages[] = {
+    RCC_BASE & ~(PORT_PAGE - 1U),
+    TAMP_BASE & ~(PORT_PAGE - 1U),
+};
+
+static Port_Config_t   portCfg;
+static uint64_t        portNowNs;
+static uint64_t        portStartNs;
+static uint8_t         portTickSuspended;
+static uint16_t        portGpio[PORT_GPIO_PORTS];
+static Port_GpioHook_t portGpioHook;
+static void          (*portWfiHook)(void);
+static UART_HandleTypeDef *portUartDma;    /* transfer ending at the next read of the time */
+
+/*============================================================================*/
+/*                          TIME                                              */
+/*============================================================================*/
+
+static void Port_UartDmaDone(void);
+
+static uint64_t Port_HostNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  Set the port time, the cycle counter follows at SystemCoreClock.
+ *         A UART DMA transfer ends here, as its interrupt would.
+ */
+static void Port_SetTime(uint64_t ns)
+{
+    uint64_t mhz = SystemCoreClock / 1000000U;
+
+    Port_UartDmaDone();
+    if (ns <= portNowNs)
+    {
+        return;
+    }
+    if ((portDwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U)
+    {
+        portDwt.CYCCNT += (uint32_t)(((ns * mhz) / 1000U) - ((portNowNs * mhz) / 1000U));
+    }
+    portNowNs = ns;
+}
+
+uint64_t Port_NowNs(void)
+{
+    if (portCfg.timeMode == PORT_TIME_REAL)
+    {
+        Port_SetTime(Port_HostNs() - portStartNs);
+    }
+    return portNowNs;
+}
+
+void Port_AdvanceTo(uint64_t ns)
+{
+    if (portCfg.timeMode == PORT_TIME_REAL)
+    {
+        struct timespec ts;
+        uint64_t at = portStartNs + ns;
+
+        ts.tv_sec = (time_t)(at / 1000000000ULL);
+        ts.tv_nsec = (long)(at % 1000000000ULL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+        {
+        }
+        (void)Port_NowNs();
+        return;
+    }
+    Port_SetTime(ns);
+}
+
+void Port_AdvanceNs(uint64_t ns)
+{
+    Port_AdvanceTo(Port_NowNs() + ns);
+}
+
+void Port_SetWfiHook(void (*hook)(void))
+{
+    portWfiHook = hook;
+}
+
+void Port_WaitForInterrupt(void)
+{
+    if (portWfiHook != NULL)
+    {
+        portWfiHook();
+        return;
+    }
+    Port_AdvanceNs(PORT_TICK_NS);
+}
+
+/*============================================================================*/
+/*                          MEMORY MAP                                        */
+/*============================================================================*/
+
+static int Port_MapFixed(uintptr_t address, size_t size)
+{
+    void *map = mmap((void *)address, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (map != (void *)address)
+    {
+        fprintf(stderr, "hal_port: cannot map 0x%08lx\n", (unsigned long)address);
+        return -1;
+    }
+    return 0;
+}
+
+int Port_Open(const Port_Config_t *config)
+{
+    portCfg = *config;
+    for (uint32_t i = 0; i < (sizeof(portPages) / sizeof(portPages[0])); i++)
+    {
+        if (Port_MapFixed(portPages[i], PORT_PAGE) != 0)
+        {
+            return -1;
+        }
+    }
+    if (Port_MapFixed(PORT_MAILBOX_BASE, PORT_MAILBOX_SIZE) != 0)
+    {
+        return -1;
+    }
+
+    portNowNs = 0;
+    portStartNs = Port_HostNs();
+    Port_PowerCycle(0);
+    return 0;
+}
+
+void Port_Close(void)
+{
+    for (uint32_t i = 0; i < (sizeof(portPages) / sizeof(portPages[0])); i++)
+    {
+        (void)munmap((void *)portPages[i], PORT_PAGE);
+    }
+    (void)munmap((void *)PORT_MAILBOX_BASE, PORT_MAILBOX_SIZE);
+}
+
+void Port_PowerCycle(int keepBackupDomain)
+{
+    memset((void *)PORT_MAILBOX_BASE, 0, PORT_MAILBOX_SIZE);
+    if (!keepBackupDomain)
+    {
+        memset((void *)(TAMP_BASE & ~(PORT_PAGE - 1U)), 0, PORT_PAGE);
+    }
+    Port_McuReset();
+}
+
+void Port_McuReset(void)
+{
+    memset(&portScb, 0, sizeof(portScb));
+    memset(&portDwt, 0, sizeof(portDwt));
+    memset(&portCoreDebug, 0, sizeof(portCoreDebug));
+    memset((void *)(RCC_BASE & ~(PORT_PAGE - 1U)), 0, PORT_PAGE);
+    memset(portGpio, 0, sizeof(portGpio));
+    portTickSuspended = 0U;
+    portUartDma = NULL;
+}
+
+/*============================================================================*/
+/*                          HAL                                               */
+/*============================================================================*/
+
+__attribute__((weak)) uint32_t HAL_GetTick(void)
+{
+    if ((portCfg.timeMode == PORT_TIME_VIRTUAL) && !portTickSuspended)
+    {
+        Port_SetTime(portNowNs + portCfg.tickReadNs);
+    }
+    return (uint32_t)(Port_NowNs() / PORT_TICK_NS);
+}
+
+__attribute__((weak)) void HAL_Delay(uint32_t Delay)
+{
+    Port_AdvanceNs((uint64_t)Delay * PORT_TICK_NS);
+}
+
+void HAL_SuspendTick(void)
+{
+    portTickSuspended = 1U;
+}
+
+void HAL_ResumeTick(void)
+{
+    portTickSuspended = 0U;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)huart;
+    (void)Timeout;
+    if (portCfg.uart == NULL)
+    {
+        return HAL_OK;
+    }
+    if (portCfg.uartRaw)
+    {
+        (void)fwrite(pData, 1U, Size, portCfg.uart);
+        return HAL_OK;
+    }
+    for (uint16_t i = 0; i < Size; i++)
+    {
+        if (pData[i] != '\r')
+        {
+            fputc(pData[i], portCfg.uart);
+        }
+    }
+    return HAL_OK;
+}
+
+/* The bytes are written when the transfer starts; it ends at the next read
+ * or move of the port time, whatever its length */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (portUartDma != NULL)
+    {
+        return HAL_BUSY;
+    }
+    (void)HAL_UART_Transmit(huart, pData, Size, 0U);
+    portUartDma = huart;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+    portUartDma = NULL;
+    return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+static void Port_UartDmaDone(void)
+{
+    UART_HandleTypeDef *huart = portUartDma;
+
+    if (huart != NULL)
+    {
+        portUartDma = NULL;
+        HAL_UART_TxCpltCallback(huart);
+    }
+}
+
+/* DMA channel and NVIC setup: nothing behind them on the host */
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+static uint16_t *Port_GpioState(GPIO_TypeDef *GPIOx)
+{
+    uintptr_t index = ((uintptr_t)GPIOx - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE);
+
+    if (((uintptr_t)GPIOx < GPIOA_BASE) || (index >= PORT_GPIO_PORTS))
+    {
+        fprintf(stderr, "hal_port: no GPIO port at 0x%08lx\n", (unsigned long)(uintptr_t)GPIOx);
+        exit(1);
+    }
+    return &portGpio[index];
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    uint16_t *state = Port_GpioState(GPIOx);
+
+    if (PinState == GPIO_PIN_SET)
+    {
+        *state |= GPIO_Pin;
+    }
+    else
+    {
+        *state &= (uint16_t)~GPIO_Pin;
+    }
+    if (portGpioHook != NULL)
+    {
+        portGpioHook(GPIOx, GPIO_Pin, PinState == GPIO_PIN_SET);
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    HAL_GPIO_WritePin(GPIOx, GPIO_Pin, ((*Port_GpioState(GPIOx) & GPIO_Pin) != 0U) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(const GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return ((*Port_GpioState((GPIO_TypeDef *)GPIOx) & GPIO_Pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void Port_SetGpioHook(Port_GpioHook_t hook)
+{
+    portGpioHook = hook;
+}
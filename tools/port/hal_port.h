@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    hal_port.h
+ * @brief   Host port of the HAL services used by the Boot and Appli logic
+ *
+ * ota_bootloader.c, modem.c and usb_host.c build unchanged for Linux when
+ * linked with hal_port.c in place of the HAL:
+ *  - time base: HAL_GetTick, HAL_Delay, HAL_SuspendTick, HAL_ResumeTick,
+ *    on virtual time or on the host clock
+ *  - HAL_UART_Transmit to a host stream, carriage returns dropped, or raw
+ *    bytes for a capture with the binary trace dumps (tools/trace_decode);
+ *    HAL_UART_Transmit_DMA the same, ended at the next read of the time
+ *  - HAL_GPIO_WritePin, HAL_GPIO_ReadPin, HAL_GPIO_TogglePin, with a hook
+ *    for the models behind the pins
+ *  - RCC, PWR and TAMP (backup registers) and the OTA mailbox of the AXI
+ *    SRAM mapped at their device addresses
+ *  - SCB, DWT and CoreDebug as plain structures, DWT->CYCCNT following the
+ *    port time at SystemCoreClock (see hal_port_cmsis.h)
+ *
+ * HAL_GetTick and HAL_Delay are weak, as in the HAL: a model that needs to
+ * see the delays of the firmware defines its own on top of Port_Advance*.
+ ******************************************************************************
+ */
+
+#ifndef HAL_PORT_H
+#define HAL_PORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*============================================================================*/
+/*                          DEFINITIONS                                       */
+/*============================================================================*/
+
+/* OTA_SRAM_BASE and OTA_SRAM_SIZE of ota_bootloader.c */
+#define PORT_MAILBOX_BASE       0x2406C000UL
+#define PORT_MAILBOX_SIZE       0x00020000UL
+
+typedef enum {
+    PORT_TIME_VIRTUAL = 0,      /* moves only with Port_Advance* and HAL_Delay */
+    PORT_TIME_REAL              /* host monotonic clock, Port_Advance* sleep */
+} Port_TimeMode_t;
+
+typedef struct {
+    Port_TimeMode_t timeMode;
+    uint32_t tickReadNs;        /* virtual time of one HAL_GetTick, so loops on the tick end */
+    FILE    *uart;              /* HAL_UART_Transmit output, NULL: dropped */
+    uint8_t  uartRaw;           /* 1: bytes unchanged, as a capture of the board UART */
+} Port_Config_t;
+
+/**
+ * @brief  Called on each HAL_GPIO_WritePin and HAL_GPIO_TogglePin, after the
+ *         pin state is updated
+ */
+typedef void (*Port_GpioHook_t)(void *port, uint16_t pin, int set);
+
+/*============================================================================*/
+/*                          FUNCTIONS                                         */
+/*============================================================================*/
+
+/**
+ * @brief  Map the device pages and the mailbox, cleared, and start the time
+ * @retval 0 on success
+ */
+int  Port_Open(const Port_Config_t *config);
+void Port_Close(void);
+
+/**
+ * @brief  Power cycle: the mailbox is cleared, then Port_McuReset
+ * @param  keepBackupDomain: 1 if VBAT keeps the backup registers
+ */
+void Port_PowerCycle(int keepBackupDomain);
+
+/**
+ * @brief  System reset: core registers, RCC and PWR cleared, the mailbox
+ *         and the backup registers kept
+ */
+void Port_McuReset(void);
+
+uint64_t Port_NowNs(void);
+
+/**
+ * @brief  Virtual time: move it forward. Real time: sleep until then.
+ */
+void Port_AdvanceTo(uint64_t ns);
+void Port_AdvanceNs(uint64_t ns);
+
+/**
+ * @brief  __WFI of the firmware: the hook runs the next event of a model,
+ *         without one the next interrupt is the SysTick, a millisecond later
+ */
+void Port_SetWfiHook(void (*hook)(void));
+void Port_WaitForInterrupt(void);
+
+void Port_SetGpioHook(Port_GpioHook_t hook);
+
+#endif /* HAL_PORT_H */
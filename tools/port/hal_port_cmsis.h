@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * @file    hal_port_cmsis.h
+ * @brief   stm32h7rsxx_hal.h for the host build, Cortex-M core mapped to the port
+ *
+ * Include in place of stm32h7rsxx_hal.h, or force it in first, so the
+ * firmware headers find the HAL already included. The CMSIS intrinsics and
+ * cache maintenance are ARM instructions: their inline versions are hidden
+ * and replaced by the macros below. SCB, DWT and CoreDebug are structures
+ * of hal_port.c; on real time DWT->CYCCNT is brought up to date by each
+ * read of the port time (HAL_GetTick included).
+ ******************************************************************************
+ */
+
+#ifndef HAL_PORT_CMSIS_H
+#define HAL_PORT_CMSIS_H
+
+#define __DSB                         host_cmsis_dsb
+#define __ISB                         host_cmsis_isb
+#define __enable_irq                  host_cmsis_enable_irq
+#define __disable_irq                 host_cmsis_disable_irq
+#define __get_PRIMASK                 host_cmsis_get_primask
+#define __set_PRIMASK                 host_cmsis_set_primask
+#define __set_MSP                     host_cmsis_set_msp
+#define SCB_EnableDCache              host_scb_enable_dcache
+#define SCB_DisableDCache             host_scb_disable_dcache
+#define SCB_DisableICache             host_scb_disable_icache
+#define SCB_InvalidateDCache_by_Addr  host_scb_invalidate_dcache_by_addr
+#define SCB_CleanDCache_by_Addr       host_scb_clean_dcache_by_addr
+#include "stm32h7rsxx_hal.h"
+#undef __DSB
+#undef __ISB
+#undef __enable_irq
+#undef __disable_irq
+#undef __get_PRIMASK
+#undef __set_PRIMASK
+#undef __set_MSP
+#undef SCB_EnableDCache
+#undef SCB_DisableDCache
+#undef SCB_DisableICache
+#undef SCB_InvalidateDCache_by_Addr
+#undef SCB_CleanDCache_by_Addr
+#undef __WFI
+#undef SCB
+#undef DWT
+#undef CoreDebug
+
+#include "hal_port.h"
+
+extern SCB_Type       portScb;
+extern DWT_Type       portDwt;
+extern CoreDebug_Type portCoreDebug;
+#define SCB           (&portScb)
+#define DWT           (&portDwt)
+#define CoreDebug     (&portCoreDebug)
+
+#define __DSB()                   ((void)0)
+#define __ISB()                   ((void)0)
+#define __enable_irq()            ((void)0)
+#define __disable_irq()           ((void)0)
+#define __get_PRIMASK()           (0U)
+#define __set_PRIMASK(_V_)        ((void)(_V_))
+#define __set_MSP(_V_)            ((void)(_V_))
+#define __WFI()                   Port_WaitForInterrupt()
+#define SCB_EnableDCache()        (portScb.CCR |= SCB_CCR_DC_Msk)
+#define SCB_DisableDCache()       (portScb.CCR &= ~SCB_CCR_DC_Msk)
+#define SCB_DisableICache()       (portScb.CCR &= ~SCB_CCR_IC_Msk)
+#define SCB_InvalidateDCache_by_Addr(_A_, _S_)  ((void)(_A_), (void)(_S_))
+#define SCB_CleanDCache_by_Addr(_A_, _S_)       ((void)(_A_), (void)(_S_))
+
+#endif /* HAL_PORT_CMSIS_H */
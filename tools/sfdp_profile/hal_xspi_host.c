@@ -0,0 +1,226 @@
+/**
+ ******************************************************************************
+ * @file    hal_xspi_host.c
+ * @brief   Host replacement of the XSPI HAL used by sfdp_profile
+ *
+ * The real SAL and NOR SFDP driver are linked against these functions. The
+ * memory model is minimal: SFDP reads (0x5A) are served from the dump, the
+ * read ID (0x9F) returns the ID given on the command line and every other
+ * read returns 0x00, i.e. the post-reset value of the status and
+ * configuration registers. Status pollings always match.
+ *
+ * Every transaction that changes the memory state (command without data,
+ * write, polling) is recorded with the HAL_Delay that follows it so that the
+ * target can replay the exact sequence. Reads do not change the memory and
+ * are dropped.
+ ******************************************************************************
+ */
+
+#include "hal_xspi_host.h"
+#include <string.h>
+
+/*============================================================================*/
+/*                          MEMORY MODEL                                      */
+/*============================================================================*/
+
+static XSPI_TypeDef hostRegs;
+static XSPI_HandleTypeDef hostHandle;
+
+static uint8_t  sfdpImage[HOST_XSPI_MAX_SFDP];
+static uint32_t sfdpImageSize;
+static uint8_t  idImage[3];
+
+static HOST_XSPI_Record_t record;
+static XSPI_RegularCmdTypeDef pendingCmd;
+static uint32_t tick;
+
+void HOST_XSPI_Setup(const uint8_t *sfdp, uint32_t sfdpSize, const uint8_t *jedecId)
+{
+    memset(&hostRegs, 0, sizeof(hostRegs));
+    memset(&hostHandle, 0, sizeof(hostHandle));
+    memset(&record, 0, sizeof(record));
+
+    /* Same memory type as MX_XSPI2_Init in Boot and ExtMemLoader */
+    hostRegs.DCR1 = HAL_XSPI_MEMTYPE_MACRONIX;
+    hostHandle.Instance = &hostRegs;
+
+    sfdpImageSize = (sfdpSize > HOST_XSPI_MAX_SFDP) ? HOST_XSPI_MAX_SFDP : sfdpSize;
+    memcpy(sfdpImage, sfdp, sfdpImageSize);
+    memcpy(idImage, jedecId, sizeof(idImage));
+
+    tick = 0;
+}
+
+XSPI_HandleTypeDef *HOST_XSPI_Handle(void)
+{
+    return &hostHandle;
+}
+
+const HOST_XSPI_Record_t *HOST_XSPI_GetRecord(void)
+{
+    return &record;
+}
+
+/**
+ * @brief  Opcode of a command, without the 8D8D8D command extension
+ */
+static uint8_t Host_Opcode(const XSPI_RegularCmdTypeDef *cmd)
+{
+    if (cmd->InstructionWidth == HAL_XSPI_INSTRUCTION_16_BITS)
+    {
+        return (uint8_t)(cmd->Instruction >> 8);
+    }
+    return (uint8_t)cmd->Instruction;
+}
+
+/**
+ * @brief  Append the pending command to the record
+ * @retval Recorded step, NULL if the record is full
+ */
+static HOST_XSPI_Step_t *Host_Record(void)
+{
+    HOST_XSPI_Step_t *step;
+
+    if (record.stepCount >= HOST_XSPI_MAX_STEPS)
+    {
+        record.overflow = 1;
+        return NULL;
+    }
+
+    step = &record.steps[record.stepCount++];
+    memset(step, 0, sizeof(*step));
+    step->command = pendingCmd;
+    return step;
+}
+
+/*============================================================================*/
+/*                          HAL FUNCTIONS                                     */
+/*============================================================================*/
+
+HAL_StatusTypeDef HAL_XSPI_Command(XSPI_HandleTypeDef *hxspi, XSPI_RegularCmdTypeDef *const pCmd, uint32_t Timeout)
+{
+    (void)hxspi;
+    (void)Timeout;
+
+    pendingCmd = *pCmd;
+    if (pCmd->DataMode == HAL_XSPI_DATA_NONE)
+    {
+        (void)Host_Record();
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_Transmit(XSPI_HandleTypeDef *hxspi, const uint8_t *pData, uint32_t Timeout)
+{
+    HOST_XSPI_Step_t *step;
+
+    (void)hxspi;
+    (void)Timeout;
+
+    if (pendingCmd.DataLength > HOST_XSPI_MAX_DATA)
+    {
+        record.overflow = 1;
+        return HAL_OK;
+    }
+
+    step = Host_Record();
+    if (step != NULL)
+    {
+        memcpy(step->data, pData, pendingCmd.DataLength);
+        step->dataSize = pendingCmd.DataLength;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_Receive(XSPI_HandleTypeDef *hxspi, uint8_t *const pData, uint32_t Timeout)
+{
+    uint32_t len = pendingCmd.DataLength;
+
+    (void)hxspi;
+    (void)Timeout;
+
+    memset(pData, 0x00, len);
+
+    switch (Host_Opcode(&pendingCmd))
+    {
+    case 0x5A:
+        record.sfdpReads++;
+        for (uint32_t i = 0; i < len; i++)
+        {
+            uint32_t addr = pendingCmd.Address + i;
+            pData[i] = (addr < sfdpImageSize) ? sfdpImage[addr] : 0xFF;
+        }
+        break;
+
+    case 0x9F:
+        memcpy(pData, idImage, (len < sizeof(idImage)) ? len : sizeof(idImage));
+        break;
+
+    default:
+        /* Status / configuration registers: post-reset value */
+        break;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_AutoPolling(XSPI_HandleTypeDef *hxspi, XSPI_AutoPollingTypeDef *const pCfg, uint32_t Timeout)
+{
+    HOST_XSPI_Step_t *step;
+
+    (void)hxspi;
+    (void)Timeout;
+
+    step = Host_Record();
+    if (step != NULL)
+    {
+        step->polling = 1;
+        step->matchValue = (uint8_t)pCfg->MatchValue;
+        step->matchMask = (uint8_t)pCfg->MatchMask;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_MemoryMapped(XSPI_HandleTypeDef *hxspi, XSPI_MemoryMappedTypeDef *const pCfg)
+{
+    (void)hxspi;
+    (void)pCfg;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_Abort(XSPI_HandleTypeDef *hxspi)
+{
+    (void)hxspi;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_GetDelayValue(XSPI_HandleTypeDef *hxspi, XSPI_HSCalTypeDef *const pCfg)
+{
+    /* No delay line on the host: the read timing is not part of the profile */
+    (void)hxspi;
+    pCfg->FineCalibrationUnit = 0U;
+    pCfg->CoarseCalibrationUnit = 0U;
+    pCfg->MaxCalibration = HAL_XSPI_MAXCAL_NOT_REACHED;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_SetDelayValue(XSPI_HandleTypeDef *hxspi, XSPI_HSCalTypeDef *const pCfg)
+{
+    (void)hxspi;
+    (void)pCfg;
+    return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    /* Advance on every call so that driver timeouts terminate */
+    return tick++;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    /* A wait belongs to the last state change (e.g. reset recovery) */
+    if (record.stepCount != 0U)
+    {
+        record.steps[record.stepCount - 1U].delay += Delay;
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file    hal_xspi_host.h
+ * @brief   Host replacement of the XSPI HAL used by sfdp_profile: serves the
+ *          SFDP reads from a dump and records what the driver sends
+ ******************************************************************************
+ */
+
+#ifndef HAL_XSPI_HOST_H
+#define HAL_XSPI_HOST_H
+
+#include "stm32_extmem_conf.h"
+
+/*============================================================================*/
+/*                          RECORDER LIMITS                                   */
+/*============================================================================*/
+
+#define HOST_XSPI_MAX_STEPS     64U
+#define HOST_XSPI_MAX_DATA      16U     /* Configuration writes are a few bytes */
+#define HOST_XSPI_MAX_SFDP      4096U
+
+/*============================================================================*/
+/*                          TYPES                                             */
+/*============================================================================*/
+
+typedef struct {
+    XSPI_RegularCmdTypeDef command;
+    uint8_t  data[HOST_XSPI_MAX_DATA];
+    uint32_t dataSize;          /* 0 = no data phase */
+    uint32_t delay;             /* ms spent in HAL_Delay after the command */
+    uint8_t  polling;
+    uint8_t  matchValue;
+    uint8_t  matchMask;
+} HOST_XSPI_Step_t;
+
+typedef struct {
+    HOST_XSPI_Step_t steps[HOST_XSPI_MAX_STEPS];
+    uint32_t stepCount;
+    uint32_t sfdpReads;         /* Number of 0x5A commands served */
+    uint8_t  overflow;          /* A step or a data phase did not fit */
+} HOST_XSPI_Record_t;
+
+/*============================================================================*/
+/*                          API                                               */
+/*============================================================================*/
+
+/**
+ * @brief  Reset the recorder and load the memory model
+ * @param  sfdp: SFDP table dump, read with SAL_XSPI_GetSFDP from address 0
+ * @param  sfdpSize: Dump size in bytes
+ * @param  jedecId: 3 bytes answered to the read ID command (0x9F)
+ */
+void HOST_XSPI_Setup(const uint8_t *sfdp, uint32_t sfdpSize, const uint8_t *jedecId);
+
+/**
+ * @brief  Handle to pass to the driver, its Instance points to fake registers
+ */
+XSPI_HandleTypeDef *HOST_XSPI_Handle(void);
+
+/**
+ * @brief  Transactions recorded since HOST_XSPI_Setup()
+ */
+const HOST_XSPI_Record_t *HOST_XSPI_GetRecord(void);
+
+#endif /* HAL_XSPI_HOST_H */
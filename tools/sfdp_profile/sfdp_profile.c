@@ -0,0 +1,315 @@
+/**
+ ******************************************************************************
+ * @file    sfdp_profile.c
+ * @brief   Compile a raw SFDP dump into a static NOR SFDP driver profile
+ *
+ * Usage:
+ *   sfdp_profile -c <xspi_clock_hz> [-l 1|2|4|8] [-i C2:81:39] [-o profile.h] sfdp.bin
+ *
+ * The dump is the memory SFDP area read from address 0 with SAL_XSPI_GetSFDP
+ * (the header, the parameter headers and all the tables they point to). The
+ * tool runs the unmodified EXTMEM_DRIVER_NOR_SFDP_Init on it, so the parsing
+ * is exactly the one of the target, and writes a header to include on the
+ * target with:
+ *
+ *   #define EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE 1
+ *   #define EXTMEM_DRIVER_NOR_SFDP_PROFILE_FILE   "profile.h"
+ *
+ * The clock and the link must be the ones passed to EXTMEM_Init on the target
+ * (HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_XSPI2) and ConfigType): the dummy
+ * cycles of the recorded sequence depend on them.
+ ******************************************************************************
+ */
+
+#include "hal_xspi_host.h"
+#include "stm32_sfdp_driver_type.h"
+#include "stm32_sfdp_driver_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          INPUT                                             */
+/*============================================================================*/
+
+static int Profile_ParseId(const char *text, uint8_t *id)
+{
+    unsigned int b[3];
+
+    if (sscanf(text, "%x:%x:%x", &b[0], &b[1], &b[2]) != 3)
+    {
+        return -1;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        id[i] = (uint8_t)b[i];
+    }
+    return 0;
+}
+
+static int Profile_ParseLink(const char *text, EXTMEM_LinkConfig_TypeDef *link)
+{
+    switch (atoi(text))
+    {
+    case 1: *link = EXTMEM_LINK_CONFIG_1LINE;  return 0;
+    case 2: *link = EXTMEM_LINK_CONFIG_2LINES; return 0;
+    case 4: *link = EXTMEM_LINK_CONFIG_4LINES; return 0;
+    case 8: *link = EXTMEM_LINK_CONFIG_8LINES; return 0;
+    default: return -1;
+    }
+}
+
+/* Link as given with -l and as negotiated by the driver, the same text in the
+ * header and on stderr */
+static void Profile_LinkText(const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *obj, char *text, size_t size)
+{
+    static const char *const phyNames[] = {
+        "1S1S1S", "1S1S2S", "1S2S2S", "1S1D1D", "4S4S4S", "4S4D4D", "4D4D4D", "1S8S8S", "8S8D8D", "8D8D8D"
+    };
+    uint32_t phy = (uint32_t)obj->sfpd_private.SALObject.PhyLink;
+
+    snprintf(text, size, "%u lines (%s)", 1U << (unsigned int)obj->sfpd_private.Config,
+             (phy < (sizeof(phyNames) / sizeof(phyNames[0]))) ? phyNames[phy] : "?");
+}
+
+static long Profile_LoadDump(const char *path, uint8_t *buf, uint32_t max)
+{
+    FILE *f = fopen(path, "rb");
+    size_t len;
+
+    if (f == NULL)
+    {
+        return -1;
+    }
+    len = fread(buf, 1, max, f);
+    fclose(f);
+    return (long)len;
+}
+
+/*============================================================================*/
+/*                          OUTPUT                                            */
+/*============================================================================*/
+
+static void Profile_EmitCommand(FILE *out, const XSPI_RegularCmdTypeDef *c, const char *indent)
+{
+    fprintf(out, "%s.OperationType = 0x%lXU, .IOSelect = 0x%lXU,\n", indent,
+            (unsigned long)c->OperationType, (unsigned long)c->IOSelect);
+    fprintf(out, "%s.Instruction = 0x%lXU, .InstructionMode = 0x%lXU, .InstructionWidth = 0x%lXU, .InstructionDTRMode = 0x%lXU,\n", indent,
+            (unsigned long)c->Instruction, (unsigned long)c->InstructionMode,
+            (unsigned long)c->InstructionWidth, (unsigned long)c->InstructionDTRMode);
+    fprintf(out, "%s.Address = 0x%lXU, .AddressMode = 0x%lXU, .AddressWidth = 0x%lXU, .AddressDTRMode = 0x%lXU,\n", indent,
+            (unsigned long)c->Address, (unsigned long)c->AddressMode,
+            (unsigned long)c->AddressWidth, (unsigned long)c->AddressDTRMode);
+    fprintf(out, "%s.AlternateBytes = 0x%lXU, .AlternateBytesMode = 0x%lXU, .AlternateBytesWidth = 0x%lXU, .AlternateBytesDTRMode = 0x%lXU,\n", indent,
+            (unsigned long)c->AlternateBytes, (unsigned long)c->AlternateBytesMode,
+            (unsigned long)c->AlternateBytesWidth, (unsigned long)c->AlternateBytesDTRMode);
+    fprintf(out, "%s.DataMode = 0x%lXU, .DataLength = %luU, .DataDTRMode = 0x%lXU,\n", indent,
+            (unsigned long)c->DataMode, (unsigned long)c->DataLength, (unsigned long)c->DataDTRMode);
+    fprintf(out, "%s.DummyCycles = %luU, .DQSMode = 0x%lXU,\n", indent,
+            (unsigned long)c->DummyCycles, (unsigned long)c->DQSMode);
+#if defined(XSPI_CCR_SIOO)
+    fprintf(out, "%s.SIOOMode = 0x%lXU,\n", indent, (unsigned long)c->SIOOMode);
+#endif /* XSPI_CCR_SIOO */
+}
+
+static void Profile_EmitSteps(FILE *out, const HOST_XSPI_Record_t *rec)
+{
+    for (uint32_t s = 0; s < rec->stepCount; s++)
+    {
+        const HOST_XSPI_Step_t *step = &rec->steps[s];
+
+        if (step->dataSize == 0U)
+        {
+            continue;
+        }
+        fprintf(out, "static const uint8_t sfdp_profile_data%lu[] = {", (unsigned long)s);
+        for (uint32_t i = 0; i < step->dataSize; i++)
+        {
+            fprintf(out, "%s0x%02X", (i == 0U) ? " " : ", ", step->data[i]);
+        }
+        fprintf(out, " };\n");
+    }
+    fprintf(out, "\nstatic const SAL_XSPI_CommandStepTypeDef sfdp_profile_steps[] = {\n");
+    for (uint32_t s = 0; s < rec->stepCount; s++)
+    {
+        const HOST_XSPI_Step_t *step = &rec->steps[s];
+
+        fprintf(out, "  { /* %lu: %s 0x%02lX */\n    .Command = {\n", (unsigned long)s,
+                step->polling ? "poll" : (step->dataSize != 0U) ? "write" : "command",
+                (unsigned long)step->command.Instruction);
+        Profile_EmitCommand(out, &step->command, "      ");
+        fprintf(out, "    },\n");
+        if (step->dataSize != 0U)
+        {
+            fprintf(out, "    .Data = sfdp_profile_data%lu,\n", (unsigned long)s);
+        }
+        else
+        {
+            fprintf(out, "    .Data = NULL,\n");
+        }
+        fprintf(out, "    .Delay = %luU, .Polling = %uU, .MatchValue = 0x%02XU, .MatchMask = 0x%02XU\n  },\n",
+                (unsigned long)step->delay, step->polling, step->matchValue, step->matchMask);
+    }
+    fprintf(out, "};\n\n");
+}
+
+static void Profile_EmitInfo(FILE *out, const EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef *d)
+{
+    fprintf(out, "  .DriverInfo = {\n");
+    fprintf(out, "    .SpiPhyLink = %u, .ClockIn = 0U,\n", (unsigned int)d->SpiPhyLink);
+    fprintf(out, "    .ReadWIPCommand = 0x%02XU, .WIPPosition = %uU, .WIPBusyPolarity = %uU, .WIPAddress = 0x%02XU,\n",
+            d->ReadWIPCommand, d->WIPPosition, d->WIPBusyPolarity, d->WIPAddress);
+    fprintf(out, "    .WriteWELCommand = 0x%02XU,\n", d->WriteWELCommand);
+    fprintf(out, "    .ReadWELCommand = 0x%02XU, .WELPosition = %uU, .WELBusyPolarity = %uU, .WELAddress = 0x%02XU,\n",
+            d->ReadWELCommand, d->WELPosition, d->WELBusyPolarity, d->WELAddress);
+    fprintf(out, "    .PageProgramInstruction = 0x%02XU, .ReadInstruction = 0x%02XU,\n",
+            d->PageProgramInstruction, d->ReadInstruction);
+    fprintf(out, "    .EraseType1Size = %uU, .EraseType1Command = 0x%02XU, .EraseType2Size = %uU, .EraseType2Command = 0x%02XU,\n",
+            d->EraseType1Size, d->EraseType1Command, d->EraseType2Size, d->EraseType2Command);
+    fprintf(out, "    .EraseType3Size = %uU, .EraseType3Command = 0x%02XU, .EraseType4Size = %uU, .EraseType4Command = 0x%02XU,\n",
+            d->EraseType3Size, d->EraseType3Command, d->EraseType4Size, d->EraseType4Command);
+    fprintf(out, "    .EraseType1Timing = %luU, .EraseType2Timing = %luU, .EraseType3Timing = %luU, .EraseType4Timing = %luU,\n",
+            (unsigned long)d->EraseType1Timing, (unsigned long)d->EraseType2Timing,
+            (unsigned long)d->EraseType3Timing, (unsigned long)d->EraseType4Timing);
+    fprintf(out, "    .EraseChipTiming = %luU,\n", (unsigned long)d->EraseChipTiming);
+    fprintf(out, "    .SuspendCommand = 0x%02XU, .ResumeCommand = 0x%02XU, .SuspendLatency = %luU, .ResumeToSuspendDelay = %luU\n",
+            d->SuspendCommand, d->ResumeCommand,
+            (unsigned long)d->SuspendLatency, (unsigned long)d->ResumeToSuspendDelay);
+    fprintf(out, "  },\n");
+}
+
+static void Profile_Emit(FILE *out, const char *dumpPath, const uint8_t *id, uint32_t clockIn,
+                         uint32_t clockRequested, const EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *obj,
+                         const HOST_XSPI_Record_t *rec)
+{
+    const SAL_XSPI_ObjectTypeDef *sal = &obj->sfpd_private.SALObject;
+    char link[32];
+
+    Profile_LinkText(obj, link, sizeof(link));
+    fprintf(out, "/* Static NOR SFDP profile generated by tools/sfdp_profile, do not edit.\n");
+    fprintf(out, " * Source: %s, JEDEC ID %02X:%02X:%02X\n", dumpPath, id[0], id[1], id[2]);
+    fprintf(out, " * Valid for an XSPI kernel clock of %lu Hz and link %s */\n\n",
+            (unsigned long)clockIn, link);
+    fprintf(out, "#ifndef SFDP_PROFILE_H\n#define SFDP_PROFILE_H\n\n");
+
+    Profile_EmitSteps(out, rec);
+
+    fprintf(out, "static const EXTMEM_DRIVER_NOR_SFDP_ProfileTypeDef sfdp_profile = {\n");
+    fprintf(out, "  .ClockIn = %luU, .ClockRequested = %luU,\n", (unsigned long)clockIn, (unsigned long)clockRequested);
+    fprintf(out, "  .MaxFreq = %luU, .DtrReadDummyCycle = %uU,\n",
+            (unsigned long)obj->sfdp_public.MaxFreq, obj->sfdp_public.DtrReadDummyCycle);
+    fprintf(out, "  .ManuID = 0x%02XU, .FlashSize = %uU, .PageSize = %luU,\n",
+            obj->sfpd_private.ManuID, obj->sfpd_private.FlashSize, (unsigned long)obj->sfpd_private.PageSize);
+    Profile_EmitInfo(out, &obj->sfpd_private.DriverInfo);
+    fprintf(out, "  .Sfdp_table_mask = 0x%08lXU, .Reset_info = 0x%08lXU,\n",
+            (unsigned long)obj->sfpd_private.Sfdp_table_mask, (unsigned long)obj->sfpd_private.Reset_info);
+    fprintf(out, "  .Sfdp_param_number = %uU, .Sfdp_AccessProtocol = 0x%02XU,\n",
+            obj->sfpd_private.Sfdp_param_number, obj->sfpd_private.Sfdp_AccessProtocol);
+    fprintf(out, "  .Commandbase = {\n");
+    Profile_EmitCommand(out, &sal->Commandbase, "    ");
+    fprintf(out, "  },\n");
+    fprintf(out, "  .CommandExtension = %uU, .SFDPDummyCycle = %uU, .PhyLink = %u, .DTRDummyCycle = %uU,\n",
+            sal->CommandExtension, sal->SFDPDummyCycle, (unsigned int)sal->PhyLink, sal->DTRDummyCycle);
+    fprintf(out, "  .Steps = sfdp_profile_steps,\n");
+    fprintf(out, "  .StepCount = sizeof(sfdp_profile_steps) / sizeof(sfdp_profile_steps[0])\n");
+    fprintf(out, "};\n\n#endif /* SFDP_PROFILE_H */\n");
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+static void Profile_Usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s -c <xspi_clock_hz> [-l 1|2|4|8] [-i C2:81:39] [-o profile.h] sfdp.bin\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t dump[HOST_XSPI_MAX_SFDP];
+    EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef obj;
+    EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef status;
+    EXTMEM_LinkConfig_TypeDef link = EXTMEM_LINK_CONFIG_8LINES;
+    const HOST_XSPI_Record_t *rec;
+    uint8_t id[3] = { 0, 0, 0 };
+    uint32_t clockIn = 0;
+    uint32_t prescaler;
+    const char *outPath = NULL;
+    FILE *out = stdout;
+    char linkText[32];
+    long dumpSize;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:l:i:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c': clockIn = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'o': outPath = optarg; break;
+        case 'l':
+            if (Profile_ParseLink(optarg, &link) != 0) { Profile_Usage(argv[0]); return 2; }
+            break;
+        case 'i':
+            if (Profile_ParseId(optarg, id) != 0) { Profile_Usage(argv[0]); return 2; }
+            break;
+        default:
+            Profile_Usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((clockIn == 0U) || (optind != (argc - 1)))
+    {
+        Profile_Usage(argv[0]);
+        return 2;
+    }
+
+    dumpSize = Profile_LoadDump(argv[optind], dump, sizeof(dump));
+    if (dumpSize < 16)
+    {
+        fprintf(stderr, "%s: cannot read a SFDP header\n", argv[optind]);
+        return 1;
+    }
+
+    /* Run the target discovery against the dump */
+    HOST_XSPI_Setup(dump, (uint32_t)dumpSize, id);
+    memset(&obj, 0, sizeof(obj));
+    status = EXTMEM_DRIVER_NOR_SFDP_Init(HOST_XSPI_Handle(), link, clockIn, &obj);
+    rec = HOST_XSPI_GetRecord();
+    if (status != EXTMEM_DRIVER_NOR_SFDP_OK)
+    {
+        fprintf(stderr, "SFDP discovery failed (%d)\n", (int)status);
+        return 1;
+    }
+    if (rec->overflow != 0U)
+    {
+        fprintf(stderr, "configuration sequence too long (max %u steps of %u bytes)\n",
+                HOST_XSPI_MAX_STEPS, HOST_XSPI_MAX_DATA);
+        return 1;
+    }
+
+    /* Memory clock left by the discovery, programmed again by the target */
+    prescaler = (HOST_XSPI_Handle()->Instance->DCR2 & XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos;
+
+    if (outPath != NULL)
+    {
+        out = fopen(outPath, "w");
+        if (out == NULL)
+        {
+            perror(outPath);
+            return 1;
+        }
+    }
+    Profile_Emit(out, argv[optind], id, clockIn, clockIn / (prescaler + 1U), &obj, rec);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    Profile_LinkText(&obj, linkText, sizeof(linkText));
+    fprintf(stderr, "flash 2^%u bytes, page %lu bytes, link %s, clock %lu Hz, %lu SFDP reads, %lu steps\n",
+            obj.sfpd_private.FlashSize, (unsigned long)obj.sfpd_private.PageSize,
+            linkText, (unsigned long)(clockIn / (prescaler + 1U)),
+            (unsigned long)rec->sfdpReads, (unsigned long)rec->stepCount);
+    return 0;
+}
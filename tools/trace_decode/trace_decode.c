@@ -0,0 +1,413 @@
+/**
+ ******************************************************************************
+ * @file    trace_decode.c
+ * @brief   Decode the trace dumps of a UART4 capture into Chrome trace JSON
+ *
+ * Usage:
+ *   trace_decode [-o trace.json] capture_file
+ *
+ * The capture is the raw UART4 log of the Boot or the Appli built with
+ * TRACE_ENABLE 1 (or of nor_sim / modem_sim run with -T): text lines with
+ * the binary dumps of Trace_Dump between them. Each dump is found by its
+ * magic and checked with its sum, then:
+ *  - the 32-bit cycle counter is unwrapped with the 16-bit HAL tick of each
+ *    event, which also puts back in order an event taken by an interrupt
+ *    between the slot and the time stamp of another one
+ *  - each begin is matched with the next end of the same span ID
+ *  - the spans are written as complete ("X") events, one process per dump,
+ *    for chrome://tracing or ui.perfetto.dev, and summed up on stderr
+ *
+ * Checks: at least one dump is found and every dump found has a good sum,
+ * or the exit code is 1.
+ ******************************************************************************
+ */
+
+#include "trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          DEFINITIONS                                       */
+/*============================================================================*/
+
+#define DECODE_MAX_DEPTH        16U         /* open spans of one ID */
+#define DECODE_CYCLE_WRAP       4294967296.0
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t arg;
+    uint16_t tick;
+    uint16_t id;
+    uint32_t index;             /* position in the dump, for a stable sort */
+    double   time;              /* unwrapped cycles */
+} Decode_Event_t;
+
+typedef struct {
+    uint32_t count;
+    double   totalUs;
+    double   minUs;
+    double   maxUs;
+} Decode_Stats_t;
+
+/* Span names: must follow Trace_Id_t */
+static const char *const decodeNames[TRACE_ID_COUNT] = {
+    [TRACE_ID_NONE]          = "none",
+    [TRACE_ID_BOOT_UPDATE]   = "Boot update",
+    [TRACE_ID_EXTMEM_INIT]   = "EXTMEM init",
+    [TRACE_ID_FLASH_ERASE]   = "Flash erase",
+    [TRACE_ID_FLASH_PROGRAM] = "Flash program",
+    [TRACE_ID_FLASH_VERIFY]  = "Flash verify",
+    [TRACE_ID_CRC]           = "CRC",
+    [TRACE_ID_USB_ENUM]      = "USB enumeration",
+    [TRACE_ID_AT_COMMAND]    = "AT",
+    [TRACE_ID_OTA_DOWNLOAD]  = "OTA download",
+    [TRACE_ID_OTA_CHUNK]     = "OTA chunk",
+};
+
+static FILE *out;
+static int   firstEvent = 1;
+
+/*============================================================================*/
+/*                          DUMP PARSING                                      */
+/*============================================================================*/
+
+static uint32_t Decode_Read32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t Decode_Read16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief  Check the header and the sum of the dump at p
+ * @retval Size of the dump in bytes, 0 if it is not a valid one
+ */
+static size_t Decode_CheckDump(const uint8_t *p, size_t avail, Trace_DumpHeader_t *header)
+{
+    size_t size;
+    uint32_t sum = 0;
+
+    if (avail < (sizeof(Trace_DumpHeader_t) + 4U))
+    {
+        return 0;
+    }
+    header->magic = Decode_Read32(&p[0]);
+    header->image = p[4];
+    header->eventSize = p[5];
+    header->count = Decode_Read16(&p[6]);
+    header->coreClock = Decode_Read32(&p[8]);
+    header->lost = Decode_Read32(&p[12]);
+    if ((header->magic != TRACE_DUMP_MAGIC) || (header->eventSize != sizeof(Trace_Event_t))
+        || (header->coreClock == 0U))
+    {
+        return 0;
+    }
+
+    size = sizeof(Trace_DumpHeader_t) + ((size_t)header->count * sizeof(Trace_Event_t));
+    if (avail < (size + 4U))
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < size; i += 4U)
+    {
+        sum += Decode_Read32(&p[i]);
+    }
+    return (sum == Decode_Read32(&p[size])) ? (size + 4U) : 0;
+}
+
+static int Decode_CompareTime(const void *a, const void *b)
+{
+    const Decode_Event_t *ea = a;
+    const Decode_Event_t *eb = b;
+
+    if (ea->time != eb->time)
+    {
+        return (ea->time < eb->time) ? -1 : 1;
+    }
+    return (ea->index < eb->index) ? -1 : 1;
+}
+
+/**
+ * @brief  Unwrap the cycle counter: the tick difference gives the number of
+ *         2^32 wraps between two events, up to 32 s apart
+ */
+static void Decode_Unwrap(Decode_Event_t *events, uint32_t count, uint32_t coreClock)
+{
+    double cyclesPerMs = coreClock / 1000.0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (i == 0U)
+        {
+            events[i].time = events[i].cycles;
+            continue;
+        }
+
+        uint32_t dCycles = events[i].cycles - events[i - 1U].cycles;
+        int16_t  dMs = (int16_t)(events[i].tick - events[i - 1U].tick);
+        double   wraps = nearbyint(((dMs * cyclesPerMs) - dCycles) / DECODE_CYCLE_WRAP);
+
+        events[i].time = events[i - 1U].time + dCycles + (wraps * DECODE_CYCLE_WRAP);
+    }
+}
+
+/*============================================================================*/
+/*                          OUTPUT                                            */
+/*============================================================================*/
+
+static void Decode_PrintTag(FILE *f, uint32_t tag)
+{
+    for (uint32_t i = 0; i < 4U; i++)
+    {
+        char c = (char)(tag >> (8U * i));
+
+        if ((c >= '!') && (c <= '~') && (c != '"') && (c != '\\'))
+        {
+            fputc(c, f);
+        }
+    }
+}
+
+static void Decode_Span(uint32_t pid, const Decode_Event_t *begin, const Decode_Event_t *end,
+                        double t0, double cyclesPerUs)
+{
+    uint16_t id = begin->id;
+
+    fprintf(out, "%s\n  {\"name\": \"", firstEvent ? "" : ",");
+    firstEvent = 0;
+    fputs(decodeNames[id], out);
+    if (id == TRACE_ID_AT_COMMAND)
+    {
+        fputc(' ', out);
+        Decode_PrintTag(out, begin->arg);
+    }
+    fprintf(out, "\", \"cat\": \"span\", \"pid\": %lu, \"tid\": 1, \"ts\": %.3f, ",
+            (unsigned long)pid, (begin->time - t0) / cyclesPerUs);
+    if (end != NULL)
+    {
+        fprintf(out, "\"ph\": \"X\", \"dur\": %.3f, \"args\": {\"begin\": \"0x%08lx\", \"end\": \"0x%08lx\"}}",
+                (end->time - begin->time) / cyclesPerUs, (unsigned long)begin->arg, (unsigned long)end->arg);
+    }
+    else
+    {
+        /* Still open at the dump */
+        fprintf(out, "\"ph\": \"i\", \"s\": \"t\", \"args\": {\"begin\": \"0x%08lx\", \"open\": 1}}",
+                (unsigned long)begin->arg);
+    }
+}
+
+/**
+ * @brief  Decode one dump: spans to the JSON output, summary to stderr
+ */
+static void Decode_Dump(uint32_t pid, const uint8_t *p, const Trace_DumpHeader_t *header)
+{
+    Decode_Event_t *events = calloc(header->count + 1U, sizeof(Decode_Event_t));
+    Decode_Stats_t stats[TRACE_ID_COUNT];
+    uint32_t open[TRACE_ID_COUNT][DECODE_MAX_DEPTH];
+    uint32_t depth[TRACE_ID_COUNT];
+    uint32_t unmatched = 0;
+    uint32_t unknown = 0;
+    double cyclesPerUs = header->coreClock / 1000000.0;
+    double t0;
+
+    if (events == NULL)
+    {
+        fprintf(stderr, "trace_decode: out of memory\n");
+        exit(1);
+    }
+    memset(stats, 0, sizeof(stats));
+    memset(depth, 0, sizeof(depth));
+
+    for (uint32_t i = 0; i < header->count; i++)
+    {
+        const uint8_t *e = &p[sizeof(Trace_DumpHeader_t) + (i * sizeof(Trace_Event_t))];
+
+        events[i].cycles = Decode_Read32(&e[0]);
+        events[i].arg = Decode_Read32(&e[4]);
+        events[i].tick = Decode_Read16(&e[8]);
+        events[i].id = Decode_Read16(&e[10]);
+        events[i].index = i;
+    }
+    Decode_Unwrap(events, header->count, header->coreClock);
+    qsort(events, header->count, sizeof(Decode_Event_t), Decode_CompareTime);
+    t0 = (header->count != 0U) ? events[0].time : 0.0;
+
+    fprintf(out, "%s\n  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %lu, \"args\": {\"name\": \"%s %lu\"}}",
+            firstEvent ? "" : ",", (unsigned long)pid,
+            (header->image == TRACE_IMAGE_BOOT) ? "Boot" : (header->image == TRACE_IMAGE_APPLI) ? "Appli" : "image",
+            (unsigned long)pid);
+    firstEvent = 0;
+
+    for (uint32_t i = 0; i < header->count; i++)
+    {
+        uint16_t id = events[i].id & (uint16_t)~TRACE_END_FLAG;
+
+        if ((id == TRACE_ID_NONE) || (id >= TRACE_ID_COUNT))
+        {
+            unknown++;
+            continue;
+        }
+        if ((events[i].id & TRACE_END_FLAG) == 0U)
+        {
+            if (depth[id] < DECODE_MAX_DEPTH)
+            {
+                open[id][depth[id]++] = i;
+            }
+            continue;
+        }
+        if (depth[id] == 0U)
+        {
+            /* Begin overwritten in the ring, or recorded before Trace_Init */
+            unmatched++;
+            continue;
+        }
+
+        const Decode_Event_t *begin = &events[open[id][--depth[id]]];
+        double us = (events[i].time - begin->time) / cyclesPerUs;
+
+        Decode_Span(pid, begin, &events[i], t0, cyclesPerUs);
+        if ((stats[id].count == 0U) || (us < stats[id].minUs))
+        {
+            stats[id].minUs = us;
+        }
+        if (us > stats[id].maxUs)
+        {
+            stats[id].maxUs = us;
+        }
+        stats[id].totalUs += us;
+        stats[id].count++;
+    }
+    for (uint32_t id = 0; id < TRACE_ID_COUNT; id++)
+    {
+        for (uint32_t d = 0; d < depth[id]; d++)
+        {
+            Decode_Span(pid, &events[open[id][d]], NULL, t0, cyclesPerUs);
+        }
+    }
+
+    fprintf(stderr, "dump %lu: %s, %lu events, %lu lost, %lu MHz, %.3f ms\n",
+            (unsigned long)pid,
+            (header->image == TRACE_IMAGE_BOOT) ? "Boot" : (header->image == TRACE_IMAGE_APPLI) ? "Appli" : "unknown image",
+            (unsigned long)header->count, (unsigned long)header->lost,
+            (unsigned long)(header->coreClock / 1000000U),
+            (header->count != 0U) ? ((events[header->count - 1U].time - t0) / cyclesPerUs / 1000.0) : 0.0);
+    fprintf(stderr, "  %-16s %6s %12s %10s %10s %10s\n", "span", "count", "total us", "min us", "mean us", "max us");
+    for (uint32_t id = 1; id < TRACE_ID_COUNT; id++)
+    {
+        if (stats[id].count != 0U)
+        {
+            fprintf(stderr, "  %-16s %6lu %12.1f %10.1f %10.1f %10.1f\n", decodeNames[id],
+                    (unsigned long)stats[id].count, stats[id].totalUs, stats[id].minUs,
+                    stats[id].totalUs / stats[id].count, stats[id].maxUs);
+        }
+    }
+    if ((unmatched != 0U) || (unknown != 0U))
+    {
+        fprintf(stderr, "  %lu ends without a begin, %lu unknown IDs\n", (unsigned long)unmatched, (unsigned long)unknown);
+    }
+    free(events);
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+int main(int argc, char **argv)
+{
+    static const uint8_t magic[4] = {
+        (uint8_t)TRACE_DUMP_MAGIC, (uint8_t)(TRACE_DUMP_MAGIC >> 8),
+        (uint8_t)(TRACE_DUMP_MAGIC >> 16), (uint8_t)(TRACE_DUMP_MAGIC >> 24)
+    };
+    const char *outPath = NULL;
+    uint8_t *capture;
+    size_t size;
+    size_t pos = 0;
+    uint32_t dumps = 0;
+    uint32_t bad = 0;
+    FILE *f;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o': outPath = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-o trace.json] capture_file\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        fprintf(stderr, "usage: %s [-o trace.json] capture_file\n", argv[0]);
+        return 2;
+    }
+
+    f = fopen(argv[optind], "rb");
+    if (f == NULL)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    (void)fseek(f, 0, SEEK_END);
+    size = (size_t)ftell(f);
+    (void)fseek(f, 0, SEEK_SET);
+    capture = malloc(size + 1U);
+    if ((capture == NULL) || (fread(capture, 1U, size, f) != size))
+    {
+        fprintf(stderr, "trace_decode: cannot read %s\n", argv[optind]);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    out = (outPath != NULL) ? fopen(outPath, "w") : stdout;
+    if (out == NULL)
+    {
+        perror(outPath);
+        return 1;
+    }
+    fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    while ((pos + sizeof(magic)) <= size)
+    {
+        Trace_DumpHeader_t header;
+        size_t dumpSize;
+
+        if (memcmp(&capture[pos], magic, sizeof(magic)) != 0)
+        {
+            pos++;
+            continue;
+        }
+        dumpSize = Decode_CheckDump(&capture[pos], size - pos, &header);
+        if (dumpSize == 0U)
+        {
+            /* The magic in the text or a dump cut by the capture */
+            fprintf(stderr, "offset %lu: magic without a valid dump\n", (unsigned long)pos);
+            bad++;
+            pos++;
+            continue;
+        }
+        Decode_Dump(++dumps, &capture[pos], &header);
+        pos += dumpSize;
+    }
+
+    fprintf(out, "\n]}\n");
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    free(capture);
+
+    if (dumps == 0U)
+    {
+        fprintf(stderr, "no trace dump in %s\n", argv[optind]);
+    }
+    return ((dumps != 0U) && (bad == 0U)) ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/**
+ ******************************************************************************
+ * @file    wcache_bench.c
+ * @brief   Count the NOR operations saved by the ExtMem write cache
+ *
+ * Usage:
+ *   wcache_bench [-s image_size] [-p cache_pages]
+ *
+ * An image is streamed into Slot B in chunks of several sizes (the OTA
+ * downloader receives 330-byte HTTPREAD chunks), once with EXTMEM_Write per
+ * chunk as ota_flash.c did, once through EXTMEM_WCACHE. The NOR model
+ * counts what the NOR SFDP driver would issue for each EXTMEM_Write:
+ *  - one page program per page touched (the driver splits on page bounds)
+ *  - one status polling before the write, then WEL + WIP per page
+ *  - one EXTMEM call, i.e. one flash window in the application
+ * Programming ANDs the data into the array, like the memory, so the final
+ * contents are checked against the image for both paths.
+ ******************************************************************************
+ */
+
+#include "stm32_extmem_wcache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          NOR MODEL                                         */
+/*============================================================================*/
+
+#define NOR_PAGE_SIZE       256U
+#define NOR_BLOCK_SIZE      0x10000U
+#define NOR_SLOT_ADDR       0x01000000U     /* SLOT_B_FLASH_ADDR */
+#define NOR_SLOT_SIZE       0x00400000U     /* Modelled part of Slot B */
+
+typedef struct {
+    uint32_t calls;         /* EXTMEM_Write calls (flash windows) */
+    uint32_t programs;      /* Page programs */
+    uint32_t pollings;      /* WIP / WEL status pollings */
+    uint32_t erases;        /* Block erases */
+} Nor_Stats_t;
+
+static uint8_t nor[NOR_SLOT_SIZE];
+static Nor_Stats_t stats;
+
+static void Nor_Reset(void)
+{
+    memset(nor, 0x00, sizeof(nor));     /* Not erased: a missing erase shows */
+    memset(&stats, 0, sizeof(stats));
+}
+
+EXTMEM_StatusTypeDef EXTMEM_Write(uint32_t MemId, uint32_t Address, const uint8_t *Data, uint32_t Size)
+{
+    uint32_t first, last;
+
+    (void)MemId;
+
+    if ((Address < NOR_SLOT_ADDR) || ((Address - NOR_SLOT_ADDR + Size) > NOR_SLOT_SIZE) || (Size == 0U))
+    {
+        return EXTMEM_ERROR_PARAM;
+    }
+
+    first = Address / NOR_PAGE_SIZE;
+    last = (Address + Size - 1U) / NOR_PAGE_SIZE;
+
+    stats.calls++;
+    stats.programs += last - first + 1U;
+    stats.pollings += 1U + (2U * (last - first + 1U));
+
+    for (uint32_t i = 0; i < Size; i++)
+    {
+        nor[Address - NOR_SLOT_ADDR + i] &= Data[i];
+    }
+    return EXTMEM_OK;
+}
+
+EXTMEM_StatusTypeDef EXTMEM_EraseSector(uint32_t MemId, uint32_t Address, uint32_t Size)
+{
+    (void)MemId;
+
+    if ((Address < NOR_SLOT_ADDR) || ((Address - NOR_SLOT_ADDR + Size) > NOR_SLOT_SIZE)
+        || ((Address % NOR_BLOCK_SIZE) != 0U) || ((Size % NOR_BLOCK_SIZE) != 0U))
+    {
+        return EXTMEM_ERROR_PARAM;
+    }
+
+    memset(&nor[Address - NOR_SLOT_ADDR], 0xFF, Size);
+    stats.erases += Size / NOR_BLOCK_SIZE;
+    return EXTMEM_OK;
+}
+
+/*============================================================================*/
+/*                          WRITERS                                           */
+/*============================================================================*/
+
+/**
+ * @brief  Previous ota_flash.c behaviour: erase ahead, one write per chunk
+ */
+static int Bench_Direct(const uint8_t *image, uint32_t size, uint32_t chunk)
+{
+    uint32_t erasedUpTo = 0;
+
+    for (uint32_t offset = 0; offset < size; offset += chunk)
+    {
+        uint32_t len = ((size - offset) < chunk) ? (size - offset) : chunk;
+
+        while (erasedUpTo < (offset + len))
+        {
+            if (EXTMEM_EraseSector(0, NOR_SLOT_ADDR + erasedUpTo, NOR_BLOCK_SIZE) != EXTMEM_OK)
+            {
+                return -1;
+            }
+            erasedUpTo += NOR_BLOCK_SIZE;
+        }
+
+        if (EXTMEM_Write(0, NOR_SLOT_ADDR + offset, &image[offset], len) != EXTMEM_OK)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Same stream through EXTMEM_WCACHE, synced once at the end
+ */
+static int Bench_Cached(const uint8_t *image, uint32_t size, uint32_t chunk, uint32_t pages)
+{
+    static uint32_t eraseMap[EXTMEM_WCACHE_MAP_WORDS(NOR_SLOT_SIZE, NOR_BLOCK_SIZE)];
+    EXTMEM_WCACHE_HandleTypeDef cache;
+    EXTMEM_WCACHE_InitTypeDef init = {
+        .MemId         = 0,
+        .RegionAddress = NOR_SLOT_ADDR,
+        .RegionSize    = NOR_SLOT_SIZE,
+        .PageSize      = NOR_PAGE_SIZE,
+        .EraseSize     = NOR_BLOCK_SIZE,
+        .Buffer        = malloc(pages * NOR_PAGE_SIZE),
+        .BufferSize    = pages * NOR_PAGE_SIZE,
+        .EraseMap      = eraseMap,
+    };
+    int result = -1;
+
+    if ((init.Buffer != NULL) && (EXTMEM_WCACHE_Init(&cache, &init) == EXTMEM_OK))
+    {
+        result = 0;
+        for (uint32_t offset = 0; (offset < size) && (result == 0); offset += chunk)
+        {
+            uint32_t len = ((size - offset) < chunk) ? (size - offset) : chunk;
+
+            if (EXTMEM_WCACHE_Write(&cache, NOR_SLOT_ADDR + offset, &image[offset], len) != EXTMEM_OK)
+            {
+                result = -1;
+            }
+        }
+
+        if ((result == 0) && (EXTMEM_WCACHE_Sync(&cache) != EXTMEM_OK))
+        {
+            result = -1;
+        }
+
+        if ((result == 0) && ((cache.PageProgramCount != stats.programs) || (cache.EraseCount != stats.erases)))
+        {
+            fprintf(stderr, "cache statistics do not match the NOR model\n");
+            result = -1;
+        }
+    }
+
+    free(init.Buffer);
+    return result;
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+static const uint32_t chunkSizes[] = { 64, 128, 256, 330, 512, 1000, 1460, 4096 };
+
+static int Bench_Check(const uint8_t *image, uint32_t size, const char *label, uint32_t chunk)
+{
+    if (memcmp(nor, image, size) != 0)
+    {
+        fprintf(stderr, "%s, chunk %u: flash contents differ from the image\n", label, chunk);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t size = 512U * 1024U;
+    uint32_t pages = 4U;
+    uint8_t *image;
+    int opt;
+    int result = 0;
+
+    while ((opt = getopt(argc, argv, "s:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's': size = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'p': pages = (uint32_t)strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-s image_size] [-p cache_pages]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if ((size == 0U) || (size > NOR_SLOT_SIZE) || (pages == 0U))
+    {
+        fprintf(stderr, "image size must be 1..%u bytes, cache at least one page\n", NOR_SLOT_SIZE);
+        return 2;
+    }
+
+    image = malloc(size);
+    if (image == NULL)
+    {
+        return 1;
+    }
+
+    srand(1);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        image[i] = (uint8_t)rand();
+    }
+
+    printf("image %u bytes, page %u bytes, cache %u page(s)\n\n", size, NOR_PAGE_SIZE, pages);
+    printf("chunk |      direct write      |      write cache       | programs\n");
+    printf("bytes | calls programs pollings | calls programs pollings | saved\n");
+    printf("------+------------------------+------------------------+---------\n");
+
+    for (uint32_t i = 0; (i < sizeof(chunkSizes) / sizeof(chunkSizes[0])) && (result == 0); i++)
+    {
+        uint32_t chunk = chunkSizes[i];
+        Nor_Stats_t direct;
+
+        Nor_Reset();
+        result = Bench_Direct(image, size, chunk);
+        if (result == 0)
+        {
+            result = Bench_Check(image, size, "direct", chunk);
+        }
+        direct = stats;
+
+        Nor_Reset();
+        if (result == 0)
+        {
+            result = Bench_Cached(image, size, chunk, pages);
+        }
+        if (result == 0)
+        {
+            result = Bench_Check(image, size, "cached", chunk);
+        }
+
+        if (result == 0)
+        {
+            printf("%5u | %5u %8u %8u | %5u %8u %8u | %5.1f %%\n", chunk,
+                   direct.calls, direct.programs, direct.pollings,
+                   stats.calls, stats.programs, stats.pollings,
+                   100.0 * (double)(direct.programs - stats.programs) / (double)direct.programs);
+        }
+    }
+
+    free(image);
+    return (result == 0) ? 0 : 1;
+}
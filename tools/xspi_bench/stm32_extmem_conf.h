@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file    stm32_extmem_conf.h
+ * @brief   ExtMem Manager configuration for the host build of xspi_bench.
+ *          Only the NOR SFDP driver and the XSPI SAL are compiled, with the
+ *          synchronous functions; the SFDP cache and the static profile stay
+ *          disabled.
+ ******************************************************************************
+ */
+
+#ifndef __STM32_EXTMEM_CONF__H__
+#define __STM32_EXTMEM_CONF__H__
+
+#define EXTMEM_DRIVER_NOR_SFDP   1
+#define EXTMEM_DRIVER_PSRAM      0
+#define EXTMEM_DRIVER_SDCARD     0
+#define EXTMEM_DRIVER_USER       0
+
+#define EXTMEM_SAL_XSPI   1
+#define EXTMEM_SAL_SD     0
+
+#define EXTMEM_DRIVER_NOR_SFDP_STATIC_PROFILE 0
+
+/* The model replaces the HAL functions, not the registers: the precompiled
+ * commands write the registers directly and stay disabled on the host */
+#define EXTMEM_DRIVER_NOR_SFDP_PRECOMPILED_COMMANDS  0
+
+/* CMSIS barriers are ARM instructions: hide the inline version and make the
+ * SAL calls no-ops on the host */
+#define __DSB host_cmsis_dsb
+#include "stm32h7rsxx_hal.h"
+#undef __DSB
+#define __DSB() ((void)0)
+
+#include "stm32_extmem.h"
+#include "stm32_extmem_type.h"
+
+/* Memory table of the Boot, used by xspi_calib.c */
+enum {
+  EXTMEMORY_1  = 0
+};
+
+extern EXTMEM_DefinitionTypeDef extmem_list_config[1];
+
+#endif /* __STM32_EXTMEM_CONF__H__ */
@@ -0,0 +1,676 @@
+/**
+ ******************************************************************************
+ * @file    xspi_sim.c
+ * @brief   Cycle-modelled XSPI HAL and MX25UW25645G model for xspi_bench
+ *
+ * Usage:
+ *   xspi_bench [-k kernel_clock_hz] [-s board_skew]
+ *
+ * The benchmark and the read timing calibration of the Boot
+ * (Boot/Core/Src/xspi_bench.c, xspi_calib.c), the NOR SFDP driver and the
+ * XSPI SAL are linked unmodified against this file.
+ *
+ * Timing: every transaction costs its instruction, address, dummy and data
+ * cycles at the memory clock set in DCR2 (lines and DTR taken from the
+ * command), plus the chip select high time. A status polling costs one
+ * status read and the SAL polling interval per poll. Page program and
+ * erase keep the memory busy for their typical datasheet time.
+ *
+ * Checks, a failed check corrupts the transfer like the memory would:
+ *  - SPI mode takes 1S commands, OPI mode 8D commands with the 16-bit
+ *    command word made of the opcode and its inverse
+ *  - array reads need the dummy cycles of the clock bucket
+ *  - DTR array reads above SIM_NO_DQS_MAX_HZ need DQS
+ *  - DQS reads need a DQS input delay inside the sampling window: centred
+ *    on the DLL default plus the board skew, narrower as the clock rises
+ *  - program and erase need the write enable latch
+ ******************************************************************************
+ */
+
+#include "xspi_bench.h"
+#include "xspi_calib.h"
+#include "stm32_sal_xspi_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================*/
+/*                          MEMORY MODEL                                      */
+/*============================================================================*/
+
+#define SIM_FLASH_SIZE          0x02000000U     /* 256 Mbit */
+#define SIM_FLASH_SIZE_POW2     25U
+#define SIM_PAGE_SIZE           256U
+#define SIM_CS_HIGH_CYCLES      2U              /* ChipSelectHighTimeCycle of MX_XSPI2_Init */
+#define SIM_POLL_INTERVAL       0x10U           /* IntervalTime of SAL_XSPI_CheckStatusRegister */
+
+/* Typical datasheet times */
+#define SIM_TPP_NS              150000ULL       /* page program */
+#define SIM_TSE_NS              25000000ULL     /* 4KB sector erase */
+#define SIM_TBE_NS              220000000ULL    /* 64KB block erase */
+
+#define SIM_SPI_MAX_HZ          133000000U
+#define SIM_NO_DQS_MAX_HZ       133000000U
+
+/* DQS sampling window, in fine delay units */
+#define SIM_DLL_DEFAULT_FINE    0x40U           /* delay set by the DLL after a clock change */
+#define SIM_WINDOW_HALF_100MHZ  0x30U           /* half width of the window at 100 MHz */
+
+#define SIM_STATUS_WIP          0x01U
+#define SIM_STATUS_WEL          0x02U
+
+typedef enum {
+    SIM_MODE_SPI,               /* 1S1S1S */
+    SIM_MODE_OPI                /* 8D8D8D */
+} Sim_Mode_t;
+
+/* 8D8D8D read dummy cycles, one entry per clock bucket as in SFDP_BuildGenericDriver */
+static const struct {
+    uint32_t maxHz;
+    uint8_t  dummy;
+} simOpiDummy[] = {
+    { 100000000U, 10U },
+    { 133000000U, 14U },
+    { 166000000U, 16U },
+    { 200000000U, 20U },
+};
+
+static uint8_t *flash;
+static Sim_Mode_t simMode;
+static uint8_t simStatus;
+static uint64_t simNowNs;
+static uint64_t simBusyUntilNs;
+static uint32_t simKernelClock = 200000000U;
+static uint32_t simRejected;     /* Commands ignored by the memory */
+static uint32_t simCorrupted;    /* Reads returned with bad data */
+static int      simDummyOverride = -1;
+static int32_t  simSkew = 0x14;  /* Board skew of the DQS sampling window, fine units */
+static uint32_t simDllPrescaler = 0xFFFFFFFFU;
+
+EXTMEM_DefinitionTypeDef extmem_list_config[1];
+
+static XSPI_TypeDef simRegs;
+static XSPI_HandleTypeDef simHandle;
+static XSPI_RegularCmdTypeDef pendingCmd;
+
+static uint32_t Sim_Clock(void)
+{
+    uint32_t prescaler = (simRegs.DCR2 & XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos;
+    return simKernelClock / (prescaler + 1U);
+}
+
+/**
+ * @brief  The DLL calibrates the delay lines again on a clock change
+ */
+static void Sim_DllUpdate(void)
+{
+    uint32_t prescaler = (simRegs.DCR2 & XSPI_DCR2_PRESCALER) >> XSPI_DCR2_PRESCALER_Pos;
+
+    if (prescaler != simDllPrescaler)
+    {
+        simDllPrescaler = prescaler;
+        simRegs.CALSIR = SIM_DLL_DEFAULT_FINE;
+        simRegs.CALMR = SIM_DLL_DEFAULT_FINE;
+    }
+}
+
+/**
+ * @brief  Sampling window of the DQS reads at the current clock
+ */
+static void Sim_Window(int32_t *low, int32_t *high)
+{
+    int32_t centre = (int32_t)SIM_DLL_DEFAULT_FINE + simSkew;
+    int32_t half = (int32_t)(((uint64_t)SIM_WINDOW_HALF_100MHZ * 100000000U) / Sim_Clock());
+
+    *low = centre - half;
+    *high = centre + half;
+}
+
+static void Sim_Advance(uint64_t cycles)
+{
+    simNowNs += (cycles * 1000000000ULL) / Sim_Clock();
+}
+
+static uint32_t Sim_Lines(uint32_t mode, uint32_t one, uint32_t two, uint32_t four, uint32_t eight)
+{
+    if (mode == one)   return 1U;
+    if (mode == two)   return 2U;
+    if (mode == four)  return 4U;
+    if (mode == eight) return 8U;
+    return 0U;
+}
+
+/**
+ * @brief  Bus cycles of a phase of 'bits' bits
+ */
+static uint64_t Sim_PhaseCycles(uint64_t bits, uint32_t lines, uint32_t dtr)
+{
+    uint64_t perCycle = (uint64_t)lines * (dtr ? 2U : 1U);
+    return (lines == 0U) ? 0U : ((bits + perCycle - 1U) / perCycle);
+}
+
+/**
+ * @brief  Cycles of the command, address and dummy phases
+ */
+static uint64_t Sim_HeaderCycles(const XSPI_RegularCmdTypeDef *cmd)
+{
+    uint32_t iLines = Sim_Lines(cmd->InstructionMode, HAL_XSPI_INSTRUCTION_1_LINE, HAL_XSPI_INSTRUCTION_2_LINES,
+                                HAL_XSPI_INSTRUCTION_4_LINES, HAL_XSPI_INSTRUCTION_8_LINES);
+    uint32_t aLines = Sim_Lines(cmd->AddressMode, HAL_XSPI_ADDRESS_1_LINE, HAL_XSPI_ADDRESS_2_LINES,
+                                HAL_XSPI_ADDRESS_4_LINES, HAL_XSPI_ADDRESS_8_LINES);
+    uint32_t iBits = (cmd->InstructionWidth == HAL_XSPI_INSTRUCTION_16_BITS) ? 16U : 8U;
+    uint32_t aBits = (cmd->AddressWidth == HAL_XSPI_ADDRESS_32_BITS) ? 32U : 24U;
+
+    return SIM_CS_HIGH_CYCLES
+           + Sim_PhaseCycles(iBits, iLines, cmd->InstructionDTRMode == HAL_XSPI_INSTRUCTION_DTR_ENABLE)
+           + Sim_PhaseCycles(aBits, aLines, cmd->AddressDTRMode == HAL_XSPI_ADDRESS_DTR_ENABLE)
+           + cmd->DummyCycles;
+}
+
+static uint64_t Sim_DataCycles(const XSPI_RegularCmdTypeDef *cmd, uint32_t size)
+{
+    uint32_t dLines = Sim_Lines(cmd->DataMode, HAL_XSPI_DATA_1_LINE, HAL_XSPI_DATA_2_LINES,
+                                HAL_XSPI_DATA_4_LINES, HAL_XSPI_DATA_8_LINES);
+    return Sim_PhaseCycles((uint64_t)size * 8U, dLines, cmd->DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE);
+}
+
+/**
+ * @brief  Opcode of a command the memory accepts in its current mode
+ * @retval 0 if the instruction phase does not fit the mode
+ */
+static uint8_t Sim_Opcode(const XSPI_RegularCmdTypeDef *cmd)
+{
+    uint8_t op;
+
+    if (simMode == SIM_MODE_SPI)
+    {
+        if ((cmd->InstructionMode != HAL_XSPI_INSTRUCTION_1_LINE)
+            || (cmd->InstructionWidth != HAL_XSPI_INSTRUCTION_8_BITS)
+            || (cmd->InstructionDTRMode == HAL_XSPI_INSTRUCTION_DTR_ENABLE))
+        {
+            return 0;
+        }
+        return (uint8_t)cmd->Instruction;
+    }
+
+    /* OPI: 8 lines DTR, command extension is the inverse of the command */
+    op = (uint8_t)(cmd->Instruction >> 8);
+    if ((cmd->InstructionMode != HAL_XSPI_INSTRUCTION_8_LINES)
+        || (cmd->InstructionWidth != HAL_XSPI_INSTRUCTION_16_BITS)
+        || (cmd->InstructionDTRMode != HAL_XSPI_INSTRUCTION_DTR_ENABLE)
+        || ((uint8_t)cmd->Instruction != (uint8_t)~op))
+    {
+        return 0;
+    }
+    if ((cmd->AddressMode != HAL_XSPI_ADDRESS_NONE)
+        && ((cmd->AddressMode != HAL_XSPI_ADDRESS_8_LINES) || (cmd->AddressDTRMode != HAL_XSPI_ADDRESS_DTR_ENABLE)))
+    {
+        return 0;
+    }
+    return op;
+}
+
+static uint8_t Sim_Busy(void)
+{
+    if (simNowNs >= simBusyUntilNs)
+    {
+        simStatus &= (uint8_t)~SIM_STATUS_WIP;
+    }
+    return simStatus & SIM_STATUS_WIP;
+}
+
+/**
+ * @brief  Dummy cycles an array read needs at the current clock
+ */
+static uint8_t Sim_ReadDummy(void)
+{
+    uint32_t clock = Sim_Clock();
+
+    if (simMode == SIM_MODE_SPI)
+    {
+        return 8U;
+    }
+    for (uint32_t i = 0; i < (sizeof(simOpiDummy) / sizeof(simOpiDummy[0])); i++)
+    {
+        if (clock <= simOpiDummy[i].maxHz)
+        {
+            return simOpiDummy[i].dummy;
+        }
+    }
+    return 0xFFU;
+}
+
+/**
+ * @brief  Check the timing of an array read
+ * @retval 1 if the data are sampled correctly
+ */
+static int Sim_ReadValid(const XSPI_RegularCmdTypeDef *cmd)
+{
+    uint32_t clock = Sim_Clock();
+
+    if ((simMode == SIM_MODE_SPI) && (clock > SIM_SPI_MAX_HZ))
+    {
+        return 0;
+    }
+    if (cmd->DummyCycles < Sim_ReadDummy())
+    {
+        return 0;
+    }
+    if ((cmd->DataDTRMode == HAL_XSPI_DATA_DTR_ENABLE) && (clock > SIM_NO_DQS_MAX_HZ)
+        && (cmd->DQSMode != HAL_XSPI_DQS_ENABLE))
+    {
+        return 0;
+    }
+    if (cmd->DQSMode == HAL_XSPI_DQS_ENABLE)
+    {
+        int32_t low;
+        int32_t high;
+        int32_t fine;
+
+        Sim_DllUpdate();
+        Sim_Window(&low, &high);
+        fine = (int32_t)(simRegs.CALSIR & XSPI_CALSIR_FINE);
+        if ((fine < low) || (fine > high))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void Sim_Erase(uint32_t address, uint32_t size, uint64_t duration)
+{
+    if (((simStatus & SIM_STATUS_WEL) == 0U) || Sim_Busy())
+    {
+        simRejected++;
+        return;
+    }
+    address &= ~(size - 1U);
+    if (address < SIM_FLASH_SIZE)
+    {
+        memset(&flash[address], 0xFF, size);
+    }
+    simStatus = (uint8_t)((simStatus & ~SIM_STATUS_WEL) | SIM_STATUS_WIP);
+    simBusyUntilNs = simNowNs + duration;
+}
+
+/*============================================================================*/
+/*                          HAL FUNCTIONS                                     */
+/*============================================================================*/
+
+HAL_StatusTypeDef HAL_XSPI_Command(XSPI_HandleTypeDef *hxspi, XSPI_RegularCmdTypeDef *const pCmd, uint32_t Timeout)
+{
+    uint8_t op;
+
+    (void)hxspi;
+    (void)Timeout;
+
+    pendingCmd = *pCmd;
+    if (pCmd->DataMode != HAL_XSPI_DATA_NONE)
+    {
+        /* Executed with the data phase */
+        return HAL_OK;
+    }
+
+    Sim_Advance(Sim_HeaderCycles(pCmd));
+    op = Sim_Opcode(pCmd);
+    (void)Sim_Busy();
+
+    switch (op)
+    {
+    case 0x06:  /* WREN */
+        simStatus |= SIM_STATUS_WEL;
+        break;
+    case 0x04:  /* WRDI */
+        simStatus &= (uint8_t)~SIM_STATUS_WEL;
+        break;
+    case 0x21:  /* SE4B */
+        Sim_Erase(pCmd->Address, 0x1000U, SIM_TSE_NS);
+        break;
+    case 0xDC:  /* BE4B */
+        Sim_Erase(pCmd->Address, 0x10000U, SIM_TBE_NS);
+        break;
+    default:
+        simRejected++;
+        break;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_Transmit(XSPI_HandleTypeDef *hxspi, const uint8_t *pData, uint32_t Timeout)
+{
+    uint32_t address = pendingCmd.Address;
+
+    (void)hxspi;
+    (void)Timeout;
+
+    Sim_Advance(Sim_HeaderCycles(&pendingCmd) + Sim_DataCycles(&pendingCmd, pendingCmd.DataLength));
+
+    if ((Sim_Opcode(&pendingCmd) != 0x12U) || ((simStatus & SIM_STATUS_WEL) == 0U) || Sim_Busy()
+        || (address >= SIM_FLASH_SIZE))
+    {
+        simRejected++;
+        return HAL_OK;
+    }
+
+    /* Page program: wraps inside the page, only clears bits */
+    for (uint32_t i = 0; i < pendingCmd.DataLength; i++)
+    {
+        uint32_t pos = (address & ~(SIM_PAGE_SIZE - 1U)) | ((address + i) & (SIM_PAGE_SIZE - 1U));
+        flash[pos] &= pData[i];
+    }
+    simStatus = (uint8_t)((simStatus & ~SIM_STATUS_WEL) | SIM_STATUS_WIP);
+    simBusyUntilNs = simNowNs + SIM_TPP_NS;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_Receive(XSPI_HandleTypeDef *hxspi, uint8_t *const pData, uint32_t Timeout)
+{
+    static const uint8_t id[3] = { 0xC2, 0x81, 0x39 };
+    uint32_t len = pendingCmd.DataLength;
+    uint8_t op = Sim_Opcode(&pendingCmd);
+
+    (void)hxspi;
+    (void)Timeout;
+
+    Sim_Advance(Sim_HeaderCycles(&pendingCmd) + Sim_DataCycles(&pendingCmd, len));
+
+    switch (op)
+    {
+    case 0x0C:  /* FAST_READ4B, SPI */
+    case 0xEE:  /* 8DTRD, OPI */
+        if (((op == 0x0C) != (simMode == SIM_MODE_SPI)) || (pendingCmd.Address + len > SIM_FLASH_SIZE))
+        {
+            simRejected++;
+            memset(pData, 0xA5, len);
+            break;
+        }
+        memcpy(pData, &flash[pendingCmd.Address], len);
+        if (!Sim_ReadValid(&pendingCmd))
+        {
+            /* Sampled in the wrong data eye */
+            simCorrupted++;
+            for (uint32_t i = 0; i < len; i++)
+            {
+                pData[i] = (uint8_t)((pData[i] << 1) | (pData[i] >> 7));
+            }
+        }
+        break;
+
+    case 0x05:  /* RDSR */
+        memset(pData, Sim_Busy() | (simStatus & SIM_STATUS_WEL), len);
+        break;
+
+    case 0x9F:  /* RDID */
+        memset(pData, 0x00, len);
+        memcpy(pData, id, (len < sizeof(id)) ? len : sizeof(id));
+        break;
+
+    default:
+        simRejected++;
+        memset(pData, 0xA5, len);
+        break;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_AutoPolling(XSPI_HandleTypeDef *hxspi, XSPI_AutoPollingTypeDef *const pCfg, uint32_t Timeout)
+{
+    uint64_t pollCycles = Sim_HeaderCycles(&pendingCmd) + Sim_DataCycles(&pendingCmd, 1U) + SIM_POLL_INTERVAL;
+    uint64_t deadline = simNowNs + ((uint64_t)Timeout * 1000000ULL);
+
+    (void)hxspi;
+
+    if (Sim_Opcode(&pendingCmd) != 0x05U)
+    {
+        simRejected++;
+        simNowNs = deadline;
+        return HAL_TIMEOUT;
+    }
+
+    for (;;)
+    {
+        Sim_Advance(pollCycles);
+        if (((Sim_Busy() | (simStatus & SIM_STATUS_WEL)) & pCfg->MatchMask) == pCfg->MatchValue)
+        {
+            return HAL_OK;
+        }
+        if (simNowNs >= deadline)
+        {
+            return HAL_TIMEOUT;
+        }
+        if (Sim_Busy() && (simBusyUntilNs > simNowNs + 1000000ULL))
+        {
+            /* Long busy time: skip the polls that cannot match */
+            uint64_t polls = (simBusyUntilNs - simNowNs) * Sim_Clock() / (pollCycles * 1000000000ULL);
+            Sim_Advance(polls * pollCycles);
+        }
+    }
+}
+
+HAL_StatusTypeDef HAL_XSPI_MemoryMapped(XSPI_HandleTypeDef *hxspi, XSPI_MemoryMappedTypeDef *const pCfg)
+{
+    (void)hxspi;
+    (void)pCfg;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_Abort(XSPI_HandleTypeDef *hxspi)
+{
+    (void)hxspi;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_GetDelayValue(XSPI_HandleTypeDef *hxspi, XSPI_HSCalTypeDef *const pCfg)
+{
+    uint32_t reg = 0;
+
+    (void)hxspi;
+    Sim_DllUpdate();
+    switch (pCfg->DelayValueType)
+    {
+    case HAL_XSPI_CAL_FEEDBACK_CLK_DELAY: reg = simRegs.CALMR; break;
+    case HAL_XSPI_CAL_DQS_INPUT_DELAY:    reg = simRegs.CALSIR; break;
+    default: return HAL_ERROR;
+    }
+    pCfg->FineCalibrationUnit = reg & XSPI_CALSIR_FINE;
+    pCfg->CoarseCalibrationUnit = (reg & XSPI_CALSIR_COARSE) >> XSPI_CALSIR_COARSE_Pos;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_XSPI_SetDelayValue(XSPI_HandleTypeDef *hxspi, XSPI_HSCalTypeDef *const pCfg)
+{
+    uint32_t reg = pCfg->FineCalibrationUnit | (pCfg->CoarseCalibrationUnit << XSPI_CALSIR_COARSE_Pos);
+
+    (void)hxspi;
+    Sim_DllUpdate();
+    switch (pCfg->DelayValueType)
+    {
+    case HAL_XSPI_CAL_FEEDBACK_CLK_DELAY: simRegs.CALMR = reg; break;
+    case HAL_XSPI_CAL_DQS_INPUT_DELAY:    simRegs.CALSIR = reg; break;
+    default: return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(simNowNs / 1000000ULL);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    simNowNs += (uint64_t)Delay * 1000000ULL;
+}
+
+/*============================================================================*/
+/*                          PLATFORM HOOKS (HOST)                             */
+/*============================================================================*/
+
+/**
+ * @brief  Configure the driver object as SFDP_BuildGenericDriver does on the
+ *         board for the MX25UW25645G, without the SFDP discovery
+ */
+EXTMEM_DRIVER_NOR_SFDP_StatusTypeDef XSPI_Bench_Setup(const XSPI_Bench_Point_t *point,
+                                                      EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object)
+{
+    EXTMEM_DRIVER_NOR_SFDP_InfoTypeDef *info = &object->sfpd_private.DriverInfo;
+    SAL_XSPI_ObjectTypeDef *sal = &object->sfpd_private.SALObject;
+    uint8_t octal = (point->config == EXTMEM_LINK_CONFIG_8LINES) ? 1U : 0U;
+    uint32_t maxFreq = octal ? 200000000U : SIM_SPI_MAX_HZ;
+    uint32_t clock;
+    uint8_t dummy;
+
+    /* Memory state after the reset and the link switch */
+    simMode = octal ? SIM_MODE_OPI : SIM_MODE_SPI;
+    simStatus = 0;
+    simBusyUntilNs = simNowNs;
+
+    object->sfpd_private.Config = point->config;
+    object->sfpd_private.ManuID = 0xC2;
+    object->sfpd_private.FlashSize = SIM_FLASH_SIZE_POW2;
+    object->sfpd_private.PageSize = SIM_PAGE_SIZE;
+
+    info->SpiPhyLink = octal ? PHY_LINK_8D8D8D : PHY_LINK_1S1S1S;
+    info->ClockIn = simKernelClock;
+    info->ReadWIPCommand = 0x05;
+    info->ReadWELCommand = 0x05;
+    info->WriteWELCommand = 0x06;
+    info->WIPPosition = 0;
+    info->WELPosition = 1;
+    info->PageProgramInstruction = 0x12;
+    info->ReadInstruction = octal ? 0xEE : 0x0C;
+    info->EraseType1Size = 12;
+    info->EraseType1Command = 0x21;
+    info->EraseType1Timing = 400;
+    info->EraseType3Size = 16;
+    info->EraseType3Command = 0xDC;
+    info->EraseType3Timing = 2000;
+
+    (void)SAL_XSPI_Init(sal, &simHandle);
+    (void)SAL_XSPI_MemoryConfig(sal, PARAM_PHY_LINK, &info->SpiPhyLink);
+    (void)SAL_XSPI_MemoryConfig(sal, PARAM_ADDRESS_4BITS, NULL);
+    SAL_XSPI_SET_COMMANDEXTENSION(*sal, octal);
+
+    if ((point->maxFreq != 0U) && (point->maxFreq < maxFreq))
+    {
+        maxFreq = point->maxFreq;
+    }
+    (void)SAL_XSPI_SetClock(sal, simKernelClock, maxFreq, &clock);
+
+    /* Same buckets as SFDP_BuildGenericDriver: the smallest frequency covering the clock */
+    dummy = octal ? Sim_ReadDummy() : 8U;
+    if (simDummyOverride >= 0)
+    {
+        dummy = (uint8_t)simDummyOverride;
+    }
+    (void)SAL_XSPI_MemoryConfig(sal, PARAM_DUMMY_CYCLES, &dummy);
+
+    /* Starting point of the calibration, as at the end of EXTMEM_DRIVER_NOR_SFDP_Init */
+    (void)SAL_XSPI_GetTiming(sal, &object->sfpd_private.DefaultTiming);
+
+    return EXTMEM_DRIVER_NOR_SFDP_OK;
+}
+
+uint64_t XSPI_Bench_TimeNs(void)
+{
+    return simNowNs;
+}
+
+void XSPI_Bench_Print(const char *str)
+{
+    fputs(str, stdout);
+}
+
+/*============================================================================*/
+/*                          MAIN                                              */
+/*============================================================================*/
+
+/**
+ * @brief  Calibrate the 8D8D8D link on the Boot pattern
+ * @retval 0 if the timing found is inside the model window
+ */
+static int Sim_CalibCheck(void)
+{
+    static const XSPI_Bench_Point_t octal = { EXTMEM_LINK_CONFIG_8LINES, 0U };
+    EXTMEM_DRIVER_NOR_SFDP_ObjectTypeDef *object = &extmem_list_config[EXTMEMORY_1].NorSfdpObject;
+    EXTMEM_DRIVER_NOR_SFDP_CalibrationTypeDef calib;
+    int32_t low;
+    int32_t high;
+    int status;
+
+    memset(object, 0, sizeof(*object));
+    (void)XSPI_Bench_Setup(&octal, object);
+    Sim_DllUpdate();
+    Sim_Window(&low, &high);
+    printf("\ncalibration, board skew %ld: DLL default delay %u, window %ld..%ld at %lu MHz\n",
+           (long)simSkew, SIM_DLL_DEFAULT_FINE, (long)low, (long)high, (unsigned long)(Sim_Clock() / 1000000U));
+
+    status = XSPI_Calib_Run(&calib);
+    if (status != 0)
+    {
+        printf("calibration failed: %d\n", status);
+        return 1;
+    }
+
+    Sim_Window(&low, &high);
+    printf("calibrated: %lu MHz, delay %u, %u/%u settings pass, margin %ld/%ld\n",
+           (unsigned long)(calib.Clock / 1000000U), calib.Timing.DelayFine, calib.WindowWidth, calib.TapCount,
+           (long)calib.Timing.DelayFine - low, high - (long)calib.Timing.DelayFine);
+    return ((calib.Timing.DelayFine >= low) && (calib.Timing.DelayFine <= high)) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    XSPI_Bench_Point_t point = { EXTMEM_LINK_CONFIG_8LINES, 0U };
+    XSPI_Bench_Result_t result;
+    int failures;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "k:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'k': simKernelClock = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': simSkew = (int32_t)strtol(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-k kernel_clock_hz] [-s board_skew]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    flash = malloc(SIM_FLASH_SIZE);
+    if ((flash == NULL) || (simKernelClock == 0U))
+    {
+        return 1;
+    }
+    memset(flash, 0x00, SIM_FLASH_SIZE);    /* Not erased: a missing erase shows */
+
+    memset(&simRegs, 0, sizeof(simRegs));
+    simRegs.DCR1 = HAL_XSPI_MEMTYPE_MACRONIX;
+    simHandle.Instance = &simRegs;
+
+    printf("XSPI kernel clock %lu MHz, %u KB bench area\n\n",
+           (unsigned long)(simKernelClock / 1000000U), XSPI_BENCH_SIZE / 1024U);
+    failures = XSPI_Bench_Run();
+    printf("\nrejected commands: %lu, corrupted reads: %lu\n",
+           (unsigned long)simRejected, (unsigned long)simCorrupted);
+
+    /* The model must catch a dummy cycle count too short for the clock */
+    simDummyOverride = 14;
+    simCorrupted = 0;
+    (void)XSPI_Bench_Measure(&point, &result);
+    printf("model check, 14 dummy cycles at %lu MHz: %s\n", (unsigned long)(result.link.Clock / 1000000U),
+           ((result.status == -1) && (simCorrupted != 0U)) ? "rejected" : "NOT DETECTED");
+    if ((result.status != -1) || (simCorrupted == 0U) || (simRejected != 0U))
+    {
+        failures++;
+    }
+    simDummyOverride = -1;
+
+    failures += Sim_CalibCheck();
+
+    free(flash);
+    return (failures == 0) ? 0 : 1;
+}